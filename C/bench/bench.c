@@ -0,0 +1,369 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"../lib/numeric/realnum.h"
+#include"../lib/vector/vector.h"
+#include"../lib/matrix/matrix.h"
+#include"../lib/matrix/lu.h"
+#include"../lib/matrix/qr.h"
+#include"../lib/matrix/cholesky.h"
+#include"../lib/matrix/eigen.h"
+#include"../lib/matrix/batch.h"
+
+/*
+ * Benchmarks of the library kernels.
+ *
+ * Every benchmark repeats its operation until at least `min_seconds` have
+ * passed and prints one CSV row to stdout:
+ *
+ *   name,size,ns_per_op,gflops,bytes_per_elem
+ *
+ * `gflops` counts the arithmetic of the textbook algorithm on realnums, 0 for
+ * operations without arithmetic. `bytes_per_elem` is the storage the operation
+ * has to read and write, divided by the number of elements it works on.
+ *
+ * Usage: bench [min_seconds] [filter], where only benchmarks whose name
+ * contains `filter` run.
+ */
+
+typedef struct bench_case {
+    const char* name;
+    size_t size;
+    double flops; /* per operation */
+    double bytes; /* per operation */
+    double elems; /* per operation */
+    void (*run)(void* ctx);
+    void* ctx;
+} bench_case;
+
+static double min_seconds = 0.2;
+static const char* filter = NULL;
+static volatile realnum_aprox sink;
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Keeps the compiler from dropping a result. */
+static void consume(realnum* num) {
+    if (num->kind == REALNUM_APROX) {
+        sink = num->value.aprox;
+    }
+    realnum_free(num);
+}
+
+static void bench_run(bench_case* c) {
+    if (filter != NULL && strstr(c->name, filter) == NULL) {
+        return;
+    }
+    c->run(c->ctx);
+    size_t reps = 0;
+    double start = now();
+    double elapsed;
+    do {
+        c->run(c->ctx);
+        reps++;
+        elapsed = now() - start;
+    } while (elapsed < min_seconds);
+    double ns = elapsed * 1e9 / (double)reps;
+    printf("%s,%zu,%.1f,%.4f,%.1f\n", c->name, c->size, ns, c->flops / ns, c->bytes / c->elems);
+    fflush(stdout);
+}
+
+/* Deterministic values in [-1, 1). */
+static realnum_aprox bench_value(size_t i) {
+    return (realnum_aprox)((double)((i * 2654435761u) % 2048) / 1024.0 - 1.0);
+}
+
+static linvector bench_vector(size_t size, size_t seed) {
+    linvector vec = linvector_with_capacity(size);
+    for (size_t i = 0; i < size; i++) {
+        vec.data[i] = realnum_from_aprox(bench_value(seed + i));
+    }
+    vec.size = size;
+    return vec;
+}
+
+static linmatrix bench_matrix(size_t n, size_t seed) {
+    linmatrix mat = linmatrix_new(n, n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            linmatrix_set(&mat, i, j, realnum_from_aprox(bench_value(seed + i * n + j) + (i == j ? (realnum_aprox)n : 0)));
+        }
+    }
+    return mat;
+}
+
+/* Scalar operations, a batch of REALNUM_BATCH per run. */
+
+#define REALNUM_BATCH 1024
+
+typedef struct realnum_ctx {
+    realnum a[REALNUM_BATCH];
+    realnum b[REALNUM_BATCH];
+    realnum (*op)(realnum*, realnum*);
+} realnum_ctx;
+
+static void run_realnum(void* ctx) {
+    realnum_ctx* c = ctx;
+    for (size_t i = 0; i < REALNUM_BATCH; i++) {
+        realnum r = c->op(&c->a[i], &c->b[i]);
+        consume(&r);
+    }
+}
+
+static void bench_realnum(const char* name, realnum_kind kind, realnum (*op)(realnum*, realnum*)) {
+    realnum_ctx* ctx = malloc(sizeof(realnum_ctx));
+    for (size_t i = 0; i < REALNUM_BATCH; i++) {
+        if (kind == REALNUM_FRAC) {
+            ctx->a[i] = realnum_from_frac((int64_t)(i % 97) + 1, (int64_t)(i % 89) + 2);
+            ctx->b[i] = realnum_from_frac((int64_t)(i % 83) + 1, (int64_t)(i % 79) + 3);
+        } else {
+            ctx->a[i] = realnum_from_aprox(bench_value(i) + 2);
+            ctx->b[i] = realnum_from_aprox(bench_value(i + 1) + 2);
+        }
+    }
+    ctx->op = op;
+    bench_run(&(bench_case){name, REALNUM_BATCH, REALNUM_BATCH, 3.0 * REALNUM_BATCH * sizeof(realnum), REALNUM_BATCH, run_realnum, ctx});
+    free(ctx);
+}
+
+/* Vector operations. */
+
+typedef struct vector_ctx {
+    linvector a;
+    linvector b;
+    linvector dst;
+} vector_ctx;
+
+static void run_dot(void* ctx) {
+    vector_ctx* c = ctx;
+    realnum r = linvector_dot(&c->a, &c->b);
+    consume(&r);
+}
+
+static void run_add(void* ctx) {
+    vector_ctx* c = ctx;
+    linvector_add_into(&c->dst, &c->a, &c->b);
+}
+
+static void run_normalize(void* ctx) {
+    vector_ctx* c = ctx;
+    linvector_normalize_into(&c->dst, &c->a);
+}
+
+static void bench_vectors(size_t size) {
+    vector_ctx ctx = {bench_vector(size, 0), bench_vector(size, 7), bench_vector(size, 13)};
+    double n = (double)size;
+    double elem = sizeof(realnum);
+    bench_run(&(bench_case){"linvector_dot", size, 2 * n, 2 * n * elem, n, run_dot, &ctx});
+    bench_run(&(bench_case){"linvector_add_into", size, n, 3 * n * elem, n, run_add, &ctx});
+    bench_run(&(bench_case){"linvector_normalize_into", size, 3 * n, 3 * n * elem, n, run_normalize, &ctx});
+    linvector_free(&ctx.a);
+    linvector_free(&ctx.b);
+    linvector_free(&ctx.dst);
+}
+
+/* Matrix operations. */
+
+typedef struct matrix_ctx {
+    linmatrix a;
+    linmatrix b;
+    linmatrix spd; /* a^T * a + n * I, symmetric positive definite. */
+} matrix_ctx;
+
+static void run_mul(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix r = linmatrix_mul(&c->a, &c->b);
+    linmatrix_free(&r);
+}
+
+static void run_transpose(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix r = linmatrix_transpose(&c->a);
+    linmatrix_free(&r);
+}
+
+static void run_transpose_in_place(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix_transpose_in_place(&c->a);
+}
+
+static void run_determinant(void* ctx) {
+    matrix_ctx* c = ctx;
+    realnum r = linmatrix_determinant(&c->a);
+    consume(&r);
+}
+
+static void run_lu(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix_lu lu = linmatrix_lu_new(&c->a);
+    linmatrix_lu_free(&lu);
+}
+
+static void run_qr(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix_qr qr = linmatrix_qr_new(&c->a);
+    linmatrix_qr_free(&qr);
+}
+
+static void run_cholesky(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix_cholesky chol = linmatrix_cholesky_new(&c->spd);
+    linmatrix_cholesky_free(&chol);
+}
+
+static void run_eigen(void* ctx) {
+    matrix_ctx* c = ctx;
+    linmatrix_eigen eigen = linmatrix_eigen_symmetric(&c->spd, true);
+    linmatrix_eigen_free(&eigen);
+}
+
+/* The number of eigenpairs found by Lanczos, as in a PCA keeping a few components. */
+#define BENCH_EIGEN_TOP 8
+
+static void run_eigen_top(void* ctx) {
+    matrix_ctx* c = ctx;
+    linoperator op = linoperator_dense(&c->spd);
+    linmatrix_eigen eigen = linoperator_eigen_top(&op, BENCH_EIGEN_TOP);
+    linmatrix_eigen_free(&eigen);
+    linoperator_free(&op);
+}
+
+static linmatrix bench_spd(linmatrix* a) {
+    linmatrix at = linmatrix_transpose(a);
+    linmatrix spd = linmatrix_mul(&at, a);
+    realnum shift = realnum_from_frac((int64_t)a->rows, 1);
+    for (size_t i = 0; i < a->rows; i++) {
+        realnum sum = realnum_add(&spd.data[i * a->rows + i], &shift);
+        realnum_free(&spd.data[i * a->rows + i]);
+        spd.data[i * a->rows + i] = sum;
+    }
+    linmatrix_free(&at);
+    return spd;
+}
+
+static void bench_matrices(size_t size) {
+    matrix_ctx ctx = {bench_matrix(size, 0), bench_matrix(size, 7), {0}};
+    ctx.spd = bench_spd(&ctx.a);
+    double n = (double)size;
+    double elem = sizeof(realnum);
+    bench_run(&(bench_case){"linmatrix_mul", size, 2 * n * n * n, 3 * n * n * elem, n * n, run_mul, &ctx});
+    bench_run(&(bench_case){"linmatrix_transpose", size, 0, 2 * n * n * elem, n * n, run_transpose, &ctx});
+    bench_run(&(bench_case){"linmatrix_transpose_in_place", size, 0, 2 * n * n * elem, n * n, run_transpose_in_place, &ctx});
+    bench_run(&(bench_case){"linmatrix_lu_new", size, 2.0 / 3.0 * n * n * n, 2 * n * n * elem, n * n, run_lu, &ctx});
+    bench_run(&(bench_case){"linmatrix_determinant", size, 2.0 / 3.0 * n * n * n, 2 * n * n * elem, n * n, run_determinant, &ctx});
+    bench_run(&(bench_case){"linmatrix_qr_new", size, 4.0 / 3.0 * n * n * n, 2 * n * n * elem, n * n, run_qr, &ctx});
+    bench_run(&(bench_case){"linmatrix_cholesky_new", size, 1.0 / 3.0 * n * n * n, 2 * n * n * elem, n * n, run_cholesky, &ctx});
+    // The Lanczos iteration count depends on the spectrum, its flop rate is not reported.
+    bench_run(&(bench_case){"linmatrix_eigen_symmetric", size, 9 * n * n * n, 2 * n * n * elem, n * n, run_eigen, &ctx});
+    bench_run(&(bench_case){"linoperator_eigen_top", size, 0, 2 * n * n * elem, n * n, run_eigen_top, &ctx});
+    linmatrix_free(&ctx.a);
+    linmatrix_free(&ctx.b);
+    linmatrix_free(&ctx.spd);
+}
+
+/* Batches of small matrices, BENCH_BATCH_COUNT per run. */
+
+#define BENCH_BATCH_COUNT 4096
+
+typedef struct batch_ctx {
+    linmatrix_batch a;
+    linmatrix_batch b;
+    linmatrix* each; /* The matrices of `a`, one linmatrix each. */
+} batch_ctx;
+
+static void run_batch_mul(void* ctx) {
+    batch_ctx* c = ctx;
+    linmatrix_batch r = linmatrix_batch_mul(&c->a, &c->b);
+    linmatrix_batch_free(&r);
+}
+
+static void run_batch_lu(void* ctx) {
+    batch_ctx* c = ctx;
+    linmatrix_batch_lu lu = linmatrix_batch_lu_new(&c->a);
+    linmatrix_batch_lu_free(&lu);
+}
+
+static void run_batch_solve(void* ctx) {
+    batch_ctx* c = ctx;
+    linmatrix_batch r = linmatrix_batch_solve(&c->a, &c->b);
+    linmatrix_batch_free(&r);
+}
+
+static void run_batch_determinant(void* ctx) {
+    batch_ctx* c = ctx;
+    linvector r = linmatrix_batch_determinant(&c->a);
+    consume(&r.data[0]);
+    linvector_free(&r);
+}
+
+/* The same determinants one linmatrix at a time, for comparison. */
+static void run_batch_determinant_each(void* ctx) {
+    batch_ctx* c = ctx;
+    for (size_t m = 0; m < BENCH_BATCH_COUNT; m++) {
+        realnum r = linmatrix_determinant(&c->each[m]);
+        consume(&r);
+    }
+}
+
+static void bench_batches(size_t size) {
+    batch_ctx ctx = {linmatrix_batch_new(BENCH_BATCH_COUNT, size, size), linmatrix_batch_new(BENCH_BATCH_COUNT, size, size), malloc(BENCH_BATCH_COUNT * sizeof(linmatrix))};
+    for (size_t m = 0; m < BENCH_BATCH_COUNT; m++) {
+        ctx.each[m] = bench_matrix(size, m * size * size);
+        linmatrix_batch_set_matrix(&ctx.a, m, &ctx.each[m]);
+        linmatrix b = bench_matrix(size, m * size * size + 7);
+        linmatrix_batch_set_matrix(&ctx.b, m, &b);
+        linmatrix_free(&b);
+    }
+    double n = (double)size;
+    double count = BENCH_BATCH_COUNT;
+    double elem = sizeof(realnum_aprox);
+    bench_run(&(bench_case){"linmatrix_batch_mul", size, count * 2 * n * n * n, count * 3 * n * n * elem, count * n * n, run_batch_mul, &ctx});
+    bench_run(&(bench_case){"linmatrix_batch_lu_new", size, count * 2.0 / 3.0 * n * n * n, count * 2 * n * n * elem, count * n * n, run_batch_lu, &ctx});
+    bench_run(&(bench_case){"linmatrix_batch_solve", size, count * 8.0 / 3.0 * n * n * n, count * 4 * n * n * elem, count * n * n, run_batch_solve, &ctx});
+    bench_run(&(bench_case){"linmatrix_batch_determinant", size, count * 2.0 / 3.0 * n * n * n, count * 2 * n * n * elem, count * n * n, run_batch_determinant, &ctx});
+    bench_run(&(bench_case){"linmatrix_batch_determinant_each", size, count * 2.0 / 3.0 * n * n * n, count * 2 * n * n * sizeof(realnum), count * n * n, run_batch_determinant_each, &ctx});
+    for (size_t m = 0; m < BENCH_BATCH_COUNT; m++) {
+        linmatrix_free(&ctx.each[m]);
+    }
+    free(ctx.each);
+    linmatrix_batch_free(&ctx.a);
+    linmatrix_batch_free(&ctx.b);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        min_seconds = atof(argv[1]);
+    }
+    if (argc > 2) {
+        filter = argv[2];
+    }
+    printf("name,size,ns_per_op,gflops,bytes_per_elem\n");
+
+    bench_realnum("realnum_add_frac", REALNUM_FRAC, realnum_add);
+    bench_realnum("realnum_mul_frac", REALNUM_FRAC, realnum_mul);
+    bench_realnum("realnum_div_frac", REALNUM_FRAC, realnum_div);
+    bench_realnum("realnum_add_aprox", REALNUM_APROX, realnum_add);
+    bench_realnum("realnum_mul_aprox", REALNUM_APROX, realnum_mul);
+    bench_realnum("realnum_div_aprox", REALNUM_APROX, realnum_div);
+
+    size_t vector_sizes[] = {16, 1024, 65536, 1048576};
+    for (size_t i = 0; i < sizeof(vector_sizes) / sizeof(vector_sizes[0]); i++) {
+        bench_vectors(vector_sizes[i]);
+    }
+
+    size_t matrix_sizes[] = {16, 64, 128};
+    for (size_t i = 0; i < sizeof(matrix_sizes) / sizeof(matrix_sizes[0]); i++) {
+        bench_matrices(matrix_sizes[i]);
+    }
+
+    size_t batch_sizes[] = {4, 8, 16, 32};
+    for (size_t i = 0; i < sizeof(batch_sizes) / sizeof(batch_sizes[0]); i++) {
+        bench_batches(batch_sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,485 @@
+#include<string.h>
+#include"./device.h"
+
+static void* lindevice_host_alloc(void* ctx, size_t bytes) {
+    (void)ctx;
+    return malloc(bytes ? bytes : 1);
+}
+
+static void lindevice_host_release(void* ctx, void* buffer) {
+    (void)ctx;
+    free(buffer);
+}
+
+static void lindevice_host_copy(void* ctx, void* dst, const void* src, size_t bytes) {
+    (void)ctx;
+    memcpy(dst, src, bytes);
+}
+
+static void lindevice_host_gemm(void* ctx, size_t m, size_t k, size_t n, const void* a, const void* b, void* c) {
+    (void)ctx;
+    const realnum_aprox* x = a;
+    const realnum_aprox* y = b;
+    realnum_aprox* z = c;
+    // Sweep LINMATRIX_BLOCK_NC columns at a time so the rows of b stay in cache.
+    for (size_t jc = 0; jc < n; jc += LINMATRIX_BLOCK_NC) {
+        size_t end = jc + LINMATRIX_BLOCK_NC < n ? jc + LINMATRIX_BLOCK_NC : n;
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (m * k * (end - jc) >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = 0; i < m; i++) {
+            realnum_aprox* row = z + i * n;
+            for (size_t j = jc; j < end; j++) {
+                row[j] = 0;
+            }
+            for (size_t p = 0; p < k; p++) {
+                realnum_aprox factor = x[i * k + p];
+                for (size_t j = jc; j < end; j++) {
+                    row[j] += factor * y[p * n + j];
+                }
+            }
+        }
+    }
+}
+
+static void lindevice_host_spmv(void* ctx, size_t rows, const void* offsets, const void* indices, const void* values, const void* x, void* y) {
+    (void)ctx;
+    const size_t* o = offsets;
+    const size_t* idx = indices;
+    const realnum_aprox* v = values;
+    const realnum_aprox* in = x;
+    realnum_aprox* out = y;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (o[rows] >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < rows; i++) {
+        realnum_aprox sum = 0;
+        for (size_t p = o[i]; p < o[i + 1]; p++) {
+            sum += v[p] * in[idx[p]];
+        }
+        out[i] = sum;
+    }
+}
+
+static realnum_aprox lindevice_host_dot(void* ctx, size_t n, const void* x, const void* y) {
+    (void)ctx;
+    const realnum_aprox* a = x;
+    const realnum_aprox* b = y;
+    realnum_aprox sum = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) reduction(+:sum) if (n >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static lindevice lindevice_host_device = {
+    "host",
+    0,
+    lindevice_host_alloc,
+    lindevice_host_release,
+    lindevice_host_copy,
+    lindevice_host_copy,
+    lindevice_host_gemm,
+    lindevice_host_spmv,
+    lindevice_host_dot,
+    NULL,
+};
+
+lindevice* lindevice_host(void) {
+    return &lindevice_host_device;
+}
+
+lindevice* lindevice_for(lindevice* device, size_t work) {
+    return work < device->min_work ? lindevice_host() : device;
+}
+
+/* Approximates `size` realnums into a new host buffer. */
+static realnum_aprox* lindevice_approximate(realnum* data, size_t size) {
+    realnum_aprox* values = malloc((size ? size : 1) * sizeof(realnum_aprox));
+    for (size_t i = 0; i < size; i++) {
+        values[i] = realnum_as_aprox(&data[i]).value.aprox;
+    }
+    return values;
+}
+
+/* Copies `size` approximations from a device buffer over the realnums of `data`. */
+static void lindevice_restore(lindevice* device, const void* src, realnum* data, size_t size) {
+    realnum_aprox* values = malloc((size ? size : 1) * sizeof(realnum_aprox));
+    device->download(device->ctx, values, src, size * sizeof(realnum_aprox));
+    for (size_t i = 0; i < size; i++) {
+        realnum_free(&data[i]);
+        data[i] = realnum_from_aprox(values[i]);
+    }
+    free(values);
+}
+
+static void* lindevice_upload_values(lindevice* device, realnum* data, size_t size) {
+    void* buffer = device->alloc(device->ctx, size * sizeof(realnum_aprox));
+    realnum_aprox* values = lindevice_approximate(data, size);
+    device->upload(device->ctx, buffer, values, size * sizeof(realnum_aprox));
+    free(values);
+    return buffer;
+}
+
+lindevice_matrix lindevice_matrix_new(lindevice* device, size_t rows, size_t cols) {
+    return (lindevice_matrix){device, rows, cols, device->alloc(device->ctx, rows * cols * sizeof(realnum_aprox))};
+}
+
+lindevice_matrix lindevice_matrix_upload(lindevice* device, linmatrix* a) {
+    return (lindevice_matrix){device, a->rows, a->cols, lindevice_upload_values(device, a->data, a->rows * a->cols)};
+}
+
+linmatrix lindevice_matrix_download(lindevice_matrix* a) {
+    linmatrix host = linmatrix_new(a->rows, a->cols);
+    lindevice_restore(a->device, a->data, host.data, a->rows * a->cols);
+    return host;
+}
+
+void lindevice_matrix_free(lindevice_matrix* a) {
+    if (a->data != NULL) {
+        a->device->release(a->device->ctx, a->data);
+    }
+    a->data = NULL;
+    a->rows = 0;
+    a->cols = 0;
+}
+
+lindevice_vector lindevice_vector_new(lindevice* device, size_t size) {
+    return (lindevice_vector){device, size, device->alloc(device->ctx, size * sizeof(realnum_aprox))};
+}
+
+lindevice_vector lindevice_vector_upload(lindevice* device, linvector* vec) {
+    return (lindevice_vector){device, vec->size, lindevice_upload_values(device, vec->data, vec->size)};
+}
+
+linvector lindevice_vector_download(lindevice_vector* vec) {
+    linvector host = linvector_with_capacity(vec->size ? vec->size : 1);
+    for (size_t i = 0; i < vec->size; i++) {
+        linvector_push(&host, realnum_new());
+    }
+    lindevice_restore(vec->device, vec->data, host.data, vec->size);
+    return host;
+}
+
+void lindevice_vector_free(lindevice_vector* vec) {
+    if (vec->data != NULL) {
+        vec->device->release(vec->device->ctx, vec->data);
+    }
+    vec->data = NULL;
+    vec->size = 0;
+}
+
+lindevice_sparse lindevice_sparse_upload(lindevice* device, linsparse* a) {
+    linsparse csr = a->format == LINSPARSE_CSR ? *a : linsparse_convert(a, LINSPARSE_CSR);
+    lindevice_sparse sparse;
+    sparse.device = device;
+    sparse.rows = csr.rows;
+    sparse.cols = csr.cols;
+    sparse.nnz = csr.nnz;
+    sparse.offsets = device->alloc(device->ctx, (csr.rows + 1) * sizeof(size_t));
+    device->upload(device->ctx, sparse.offsets, csr.offsets, (csr.rows + 1) * sizeof(size_t));
+    sparse.indices = device->alloc(device->ctx, csr.nnz * sizeof(size_t));
+    device->upload(device->ctx, sparse.indices, csr.indices, csr.nnz * sizeof(size_t));
+    sparse.values = lindevice_upload_values(device, csr.values, csr.nnz);
+    if (a->format != LINSPARSE_CSR) {
+        linsparse_free(&csr);
+    }
+    return sparse;
+}
+
+void lindevice_sparse_free(lindevice_sparse* a) {
+    if (a->offsets != NULL) {
+        a->device->release(a->device->ctx, a->offsets);
+        a->device->release(a->device->ctx, a->indices);
+        a->device->release(a->device->ctx, a->values);
+    }
+    a->offsets = NULL;
+    a->indices = NULL;
+    a->values = NULL;
+    a->rows = 0;
+    a->cols = 0;
+    a->nnz = 0;
+}
+
+static void lindevice_check_gemm(lindevice_matrix* a, lindevice_matrix* b, lindevice_matrix* c) {
+    if (a->device != b->device || a->device != c->device) {
+        fprintf(stderr, "Error: the operands must be on the same device.\n");
+        exit(1);
+    }
+    if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols) {
+        fprintf(stderr, "Error: the dimensions of the device matrices do not match.\n");
+        exit(1);
+    }
+}
+
+static void lindevice_check_spmv(lindevice_sparse* a, lindevice_vector* x, lindevice_vector* y) {
+    if (a->device != x->device || a->device != y->device) {
+        fprintf(stderr, "Error: the operands must be on the same device.\n");
+        exit(1);
+    }
+    if (x->size != a->cols || y->size != a->rows) {
+        fprintf(stderr, "Error: the sizes of the device vectors must match the matrix.\n");
+        exit(1);
+    }
+}
+
+static void lindevice_check_dot(lindevice_vector* x, lindevice_vector* y) {
+    if (x->device != y->device) {
+        fprintf(stderr, "Error: the operands must be on the same device.\n");
+        exit(1);
+    }
+    if (x->size != y->size) {
+        fprintf(stderr, "Error: the device vectors must have the same size.\n");
+        exit(1);
+    }
+}
+
+void lindevice_gemm(lindevice_matrix* a, lindevice_matrix* b, lindevice_matrix* c) {
+    lindevice_check_gemm(a, b, c);
+    lindevice* device = a->device;
+    device->gemm(device->ctx, a->rows, a->cols, b->cols, a->data, b->data, c->data);
+}
+
+void lindevice_spmv(lindevice_sparse* a, lindevice_vector* x, lindevice_vector* y) {
+    lindevice_check_spmv(a, x, y);
+    lindevice* device = a->device;
+    device->spmv(device->ctx, a->rows, a->offsets, a->indices, a->values, x->data, y->data);
+}
+
+realnum lindevice_dot(lindevice_vector* x, lindevice_vector* y) {
+    lindevice_check_dot(x, y);
+    lindevice* device = x->device;
+    return realnum_from_aprox(device->dot(device->ctx, x->size, x->data, y->data));
+}
+
+linmatrix linmatrix_mul_on(lindevice* device, linmatrix* a, linmatrix* b) {
+    lindevice* target = lindevice_for(device, a->rows * a->cols * b->cols);
+    if (target == lindevice_host() || a->cols != b->rows) {
+        return linmatrix_mul(a, b);
+    }
+    lindevice_matrix da = lindevice_matrix_upload(target, a);
+    lindevice_matrix db = lindevice_matrix_upload(target, b);
+    lindevice_matrix dc = lindevice_matrix_new(target, a->rows, b->cols);
+    lindevice_gemm(&da, &db, &dc);
+    linmatrix c = lindevice_matrix_download(&dc);
+    lindevice_matrix_free(&da);
+    lindevice_matrix_free(&db);
+    lindevice_matrix_free(&dc);
+    return c;
+}
+
+/* A queued call, with `ctx` freed after it when the stream allocated it. */
+struct linstream_task {
+    void (*run)(void* ctx);
+    void* ctx;
+    bool owned;
+    linstream_task* next;
+};
+
+static int linstream_worker(void* arg) {
+    linstream* stream = arg;
+    mtx_lock(&stream->lock);
+    for (;;) {
+        while (stream->head == NULL && !stream->closing) {
+            cnd_wait(&stream->changed, &stream->lock);
+        }
+        if (stream->head == NULL) {
+            break;
+        }
+        linstream_task* task = stream->head;
+        stream->head = task->next;
+        if (stream->head == NULL) {
+            stream->tail = NULL;
+        }
+        mtx_unlock(&stream->lock);
+        task->run(task->ctx);
+        if (task->owned) {
+            free(task->ctx);
+        }
+        free(task);
+        mtx_lock(&stream->lock);
+        stream->completed++;
+        cnd_broadcast(&stream->changed);
+    }
+    mtx_unlock(&stream->lock);
+    return 0;
+}
+
+linstream* linstream_new(lindevice* device) {
+    linstream* stream = malloc(sizeof(linstream));
+    stream->device = device;
+    stream->head = NULL;
+    stream->tail = NULL;
+    stream->submitted = 0;
+    stream->completed = 0;
+    stream->closing = false;
+    if (mtx_init(&stream->lock, mtx_plain) != thrd_success || cnd_init(&stream->changed) != thrd_success
+        || thrd_create(&stream->worker, linstream_worker, stream) != thrd_success) {
+        fprintf(stderr, "Error: could not start the stream thread.\n");
+        exit(1);
+    }
+    return stream;
+}
+
+void linstream_free(linstream* stream) {
+    mtx_lock(&stream->lock);
+    stream->closing = true;
+    cnd_broadcast(&stream->changed);
+    mtx_unlock(&stream->lock);
+    thrd_join(stream->worker, NULL);
+    cnd_destroy(&stream->changed);
+    mtx_destroy(&stream->lock);
+    free(stream);
+}
+
+static uint64_t linstream_enqueue(linstream* stream, void (*run)(void* ctx), void* ctx, bool owned) {
+    linstream_task* task = malloc(sizeof(linstream_task));
+    task->run = run;
+    task->ctx = ctx;
+    task->owned = owned;
+    task->next = NULL;
+    mtx_lock(&stream->lock);
+    if (stream->tail == NULL) {
+        stream->head = task;
+    } else {
+        stream->tail->next = task;
+    }
+    stream->tail = task;
+    uint64_t ticket = ++stream->submitted;
+    cnd_broadcast(&stream->changed);
+    mtx_unlock(&stream->lock);
+    return ticket;
+}
+
+uint64_t linstream_submit(linstream* stream, void (*run)(void* ctx), void* ctx) {
+    return linstream_enqueue(stream, run, ctx, false);
+}
+
+static void linstream_check_device(linstream* stream, lindevice* device) {
+    if (device != stream->device) {
+        fprintf(stderr, "Error: the operands must be on the device of the stream.\n");
+        exit(1);
+    }
+}
+
+typedef struct linstream_transfer_ctx {
+    linmatrix* host;
+    lindevice_matrix* device;
+} linstream_transfer_ctx;
+
+static void linstream_run_upload(void* ctx) {
+    linstream_transfer_ctx* t = ctx;
+    size_t size = t->host->rows * t->host->cols;
+    realnum_aprox* values = lindevice_approximate(t->host->data, size);
+    lindevice* device = t->device->device;
+    device->upload(device->ctx, t->device->data, values, size * sizeof(realnum_aprox));
+    free(values);
+}
+
+static void linstream_run_download(void* ctx) {
+    linstream_transfer_ctx* t = ctx;
+    lindevice_restore(t->device->device, t->device->data, t->host->data, t->host->rows * t->host->cols);
+}
+
+static uint64_t linstream_transfer(linstream* stream, linmatrix* host, lindevice_matrix* device, void (*run)(void* ctx)) {
+    linstream_check_device(stream, device->device);
+    if (host->rows != device->rows || host->cols != device->cols) {
+        fprintf(stderr, "Error: the host and device matrices must have the same shape.\n");
+        exit(1);
+    }
+    linstream_transfer_ctx* ctx = malloc(sizeof(linstream_transfer_ctx));
+    ctx->host = host;
+    ctx->device = device;
+    return linstream_enqueue(stream, run, ctx, true);
+}
+
+uint64_t linstream_matrix_upload(linstream* stream, linmatrix* src, lindevice_matrix* dst) {
+    return linstream_transfer(stream, src, dst, linstream_run_upload);
+}
+
+uint64_t linstream_matrix_download(linstream* stream, lindevice_matrix* src, linmatrix* dst) {
+    return linstream_transfer(stream, dst, src, linstream_run_download);
+}
+
+typedef struct linstream_gemm_ctx {
+    lindevice_matrix* a;
+    lindevice_matrix* b;
+    lindevice_matrix* c;
+} linstream_gemm_ctx;
+
+static void linstream_run_gemm(void* ctx) {
+    linstream_gemm_ctx* g = ctx;
+    lindevice_gemm(g->a, g->b, g->c);
+}
+
+uint64_t linstream_gemm(linstream* stream, lindevice_matrix* a, lindevice_matrix* b, lindevice_matrix* c) {
+    lindevice_check_gemm(a, b, c);
+    linstream_check_device(stream, a->device);
+    linstream_gemm_ctx* ctx = malloc(sizeof(linstream_gemm_ctx));
+    *ctx = (linstream_gemm_ctx){a, b, c};
+    return linstream_enqueue(stream, linstream_run_gemm, ctx, true);
+}
+
+typedef struct linstream_spmv_ctx {
+    lindevice_sparse* a;
+    lindevice_vector* x;
+    lindevice_vector* y;
+} linstream_spmv_ctx;
+
+static void linstream_run_spmv(void* ctx) {
+    linstream_spmv_ctx* s = ctx;
+    lindevice_spmv(s->a, s->x, s->y);
+}
+
+uint64_t linstream_spmv(linstream* stream, lindevice_sparse* a, lindevice_vector* x, lindevice_vector* y) {
+    lindevice_check_spmv(a, x, y);
+    linstream_check_device(stream, a->device);
+    linstream_spmv_ctx* ctx = malloc(sizeof(linstream_spmv_ctx));
+    *ctx = (linstream_spmv_ctx){a, x, y};
+    return linstream_enqueue(stream, linstream_run_spmv, ctx, true);
+}
+
+typedef struct linstream_dot_ctx {
+    lindevice_vector* x;
+    lindevice_vector* y;
+    realnum* result;
+} linstream_dot_ctx;
+
+static void linstream_run_dot(void* ctx) {
+    linstream_dot_ctx* d = ctx;
+    realnum_free(d->result);
+    *d->result = lindevice_dot(d->x, d->y);
+}
+
+uint64_t linstream_dot(linstream* stream, lindevice_vector* x, lindevice_vector* y, realnum* result) {
+    lindevice_check_dot(x, y);
+    linstream_check_device(stream, x->device);
+    linstream_dot_ctx* ctx = malloc(sizeof(linstream_dot_ctx));
+    *ctx = (linstream_dot_ctx){x, y, result};
+    return linstream_enqueue(stream, linstream_run_dot, ctx, true);
+}
+
+bool linstream_done(linstream* stream, uint64_t ticket) {
+    mtx_lock(&stream->lock);
+    bool done = stream->completed >= ticket;
+    mtx_unlock(&stream->lock);
+    return done;
+}
+
+void linstream_wait(linstream* stream, uint64_t ticket) {
+    mtx_lock(&stream->lock);
+    while (stream->completed < ticket) {
+        cnd_wait(&stream->changed, &stream->lock);
+    }
+    mtx_unlock(&stream->lock);
+}
+
+void linstream_sync(linstream* stream) {
+    mtx_lock(&stream->lock);
+    uint64_t ticket = stream->submitted;
+    mtx_unlock(&stream->lock);
+    linstream_wait(stream, ticket);
+}
@@ -0,0 +1,349 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include<threads.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"../matrix/matrix.h"
+#include"../sparse/sparse.h"
+
+/*
+ * The default number of multiply-adds under which linmatrix_mul_on keeps a
+ * product on the host: below it the transfers cost more than the device saves.
+ */
+#ifndef LINDEVICE_MIN_WORK
+#define LINDEVICE_MIN_WORK (1 << 21)
+#endif
+
+/**
+ * @struct lindevice
+ * @brief An execution backend for the throughput-bound kernels.
+ *
+ * Buffers are opaque handles to `bytes` of device memory returned by `alloc`,
+ * holding row-major arrays of realnum_aprox (and of size_t for sparse
+ * structure). `upload` and `download` copy between host and device memory.
+ * `gemm` overwrites the m x n buffer `c` with a * b, `spmv` overwrites `y`
+ * with the product of a CSR matrix and `x`, and `dot` returns the dot product
+ * of two buffers. A GPU backend fills these fields with its own launches;
+ * lindevice_host runs them on the host.
+ */
+typedef struct lindevice {
+    const char* name;
+    size_t min_work; /**< Products with fewer multiply-adds stay on the host in linmatrix_mul_on. */
+    void* (*alloc)(void* ctx, size_t bytes);
+    void (*release)(void* ctx, void* buffer);
+    void (*upload)(void* ctx, void* dst, const void* src, size_t bytes);
+    void (*download)(void* ctx, void* dst, const void* src, size_t bytes);
+    void (*gemm)(void* ctx, size_t m, size_t k, size_t n, const void* a, const void* b, void* c);
+    void (*spmv)(void* ctx, size_t rows, const void* offsets, const void* indices, const void* values, const void* x, void* y);
+    realnum_aprox (*dot)(void* ctx, size_t n, const void* x, const void* y);
+    void* ctx;
+} lindevice;
+
+/**
+ * @struct lindevice_matrix
+ * @brief A dense matrix resident in the memory of a device.
+ */
+typedef struct lindevice_matrix {
+    lindevice* device;
+    size_t rows;
+    size_t cols;
+    void* data;
+} lindevice_matrix;
+
+/**
+ * @struct lindevice_vector
+ * @brief A vector resident in the memory of a device.
+ */
+typedef struct lindevice_vector {
+    lindevice* device;
+    size_t size;
+    void* data;
+} lindevice_vector;
+
+/**
+ * @struct lindevice_sparse
+ * @brief A CSR matrix resident in the memory of a device.
+ */
+typedef struct lindevice_sparse {
+    lindevice* device;
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    void* offsets;
+    void* indices;
+    void* values;
+} lindevice_sparse;
+
+typedef struct linstream_task linstream_task;
+
+/**
+ * @struct linstream
+ * @brief An in-order queue of device work run by a thread of its own.
+ *
+ * Every submission returns a ticket, numbered from 1 in submission order; the
+ * caller keeps the handles and host data of a submission alive, and does not
+ * touch its outputs, until linstream_wait on its ticket returns. Meanwhile the
+ * host is free to prepare the next batch of work.
+ */
+typedef struct linstream {
+    lindevice* device;
+    thrd_t worker;
+    mtx_t lock;
+    cnd_t changed;
+    linstream_task* head;
+    linstream_task* tail;
+    uint64_t submitted;
+    uint64_t completed;
+    bool closing;
+} linstream;
+
+/**
+ * Returns the built-in backend, whose buffers are host memory and whose kernels
+ * run on the host, split between threads when built with OpenMP.
+ *
+ * It is the fallback of every other backend and a reference to test them against.
+ *
+ * @return The host backend.
+ */
+lindevice* lindevice_host(void);
+
+/**
+ * Returns the backend a product of `work` multiply-adds should run on.
+ *
+ * @param device The preferred backend.
+ * @param work The number of multiply-adds.
+ * @return `device`, or lindevice_host when `work` is below its `min_work`.
+ */
+lindevice* lindevice_for(lindevice* device, size_t work);
+
+/**
+ * Allocates a matrix on a device, with undefined elements until written.
+ *
+ * @param device The backend.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return The device matrix.
+ */
+lindevice_matrix lindevice_matrix_new(lindevice* device, size_t rows, size_t cols);
+
+/**
+ * Copies an approximation of a matrix to a device.
+ *
+ * @param device The backend.
+ * @param a The matrix, left untouched.
+ * @return The device matrix.
+ */
+lindevice_matrix lindevice_matrix_upload(lindevice* device, linmatrix* a);
+
+/**
+ * Copies a device matrix back to the host.
+ *
+ * @param a The device matrix.
+ * @return The matrix, with approximated elements.
+ */
+linmatrix lindevice_matrix_download(lindevice_matrix* a);
+
+/**
+ * Frees the device memory of the given matrix.
+ *
+ * @param a The device matrix to free.
+ */
+void lindevice_matrix_free(lindevice_matrix* a);
+
+/**
+ * Allocates a vector on a device, with undefined elements until written.
+ *
+ * @param device The backend.
+ * @param size The number of elements.
+ * @return The device vector.
+ */
+lindevice_vector lindevice_vector_new(lindevice* device, size_t size);
+
+/**
+ * Copies an approximation of a vector to a device.
+ *
+ * @param device The backend.
+ * @param vec The vector, left untouched.
+ * @return The device vector.
+ */
+lindevice_vector lindevice_vector_upload(lindevice* device, linvector* vec);
+
+/**
+ * Copies a device vector back to the host.
+ *
+ * @param vec The device vector.
+ * @return The vector, with approximated elements.
+ */
+linvector lindevice_vector_download(lindevice_vector* vec);
+
+/**
+ * Frees the device memory of the given vector.
+ *
+ * @param vec The device vector to free.
+ */
+void lindevice_vector_free(lindevice_vector* vec);
+
+/**
+ * Copies an approximation of a sparse matrix to a device, converting it to CSR.
+ *
+ * @param device The backend.
+ * @param a The sparse matrix of either format, left untouched.
+ * @return The device matrix.
+ */
+lindevice_sparse lindevice_sparse_upload(lindevice* device, linsparse* a);
+
+/**
+ * Frees the device memory of the given sparse matrix.
+ *
+ * @param a The device matrix to free.
+ */
+void lindevice_sparse_free(lindevice_sparse* a);
+
+/**
+ * Overwrites c with a * b on the device of the three matrices.
+ *
+ * @param a The left factor.
+ * @param b The right factor, with one row per column of `a`.
+ * @param c The product, with the rows of `a` and the columns of `b`.
+ */
+void lindevice_gemm(lindevice_matrix* a, lindevice_matrix* b, lindevice_matrix* c);
+
+/**
+ * Overwrites y with a * x on the device of the three operands.
+ *
+ * @param a The sparse matrix.
+ * @param x The vector, with one element per column of `a`.
+ * @param y The product, with one element per row of `a`.
+ */
+void lindevice_spmv(lindevice_sparse* a, lindevice_vector* x, lindevice_vector* y);
+
+/**
+ * Calculates the dot product of two vectors on their device.
+ *
+ * @param x The first vector.
+ * @param y The second vector, of the same size.
+ * @return The approximated dot product.
+ */
+realnum lindevice_dot(lindevice_vector* x, lindevice_vector* y);
+
+/**
+ * Multiplies two host matrices on the backend lindevice_for picks.
+ *
+ * On the host this is linmatrix_mul, exact for exact operands. On another
+ * device the operands are uploaded, multiplied and the approximated product
+ * downloaded.
+ *
+ * @param device The preferred backend.
+ * @param a The left factor, left untouched.
+ * @param b The right factor, left untouched.
+ * @return The product.
+ */
+linmatrix linmatrix_mul_on(lindevice* device, linmatrix* a, linmatrix* b);
+
+/**
+ * Creates a stream for a device and starts its thread.
+ *
+ * The stream is returned by pointer since its thread keeps referring to it.
+ *
+ * @param device The backend the work is submitted to.
+ * @return The stream, to be freed with linstream_free.
+ */
+linstream* linstream_new(lindevice* device);
+
+/**
+ * Waits for the pending work of a stream, stops its thread and frees it.
+ *
+ * @param stream The stream to free.
+ */
+void linstream_free(linstream* stream);
+
+/**
+ * Queues a call of `run(ctx)` on the thread of a stream.
+ *
+ * @param stream The stream.
+ * @param run The function to call.
+ * @param ctx Its argument.
+ * @return The ticket of the submission.
+ */
+uint64_t linstream_submit(linstream* stream, void (*run)(void* ctx), void* ctx);
+
+/**
+ * Queues the upload of a host matrix into a device matrix of its shape.
+ *
+ * @param stream The stream.
+ * @param src The host matrix.
+ * @param dst The device matrix, on the device of the stream.
+ * @return The ticket of the submission.
+ */
+uint64_t linstream_matrix_upload(linstream* stream, linmatrix* src, lindevice_matrix* dst);
+
+/**
+ * Queues the download of a device matrix into a host matrix of its shape,
+ * whose elements are replaced by approximations.
+ *
+ * @param stream The stream.
+ * @param src The device matrix.
+ * @param dst The host matrix.
+ * @return The ticket of the submission.
+ */
+uint64_t linstream_matrix_download(linstream* stream, lindevice_matrix* src, linmatrix* dst);
+
+/**
+ * Queues lindevice_gemm(a, b, c).
+ *
+ * @param stream The stream.
+ * @param a The left factor.
+ * @param b The right factor.
+ * @param c The product.
+ * @return The ticket of the submission.
+ */
+uint64_t linstream_gemm(linstream* stream, lindevice_matrix* a, lindevice_matrix* b, lindevice_matrix* c);
+
+/**
+ * Queues lindevice_spmv(a, x, y).
+ *
+ * @param stream The stream.
+ * @param a The sparse matrix.
+ * @param x The vector.
+ * @param y The product.
+ * @return The ticket of the submission.
+ */
+uint64_t linstream_spmv(linstream* stream, lindevice_sparse* a, lindevice_vector* x, lindevice_vector* y);
+
+/**
+ * Queues lindevice_dot(x, y) into `*result`.
+ *
+ * @param stream The stream.
+ * @param x The first vector.
+ * @param y The second vector.
+ * @param result Where to store the dot product. It must hold a realnum, such as realnum_new(), which is freed first.
+ * @return The ticket of the submission.
+ */
+uint64_t linstream_dot(linstream* stream, lindevice_vector* x, lindevice_vector* y, realnum* result);
+
+/**
+ * Returns whether the submission with the given ticket has completed.
+ *
+ * @param stream The stream.
+ * @param ticket The ticket.
+ * @return Whether it has completed.
+ */
+bool linstream_done(linstream* stream, uint64_t ticket);
+
+/**
+ * Blocks until the submission with the given ticket, and every one before it, has completed.
+ *
+ * @param stream The stream.
+ * @param ticket The ticket.
+ */
+void linstream_wait(linstream* stream, uint64_t ticket);
+
+/**
+ * Blocks until every submission so far has completed.
+ *
+ * @param stream The stream.
+ */
+void linstream_sync(linstream* stream);
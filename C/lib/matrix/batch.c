@@ -0,0 +1,315 @@
+#include<string.h>
+#include"./batch.h"
+#include"../stats/stats.h"
+
+#define L LINMATRIX_BATCH_LANES
+
+static size_t linmatrix_batch_groups(size_t count) {
+    return (count + L - 1) / L;
+}
+
+/*
+ * The offset of element (row, col) of matrix m in a batch with `rows` rows and `cols` columns.
+ */
+static size_t linmatrix_batch_index(size_t rows, size_t cols, size_t m, size_t row, size_t col) {
+    return ((m / L) * rows * cols + row * cols + col) * L + m % L;
+}
+
+static void linmatrix_batch_check(linmatrix_batch* batch, size_t m, size_t row, size_t col) {
+    if (m >= batch->count || row >= batch->rows || col >= batch->cols) {
+        fprintf(stderr, "Error: batch index out of bounds.\n");
+        exit(1);
+    }
+}
+
+linmatrix_batch linmatrix_batch_new(size_t count, size_t rows, size_t cols) {
+    linmatrix_batch batch;
+    batch.count = count;
+    batch.rows = rows;
+    batch.cols = cols;
+    batch.data = calloc(linmatrix_batch_groups(count) * rows * cols * L + 1, sizeof(realnum_aprox));
+    return batch;
+}
+
+void linmatrix_batch_free(linmatrix_batch* batch) {
+    free(batch->data);
+    batch->data = NULL;
+    batch->count = 0;
+    batch->rows = 0;
+    batch->cols = 0;
+}
+
+realnum linmatrix_batch_get(linmatrix_batch* batch, size_t m, size_t row, size_t col) {
+    linmatrix_batch_check(batch, m, row, col);
+    return realnum_from_aprox(batch->data[linmatrix_batch_index(batch->rows, batch->cols, m, row, col)]);
+}
+
+void linmatrix_batch_set(linmatrix_batch* batch, size_t m, size_t row, size_t col, realnum* value) {
+    linmatrix_batch_check(batch, m, row, col);
+    batch->data[linmatrix_batch_index(batch->rows, batch->cols, m, row, col)] = realnum_as_aprox(value).value.aprox;
+}
+
+linmatrix linmatrix_batch_get_matrix(linmatrix_batch* batch, size_t m) {
+    linmatrix_batch_check(batch, m, 0, 0);
+    size_t rows = batch->rows, cols = batch->cols;
+    linmatrix a = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            a.data[i * cols + j] = realnum_from_aprox(batch->data[linmatrix_batch_index(rows, cols, m, i, j)]);
+        }
+    }
+    return a;
+}
+
+void linmatrix_batch_set_matrix(linmatrix_batch* batch, size_t m, linmatrix* a) {
+    linmatrix_batch_check(batch, m, 0, 0);
+    if (a->rows != batch->rows || a->cols != batch->cols) {
+        fprintf(stderr, "Error: the matrix must have the shape of the batch.\n");
+        exit(1);
+    }
+    size_t rows = batch->rows, cols = batch->cols;
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            batch->data[linmatrix_batch_index(rows, cols, m, i, j)] = realnum_as_aprox(&a->data[i * cols + j]).value.aprox;
+        }
+    }
+}
+
+linmatrix_batch linmatrix_batch_mul(linmatrix_batch* a, linmatrix_batch* b) {
+    if (a->count != b->count || a->cols != b->rows) {
+        fprintf(stderr, "Error: the batches must hold as many matrices and the columns of the first must match the rows of the second.\n");
+        exit(1);
+    }
+    size_t m = a->rows, k = a->cols, n = b->cols;
+    size_t groups = linmatrix_batch_groups(a->count);
+    LINSTATS_KERNEL_BEGIN(batch_mul);
+    linmatrix_batch c = linmatrix_batch_new(a->count, m, n);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (groups * m * k * n * L >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t g = 0; g < groups; g++) {
+        const realnum_aprox* ag = a->data + g * m * k * L;
+        const realnum_aprox* bg = b->data + g * k * n * L;
+        realnum_aprox* cg = c.data + g * m * n * L;
+        for (size_t i = 0; i < m; i++) {
+            for (size_t p = 0; p < k; p++) {
+                const realnum_aprox* x = ag + (i * k + p) * L;
+                for (size_t j = 0; j < n; j++) {
+                    const realnum_aprox* y = bg + (p * n + j) * L;
+                    realnum_aprox* z = cg + (i * n + j) * L;
+                    for (size_t l = 0; l < L; l++) {
+                        z[l] += x[l] * y[l];
+                    }
+                }
+            }
+        }
+    }
+    LINSTATS_KERNEL_END(batch_mul, LINSTATS_MATRIX_BATCH);
+    return c;
+}
+
+/*
+ * Factors the L matrices of one group of an n x n batch in place. The pivot
+ * rows differ between lanes, so only the row swaps are done lane by lane; the
+ * elimination runs across all lanes at once, with a zero multiplier for the
+ * lanes whose column has no non-zero pivot.
+ */
+static void linmatrix_batch_lu_group(realnum_aprox* a, size_t* pivots, bool* singular, size_t n) {
+    for (size_t l = 0; l < L; l++) {
+        singular[l] = false;
+    }
+    for (size_t k = 0; k < n; k++) {
+        realnum_aprox best[L];
+        size_t pivot[L];
+        for (size_t l = 0; l < L; l++) {
+            realnum_aprox value = a[(k * n + k) * L + l];
+            best[l] = value < 0 ? -value : value;
+            pivot[l] = k;
+        }
+        for (size_t i = k + 1; i < n; i++) {
+            for (size_t l = 0; l < L; l++) {
+                realnum_aprox value = a[(i * n + k) * L + l];
+                value = value < 0 ? -value : value;
+                if (value > best[l]) {
+                    best[l] = value;
+                    pivot[l] = i;
+                }
+            }
+        }
+        for (size_t l = 0; l < L; l++) {
+            pivots[k * L + l] = pivot[l];
+            if (pivot[l] != k) {
+                for (size_t j = 0; j < n; j++) {
+                    realnum_aprox swap = a[(k * n + j) * L + l];
+                    a[(k * n + j) * L + l] = a[(pivot[l] * n + j) * L + l];
+                    a[(pivot[l] * n + j) * L + l] = swap;
+                }
+            }
+        }
+        realnum_aprox inverse[L];
+        for (size_t l = 0; l < L; l++) {
+            realnum_aprox value = a[(k * n + k) * L + l];
+            singular[l] = singular[l] || value == 0;
+            inverse[l] = value == 0 ? 0 : 1 / value;
+        }
+        for (size_t i = k + 1; i < n; i++) {
+            realnum_aprox* row = a + i * n * L;
+            const realnum_aprox* top = a + k * n * L;
+            for (size_t l = 0; l < L; l++) {
+                row[k * L + l] *= inverse[l];
+            }
+            for (size_t j = k + 1; j < n; j++) {
+                for (size_t l = 0; l < L; l++) {
+                    row[j * L + l] -= row[k * L + l] * top[j * L + l];
+                }
+            }
+        }
+    }
+}
+
+linmatrix_batch_lu linmatrix_batch_lu_in_place(linmatrix_batch* a) {
+    if (a->rows != a->cols) {
+        fprintf(stderr, "Error: only batches of square matrices have an LU factorization.\n");
+        exit(1);
+    }
+    size_t n = a->rows;
+    size_t groups = linmatrix_batch_groups(a->count);
+    LINSTATS_KERNEL_BEGIN(batch_lu);
+    linmatrix_batch_lu lu;
+    lu.lu = *a;
+    lu.pivots = malloc(groups * n * L * sizeof(size_t) + 1);
+    lu.singular = malloc(groups * L * sizeof(bool) + 1);
+    a->data = NULL;
+    a->count = 0;
+    a->rows = 0;
+    a->cols = 0;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (groups * n * n * n * L >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t g = 0; g < groups; g++) {
+        linmatrix_batch_lu_group(lu.lu.data + g * n * n * L, lu.pivots + g * n * L, lu.singular + g * L, n);
+    }
+    LINSTATS_KERNEL_END(batch_lu, LINSTATS_MATRIX_BATCH);
+    return lu;
+}
+
+linmatrix_batch_lu linmatrix_batch_lu_new(linmatrix_batch* a) {
+    linmatrix_batch copy = linmatrix_batch_new(a->count, a->rows, a->cols);
+    memcpy(copy.data, a->data, linmatrix_batch_groups(a->count) * a->rows * a->cols * L * sizeof(realnum_aprox));
+    return linmatrix_batch_lu_in_place(&copy);
+}
+
+void linmatrix_batch_lu_free(linmatrix_batch_lu* lu) {
+    linmatrix_batch_free(&lu->lu);
+    free(lu->pivots);
+    free(lu->singular);
+    lu->pivots = NULL;
+    lu->singular = NULL;
+}
+
+linvector linmatrix_batch_lu_determinant(linmatrix_batch_lu* lu) {
+    size_t n = lu->lu.rows, count = lu->lu.count;
+    linvector det = linvector_with_capacity(count ? count : 1);
+    for (size_t m = 0; m < count; m++) {
+        const realnum_aprox* a = lu->lu.data + (m / L) * n * n * L + m % L;
+        const size_t* pivots = lu->pivots + (m / L) * n * L + m % L;
+        realnum_aprox value = 1;
+        for (size_t k = 0; k < n; k++) {
+            value *= pivots[k * L] == k ? a[(k * n + k) * L] : -a[(k * n + k) * L];
+        }
+        linvector_push(&det, realnum_from_aprox(value));
+    }
+    return det;
+}
+
+/*
+ * Applies the row swaps of one group to its block of right-hand sides and
+ * runs forward substitution with L and back substitution with U over it.
+ */
+static void linmatrix_batch_lu_substitute(const realnum_aprox* a, const size_t* pivots, realnum_aprox* x, size_t n, size_t width) {
+    for (size_t k = 0; k < n; k++) {
+        for (size_t l = 0; l < L; l++) {
+            size_t p = pivots[k * L + l];
+            if (p != k) {
+                for (size_t j = 0; j < width; j++) {
+                    realnum_aprox swap = x[(k * width + j) * L + l];
+                    x[(k * width + j) * L + l] = x[(p * width + j) * L + l];
+                    x[(p * width + j) * L + l] = swap;
+                }
+            }
+        }
+    }
+    for (size_t i = 1; i < n; i++) {
+        for (size_t k = 0; k < i; k++) {
+            const realnum_aprox* factor = a + (i * n + k) * L;
+            for (size_t j = 0; j < width; j++) {
+                for (size_t l = 0; l < L; l++) {
+                    x[(i * width + j) * L + l] -= factor[l] * x[(k * width + j) * L + l];
+                }
+            }
+        }
+    }
+    for (size_t i = n; i-- > 0;) {
+        for (size_t k = i + 1; k < n; k++) {
+            const realnum_aprox* factor = a + (i * n + k) * L;
+            for (size_t j = 0; j < width; j++) {
+                for (size_t l = 0; l < L; l++) {
+                    x[(i * width + j) * L + l] -= factor[l] * x[(k * width + j) * L + l];
+                }
+            }
+        }
+        // The padding lanes hold zero matrices, whose solutions are left zero.
+        realnum_aprox inverse[L];
+        for (size_t l = 0; l < L; l++) {
+            realnum_aprox value = a[(i * n + i) * L + l];
+            inverse[l] = value == 0 ? 0 : 1 / value;
+        }
+        for (size_t j = 0; j < width; j++) {
+            for (size_t l = 0; l < L; l++) {
+                x[(i * width + j) * L + l] *= inverse[l];
+            }
+        }
+    }
+}
+
+linmatrix_batch linmatrix_batch_lu_solve(linmatrix_batch_lu* lu, linmatrix_batch* b) {
+    size_t n = lu->lu.rows, count = lu->lu.count;
+    if (b->count != count || b->rows != n) {
+        fprintf(stderr, "Error: the right-hand sides must match the number and size of the matrices.\n");
+        exit(1);
+    }
+    for (size_t m = 0; m < count; m++) {
+        if (lu->singular[m]) {
+            fprintf(stderr, "Error: cannot solve a system with a singular matrix.\n");
+            exit(1);
+        }
+    }
+    size_t width = b->cols;
+    size_t groups = linmatrix_batch_groups(count);
+    LINSTATS_KERNEL_BEGIN(batch_solve);
+    linmatrix_batch x = linmatrix_batch_new(count, n, width);
+    memcpy(x.data, b->data, groups * n * width * L * sizeof(realnum_aprox));
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (groups * n * n * width * L >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t g = 0; g < groups; g++) {
+        linmatrix_batch_lu_substitute(lu->lu.data + g * n * n * L, lu->pivots + g * n * L, x.data + g * n * width * L, n, width);
+    }
+    LINSTATS_KERNEL_END(batch_solve, LINSTATS_MATRIX_BATCH);
+    return x;
+}
+
+linvector linmatrix_batch_determinant(linmatrix_batch* a) {
+    linmatrix_batch_lu lu = linmatrix_batch_lu_new(a);
+    linvector det = linmatrix_batch_lu_determinant(&lu);
+    linmatrix_batch_lu_free(&lu);
+    return det;
+}
+
+linmatrix_batch linmatrix_batch_solve(linmatrix_batch* a, linmatrix_batch* b) {
+    linmatrix_batch_lu lu = linmatrix_batch_lu_new(a);
+    linmatrix_batch x = linmatrix_batch_lu_solve(&lu, b);
+    linmatrix_batch_lu_free(&lu);
+    return x;
+}
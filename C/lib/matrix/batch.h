@@ -0,0 +1,183 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"./matrix.h"
+
+/*
+ * The number of matrices interleaved element by element in one group of a
+ * linmatrix_batch. Every kernel runs its innermost loop across the lanes of a
+ * group, so this should be a multiple of the SIMD width of REALNUM_APROX.
+ */
+#ifndef LINMATRIX_BATCH_LANES
+#define LINMATRIX_BATCH_LANES 8
+#endif
+
+/**
+ * @struct linmatrix_batch
+ * @brief Represents `count` matrices of the same shape in one contiguous buffer.
+ *
+ * The matrices are stored in groups of LINMATRIX_BATCH_LANES, each group
+ * holding element (i, j) of all its matrices next to each other: element
+ * (i, j) of matrix m is at
+ * `((m / LANES) * rows * cols + i * cols + j) * LANES + m % LANES`. The last
+ * group is padded with zero matrices. Every element is an approximation.
+ *
+ * Batched operations run one group at a time, in parallel across groups and
+ * vectorized across the matrices of a group, with no allocation or dispatch
+ * per matrix.
+ */
+typedef struct linmatrix_batch {
+    size_t count;
+    size_t rows;
+    size_t cols;
+    realnum_aprox* data;
+} linmatrix_batch;
+
+/**
+ * @struct linmatrix_batch_lu
+ * @brief Represents the PLU factorizations of every matrix of a square batch.
+ *
+ * `lu` holds the factors of each matrix as linmatrix_lu does: U on and above
+ * the diagonal and the multipliers of L below it. `pivots` holds the row
+ * swapped with row k of each matrix in the grouped layout of a batch with
+ * one column, and `singular[m]` whether matrix m had a column without a
+ * non-zero pivot.
+ */
+typedef struct linmatrix_batch_lu {
+    linmatrix_batch lu;
+    size_t* pivots;
+    bool* singular;
+} linmatrix_batch_lu;
+
+/**
+ * Creates a batch of zero matrices.
+ *
+ * @param count The number of matrices.
+ * @param rows The number of rows of each matrix.
+ * @param cols The number of columns of each matrix.
+ * @return The newly created batch.
+ */
+linmatrix_batch linmatrix_batch_new(size_t count, size_t rows, size_t cols);
+
+/**
+ * Frees the memory occupied by the given batch.
+ *
+ * @param batch The batch to free.
+ */
+void linmatrix_batch_free(linmatrix_batch* batch);
+
+/**
+ * Gets an element of one matrix of the batch.
+ *
+ * @param batch The batch.
+ * @param m The index of the matrix.
+ * @param row The row of the element.
+ * @param col The column of the element.
+ * @return The element.
+ */
+realnum linmatrix_batch_get(linmatrix_batch* batch, size_t m, size_t row, size_t col);
+
+/**
+ * Sets an element of one matrix of the batch to an approximation of the given value.
+ *
+ * @param batch The batch.
+ * @param m The index of the matrix.
+ * @param row The row of the element.
+ * @param col The column of the element.
+ * @param value The value, left untouched.
+ */
+void linmatrix_batch_set(linmatrix_batch* batch, size_t m, size_t row, size_t col, realnum* value);
+
+/**
+ * Copies a matrix of the batch out into a linmatrix.
+ *
+ * @param batch The batch.
+ * @param m The index of the matrix.
+ * @return The matrix.
+ */
+linmatrix linmatrix_batch_get_matrix(linmatrix_batch* batch, size_t m);
+
+/**
+ * Copies a linmatrix into one matrix of the batch.
+ *
+ * @param batch The batch.
+ * @param m The index of the matrix.
+ * @param a The matrix, with the shape of the batch, left untouched.
+ */
+void linmatrix_batch_set_matrix(linmatrix_batch* batch, size_t m, linmatrix* a);
+
+/**
+ * Multiplies every matrix of one batch by the matrix at the same index of another.
+ *
+ * @param a The batch of left factors.
+ * @param b The batch of right factors, as many as in `a`.
+ * @return The batch of products.
+ */
+linmatrix_batch linmatrix_batch_mul(linmatrix_batch* a, linmatrix_batch* b);
+
+/**
+ * Computes the PLU factorization of every matrix of a square batch.
+ *
+ * Each column of each matrix is pivoted on its entry of largest magnitude at
+ * or below the diagonal; a column without a non-zero pivot marks its matrix
+ * as singular and is skipped.
+ *
+ * @param a The batch to factor, left untouched.
+ * @return The factorizations.
+ */
+linmatrix_batch_lu linmatrix_batch_lu_new(linmatrix_batch* a);
+
+/**
+ * Computes the PLU factorization of every matrix of a square batch in place.
+ *
+ * The factorizations take over the storage of `a`, which is left empty.
+ *
+ * @param a The batch to factor.
+ * @return The factorizations.
+ */
+linmatrix_batch_lu linmatrix_batch_lu_in_place(linmatrix_batch* a);
+
+/**
+ * Frees the memory occupied by the given factorizations.
+ *
+ * @param lu The factorizations to free.
+ */
+void linmatrix_batch_lu_free(linmatrix_batch_lu* lu);
+
+/**
+ * Calculates the determinant of every factored matrix.
+ *
+ * @param lu The factorizations.
+ * @return The determinants, one per matrix.
+ */
+linvector linmatrix_batch_lu_determinant(linmatrix_batch_lu* lu);
+
+/**
+ * Solves A_m * X_m = B_m for every matrix of the batch.
+ *
+ * @param lu The factorizations of the batch A, none of them singular.
+ * @param b The right-hand sides, as many as in A and with one row per row of A.
+ * @return The solutions.
+ */
+linmatrix_batch linmatrix_batch_lu_solve(linmatrix_batch_lu* lu, linmatrix_batch* b);
+
+/**
+ * Calculates the determinant of every matrix of a square batch through its LU factorization.
+ *
+ * @param a The batch.
+ * @return The determinants, one per matrix.
+ */
+linvector linmatrix_batch_determinant(linmatrix_batch* a);
+
+/**
+ * Solves A_m * X_m = B_m for every matrix of the batch through their LU factorizations.
+ *
+ * @param a The batch of square matrices.
+ * @param b The right-hand sides.
+ * @return The solutions.
+ */
+linmatrix_batch linmatrix_batch_solve(linmatrix_batch* a, linmatrix_batch* b);
@@ -0,0 +1,200 @@
+#include"./cholesky.h"
+#include"../stats/stats.h"
+
+#define NB LINMATRIX_CHOLESKY_BLOCK
+
+static realnum_aprox linmatrix_cholesky_sqrt(realnum_aprox value) {
+    realnum num = realnum_from_aprox(value);
+    return realnum_sqrt(&num).value.aprox;
+}
+
+/*
+ * Computes column j of L from row i of the panel starting at column k, whose
+ * columns before j are already final: the contributions of the panels before
+ * k were subtracted by the trailing updates.
+ */
+static realnum_aprox linmatrix_cholesky_reduce(realnum_aprox* a, size_t n, size_t k, size_t i, size_t j) {
+    realnum_aprox sum = a[i * n + j];
+    for (size_t c = k; c < j; c++) {
+        sum -= a[i * n + c] * a[j * n + c];
+    }
+    return sum;
+}
+
+linmatrix_cholesky linmatrix_cholesky_in_place(linmatrix* a) {
+    if (a->rows != a->cols) {
+        fprintf(stderr, "Error: only square matrices have a Cholesky factorization.\n");
+        exit(1);
+    }
+    size_t n = a->rows;
+    LINSTATS_KERNEL_BEGIN(cholesky);
+    linmatrix_cholesky chol;
+    chol.l = *a;
+    chol.definite = true;
+    a->data = NULL;
+    a->rows = 0;
+    a->cols = 0;
+
+    // The factorization runs on a plain array of approximations of the lower
+    // triangle, which is written back into the elements once it is done.
+    realnum* data = chol.l.data;
+    realnum_aprox* x = malloc(n * n * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            x[i * n + j] = j <= i ? realnum_as_aprox(&data[i * n + j]).value.aprox : 0;
+            realnum_free(&data[i * n + j]);
+        }
+    }
+    for (size_t k = 0; k < n && chol.definite; k += NB) {
+        size_t end = k + NB < n ? k + NB : n;
+        // The diagonal block.
+        for (size_t j = k; j < end; j++) {
+            realnum_aprox pivot = linmatrix_cholesky_reduce(x, n, k, j, j);
+            if (!(pivot > 0)) {
+                chol.definite = false;
+                break;
+            }
+            x[j * n + j] = linmatrix_cholesky_sqrt(pivot);
+            for (size_t i = j + 1; i < end; i++) {
+                x[i * n + j] = linmatrix_cholesky_reduce(x, n, k, i, j) / x[j * n + j];
+            }
+        }
+        if (!chol.definite || end == n) {
+            continue;
+        }
+        // The panel below it, L21 = A21 * L11^-T, one independent row at a time.
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if ((n - end) * (end - k) * (end - k) >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = end; i < n; i++) {
+            for (size_t j = k; j < end; j++) {
+                x[i * n + j] = linmatrix_cholesky_reduce(x, n, k, i, j) / x[j * n + j];
+            }
+        }
+        // The lower triangle of the trailing matrix, A22 -= L21 * L21^T. Both
+        // factors are rows of the panel, so every element is a contiguous dot product.
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1) if ((n - end) * (n - end) * (end - k) / 2 >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = end; i < n; i++) {
+            const realnum_aprox* li = &x[i * n + k];
+            for (size_t j = end; j <= i; j++) {
+                const realnum_aprox* lj = &x[j * n + k];
+                realnum_aprox sum = 0;
+                for (size_t c = 0; c < end - k; c++) {
+                    sum += li[c] * lj[c];
+                }
+                x[i * n + j] -= sum;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            data[i * n + j] = j <= i ? realnum_from_aprox(x[i * n + j]) : realnum_new();
+        }
+    }
+    free(x);
+    LINSTATS_KERNEL_END(cholesky, LINSTATS_MATRIX_CHOLESKY);
+    return chol;
+}
+
+linmatrix_cholesky linmatrix_cholesky_new(linmatrix* a) {
+    linmatrix copy = linmatrix_clone(a);
+    return linmatrix_cholesky_in_place(&copy);
+}
+
+void linmatrix_cholesky_free(linmatrix_cholesky* chol) {
+    linmatrix_free(&chol->l);
+}
+
+realnum linmatrix_cholesky_determinant(linmatrix_cholesky* chol) {
+    if (!chol->definite) {
+        fprintf(stderr, "Error: the matrix is not positive definite.\n");
+        exit(1);
+    }
+    size_t n = chol->l.rows;
+    realnum_aprox det = 1;
+    for (size_t i = 0; i < n; i++) {
+        det *= chol->l.data[i * n + i].value.aprox;
+    }
+    return realnum_from_aprox(det * det);
+}
+
+/*
+ * Runs forward substitution with L and back substitution with L^T over a
+ * row-major block of right-hand sides, a whole row at a time.
+ */
+static void linmatrix_cholesky_substitute(linmatrix_cholesky* chol, realnum_aprox* x, size_t width) {
+    if (!chol->definite) {
+        fprintf(stderr, "Error: the matrix is not positive definite.\n");
+        exit(1);
+    }
+    size_t n = chol->l.rows;
+    realnum* data = chol->l.data;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = 0; k < i; k++) {
+            realnum_aprox l = data[i * n + k].value.aprox;
+            for (size_t c = 0; c < width; c++) {
+                x[i * width + c] -= l * x[k * width + c];
+            }
+        }
+        realnum_aprox d = data[i * n + i].value.aprox;
+        for (size_t c = 0; c < width; c++) {
+            x[i * width + c] /= d;
+        }
+    }
+    for (size_t i = n; i-- > 0;) {
+        realnum_aprox d = data[i * n + i].value.aprox;
+        for (size_t c = 0; c < width; c++) {
+            x[i * width + c] /= d;
+        }
+        // Row i of L^T is column i of L.
+        for (size_t k = 0; k < i; k++) {
+            realnum_aprox l = data[i * n + k].value.aprox;
+            for (size_t c = 0; c < width; c++) {
+                x[k * width + c] -= l * x[i * width + c];
+            }
+        }
+    }
+}
+
+linvector linmatrix_cholesky_solve(linmatrix_cholesky* chol, linvector* b) {
+    size_t n = chol->l.rows;
+    if (b->size != n) {
+        fprintf(stderr, "Error: the size of the vector must match the size of the matrix.\n");
+        exit(1);
+    }
+    realnum_aprox* x = malloc(n * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = realnum_as_aprox(&b->data[i]).value.aprox;
+    }
+    linmatrix_cholesky_substitute(chol, x, 1);
+    linvector result = linvector_with_capacity(n ? n : 1);
+    for (size_t i = 0; i < n; i++) {
+        linvector_push(&result, realnum_from_aprox(x[i]));
+    }
+    free(x);
+    return result;
+}
+
+linmatrix linmatrix_cholesky_solve_matrix(linmatrix_cholesky* chol, linmatrix* b) {
+    size_t n = chol->l.rows;
+    if (b->rows != n) {
+        fprintf(stderr, "Error: the number of rows of the right-hand side must match the size of the matrix.\n");
+        exit(1);
+    }
+    size_t width = b->cols;
+    realnum_aprox* x = malloc(n * width * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < n * width; i++) {
+        x[i] = realnum_as_aprox(&b->data[i]).value.aprox;
+    }
+    linmatrix_cholesky_substitute(chol, x, width);
+    linmatrix result = linmatrix_new(n, width);
+    for (size_t i = 0; i < n * width; i++) {
+        result.data[i] = realnum_from_aprox(x[i]);
+    }
+    free(x);
+    return result;
+}
+
+#undef NB
@@ -0,0 +1,85 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"./matrix.h"
+
+/*
+ * The number of columns factored per panel. The lower triangle below each
+ * panel is then updated at once, with contiguous dot products of its rows.
+ */
+#ifndef LINMATRIX_CHOLESKY_BLOCK
+#define LINMATRIX_CHOLESKY_BLOCK 32
+#endif
+
+/**
+ * @struct linmatrix_cholesky
+ * @brief Represents the Cholesky factorization A = L * L^T of a symmetric positive definite matrix.
+ *
+ * `l` is lower triangular, with zeros above the diagonal, and every element
+ * on and below it is an approximation.
+ *
+ * The factorization is computed once in O(n^3 / 3), half the work of LU, and
+ * can then be reused for any number of determinants and solves.
+ */
+typedef struct linmatrix_cholesky {
+    linmatrix l;
+    bool definite; /**< Whether every pivot was positive. */
+} linmatrix_cholesky;
+
+/**
+ * Computes the Cholesky factorization of a symmetric positive definite matrix.
+ *
+ * Only the lower triangle of the matrix is read. The factorization stops at
+ * the first pivot that is not positive and marks the matrix as not definite.
+ *
+ * @param a The matrix to factor, left untouched.
+ * @return The factorization.
+ */
+linmatrix_cholesky linmatrix_cholesky_new(linmatrix* a);
+
+/**
+ * Computes the Cholesky factorization of a symmetric positive definite matrix in place.
+ *
+ * The factorization takes over the storage of `a`, which is left empty.
+ *
+ * @param a The matrix to factor.
+ * @return The factorization.
+ */
+linmatrix_cholesky linmatrix_cholesky_in_place(linmatrix* a);
+
+/**
+ * Frees the memory occupied by the given factorization.
+ *
+ * @param chol The factorization to free.
+ */
+void linmatrix_cholesky_free(linmatrix_cholesky* chol);
+
+/**
+ * Calculates the determinant of the factored matrix.
+ *
+ * @param chol The factorization.
+ * @return The square of the product of the diagonal of L.
+ */
+realnum linmatrix_cholesky_determinant(linmatrix_cholesky* chol);
+
+/**
+ * Solves A * x = b for x.
+ *
+ * @param chol The factorization of A.
+ * @param b The right-hand side.
+ * @return The solution.
+ */
+linvector linmatrix_cholesky_solve(linmatrix_cholesky* chol, linvector* b);
+
+/**
+ * Solves A * X = B for every column of B at once.
+ *
+ * @param chol The factorization of A.
+ * @param b The right-hand sides, one per column.
+ * @return The solutions, one per column.
+ */
+linmatrix linmatrix_cholesky_solve_matrix(linmatrix_cholesky* chol, linmatrix* b);
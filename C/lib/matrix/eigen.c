@@ -0,0 +1,756 @@
+#include"./eigen.h"
+#include"../stats/stats.h"
+
+/*
+ * The number of columns of Q each task updates while the Householder
+ * reflections of the tridiagonalization are accumulated.
+ */
+#define NC 64
+
+static realnum_aprox linmatrix_eigen_sqrt(realnum_aprox value) {
+    realnum num = realnum_from_aprox(value);
+    return realnum_sqrt(&num).value.aprox;
+}
+
+static realnum_aprox linmatrix_eigen_abs(realnum_aprox value) {
+    return value < 0 ? -value : value;
+}
+
+static realnum_aprox* linmatrix_eigen_approximate(realnum* data, size_t size) {
+    realnum_aprox* values = malloc(size * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < size; i++) {
+        values[i] = realnum_as_aprox(&data[i]).value.aprox;
+    }
+    return values;
+}
+
+/* A dense matrix, approximated row-major. */
+typedef struct linoperator_dense_ctx {
+    size_t rows;
+    size_t cols;
+    realnum_aprox* data;
+} linoperator_dense_ctx;
+
+static void linoperator_dense_apply(void* ctx, const realnum_aprox* x, realnum_aprox* y) {
+    linoperator_dense_ctx* a = ctx;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->rows * a->cols >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < a->rows; i++) {
+        realnum_aprox sum = 0;
+        for (size_t j = 0; j < a->cols; j++) {
+            sum += a->data[i * a->cols + j] * x[j];
+        }
+        y[i] = sum;
+    }
+}
+
+static void linoperator_dense_apply_transpose(void* ctx, const realnum_aprox* x, realnum_aprox* y) {
+    linoperator_dense_ctx* a = ctx;
+    // Each task owns a run of NC outputs and streams the rows through it.
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->rows * a->cols >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t jc = 0; jc < a->cols; jc += NC) {
+        size_t end = jc + NC < a->cols ? jc + NC : a->cols;
+        for (size_t j = jc; j < end; j++) {
+            y[j] = 0;
+        }
+        for (size_t i = 0; i < a->rows; i++) {
+            for (size_t j = jc; j < end; j++) {
+                y[j] += a->data[i * a->cols + j] * x[i];
+            }
+        }
+    }
+}
+
+static void linoperator_dense_release(void* ctx) {
+    linoperator_dense_ctx* a = ctx;
+    free(a->data);
+    free(a);
+}
+
+linoperator linoperator_dense(linmatrix* a) {
+    linoperator_dense_ctx* ctx = malloc(sizeof(linoperator_dense_ctx));
+    ctx->rows = a->rows;
+    ctx->cols = a->cols;
+    ctx->data = linmatrix_eigen_approximate(a->data, a->rows * a->cols);
+    return (linoperator){a->rows, a->cols, linoperator_dense_apply, linoperator_dense_apply_transpose, linoperator_dense_release, ctx};
+}
+
+/* A sparse matrix, with its values approximated and its structure copied. */
+typedef struct linoperator_sparse_ctx {
+    linsparse_format format;
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t* offsets;
+    size_t* indices;
+    realnum_aprox* values;
+} linoperator_sparse_ctx;
+
+/* y[o] = sum of values[p] * x[indices[p]] over the entries of outer index o. */
+static void linoperator_sparse_gather(linoperator_sparse_ctx* a, size_t outer, const realnum_aprox* x, realnum_aprox* y) {
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->nnz >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t o = 0; o < outer; o++) {
+        realnum_aprox sum = 0;
+        for (size_t p = a->offsets[o]; p < a->offsets[o + 1]; p++) {
+            sum += a->values[p] * x[a->indices[p]];
+        }
+        y[o] = sum;
+    }
+}
+
+/* y[indices[p]] += values[p] * x[o] over the entries of every outer index o. */
+static void linoperator_sparse_scatter(linoperator_sparse_ctx* a, size_t outer, size_t inner, const realnum_aprox* x, realnum_aprox* y) {
+    for (size_t i = 0; i < inner; i++) {
+        y[i] = 0;
+    }
+    for (size_t o = 0; o < outer; o++) {
+        for (size_t p = a->offsets[o]; p < a->offsets[o + 1]; p++) {
+            y[a->indices[p]] += a->values[p] * x[o];
+        }
+    }
+}
+
+static void linoperator_sparse_apply(void* ctx, const realnum_aprox* x, realnum_aprox* y) {
+    linoperator_sparse_ctx* a = ctx;
+    if (a->format == LINSPARSE_CSR) {
+        linoperator_sparse_gather(a, a->rows, x, y);
+    } else {
+        linoperator_sparse_scatter(a, a->cols, a->rows, x, y);
+    }
+}
+
+static void linoperator_sparse_apply_transpose(void* ctx, const realnum_aprox* x, realnum_aprox* y) {
+    linoperator_sparse_ctx* a = ctx;
+    if (a->format == LINSPARSE_CSR) {
+        linoperator_sparse_scatter(a, a->rows, a->cols, x, y);
+    } else {
+        linoperator_sparse_gather(a, a->cols, x, y);
+    }
+}
+
+static void linoperator_sparse_release(void* ctx) {
+    linoperator_sparse_ctx* a = ctx;
+    free(a->offsets);
+    free(a->indices);
+    free(a->values);
+    free(a);
+}
+
+linoperator linoperator_sparse(linsparse* a) {
+    size_t outer = (a->format == LINSPARSE_CSR ? a->rows : a->cols) + 1;
+    linoperator_sparse_ctx* ctx = malloc(sizeof(linoperator_sparse_ctx));
+    ctx->format = a->format;
+    ctx->rows = a->rows;
+    ctx->cols = a->cols;
+    ctx->nnz = a->nnz;
+    ctx->offsets = malloc(outer * sizeof(size_t));
+    memcpy(ctx->offsets, a->offsets, outer * sizeof(size_t));
+    ctx->indices = malloc(a->nnz * sizeof(size_t) + 1);
+    memcpy(ctx->indices, a->indices, a->nnz * sizeof(size_t));
+    ctx->values = linmatrix_eigen_approximate(a->values, a->nnz);
+    return (linoperator){a->rows, a->cols, linoperator_sparse_apply, linoperator_sparse_apply_transpose, linoperator_sparse_release, ctx};
+}
+
+void linoperator_free(linoperator* op) {
+    if (op->release) {
+        op->release(op->ctx);
+    }
+    op->ctx = NULL;
+}
+
+/*
+ * Diagonalizes the symmetric tridiagonal matrix with diagonal d and
+ * off-diagonal e, both overwritten, by implicit QR steps with Wilkinson
+ * shifts. The rotations of every step are applied to the columns of the
+ * row-major rows x n matrix z, if given, one row per task. Returns whether
+ * every eigenvalue converged.
+ */
+static bool linmatrix_eigen_tridiagonal(realnum_aprox* d, realnum_aprox* e, size_t n, realnum_aprox* z, size_t rows) {
+    realnum_aprox* c = malloc(n * sizeof(realnum_aprox) + 1);
+    realnum_aprox* s = malloc(n * sizeof(realnum_aprox) + 1);
+    size_t steps = 0;
+    size_t hi = n ? n - 1 : 0;
+    while (hi > 0) {
+        for (size_t i = 0; i < hi; i++) {
+            if (linmatrix_eigen_abs(e[i]) <= LINMATRIX_EIGEN_EPSILON * (linmatrix_eigen_abs(d[i]) + linmatrix_eigen_abs(d[i + 1]))) {
+                e[i] = 0;
+            }
+        }
+        while (hi > 0 && e[hi - 1] == 0) {
+            hi--;
+        }
+        if (hi == 0) {
+            break;
+        }
+        if (steps++ >= LINMATRIX_EIGEN_MAX_STEPS * n) {
+            free(c);
+            free(s);
+            return false;
+        }
+        size_t lo = hi - 1;
+        while (lo > 0 && e[lo - 1] != 0) {
+            lo--;
+        }
+        // The eigenvalue of the trailing 2 x 2 block closer to d[hi].
+        realnum_aprox delta = (d[hi - 1] - d[hi]) / 2;
+        realnum_aprox off = e[hi - 1];
+        realnum_aprox root = linmatrix_eigen_sqrt(delta * delta + off * off);
+        realnum_aprox mu = d[hi] - off * off / (delta + (delta < 0 ? -root : root));
+        // Chase the bulge of the shifted first rotation down the block.
+        realnum_aprox x = d[lo] - mu;
+        realnum_aprox y = e[lo];
+        for (size_t k = lo; k < hi; k++) {
+            realnum_aprox r = linmatrix_eigen_sqrt(x * x + y * y);
+            realnum_aprox ck = r == 0 ? 1 : x / r;
+            realnum_aprox sk = r == 0 ? 0 : y / r;
+            if (k > lo) {
+                e[k - 1] = r;
+            }
+            realnum_aprox dk = d[k];
+            realnum_aprox dk1 = d[k + 1];
+            realnum_aprox ek = e[k];
+            d[k] = ck * ck * dk + 2 * ck * sk * ek + sk * sk * dk1;
+            d[k + 1] = sk * sk * dk - 2 * ck * sk * ek + ck * ck * dk1;
+            e[k] = ck * sk * (dk1 - dk) + (ck * ck - sk * sk) * ek;
+            if (k + 1 < hi) {
+                x = e[k];
+                y = sk * e[k + 1];
+                e[k + 1] *= ck;
+            }
+            c[k] = ck;
+            s[k] = sk;
+        }
+        if (z) {
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(static) if (rows * (hi - lo) >= LINMATRIX_PARALLEL_THRESHOLD)
+            #endif
+            for (size_t i = 0; i < rows; i++) {
+                realnum_aprox* row = &z[i * n];
+                for (size_t k = lo; k < hi; k++) {
+                    realnum_aprox a = row[k];
+                    realnum_aprox b = row[k + 1];
+                    row[k] = c[k] * a + s[k] * b;
+                    row[k + 1] = c[k] * b - s[k] * a;
+                }
+            }
+        }
+    }
+    free(c);
+    free(s);
+    return true;
+}
+
+/*
+ * Reduces the symmetric n x n row-major matrix a to tridiagonal form
+ * Q^T * A * Q with diagonal d and off-diagonal e. Reflection k, acting on
+ * rows and columns k + 1 onwards, is left below the subdiagonal of column k
+ * with its factor in tau[k].
+ */
+static void linmatrix_eigen_tridiagonalize(realnum_aprox* a, size_t n, realnum_aprox* d, realnum_aprox* e, realnum_aprox* tau) {
+    realnum_aprox* p = malloc(n * sizeof(realnum_aprox) + 1);
+    for (size_t k = 0; k + 1 < n; k++) {
+        realnum_aprox alpha = a[(k + 1) * n + k];
+        realnum_aprox tail = 0;
+        for (size_t i = k + 2; i < n; i++) {
+            tail += a[i * n + k] * a[i * n + k];
+        }
+        if (tail == 0) {
+            tau[k] = 0;
+            e[k] = alpha;
+            continue;
+        }
+        realnum_aprox norm = linmatrix_eigen_sqrt(alpha * alpha + tail);
+        realnum_aprox beta = alpha >= 0 ? -norm : norm;
+        realnum_aprox t = (beta - alpha) / beta;
+        realnum_aprox scale = 1 / (alpha - beta);
+        tau[k] = t;
+        e[k] = beta;
+        a[(k + 1) * n + k] = 1;
+        for (size_t i = k + 2; i < n; i++) {
+            a[i * n + k] *= scale;
+        }
+        // p = tau * A22 * v, then w = p - (tau / 2) * (p^T v) * v is left in p.
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if ((n - k) * (n - k) >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = k + 1; i < n; i++) {
+            realnum_aprox sum = 0;
+            for (size_t j = k + 1; j < n; j++) {
+                sum += a[i * n + j] * a[j * n + k];
+            }
+            p[i] = t * sum;
+        }
+        realnum_aprox pv = 0;
+        for (size_t i = k + 1; i < n; i++) {
+            pv += p[i] * a[i * n + k];
+        }
+        for (size_t i = k + 1; i < n; i++) {
+            p[i] -= t / 2 * pv * a[i * n + k];
+        }
+        // A22 -= v * w^T + w * v^T.
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if ((n - k) * (n - k) >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = k + 1; i < n; i++) {
+            realnum_aprox vi = a[i * n + k];
+            realnum_aprox wi = p[i];
+            for (size_t j = k + 1; j < n; j++) {
+                a[i * n + j] -= vi * p[j] + wi * a[j * n + k];
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        d[i] = a[i * n + i];
+    }
+    free(p);
+}
+
+/*
+ * Forms Q = H_0 * H_1 * ... * H_{n-2} from the reflections left in a by
+ * linmatrix_eigen_tridiagonalize, NC columns per task.
+ */
+static realnum_aprox* linmatrix_eigen_accumulate(realnum_aprox* a, size_t n, realnum_aprox* tau) {
+    realnum_aprox* q = calloc(n * n + 1, sizeof(realnum_aprox));
+    for (size_t i = 0; i < n; i++) {
+        q[i * n + i] = 1;
+    }
+    for (size_t k = n > 1 ? n - 1 : 0; k-- > 0;) {
+        if (tau[k] == 0) {
+            continue;
+        }
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if ((n - k) * (n - k) >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t jc = k + 1; jc < n; jc += NC) {
+            size_t end = jc + NC < n ? jc + NC : n;
+            realnum_aprox w[NC];
+            for (size_t j = jc; j < end; j++) {
+                w[j - jc] = 0;
+            }
+            for (size_t i = k + 1; i < n; i++) {
+                realnum_aprox v = a[i * n + k];
+                for (size_t j = jc; j < end; j++) {
+                    w[j - jc] += v * q[i * n + j];
+                }
+            }
+            for (size_t i = k + 1; i < n; i++) {
+                realnum_aprox v = tau[k] * a[i * n + k];
+                for (size_t j = jc; j < end; j++) {
+                    q[i * n + j] -= v * w[j - jc];
+                }
+            }
+        }
+    }
+    return q;
+}
+
+/* An eigenvalue and the column of its eigenvector, ordered largest first. */
+typedef struct linmatrix_eigen_pair {
+    realnum_aprox value;
+    size_t index;
+} linmatrix_eigen_pair;
+
+static int linmatrix_eigen_compare(const void* a, const void* b) {
+    realnum_aprox x = ((const linmatrix_eigen_pair*)a)->value;
+    realnum_aprox y = ((const linmatrix_eigen_pair*)b)->value;
+    return (x < y) - (x > y);
+}
+
+static linmatrix_eigen_pair* linmatrix_eigen_sort(realnum_aprox* d, size_t n) {
+    linmatrix_eigen_pair* pairs = malloc(n * sizeof(linmatrix_eigen_pair) + 1);
+    for (size_t i = 0; i < n; i++) {
+        pairs[i] = (linmatrix_eigen_pair){d[i], i};
+    }
+    qsort(pairs, n, sizeof(linmatrix_eigen_pair), linmatrix_eigen_compare);
+    return pairs;
+}
+
+static linvector linmatrix_eigen_values(linmatrix_eigen_pair* pairs, size_t k) {
+    linvector values = linvector_with_capacity(k ? k : 1);
+    for (size_t i = 0; i < k; i++) {
+        linvector_push(&values, realnum_from_aprox(pairs[i].value));
+    }
+    return values;
+}
+
+linmatrix_eigen linmatrix_eigen_symmetric(linmatrix* a, bool vectors) {
+    if (a->rows != a->cols) {
+        fprintf(stderr, "Error: only square matrices have a symmetric eigendecomposition.\n");
+        exit(1);
+    }
+    size_t n = a->rows;
+    LINSTATS_KERNEL_BEGIN(eigen);
+    realnum_aprox* work = malloc(n * n * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j <= i; j++) {
+            work[i * n + j] = realnum_as_aprox(&a->data[i * n + j]).value.aprox;
+            work[j * n + i] = work[i * n + j];
+        }
+    }
+    realnum_aprox* d = malloc(n * sizeof(realnum_aprox) + 1);
+    realnum_aprox* e = malloc(n * sizeof(realnum_aprox) + 1);
+    realnum_aprox* tau = malloc(n * sizeof(realnum_aprox) + 1);
+    linmatrix_eigen_tridiagonalize(work, n, d, e, tau);
+    realnum_aprox* q = vectors ? linmatrix_eigen_accumulate(work, n, tau) : NULL;
+    free(work);
+    free(tau);
+
+    linmatrix_eigen eigen;
+    eigen.converged = linmatrix_eigen_tridiagonal(d, e, n, q, n);
+    linmatrix_eigen_pair* pairs = linmatrix_eigen_sort(d, n);
+    eigen.values = linmatrix_eigen_values(pairs, n);
+    eigen.vectors = linmatrix_new(vectors ? n : 0, vectors ? n : 0);
+    if (vectors) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t c = 0; c < n; c++) {
+                eigen.vectors.data[i * n + c] = realnum_from_aprox(q[i * n + pairs[c].index]);
+            }
+        }
+    }
+    free(q);
+    free(pairs);
+    free(d);
+    free(e);
+    LINSTATS_KERNEL_END(eigen, LINSTATS_MATRIX_EIGEN);
+    return eigen;
+}
+
+void linmatrix_eigen_free(linmatrix_eigen* eigen) {
+    linvector_free(&eigen->values);
+    linmatrix_free(&eigen->vectors);
+}
+
+/* Deterministic values in [-1, 1) for the start vectors. */
+static realnum_aprox linmatrix_lanczos_start(size_t i) {
+    return (realnum_aprox)((i * 2654435761u) % 2048) / 1024 - 1;
+}
+
+/*
+ * Removes from w its components along the first count rows of the row-major
+ * basis q, twice so that what is left is orthogonal to working precision.
+ * h is scratch space of count elements.
+ */
+static void linmatrix_lanczos_orthogonalize(realnum_aprox* q, size_t count, size_t n, realnum_aprox* w, realnum_aprox* h) {
+    for (int pass = 0; pass < 2; pass++) {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (count * n >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t j = 0; j < count; j++) {
+            realnum_aprox sum = 0;
+            for (size_t i = 0; i < n; i++) {
+                sum += q[j * n + i] * w[i];
+            }
+            h[j] = sum;
+        }
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static) if (count * n >= LINMATRIX_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = 0; i < n; i++) {
+            realnum_aprox sum = 0;
+            for (size_t j = 0; j < count; j++) {
+                sum += h[j] * q[j * n + i];
+            }
+            w[i] -= sum;
+        }
+    }
+}
+
+static realnum_aprox linmatrix_lanczos_norm(realnum_aprox* w, size_t n) {
+    realnum_aprox sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += w[i] * w[i];
+    }
+    return linmatrix_eigen_sqrt(sum);
+}
+
+/*
+ * Diagonalizes the m x m Lanczos matrix T with diagonal alpha and
+ * off-diagonal beta, leaving its eigenvalues in d and returning the last
+ * `rows` rows of the matrix of its eigenvectors.
+ */
+static realnum_aprox* linmatrix_lanczos_ritz(realnum_aprox* alpha, realnum_aprox* beta, size_t m, realnum_aprox* d, size_t rows, bool* converged) {
+    realnum_aprox* e = malloc(m * sizeof(realnum_aprox));
+    realnum_aprox* s = calloc(rows * m, sizeof(realnum_aprox));
+    for (size_t i = 0; i < m; i++) {
+        d[i] = alpha[i];
+        e[i] = beta[i];
+    }
+    for (size_t r = 0; r < rows; r++) {
+        s[r * m + m - rows + r] = 1;
+    }
+    *converged = linmatrix_eigen_tridiagonal(d, e, m, s, rows);
+    free(e);
+    return s;
+}
+
+/*
+ * The k largest eigenpairs of the symmetric n x n map applied by `apply`, by
+ * Lanczos with full reorthogonalization. The basis is kept row-major, one
+ * Lanczos vector per row, and grows until the wanted Ritz pairs converge.
+ */
+static linmatrix_eigen linmatrix_lanczos(size_t n, size_t k, void (*apply)(void*, const realnum_aprox*, realnum_aprox*), void* ctx) {
+    if (k > n) {
+        fprintf(stderr, "Error: cannot compute more eigenpairs than the size of the operator.\n");
+        exit(1);
+    }
+    linmatrix_eigen eigen;
+    eigen.converged = true;
+    if (k == 0) {
+        eigen.values = linvector_with_capacity(1);
+        eigen.vectors = linmatrix_new(n, 0);
+        return eigen;
+    }
+    size_t capacity = 2 * k + LINMATRIX_LANCZOS_CHECK < n ? 2 * k + LINMATRIX_LANCZOS_CHECK : n;
+    realnum_aprox* q = malloc(capacity * n * sizeof(realnum_aprox));
+    realnum_aprox* alpha = malloc(n * sizeof(realnum_aprox));
+    realnum_aprox* beta = malloc(n * sizeof(realnum_aprox));
+    realnum_aprox* w = malloc(n * sizeof(realnum_aprox));
+    realnum_aprox* h = malloc(n * sizeof(realnum_aprox));
+    realnum_aprox* d = malloc(n * sizeof(realnum_aprox));
+    realnum_aprox* s = NULL;
+    linmatrix_eigen_pair* pairs = NULL;
+    size_t m = 0;
+    // A running estimate of |A|, the scale of breakdowns and residuals.
+    realnum_aprox scale = 0;
+    size_t seed = 0;
+    bool converged = false;
+
+    for (size_t i = 0; i < n; i++) {
+        q[i] = linmatrix_lanczos_start(i);
+    }
+    realnum_aprox start = linmatrix_lanczos_norm(q, n);
+    for (size_t i = 0; i < n; i++) {
+        q[i] /= start;
+    }
+    for (size_t j = 0; j < n; j++) {
+        realnum_aprox* qj = &q[j * n];
+        apply(ctx, qj, w);
+        alpha[j] = 0;
+        for (size_t i = 0; i < n; i++) {
+            alpha[j] += qj[i] * w[i];
+        }
+        // Orthogonalizing against the whole basis also removes alpha and beta.
+        linmatrix_lanczos_orthogonalize(q, j + 1, n, w, h);
+        beta[j] = linmatrix_lanczos_norm(w, n);
+        m = j + 1;
+        realnum_aprox size = linmatrix_eigen_abs(alpha[j]) + beta[j] + (j ? beta[j - 1] : 0);
+        scale = size > scale ? size : scale;
+        bool breakdown = beta[j] <= LINMATRIX_EIGEN_EPSILON * scale;
+
+        if (m >= k && (m == n || breakdown || (m - k) % LINMATRIX_LANCZOS_CHECK == 0)) {
+            // Only the last row of the eigenvectors of T is needed for the residuals.
+            free(s);
+            s = linmatrix_lanczos_ritz(alpha, beta, m, d, 1, &converged);
+            free(pairs);
+            pairs = linmatrix_eigen_sort(d, m);
+            realnum_aprox top = linmatrix_eigen_abs(pairs[0].value);
+            realnum_aprox bottom = linmatrix_eigen_abs(pairs[m - 1].value);
+            realnum_aprox bound = LINMATRIX_LANCZOS_TOLERANCE * (top > bottom ? top : bottom);
+            // The residual of Ritz pair i is beta_j times the last element of its vector.
+            for (size_t i = 0; i < k && converged; i++) {
+                converged = linmatrix_eigen_abs(beta[j] * s[pairs[i].index]) <= bound;
+            }
+            if (converged || m == n) {
+                break;
+            }
+        }
+        if (m == capacity) {
+            capacity = 2 * capacity < n ? 2 * capacity : n;
+            q = realloc(q, capacity * n * sizeof(realnum_aprox));
+        }
+        realnum_aprox* next = &q[m * n];
+        if (breakdown) {
+            // The basis spans an invariant subspace, continue from a fresh direction.
+            beta[j] = 0;
+            realnum_aprox norm = 0;
+            while (norm <= LINMATRIX_EIGEN_EPSILON) {
+                seed += n;
+                for (size_t i = 0; i < n; i++) {
+                    next[i] = linmatrix_lanczos_start(seed + i);
+                }
+                linmatrix_lanczos_orthogonalize(q, m, n, next, h);
+                norm = linmatrix_lanczos_norm(next, n);
+            }
+            for (size_t i = 0; i < n; i++) {
+                next[i] /= norm;
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                next[i] = w[i] / beta[j];
+            }
+        }
+    }
+
+    // The Ritz vectors, Q^T * S over the wanted columns of S.
+    bool complete;
+    free(s);
+    free(pairs);
+    s = linmatrix_lanczos_ritz(alpha, beta, m, d, m, &complete);
+    pairs = linmatrix_eigen_sort(d, m);
+    eigen.converged = converged && complete;
+    eigen.values = linmatrix_eigen_values(pairs, k);
+    eigen.vectors = linmatrix_new(n, k);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n * m * k >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < n; i++) {
+        for (size_t c = 0; c < k; c++) {
+            realnum_aprox sum = 0;
+            for (size_t j = 0; j < m; j++) {
+                sum += q[j * n + i] * s[j * m + pairs[c].index];
+            }
+            eigen.vectors.data[i * k + c] = realnum_from_aprox(sum);
+        }
+    }
+    free(q);
+    free(alpha);
+    free(beta);
+    free(w);
+    free(h);
+    free(d);
+    free(s);
+    free(pairs);
+    return eigen;
+}
+
+linmatrix_eigen linoperator_eigen_top(linoperator* op, size_t k) {
+    if (op->rows != op->cols) {
+        fprintf(stderr, "Error: only square operators have a symmetric eigendecomposition.\n");
+        exit(1);
+    }
+    LINSTATS_KERNEL_BEGIN(lanczos);
+    linmatrix_eigen eigen = linmatrix_lanczos(op->rows, k, op->apply, op->ctx);
+    LINSTATS_KERNEL_END(lanczos, LINSTATS_LANCZOS);
+    return eigen;
+}
+
+/* The Gram operator x -> A^T * (A * x), or A * (A^T * x) when `wide`. */
+typedef struct linoperator_gram_ctx {
+    linoperator* op;
+    bool wide;
+    realnum_aprox* tmp;
+} linoperator_gram_ctx;
+
+static void linoperator_gram_apply(void* ctx, const realnum_aprox* x, realnum_aprox* y) {
+    linoperator_gram_ctx* gram = ctx;
+    linoperator* op = gram->op;
+    if (gram->wide) {
+        op->apply_transpose(op->ctx, x, gram->tmp);
+        op->apply(op->ctx, gram->tmp, y);
+    } else {
+        op->apply(op->ctx, x, gram->tmp);
+        op->apply_transpose(op->ctx, gram->tmp, y);
+    }
+}
+
+/*
+ * Completes the singular triplets from the eigenpairs of the Gram matrix of
+ * the smaller side: the singular values are the square roots of the
+ * eigenvalues and every vector of the other side is the product with A, or
+ * A^T, divided by its singular value.
+ */
+static linmatrix_svd linmatrix_svd_complete(linoperator* op, linmatrix_eigen* eigen, bool wide) {
+    size_t k = eigen->values.size;
+    size_t small = wide ? op->rows : op->cols;
+    size_t large = wide ? op->cols : op->rows;
+    linmatrix_svd svd;
+    svd.converged = eigen->converged;
+    svd.s = linvector_with_capacity(k ? k : 1);
+    linmatrix other = linmatrix_new(large, k);
+    realnum_aprox* x = malloc(small * sizeof(realnum_aprox) + 1);
+    realnum_aprox* y = malloc(large * sizeof(realnum_aprox) + 1);
+    for (size_t c = 0; c < k; c++) {
+        realnum_aprox lambda = eigen->values.data[c].value.aprox;
+        realnum_aprox sigma = lambda > 0 ? linmatrix_eigen_sqrt(lambda) : 0;
+        linvector_push(&svd.s, realnum_from_aprox(sigma));
+        for (size_t i = 0; i < small; i++) {
+            x[i] = eigen->vectors.data[i * k + c].value.aprox;
+        }
+        if (wide) {
+            op->apply_transpose(op->ctx, x, y);
+        } else {
+            op->apply(op->ctx, x, y);
+        }
+        for (size_t i = 0; i < large; i++) {
+            other.data[i * k + c] = realnum_from_aprox(sigma > 0 ? y[i] / sigma : 0);
+        }
+    }
+    free(x);
+    free(y);
+    linvector_free(&eigen->values);
+    if (wide) {
+        svd.u = eigen->vectors;
+        svd.v = other;
+    } else {
+        svd.u = other;
+        svd.v = eigen->vectors;
+    }
+    return svd;
+}
+
+linmatrix_svd linmatrix_svd_new(linmatrix* a, size_t k) {
+    bool wide = a->rows < a->cols;
+    if (k > (wide ? a->rows : a->cols)) {
+        fprintf(stderr, "Error: cannot compute more singular values than the smaller dimension of the matrix.\n");
+        exit(1);
+    }
+    linmatrix_view av = linmatrix_view_of(a);
+    linmatrix_view at = linmatrix_view_transpose(&av);
+    linmatrix gram = wide ? linmatrix_view_mul(&av, &at) : linmatrix_view_mul(&at, &av);
+    linmatrix_eigen full = linmatrix_eigen_symmetric(&gram, true);
+    linmatrix_free(&gram);
+
+    // Keep the k largest eigenpairs.
+    size_t n = full.values.size;
+    linmatrix_eigen eigen;
+    eigen.converged = full.converged;
+    eigen.values = linvector_with_capacity(k ? k : 1);
+    eigen.vectors = linmatrix_new(n, k);
+    for (size_t c = 0; c < k; c++) {
+        linvector_push(&eigen.values, realnum_clone(&full.values.data[c]));
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t c = 0; c < k; c++) {
+            eigen.vectors.data[i * k + c] = realnum_clone(&full.vectors.data[i * n + c]);
+        }
+    }
+    linmatrix_eigen_free(&full);
+
+    linoperator op = linoperator_dense(a);
+    linmatrix_svd svd = linmatrix_svd_complete(&op, &eigen, wide);
+    linoperator_free(&op);
+    return svd;
+}
+
+linmatrix_svd linoperator_svd_top(linoperator* op, size_t k) {
+    if (!op->apply_transpose) {
+        fprintf(stderr, "Error: the singular values of an operator need its transpose product.\n");
+        exit(1);
+    }
+    bool wide = op->rows < op->cols;
+    size_t small = wide ? op->rows : op->cols;
+    if (k > small) {
+        fprintf(stderr, "Error: cannot compute more singular values than the smaller dimension of the operator.\n");
+        exit(1);
+    }
+    LINSTATS_KERNEL_BEGIN(lanczos);
+    linoperator_gram_ctx gram = {op, wide, malloc((wide ? op->cols : op->rows) * sizeof(realnum_aprox) + 1)};
+    linmatrix_eigen eigen = linmatrix_lanczos(small, k, linoperator_gram_apply, &gram);
+    free(gram.tmp);
+    linmatrix_svd svd = linmatrix_svd_complete(op, &eigen, wide);
+    LINSTATS_KERNEL_END(lanczos, LINSTATS_LANCZOS);
+    return svd;
+}
+
+void linmatrix_svd_free(linmatrix_svd* svd) {
+    linmatrix_free(&svd->u);
+    linvector_free(&svd->s);
+    linmatrix_free(&svd->v);
+}
+
+#undef NC
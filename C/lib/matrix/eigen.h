@@ -0,0 +1,204 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"../sparse/sparse.h"
+#include"./matrix.h"
+
+/*
+ * The relative size under which an off-diagonal element of the tridiagonal
+ * matrix is taken as zero, the unit roundoff of REALNUM_APROX.
+ */
+#ifndef LINMATRIX_EIGEN_EPSILON
+#if REALNUM_APROX_PRECISION == 32
+#define LINMATRIX_EIGEN_EPSILON 1.2e-7
+#elif REALNUM_APROX_PRECISION == 64
+#define LINMATRIX_EIGEN_EPSILON 2.3e-16
+#elif REALNUM_APROX_PRECISION == 80
+#define LINMATRIX_EIGEN_EPSILON 1.1e-19
+#else
+#define LINMATRIX_EIGEN_EPSILON 2e-34
+#endif
+#endif
+
+/*
+ * The implicit QR iteration gives up after this many steps per eigenvalue,
+ * leaving `converged` false. A Wilkinson shift converges in two or three.
+ */
+#ifndef LINMATRIX_EIGEN_MAX_STEPS
+#define LINMATRIX_EIGEN_MAX_STEPS 30
+#endif
+
+/*
+ * Lanczos stops once the residual |A * x - theta * x| of each wanted Ritz pair
+ * is below this fraction of the largest Ritz value.
+ */
+#ifndef LINMATRIX_LANCZOS_TOLERANCE
+#if REALNUM_APROX_PRECISION == 32
+#define LINMATRIX_LANCZOS_TOLERANCE 1e-5
+#elif REALNUM_APROX_PRECISION == 64
+#define LINMATRIX_LANCZOS_TOLERANCE 1e-10
+#elif REALNUM_APROX_PRECISION == 80
+#define LINMATRIX_LANCZOS_TOLERANCE 1e-13
+#else
+#define LINMATRIX_LANCZOS_TOLERANCE 1e-24
+#endif
+#endif
+
+/*
+ * The number of Lanczos steps between two convergence checks, each of which
+ * solves the tridiagonal eigenproblem built so far.
+ */
+#ifndef LINMATRIX_LANCZOS_CHECK
+#define LINMATRIX_LANCZOS_CHECK 8
+#endif
+
+/**
+ * @struct linoperator
+ * @brief A linear map known only through its products with vectors.
+ *
+ * `apply` overwrites `y`, with `rows` elements, with A * x for `x` of `cols`
+ * elements; `apply_transpose` does the same for A^T and may be NULL. `release`
+ * frees `ctx` and may be NULL when the caller owns it. Any map can be wrapped
+ * by filling these fields; linoperator_dense and linoperator_sparse wrap the
+ * matrices of the library.
+ */
+typedef struct linoperator {
+    size_t rows;
+    size_t cols;
+    void (*apply)(void* ctx, const realnum_aprox* x, realnum_aprox* y);
+    void (*apply_transpose)(void* ctx, const realnum_aprox* x, realnum_aprox* y);
+    void (*release)(void* ctx);
+    void* ctx;
+} linoperator;
+
+/**
+ * @struct linmatrix_eigen
+ * @brief Eigenvalues and eigenvectors of a symmetric matrix.
+ *
+ * `values` is sorted from largest to smallest and column i of `vectors`, with
+ * one row per row of the matrix, is the unit eigenvector of `values[i]`. Every
+ * element is an approximation.
+ */
+typedef struct linmatrix_eigen {
+    linvector values;
+    linmatrix vectors; /**< Empty when the eigenvectors were not asked for. */
+    bool converged; /**< Whether every returned pair reached its tolerance. */
+} linmatrix_eigen;
+
+/**
+ * @struct linmatrix_svd
+ * @brief The k largest singular triplets of a matrix, A ≈ U * diag(s) * V^T.
+ *
+ * `s` is sorted from largest to smallest and column i of `u` and of `v` are
+ * the left and right singular vectors of `s[i]`. Every element is an
+ * approximation.
+ */
+typedef struct linmatrix_svd {
+    linmatrix u; /**< rows x k. */
+    linvector s;
+    linmatrix v; /**< cols x k. */
+    bool converged; /**< Whether every returned triplet reached its tolerance. */
+} linmatrix_svd;
+
+/**
+ * Wraps a dense matrix as an operator.
+ *
+ * The elements are approximated once, into storage owned by the operator, so
+ * later changes to `a` are not seen.
+ *
+ * @param a The matrix.
+ * @return The operator, to be freed with linoperator_free.
+ */
+linoperator linoperator_dense(linmatrix* a);
+
+/**
+ * Wraps a sparse matrix of either format as an operator.
+ *
+ * The values are approximated once, into storage owned by the operator, so
+ * later changes to `a` are not seen.
+ *
+ * @param a The matrix.
+ * @return The operator, to be freed with linoperator_free.
+ */
+linoperator linoperator_sparse(linsparse* a);
+
+/**
+ * Frees the context of an operator through its `release` function.
+ *
+ * @param op The operator to free.
+ */
+void linoperator_free(linoperator* op);
+
+/**
+ * Computes every eigenvalue of a symmetric matrix, and optionally every eigenvector.
+ *
+ * The matrix is reduced to tridiagonal form by Householder reflections and
+ * the tridiagonal matrix is diagonalized by the implicit QR iteration with
+ * Wilkinson shifts, in O(n^3) overall. Only the lower triangle is read.
+ *
+ * @param a The symmetric matrix, left untouched.
+ * @param vectors Whether to compute the eigenvectors, which triples the work.
+ * @return The eigenvalues and eigenvectors.
+ */
+linmatrix_eigen linmatrix_eigen_symmetric(linmatrix* a, bool vectors);
+
+/**
+ * Computes the k largest eigenvalues of a symmetric operator and their eigenvectors.
+ *
+ * Runs the Lanczos iteration with full reorthogonalization from a fixed start
+ * vector, checking the Ritz pairs every LINMATRIX_LANCZOS_CHECK steps and
+ * stopping as soon as the k largest reach LINMATRIX_LANCZOS_TOLERANCE. Only
+ * products with the operator are needed, and for well separated eigenvalues
+ * the Krylov space stays a small multiple of k, so this is far cheaper than
+ * the full decomposition when k is small.
+ *
+ * @param op The square, symmetric operator.
+ * @param k The number of eigenpairs, at most the size of the operator.
+ * @return The eigenpairs, largest first.
+ */
+linmatrix_eigen linoperator_eigen_top(linoperator* op, size_t k);
+
+/**
+ * Frees the memory occupied by the given eigendecomposition.
+ *
+ * @param eigen The eigendecomposition to free.
+ */
+void linmatrix_eigen_free(linmatrix_eigen* eigen);
+
+/**
+ * Computes the k largest singular values of a matrix and their singular vectors.
+ *
+ * The singular values are the square roots of the eigenvalues of the Gram
+ * matrix of the smaller side, A^T * A or A * A^T, which is formed with the
+ * blocked product and diagonalized with linmatrix_eigen_symmetric. Squaring
+ * halves the relative accuracy of singular values much smaller than the
+ * largest.
+ *
+ * @param a The matrix, left untouched.
+ * @param k The number of triplets, at most the smaller dimension.
+ * @return The singular triplets, largest first.
+ */
+linmatrix_svd linmatrix_svd_new(linmatrix* a, size_t k);
+
+/**
+ * Computes the k largest singular values of an operator and their singular vectors.
+ *
+ * Runs linoperator_eigen_top on x -> A^T * (A * x), or A * (A^T * x) when A
+ * has fewer rows than columns, so only products are needed.
+ *
+ * @param op The operator, with an `apply_transpose`.
+ * @param k The number of triplets, at most the smaller dimension.
+ * @return The singular triplets, largest first.
+ */
+linmatrix_svd linoperator_svd_top(linoperator* op, size_t k);
+
+/**
+ * Frees the memory occupied by the given singular value decomposition.
+ *
+ * @param svd The decomposition to free.
+ */
+void linmatrix_svd_free(linmatrix_svd* svd);
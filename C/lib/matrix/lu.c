@@ -0,0 +1,200 @@
+#include"./lu.h"
+#include"../stats/stats.h"
+
+static bool linmatrix_lu_is_zero(realnum* num) {
+    switch (num->kind) {
+        case REALNUM_FRAC: return num->value.frac.num == 0;
+        case REALNUM_APROX: return num->value.aprox == 0;
+        default: return false;
+    }
+}
+
+static realnum_aprox linmatrix_lu_magnitude(realnum* num) {
+    realnum_aprox value = realnum_as_aprox(num).value.aprox;
+    return value < 0 ? -value : value;
+}
+
+/*
+ * Replaces *dst by *dst - factor * src, releasing the intermediate values.
+ */
+static void linmatrix_lu_eliminate(realnum* dst, realnum* factor, realnum* src) {
+    realnum product = realnum_mul(factor, src);
+    realnum diff = realnum_sub(dst, &product);
+    realnum_free(&product);
+    realnum_free(dst);
+    *dst = diff;
+}
+
+linmatrix_lu linmatrix_lu_in_place(linmatrix* a) {
+    if (a->rows != a->cols) {
+        fprintf(stderr, "Error: only square matrices have an LU factorization.\n");
+        exit(1);
+    }
+    size_t n = a->rows;
+    LINSTATS_KERNEL_BEGIN(lu);
+    linmatrix_lu lu;
+    lu.lu = *a;
+    lu.perm = malloc(n * sizeof(size_t));
+    lu.odd = false;
+    lu.singular = false;
+    a->data = NULL;
+    a->rows = 0;
+    a->cols = 0;
+
+    realnum* data = lu.lu.data;
+    for (size_t i = 0; i < n; i++) {
+        lu.perm[i] = i;
+    }
+    for (size_t k = 0; k < n; k++) {
+        size_t pivot_row = k;
+        realnum_aprox pivot_abs = linmatrix_lu_magnitude(&data[k * n + k]);
+        for (size_t i = k + 1; i < n; i++) {
+            realnum_aprox abs = linmatrix_lu_magnitude(&data[i * n + k]);
+            if (abs > pivot_abs) {
+                pivot_row = i;
+                pivot_abs = abs;
+            }
+        }
+        if (linmatrix_lu_is_zero(&data[pivot_row * n + k])) {
+            lu.singular = true;
+            continue;
+        }
+        if (pivot_row != k) {
+            for (size_t j = 0; j < n; j++) {
+                realnum temp = data[k * n + j];
+                data[k * n + j] = data[pivot_row * n + j];
+                data[pivot_row * n + j] = temp;
+            }
+            size_t temp = lu.perm[k];
+            lu.perm[k] = lu.perm[pivot_row];
+            lu.perm[pivot_row] = temp;
+            lu.odd = !lu.odd;
+        }
+
+        realnum* pivot = &data[k * n];
+        for (size_t i = k + 1; i < n; i++) {
+            realnum* row = &data[i * n];
+            realnum factor = realnum_div(&row[k], &pivot[k]);
+            realnum_free(&row[k]);
+            row[k] = factor;
+            if (linmatrix_lu_is_zero(&factor)) {
+                continue;
+            }
+            for (size_t j = k + 1; j < n; j++) {
+                linmatrix_lu_eliminate(&row[j], &row[k], &pivot[j]);
+            }
+        }
+    }
+    LINSTATS_KERNEL_END(lu, LINSTATS_MATRIX_LU);
+    return lu;
+}
+
+linmatrix_lu linmatrix_lu_new(linmatrix* a) {
+    linmatrix copy = linmatrix_clone(a);
+    return linmatrix_lu_in_place(&copy);
+}
+
+void linmatrix_lu_free(linmatrix_lu* lu) {
+    linmatrix_free(&lu->lu);
+    free(lu->perm);
+    lu->perm = NULL;
+}
+
+realnum linmatrix_lu_determinant(linmatrix_lu* lu) {
+    size_t n = lu->lu.rows;
+    realnum det = realnum_from_frac(lu->odd ? -1 : 1, 1);
+    for (size_t i = 0; i < n; i++) {
+        realnum next = realnum_mul(&det, &lu->lu.data[i * n + i]);
+        realnum_free(&det);
+        det = next;
+    }
+    return det;
+}
+
+/*
+ * Runs forward substitution with L and back substitution with U over a
+ * permuted row-major block of right-hand sides, a whole row at a time.
+ */
+static void linmatrix_lu_substitute(linmatrix_lu* lu, realnum* x, size_t width) {
+    if (lu->singular) {
+        fprintf(stderr, "Error: cannot solve a system with a singular matrix.\n");
+        exit(1);
+    }
+    size_t n = lu->lu.rows;
+    realnum* data = lu->lu.data;
+    for (size_t i = 1; i < n; i++) {
+        for (size_t k = 0; k < i; k++) {
+            for (size_t j = 0; j < width; j++) {
+                linmatrix_lu_eliminate(&x[i * width + j], &data[i * n + k], &x[k * width + j]);
+            }
+        }
+    }
+    for (size_t i = n; i-- > 0;) {
+        for (size_t k = i + 1; k < n; k++) {
+            for (size_t j = 0; j < width; j++) {
+                linmatrix_lu_eliminate(&x[i * width + j], &data[i * n + k], &x[k * width + j]);
+            }
+        }
+        for (size_t j = 0; j < width; j++) {
+            realnum quot = realnum_div(&x[i * width + j], &data[i * n + i]);
+            realnum_free(&x[i * width + j]);
+            x[i * width + j] = quot;
+        }
+    }
+}
+
+linvector linmatrix_lu_solve(linmatrix_lu* lu, linvector* b) {
+    size_t n = lu->lu.rows;
+    if (b->size != n) {
+        fprintf(stderr, "Error: the size of the vector must match the size of the matrix.\n");
+        exit(1);
+    }
+    linvector x = linvector_with_capacity(n);
+    for (size_t i = 0; i < n; i++) {
+        x.data[i] = realnum_clone(&b->data[lu->perm[i]]);
+    }
+    x.size = n;
+    linmatrix_lu_substitute(lu, x.data, 1);
+    return x;
+}
+
+linmatrix linmatrix_lu_solve_matrix(linmatrix_lu* lu, linmatrix* b) {
+    size_t n = lu->lu.rows;
+    if (b->rows != n) {
+        fprintf(stderr, "Error: the number of rows of the right-hand side must match the size of the matrix.\n");
+        exit(1);
+    }
+    linmatrix x;
+    x.rows = b->rows;
+    x.cols = b->cols;
+    x.data = malloc(b->rows * b->cols * sizeof(realnum));
+    x.borrowed = false;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < b->cols; j++) {
+            x.data[i * b->cols + j] = realnum_clone(&b->data[lu->perm[i] * b->cols + j]);
+        }
+    }
+    linmatrix_lu_substitute(lu, x.data, b->cols);
+    return x;
+}
+
+linmatrix linmatrix_lu_inverse(linmatrix_lu* lu) {
+    linmatrix identity = linmatrix_identity(lu->lu.rows);
+    linmatrix inverse = linmatrix_lu_solve_matrix(lu, &identity);
+    linmatrix_free(&identity);
+    return inverse;
+}
+
+realnum linmatrix_determinant(linmatrix* a) {
+    linmatrix_lu lu = linmatrix_lu_new(a);
+    realnum det = linmatrix_lu_determinant(&lu);
+    linmatrix_lu_free(&lu);
+    return det;
+}
+
+linmatrix linmatrix_inverse(linmatrix* a) {
+    linmatrix_lu lu = linmatrix_lu_new(a);
+    linmatrix inverse = linmatrix_lu_inverse(&lu);
+    linmatrix_lu_free(&lu);
+    return inverse;
+}
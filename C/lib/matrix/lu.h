@@ -0,0 +1,106 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"./matrix.h"
+
+/**
+ * @struct linmatrix_lu
+ * @brief Represents the PLU factorization P * A = L * U of a square matrix.
+ *
+ * L and U share one matrix: U is stored on and above the diagonal and the
+ * multipliers of L below it, with its unit diagonal left implicit. `perm[i]` is
+ * the row of A that ended up in row i.
+ *
+ * The factorization is computed once in O(n^3) and can then be reused for any
+ * number of determinants, solves and inverses.
+ */
+typedef struct linmatrix_lu {
+    linmatrix lu;
+    size_t* perm;
+    bool odd; /**< Whether the permutation is odd. */
+    bool singular; /**< Whether a column had no non-zero pivot. */
+} linmatrix_lu;
+
+/**
+ * Computes the PLU factorization of a square matrix.
+ *
+ * Each column is pivoted on the entry of largest magnitude at or below the
+ * diagonal. A column without a non-zero pivot marks the matrix as singular and
+ * is skipped, so the factorization always completes. Exact elements are
+ * eliminated exactly.
+ *
+ * @param a The matrix to factor, left untouched.
+ * @return The factorization.
+ */
+linmatrix_lu linmatrix_lu_new(linmatrix* a);
+
+/**
+ * Computes the PLU factorization of a square matrix in place.
+ *
+ * The factorization takes over the storage of `a`, which is left empty.
+ *
+ * @param a The matrix to factor.
+ * @return The factorization.
+ */
+linmatrix_lu linmatrix_lu_in_place(linmatrix* a);
+
+/**
+ * Frees the memory occupied by the given factorization.
+ *
+ * @param lu The factorization to free.
+ */
+void linmatrix_lu_free(linmatrix_lu* lu);
+
+/**
+ * Calculates the determinant of the factored matrix.
+ *
+ * @param lu The factorization.
+ * @return The product of the pivots, negated for an odd permutation.
+ */
+realnum linmatrix_lu_determinant(linmatrix_lu* lu);
+
+/**
+ * Solves A * x = b for x.
+ *
+ * @param lu The factorization of A.
+ * @param b The right-hand side.
+ * @return The solution.
+ */
+linvector linmatrix_lu_solve(linmatrix_lu* lu, linvector* b);
+
+/**
+ * Solves A * X = B for every column of B at once.
+ *
+ * @param lu The factorization of A.
+ * @param b The right-hand sides, one per column.
+ * @return The solutions, one per column.
+ */
+linmatrix linmatrix_lu_solve_matrix(linmatrix_lu* lu, linmatrix* b);
+
+/**
+ * Calculates the inverse of the factored matrix.
+ *
+ * @param lu The factorization.
+ * @return The inverse.
+ */
+linmatrix linmatrix_lu_inverse(linmatrix_lu* lu);
+
+/**
+ * Calculates the determinant of a square matrix through its LU factorization.
+ *
+ * @param a The matrix.
+ * @return The determinant.
+ */
+realnum linmatrix_determinant(linmatrix* a);
+
+/**
+ * Calculates the inverse of a square matrix through its LU factorization.
+ *
+ * @param a The matrix.
+ * @return The inverse.
+ */
+linmatrix linmatrix_inverse(linmatrix* a);
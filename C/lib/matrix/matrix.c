@@ -0,0 +1,440 @@
+#include"./matrix.h"
+#include"../stats/stats.h"
+
+#define MC LINMATRIX_BLOCK_MC
+#define KC LINMATRIX_BLOCK_KC
+#define NC LINMATRIX_BLOCK_NC
+#define MR LINMATRIX_MICRO_MR
+#define NR LINMATRIX_MICRO_NR
+#define TILE LINMATRIX_TRANSPOSE_TILE
+
+linmatrix linmatrix_new(size_t rows, size_t cols) {
+    linmatrix mat;
+    mat.rows = rows;
+    mat.cols = cols;
+    mat.data = malloc(rows * cols * sizeof(realnum));
+    mat.borrowed = false;
+    LINSTATS_ALLOC(LINSTATS_MATRIX_ALLOC, rows * cols * sizeof(realnum));
+    for (size_t i = 0; i < rows * cols; i++) {
+        mat.data[i] = realnum_new();
+    }
+    return mat;
+}
+
+linmatrix linmatrix_identity(size_t n) {
+    linmatrix mat = linmatrix_new(n, n);
+    for (size_t i = 0; i < n; i++) {
+        mat.data[i * n + i] = realnum_from_frac(1, 1);
+    }
+    return mat;
+}
+
+linmatrix linmatrix_with_data(realnum* data, size_t rows, size_t cols) {
+    linmatrix mat;
+    mat.rows = rows;
+    mat.cols = cols;
+    mat.data = data;
+    mat.borrowed = false;
+    return mat;
+}
+
+linmatrix linmatrix_borrow(realnum* data, size_t rows, size_t cols) {
+    linmatrix mat = linmatrix_with_data(data, rows, cols);
+    mat.borrowed = true;
+    return mat;
+}
+
+linmatrix linmatrix_from_rows(linvector* rows, size_t n) {
+    size_t cols = n > 0 ? rows[0].size : 0;
+    linmatrix mat = linmatrix_new(n, cols);
+    for (size_t i = 0; i < n; i++) {
+        if (rows[i].size != cols) {
+            fprintf(stderr, "Error: all rows must have the same size to build a matrix.\n");
+            exit(1);
+        }
+        for (size_t j = 0; j < cols; j++) {
+            mat.data[i * cols + j] = realnum_clone(&rows[i].data[j]);
+        }
+    }
+    return mat;
+}
+
+linmatrix linmatrix_clone(linmatrix* mat) {
+    linmatrix clone;
+    clone.rows = mat->rows;
+    clone.cols = mat->cols;
+    clone.data = malloc(mat->rows * mat->cols * sizeof(realnum));
+    clone.borrowed = false;
+    LINSTATS_ALLOC(LINSTATS_MATRIX_ALLOC, mat->rows * mat->cols * sizeof(realnum));
+    for (size_t i = 0; i < mat->rows * mat->cols; i++) {
+        clone.data[i] = realnum_clone(&mat->data[i]);
+    }
+    return clone;
+}
+
+void linmatrix_free(linmatrix* mat) {
+    if (!mat->borrowed) {
+        for (size_t i = 0; i < mat->rows * mat->cols; i++) {
+            realnum_free(&mat->data[i]);
+        }
+        free(mat->data);
+    }
+    mat->data = NULL;
+    mat->rows = 0;
+    mat->cols = 0;
+}
+
+realnum linmatrix_get(linmatrix* mat, size_t row, size_t col) {
+    if (row >= mat->rows || col >= mat->cols) {
+        fprintf(stderr, "Error: matrix index out of bounds.\n");
+        exit(1);
+    }
+    return mat->data[row * mat->cols + col];
+}
+
+void linmatrix_set(linmatrix* mat, size_t row, size_t col, realnum value) {
+    if (row >= mat->rows || col >= mat->cols) {
+        fprintf(stderr, "Error: matrix index out of bounds.\n");
+        exit(1);
+    }
+    realnum_free(&mat->data[row * mat->cols + col]);
+    mat->data[row * mat->cols + col] = value;
+}
+
+void linmatrix_print(linmatrix* mat, uint16_t precision) {
+    for (size_t i = 0; i < mat->rows; i++) {
+        printf("[");
+        for (size_t j = 0; j < mat->cols; j++) {
+            realnum_print(&mat->data[i * mat->cols + j], precision);
+            if (j < mat->cols - 1) {
+                printf(", ");
+            }
+        }
+        printf("]\n");
+    }
+}
+
+linmatrix linmatrix_add(linmatrix* a, linmatrix* b) {
+    if (a->rows != b->rows || a->cols != b->cols) {
+        fprintf(stderr, "Error: matrices must have the same dimensions to be added.\n");
+        exit(1);
+    }
+    linmatrix mat = linmatrix_new(a->rows, a->cols);
+    for (size_t i = 0; i < a->rows * a->cols; i++) {
+        mat.data[i] = realnum_add(&a->data[i], &b->data[i]);
+    }
+    return mat;
+}
+
+linmatrix linmatrix_sub(linmatrix* a, linmatrix* b) {
+    if (a->rows != b->rows || a->cols != b->cols) {
+        fprintf(stderr, "Error: matrices must have the same dimensions to be subtracted.\n");
+        exit(1);
+    }
+    linmatrix mat = linmatrix_new(a->rows, a->cols);
+    for (size_t i = 0; i < a->rows * a->cols; i++) {
+        mat.data[i] = realnum_sub(&a->data[i], &b->data[i]);
+    }
+    return mat;
+}
+
+linmatrix linmatrix_scale(linmatrix* a, realnum scalar) {
+    linmatrix mat = linmatrix_new(a->rows, a->cols);
+    for (size_t i = 0; i < a->rows * a->cols; i++) {
+        mat.data[i] = realnum_mul(&a->data[i], &scalar);
+    }
+    return mat;
+}
+
+linmatrix linmatrix_transpose(linmatrix* a) {
+    linmatrix mat;
+    mat.rows = a->cols;
+    mat.cols = a->rows;
+    mat.data = malloc(a->rows * a->cols * sizeof(realnum));
+    mat.borrowed = false;
+    LINSTATS_ALLOC(LINSTATS_MATRIX_ALLOC, a->rows * a->cols * sizeof(realnum));
+    LINSTATS_KERNEL_BEGIN(transpose);
+    for (size_t ib = 0; ib < a->rows; ib += TILE) {
+        size_t ie = ib + TILE < a->rows ? ib + TILE : a->rows;
+        for (size_t jb = 0; jb < a->cols; jb += TILE) {
+            size_t je = jb + TILE < a->cols ? jb + TILE : a->cols;
+            for (size_t i = ib; i < ie; i++) {
+                for (size_t j = jb; j < je; j++) {
+                    mat.data[j * a->rows + i] = realnum_clone(&a->data[i * a->cols + j]);
+                }
+            }
+        }
+    }
+    LINSTATS_KERNEL_END(transpose, LINSTATS_MATRIX_TRANSPOSE);
+    return mat;
+}
+
+void linmatrix_transpose_in_place(linmatrix* a) {
+    if (a->rows != a->cols) {
+        if (a->borrowed) {
+            fprintf(stderr, "Error: a linmatrix that borrows its elements cannot change shape.\n");
+            exit(1);
+        }
+        linmatrix mat = linmatrix_transpose(a);
+        linmatrix_free(a);
+        *a = mat;
+        return;
+    }
+    size_t n = a->rows;
+    LINSTATS_KERNEL_BEGIN(transpose);
+    for (size_t ib = 0; ib < n; ib += TILE) {
+        size_t ie = ib + TILE < n ? ib + TILE : n;
+        for (size_t jb = ib; jb < n; jb += TILE) {
+            size_t je = jb + TILE < n ? jb + TILE : n;
+            for (size_t i = ib; i < ie; i++) {
+                for (size_t j = ib == jb ? i + 1 : jb; j < je; j++) {
+                    realnum temp = a->data[i * n + j];
+                    a->data[i * n + j] = a->data[j * n + i];
+                    a->data[j * n + i] = temp;
+                }
+            }
+        }
+    }
+    LINSTATS_KERNEL_END(transpose, LINSTATS_MATRIX_TRANSPOSE);
+}
+
+/*
+ * Packs the mc x kc block of `a` starting at (row, col) into micro-panels of MR
+ * rows. Inside a panel the MR elements of each column are contiguous, so the
+ * micro-kernel reads the panel front to back. Rows past the edge are padded
+ * with zeros, the kernel never reads them.
+ */
+static void linmatrix_pack_a(linmatrix_view* a, size_t row, size_t col, size_t mc, size_t kc, realnum* pack) {
+    for (size_t ir = 0; ir < mc; ir += MR) {
+        size_t mr = mc - ir < MR ? mc - ir : MR;
+        for (size_t p = 0; p < kc; p++) {
+            for (size_t i = 0; i < MR; i++) {
+                *pack++ = i < mr ? a->data[(row + ir + i) * a->row_stride + (col + p) * a->col_stride] : realnum_new();
+            }
+        }
+    }
+}
+
+/*
+ * Packs the kc x nc block of `b` starting at (row, col) into micro-panels of NR
+ * columns, with the NR elements of each row stored contiguously.
+ */
+static void linmatrix_pack_b(linmatrix_view* b, size_t row, size_t col, size_t kc, size_t nc, realnum* pack) {
+    for (size_t jr = 0; jr < nc; jr += NR) {
+        size_t nr = nc - jr < NR ? nc - jr : NR;
+        for (size_t p = 0; p < kc; p++) {
+            for (size_t j = 0; j < NR; j++) {
+                *pack++ = j < nr ? b->data[(row + p) * b->row_stride + (col + jr + j) * b->col_stride] : realnum_new();
+            }
+        }
+    }
+}
+
+/*
+ * Computes the mr x nr tile c += pa * pb, or c -= pa * pb, where pa is an MR x
+ * kc packed panel of A, pb a kc x NR packed panel of B, and element (i, j) of
+ * the tile is c[i * rs + j * cs]. The tile is accumulated locally and written
+ * back once.
+ */
+static void linmatrix_micro_kernel(size_t kc, size_t mr, size_t nr, realnum* pa, realnum* pb, realnum* c, size_t rs, size_t cs, bool subtract) {
+    realnum acc[MR * NR];
+    for (size_t i = 0; i < MR * NR; i++) {
+        acc[i] = realnum_new();
+    }
+    for (size_t p = 0; p < kc; p++) {
+        realnum* ap = pa + p * MR;
+        realnum* bp = pb + p * NR;
+        for (size_t i = 0; i < mr; i++) {
+            for (size_t j = 0; j < nr; j++) {
+                realnum temp = realnum_mul(&ap[i], &bp[j]);
+                realnum sum = realnum_add(&acc[i * NR + j], &temp);
+                realnum_free(&acc[i * NR + j]);
+                realnum_free(&temp);
+                acc[i * NR + j] = sum;
+            }
+        }
+    }
+    for (size_t i = 0; i < mr; i++) {
+        for (size_t j = 0; j < nr; j++) {
+            realnum* dst = &c[i * rs + j * cs];
+            realnum sum = subtract ? realnum_sub(dst, &acc[i * NR + j]) : realnum_add(dst, &acc[i * NR + j]);
+            realnum_free(dst);
+            realnum_free(&acc[i * NR + j]);
+            *dst = sum;
+        }
+    }
+}
+
+/*
+ * Accumulates c += a * b, or c -= a * b, with the blocked kernel. The row
+ * blocks of c are split between threads, each packing its own blocks of a
+ * into a private buffer while the packed block of b is shared.
+ */
+static void linmatrix_gemm(linmatrix_view* c, linmatrix_view* a, linmatrix_view* b, bool subtract) {
+    size_t m = a->rows;
+    size_t n = b->cols;
+    size_t k = a->cols;
+    if (m == 0 || n == 0 || k == 0) {
+        return;
+    }
+    LINSTATS_KERNEL_BEGIN(mul);
+    realnum* pack_b = malloc(KC * NC * sizeof(realnum));
+
+    #ifdef _OPENMP
+    #pragma omp parallel if (m * n * k >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    {
+        realnum* pack_a = malloc(MC * KC * sizeof(realnum));
+        for (size_t jc = 0; jc < n; jc += NC) {
+            size_t nc = n - jc < NC ? n - jc : NC;
+            for (size_t pc = 0; pc < k; pc += KC) {
+                size_t kc = k - pc < KC ? k - pc : KC;
+                #ifdef _OPENMP
+                #pragma omp single
+                #endif
+                linmatrix_pack_b(b, pc, jc, kc, nc, pack_b);
+                #ifdef _OPENMP
+                #pragma omp for schedule(static)
+                #endif
+                for (size_t ic = 0; ic < m; ic += MC) {
+                    size_t mc = m - ic < MC ? m - ic : MC;
+                    linmatrix_pack_a(a, ic, pc, mc, kc, pack_a);
+                    for (size_t jr = 0; jr < nc; jr += NR) {
+                        size_t nr = nc - jr < NR ? nc - jr : NR;
+                        for (size_t ir = 0; ir < mc; ir += MR) {
+                            size_t mr = mc - ir < MR ? mc - ir : MR;
+                            linmatrix_micro_kernel(kc, mr, nr,
+                                pack_a + ir * kc, pack_b + jr * kc,
+                                &c->data[(ic + ir) * c->row_stride + (jc + jr) * c->col_stride],
+                                c->row_stride, c->col_stride, subtract);
+                        }
+                    }
+                }
+            }
+        }
+        free(pack_a);
+    }
+
+    free(pack_b);
+    LINSTATS_KERNEL_END(mul, LINSTATS_MATRIX_MUL);
+}
+
+linmatrix linmatrix_mul(linmatrix* a, linmatrix* b) {
+    linmatrix_view av = linmatrix_view_of(a);
+    linmatrix_view bv = linmatrix_view_of(b);
+    return linmatrix_view_mul(&av, &bv);
+}
+
+linmatrix linmatrix_view_mul(linmatrix_view* a, linmatrix_view* b) {
+    if (a->cols != b->rows) {
+        fprintf(stderr, "Error: the number of columns of the first matrix must match the number of rows of the second.\n");
+        exit(1);
+    }
+    linmatrix c = linmatrix_new(a->rows, b->cols);
+    linmatrix_view cv = linmatrix_view_of(&c);
+    linmatrix_gemm(&cv, a, b, false);
+    return c;
+}
+
+void linmatrix_view_mul_sub(linmatrix_view* c, linmatrix_view* a, linmatrix_view* b) {
+    if (a->cols != b->rows || c->rows != a->rows || c->cols != b->cols) {
+        fprintf(stderr, "Error: the dimensions of the matrices do not match for c -= a * b.\n");
+        exit(1);
+    }
+    linmatrix_gemm(c, a, b, true);
+}
+
+linvector linmatrix_mul_vector(linmatrix* a, linvector* vec) {
+    linmatrix_view av = linmatrix_view_of(a);
+    linvector_view v = linvector_view_of(vec);
+    return linmatrix_view_mul_vector(&av, &v);
+}
+
+linvector linmatrix_view_mul_vector(linmatrix_view* a, linvector_view* vec) {
+    if (a->cols != vec->size) {
+        fprintf(stderr, "Error: the number of columns of the matrix must match the size of the vector.\n");
+        exit(1);
+    }
+    linvector result = linvector_with_capacity(a->rows);
+    for (size_t i = 0; i < a->rows; i++) {
+        realnum sum = realnum_new();
+        for (size_t j = 0; j < a->cols; j++) {
+            realnum temp = realnum_mul(&a->data[i * a->row_stride + j * a->col_stride], &vec->data[j * vec->stride]);
+            realnum next = realnum_add(&sum, &temp);
+            realnum_free(&sum);
+            realnum_free(&temp);
+            sum = next;
+        }
+        result.data[i] = sum;
+    }
+    result.size = a->rows;
+    return result;
+}
+
+linmatrix_view linmatrix_view_of(linmatrix* mat) {
+    return (linmatrix_view){mat->rows, mat->cols, mat->cols, 1, mat->data};
+}
+
+linmatrix_view linmatrix_view_block(linmatrix_view* view, size_t row, size_t col, size_t rows, size_t cols) {
+    if (row + rows > view->rows || col + cols > view->cols) {
+        fprintf(stderr, "Error: matrix view out of bounds.\n");
+        exit(1);
+    }
+    linmatrix_view block = *view;
+    block.rows = rows;
+    block.cols = cols;
+    if (rows > 0 && cols > 0) {
+        block.data += row * view->row_stride + col * view->col_stride;
+    }
+    return block;
+}
+
+linmatrix_view linmatrix_view_transpose(linmatrix_view* view) {
+    return (linmatrix_view){view->cols, view->rows, view->col_stride, view->row_stride, view->data};
+}
+
+linvector_view linmatrix_view_row(linmatrix_view* view, size_t row) {
+    if (row >= view->rows) {
+        fprintf(stderr, "Error: matrix index out of bounds.\n");
+        exit(1);
+    }
+    return (linvector_view){view->cols, view->col_stride, view->data + row * view->row_stride};
+}
+
+linvector_view linmatrix_view_col(linmatrix_view* view, size_t col) {
+    if (col >= view->cols) {
+        fprintf(stderr, "Error: matrix index out of bounds.\n");
+        exit(1);
+    }
+    return (linvector_view){view->rows, view->row_stride, view->data + col * view->col_stride};
+}
+
+realnum linmatrix_view_get(linmatrix_view* view, size_t row, size_t col) {
+    if (row >= view->rows || col >= view->cols) {
+        fprintf(stderr, "Error: matrix index out of bounds.\n");
+        exit(1);
+    }
+    return view->data[row * view->row_stride + col * view->col_stride];
+}
+
+linmatrix linmatrix_view_to_matrix(linmatrix_view* view) {
+    linmatrix mat;
+    mat.rows = view->rows;
+    mat.cols = view->cols;
+    mat.data = malloc(view->rows * view->cols * sizeof(realnum));
+    mat.borrowed = false;
+    LINSTATS_ALLOC(LINSTATS_MATRIX_ALLOC, view->rows * view->cols * sizeof(realnum));
+    for (size_t i = 0; i < view->rows; i++) {
+        for (size_t j = 0; j < view->cols; j++) {
+            mat.data[i * view->cols + j] = realnum_clone(&view->data[i * view->row_stride + j * view->col_stride]);
+        }
+    }
+    return mat;
+}
+
+#undef MC
+#undef KC
+#undef NC
+#undef MR
+#undef NR
+#undef TILE
@@ -0,0 +1,352 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+
+/*
+ * Blocking parameters of the GEMM kernel used by linmatrix_mul.
+ *
+ * A is consumed in MC x KC blocks and B in KC x NC blocks, both repacked into
+ * contiguous panels (MR rows of A, NR columns of B) so the micro-kernel walks
+ * memory linearly. The defaults keep a packed A block (~256 KiB) in L2 and a
+ * packed B panel (~16 KiB) in L1 with 32-byte realnums.
+ */
+#ifndef LINMATRIX_BLOCK_MC
+#define LINMATRIX_BLOCK_MC 64
+#endif
+#ifndef LINMATRIX_BLOCK_KC
+#define LINMATRIX_BLOCK_KC 128
+#endif
+#ifndef LINMATRIX_BLOCK_NC
+#define LINMATRIX_BLOCK_NC 256
+#endif
+#ifndef LINMATRIX_MICRO_MR
+#define LINMATRIX_MICRO_MR 4
+#endif
+#ifndef LINMATRIX_MICRO_NR
+#define LINMATRIX_MICRO_NR 4
+#endif
+
+/*
+ * Products of at least this many multiply-adds (m * n * k) split the row
+ * blocks of the result between threads when built with OpenMP.
+ */
+#ifndef LINMATRIX_PARALLEL_THRESHOLD
+#define LINMATRIX_PARALLEL_THRESHOLD (64 * 64 * 64)
+#endif
+
+/*
+ * Side of the square tiles linmatrix_transpose copies at a time, so the reads
+ * of the source and the writes of the destination both stay in L1.
+ */
+#ifndef LINMATRIX_TRANSPOSE_TILE
+#define LINMATRIX_TRANSPOSE_TILE 16
+#endif
+
+/**
+ * @struct linmatrix
+ * @brief Represents a dense matrix.
+ *
+ * The elements are stored contiguously in row-major order, element (i, j) lives
+ * at `data[i * cols + j]`. The matrix owns its elements and releases them in
+ * linmatrix_free, except for a linmatrix made by linmatrix_borrow, which sets
+ * `borrowed`: its buffer and elements stay the caller's and linmatrix_free
+ * leaves both alone.
+ */
+typedef struct linmatrix {
+    size_t rows;
+    size_t cols;
+    realnum* data;
+    bool borrowed;
+} linmatrix;
+
+/**
+ * @struct linmatrix_view
+ * @brief A strided window onto elements owned by a linmatrix.
+ *
+ * Element (i, j) of the view is `data[i * row_stride + j * col_stride]`, so a
+ * sub-block of a linmatrix keeps the row stride of its parent and a transpose
+ * is the same buffer with the strides swapped. Like linvector_view it never
+ * owns its elements and is only valid while the linmatrix it points into is.
+ */
+typedef struct linmatrix_view {
+    size_t rows;
+    size_t cols;
+    size_t row_stride;
+    size_t col_stride;
+    realnum* data;
+} linmatrix_view;
+
+/**
+ * Creates a new linmatrix with all elements set to 0.
+ *
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return The newly created linmatrix.
+ */
+linmatrix linmatrix_new(size_t rows, size_t cols);
+
+/**
+ * Creates a new n x n identity matrix.
+ *
+ * @param n The number of rows and columns.
+ * @return The newly created linmatrix.
+ */
+linmatrix linmatrix_identity(size_t n);
+
+/**
+ * Creates a new linmatrix that adopts a heap buffer of row-major elements without copying it.
+ *
+ * The linmatrix takes ownership of the buffer, which must come from malloc,
+ * and of its `rows * cols` elements: linmatrix_free releases both. To work on
+ * elements that stay the caller's, use linmatrix_borrow instead.
+ *
+ * @param data The row-major elements.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return The newly created linmatrix.
+ */
+linmatrix linmatrix_with_data(realnum* data, size_t rows, size_t cols);
+
+/**
+ * Creates a new linmatrix over row-major elements it does not own, without copying them.
+ *
+ * The elements can be read and written through the linmatrix, and it can be
+ * factorized in place, but linmatrix_free releases neither the buffer nor the
+ * elements. It is only valid while `data` is.
+ *
+ * @param data The row-major elements to borrow.
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return The newly created linmatrix.
+ */
+linmatrix linmatrix_borrow(realnum* data, size_t rows, size_t cols);
+
+/**
+ * Creates a new linmatrix whose rows are copies of the given linvectors.
+ *
+ * @param rows The array of row vectors, all of the same size.
+ * @param n The number of row vectors.
+ * @return The newly created linmatrix.
+ */
+linmatrix linmatrix_from_rows(linvector* rows, size_t n);
+
+/**
+ * Creates a new linmatrix that is a copy of the given linmatrix.
+ *
+ * @param mat The linmatrix to clone.
+ * @return The cloned linmatrix.
+ */
+linmatrix linmatrix_clone(linmatrix* mat);
+
+/**
+ * Frees the memory occupied by the given linmatrix.
+ *
+ * @param mat The linmatrix to free.
+ */
+void linmatrix_free(linmatrix* mat);
+
+/**
+ * Returns the element at the given row and column.
+ *
+ * The element stays owned by the matrix; use realnum_clone to keep it past the
+ * next change to it.
+ *
+ * @param mat The linmatrix.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The element at (row, col).
+ */
+realnum linmatrix_get(linmatrix* mat, size_t row, size_t col);
+
+/**
+ * Sets the element at the given row and column.
+ *
+ * The matrix takes ownership of the value and releases the one it replaces.
+ *
+ * @param mat The linmatrix.
+ * @param row The row index.
+ * @param col The column index.
+ * @param value The value to store.
+ */
+void linmatrix_set(linmatrix* mat, size_t row, size_t col, realnum value);
+
+/**
+ * Prints the elements of a matrix, one row per line.
+ *
+ * @param mat The linmatrix to be printed.
+ * @param precision The number of decimal places to print.
+ */
+void linmatrix_print(linmatrix* mat, uint16_t precision);
+
+/**
+ * Adds two linmatrices element-wise and returns the result.
+ *
+ * @param a The first linmatrix.
+ * @param b The second linmatrix.
+ * @return The result of the addition.
+ */
+linmatrix linmatrix_add(linmatrix* a, linmatrix* b);
+
+/**
+ * Subtracts the second linmatrix from the first element-wise and returns the result.
+ *
+ * @param a The first linmatrix.
+ * @param b The second linmatrix.
+ * @return The result of the subtraction.
+ */
+linmatrix linmatrix_sub(linmatrix* a, linmatrix* b);
+
+/**
+ * Multiplies each element of the linmatrix by the given scalar and returns the result.
+ *
+ * @param a The linmatrix.
+ * @param scalar The scalar value.
+ * @return The result of the multiplication.
+ */
+linmatrix linmatrix_scale(linmatrix* a, realnum scalar);
+
+/**
+ * Returns the transpose of the linmatrix.
+ *
+ * The copy is made one tile at a time instead of one column of writes per row.
+ *
+ * @param a The linmatrix.
+ * @return The transposed linmatrix.
+ */
+linmatrix linmatrix_transpose(linmatrix* a);
+
+/**
+ * Transposes the linmatrix in place.
+ *
+ * Square matrices swap their elements across the diagonal without allocating;
+ * other shapes are transposed into a new buffer that replaces the old one.
+ *
+ * @param a The linmatrix.
+ */
+void linmatrix_transpose_in_place(linmatrix* a);
+
+/**
+ * Calculates the matrix product a * b.
+ *
+ * The product is computed by a cache-blocked kernel: a and b are split in
+ * LINMATRIX_BLOCK_* tiles which are repacked into contiguous panels before
+ * being multiplied by a LINMATRIX_MICRO_MR x LINMATRIX_MICRO_NR micro-kernel.
+ * Products past LINMATRIX_PARALLEL_THRESHOLD run their row blocks on several
+ * threads when built with OpenMP.
+ *
+ * @param a The left linmatrix (m x k).
+ * @param b The right linmatrix (k x n).
+ * @return The product of the two linmatrices (m x n).
+ */
+linmatrix linmatrix_mul(linmatrix* a, linmatrix* b);
+
+/**
+ * Calculates the matrix-vector product a * vec.
+ *
+ * @param a The linmatrix (m x n).
+ * @param vec The linvector (n elements).
+ * @return The resulting linvector (m elements).
+ */
+linvector linmatrix_mul_vector(linmatrix* a, linvector* vec);
+
+/**
+ * Returns a view of a whole linmatrix.
+ *
+ * @param mat The linmatrix.
+ * @return The view.
+ */
+linmatrix_view linmatrix_view_of(linmatrix* mat);
+
+/**
+ * Returns a view of the rows x cols sub-block of a view starting at (row, col).
+ *
+ * @param view The view.
+ * @param row The first row of the block.
+ * @param col The first column of the block.
+ * @param rows The number of rows of the block.
+ * @param cols The number of columns of the block.
+ * @return The block, sharing the elements of `view`.
+ */
+linmatrix_view linmatrix_view_block(linmatrix_view* view, size_t row, size_t col, size_t rows, size_t cols);
+
+/**
+ * Returns a view of the transpose of a view, without copying it.
+ *
+ * @param view The view.
+ * @return The transposed view.
+ */
+linmatrix_view linmatrix_view_transpose(linmatrix_view* view);
+
+/**
+ * Returns a view of one row of a view.
+ *
+ * @param view The view.
+ * @param row The row index.
+ * @return The row, with one element per column.
+ */
+linvector_view linmatrix_view_row(linmatrix_view* view, size_t row);
+
+/**
+ * Returns a view of one column of a view.
+ *
+ * @param view The view.
+ * @param col The column index.
+ * @return The column, with one element per row.
+ */
+linvector_view linmatrix_view_col(linmatrix_view* view, size_t col);
+
+/**
+ * Returns the element at the given row and column of a view.
+ *
+ * @param view The view.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The element, still owned by the underlying linmatrix.
+ */
+realnum linmatrix_view_get(linmatrix_view* view, size_t row, size_t col);
+
+/**
+ * Copies the elements of a view into a new linmatrix.
+ *
+ * @param view The view.
+ * @return The newly created linmatrix.
+ */
+linmatrix linmatrix_view_to_matrix(linmatrix_view* view);
+
+/**
+ * Calculates the product of two views with the kernel of linmatrix_mul.
+ *
+ * The packing step reads the operands through their strides, so products of
+ * sub-blocks and transposes never copy them first.
+ *
+ * @param a The left view (m x k).
+ * @param b The right view (k x n).
+ * @return The product (m x n).
+ */
+linmatrix linmatrix_view_mul(linmatrix_view* a, linmatrix_view* b);
+
+/**
+ * Subtracts the product of two views from a third one in place, c -= a * b.
+ *
+ * This is the trailing update of the blocked factorizations, run by the
+ * kernel of linmatrix_mul without a temporary for the product. `c` must not
+ * share elements with `a` or `b`.
+ *
+ * @param c The view to update (m x n).
+ * @param a The left view (m x k).
+ * @param b The right view (k x n).
+ */
+void linmatrix_view_mul_sub(linmatrix_view* c, linmatrix_view* a, linmatrix_view* b);
+
+/**
+ * Calculates the product of a matrix view and a vector view.
+ *
+ * @param a The matrix view (m x n).
+ * @param vec The vector view (n elements).
+ * @return The resulting linvector (m elements).
+ */
+linvector linmatrix_view_mul_vector(linmatrix_view* a, linvector_view* vec);
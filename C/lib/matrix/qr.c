@@ -0,0 +1,330 @@
+#include"./qr.h"
+#include"../stats/stats.h"
+
+#define NB LINMATRIX_QR_BLOCK
+
+static realnum_aprox linmatrix_qr_sqrt(realnum_aprox value) {
+    realnum num = realnum_from_aprox(value);
+    return realnum_sqrt(&num).value.aprox;
+}
+
+/*
+ * Computes the reflection H_j that zeroes column j of the m x n row-major `a`
+ * below the diagonal, stores v_j and tau[j] in its place and applies H_j to
+ * the columns right of j up to the end of the panel.
+ */
+static void linmatrix_qr_reflect(realnum_aprox* a, size_t m, size_t n, size_t j, size_t end, realnum_aprox* tau) {
+    realnum_aprox alpha = a[j * n + j];
+    realnum_aprox tail = 0;
+    for (size_t i = j + 1; i < m; i++) {
+        realnum_aprox x = a[i * n + j];
+        tail += x * x;
+    }
+    if (tail == 0) {
+        // The column is already reduced, H_j is the identity.
+        *tau = 0;
+        return;
+    }
+    realnum_aprox norm = linmatrix_qr_sqrt(alpha * alpha + tail);
+    realnum_aprox beta = alpha >= 0 ? -norm : norm;
+    *tau = (beta - alpha) / beta;
+    realnum_aprox scale = 1 / (alpha - beta);
+    for (size_t i = j + 1; i < m; i++) {
+        a[i * n + j] *= scale;
+    }
+    a[j * n + j] = beta;
+    for (size_t c = j + 1; c < end; c++) {
+        realnum_aprox w = a[j * n + c];
+        for (size_t i = j + 1; i < m; i++) {
+            w += a[i * n + j] * a[i * n + c];
+        }
+        w *= *tau;
+        a[j * n + c] -= w;
+        for (size_t i = j + 1; i < m; i++) {
+            a[i * n + c] -= w * a[i * n + j];
+        }
+    }
+}
+
+/*
+ * Applies H_k to H_{k+nb-1} of the panel starting at column k to the columns
+ * right of it, as A2 -= V * (T^T * (V^T * A2)), where I - V * T * V^T is the
+ * product of the reflections. The three products run over whole rows of the
+ * approximated matrix, so they stream through memory like linmatrix_mul does.
+ */
+static void linmatrix_qr_update(realnum_aprox* a, size_t m, size_t n, const realnum_aprox* tau, size_t k, size_t nb) {
+    size_t rows = m - k;
+    size_t first = k + nb;
+    size_t width = n - first;
+
+    // V with its unit diagonal and the zeros above it spelled out.
+    realnum_aprox* v = malloc(rows * nb * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t c = 0; c < nb; c++) {
+            v[i * nb + c] = i < c ? 0 : i == c ? 1 : a[(k + i) * n + k + c];
+        }
+    }
+    // T is upper triangular, column i is -tau_i * T * (V^T * v_i) over the columns before i.
+    realnum_aprox* t = calloc(nb * nb, sizeof(realnum_aprox));
+    realnum_aprox* z = malloc(nb * sizeof(realnum_aprox));
+    for (size_t i = 0; i < nb; i++) {
+        for (size_t c = 0; c < i; c++) {
+            z[c] = 0;
+            for (size_t r = i; r < rows; r++) {
+                z[c] += v[r * nb + c] * v[r * nb + i];
+            }
+        }
+        for (size_t r = 0; r < i; r++) {
+            realnum_aprox sum = 0;
+            for (size_t c = r; c < i; c++) {
+                sum += t[r * nb + c] * z[c];
+            }
+            t[r * nb + i] = -tau[k + i] * sum;
+        }
+        t[i * nb + i] = tau[k + i];
+    }
+    free(z);
+
+    // W = V^T * A2, one row of W per column of V.
+    realnum_aprox* w = calloc(nb * width + 1, sizeof(realnum_aprox));
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (rows * nb * width >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t c = 0; c < nb; c++) {
+        realnum_aprox* wc = &w[c * width];
+        for (size_t i = c; i < rows; i++) {
+            realnum_aprox vic = v[i * nb + c];
+            const realnum_aprox* row = &a[(k + i) * n + first];
+            for (size_t j = 0; j < width; j++) {
+                wc[j] += vic * row[j];
+            }
+        }
+    }
+    // W = T^T * W, from the last row up since T^T is lower triangular.
+    for (size_t r = nb; r-- > 0;) {
+        realnum_aprox* wr = &w[r * width];
+        realnum_aprox diag = t[r * nb + r];
+        for (size_t j = 0; j < width; j++) {
+            wr[j] *= diag;
+        }
+        for (size_t c = 0; c < r; c++) {
+            realnum_aprox tcr = t[c * nb + r];
+            const realnum_aprox* wc = &w[c * width];
+            for (size_t j = 0; j < width; j++) {
+                wr[j] += tcr * wc[j];
+            }
+        }
+    }
+    // A2 -= V * W, one independent row at a time.
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (rows * nb * width >= LINMATRIX_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < rows; i++) {
+        realnum_aprox* row = &a[(k + i) * n + first];
+        size_t last = i + 1 < nb ? i + 1 : nb;
+        for (size_t c = 0; c < last; c++) {
+            realnum_aprox vic = v[i * nb + c];
+            const realnum_aprox* wc = &w[c * width];
+            for (size_t j = 0; j < width; j++) {
+                row[j] -= vic * wc[j];
+            }
+        }
+    }
+    free(v);
+    free(t);
+    free(w);
+}
+
+linmatrix_qr linmatrix_qr_in_place(linmatrix* a) {
+    size_t m = a->rows;
+    size_t n = a->cols;
+    size_t p = m < n ? m : n;
+    LINSTATS_KERNEL_BEGIN(qr);
+    linmatrix_qr qr;
+    qr.qr = *a;
+    qr.tau = malloc(p * sizeof(realnum_aprox) + 1);
+    a->data = NULL;
+    a->rows = 0;
+    a->cols = 0;
+
+    // The factorization runs on a plain array of approximations, which is
+    // written back into the elements once it is done.
+    realnum* data = qr.qr.data;
+    realnum_aprox* x = malloc(m * n * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < m * n; i++) {
+        x[i] = realnum_as_aprox(&data[i]).value.aprox;
+        realnum_free(&data[i]);
+    }
+    for (size_t k = 0; k < p; k += NB) {
+        size_t end = k + NB < p ? k + NB : p;
+        for (size_t j = k; j < end; j++) {
+            linmatrix_qr_reflect(x, m, n, j, end, &qr.tau[j]);
+        }
+        if (end < n) {
+            linmatrix_qr_update(x, m, n, qr.tau, k, end - k);
+        }
+    }
+    for (size_t i = 0; i < m * n; i++) {
+        data[i] = realnum_from_aprox(x[i]);
+    }
+    free(x);
+    LINSTATS_KERNEL_END(qr, LINSTATS_MATRIX_QR);
+    return qr;
+}
+
+linmatrix_qr linmatrix_qr_new(linmatrix* a) {
+    linmatrix copy = linmatrix_clone(a);
+    return linmatrix_qr_in_place(&copy);
+}
+
+void linmatrix_qr_free(linmatrix_qr* qr) {
+    linmatrix_free(&qr->qr);
+    free(qr->tau);
+    qr->tau = NULL;
+}
+
+/*
+ * Applies H_j to the m x width row-major block x, a whole row at a time,
+ * with `w` as scratch space of `width` elements.
+ */
+static void linmatrix_qr_apply(linmatrix_qr* qr, size_t j, realnum_aprox* x, size_t width, realnum_aprox* w) {
+    realnum_aprox tau = qr->tau[j];
+    if (tau == 0) {
+        return;
+    }
+    size_t m = qr->qr.rows;
+    size_t n = qr->qr.cols;
+    realnum* data = qr->qr.data;
+    for (size_t c = 0; c < width; c++) {
+        w[c] = x[j * width + c];
+    }
+    for (size_t i = j + 1; i < m; i++) {
+        realnum_aprox v = data[i * n + j].value.aprox;
+        for (size_t c = 0; c < width; c++) {
+            w[c] += v * x[i * width + c];
+        }
+    }
+    for (size_t c = 0; c < width; c++) {
+        w[c] *= tau;
+        x[j * width + c] -= w[c];
+    }
+    for (size_t i = j + 1; i < m; i++) {
+        realnum_aprox v = data[i * n + j].value.aprox;
+        for (size_t c = 0; c < width; c++) {
+            x[i * width + c] -= w[c] * v;
+        }
+    }
+}
+
+linmatrix linmatrix_qr_q(linmatrix_qr* qr) {
+    size_t m = qr->qr.rows;
+    size_t p = m < qr->qr.cols ? m : qr->qr.cols;
+    realnum_aprox* x = calloc(m * p + 1, sizeof(realnum_aprox));
+    realnum_aprox* w = malloc(p * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < p; i++) {
+        x[i * p + i] = 1;
+    }
+    // Q * I = H_0 * (H_1 * ... (H_{p-1} * I)).
+    for (size_t j = p; j-- > 0;) {
+        linmatrix_qr_apply(qr, j, x, p, w);
+    }
+    linmatrix q = linmatrix_new(m, p);
+    for (size_t i = 0; i < m * p; i++) {
+        q.data[i] = realnum_from_aprox(x[i]);
+    }
+    free(x);
+    free(w);
+    return q;
+}
+
+linmatrix linmatrix_qr_r(linmatrix_qr* qr) {
+    size_t n = qr->qr.cols;
+    size_t p = qr->qr.rows < n ? qr->qr.rows : n;
+    linmatrix r = linmatrix_new(p, n);
+    for (size_t i = 0; i < p; i++) {
+        for (size_t c = i; c < n; c++) {
+            r.data[i * n + c] = realnum_clone(&qr->qr.data[i * n + c]);
+        }
+    }
+    return r;
+}
+
+/*
+ * Replaces the m x width row-major block x by the least-squares solutions,
+ * left in its first n rows.
+ */
+static void linmatrix_qr_substitute(linmatrix_qr* qr, realnum_aprox* x, size_t width) {
+    size_t m = qr->qr.rows;
+    size_t n = qr->qr.cols;
+    if (m < n) {
+        fprintf(stderr, "Error: least squares needs at least as many rows as columns.\n");
+        exit(1);
+    }
+    realnum* data = qr->qr.data;
+    for (size_t i = 0; i < n; i++) {
+        if (data[i * n + i].value.aprox == 0) {
+            fprintf(stderr, "Error: the matrix does not have full column rank.\n");
+            exit(1);
+        }
+    }
+    realnum_aprox* w = malloc(width * sizeof(realnum_aprox) + 1);
+    for (size_t j = 0; j < n; j++) {
+        linmatrix_qr_apply(qr, j, x, width, w);
+    }
+    free(w);
+    for (size_t i = n; i-- > 0;) {
+        for (size_t k = i + 1; k < n; k++) {
+            realnum_aprox r = data[i * n + k].value.aprox;
+            for (size_t c = 0; c < width; c++) {
+                x[i * width + c] -= r * x[k * width + c];
+            }
+        }
+        realnum_aprox d = data[i * n + i].value.aprox;
+        for (size_t c = 0; c < width; c++) {
+            x[i * width + c] /= d;
+        }
+    }
+}
+
+linvector linmatrix_qr_solve(linmatrix_qr* qr, linvector* b) {
+    size_t m = qr->qr.rows;
+    size_t n = qr->qr.cols;
+    if (b->size != m) {
+        fprintf(stderr, "Error: the size of the vector must match the number of rows of the matrix.\n");
+        exit(1);
+    }
+    realnum_aprox* x = malloc(m * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < m; i++) {
+        x[i] = realnum_as_aprox(&b->data[i]).value.aprox;
+    }
+    linmatrix_qr_substitute(qr, x, 1);
+    linvector result = linvector_with_capacity(n ? n : 1);
+    for (size_t i = 0; i < n; i++) {
+        linvector_push(&result, realnum_from_aprox(x[i]));
+    }
+    free(x);
+    return result;
+}
+
+linmatrix linmatrix_qr_solve_matrix(linmatrix_qr* qr, linmatrix* b) {
+    size_t m = qr->qr.rows;
+    size_t n = qr->qr.cols;
+    if (b->rows != m) {
+        fprintf(stderr, "Error: the number of rows of the right-hand side must match the number of rows of the matrix.\n");
+        exit(1);
+    }
+    size_t width = b->cols;
+    realnum_aprox* x = malloc(m * width * sizeof(realnum_aprox) + 1);
+    for (size_t i = 0; i < m * width; i++) {
+        x[i] = realnum_as_aprox(&b->data[i]).value.aprox;
+    }
+    linmatrix_qr_substitute(qr, x, width);
+    linmatrix result = linmatrix_new(n, width);
+    for (size_t i = 0; i < n * width; i++) {
+        result.data[i] = realnum_from_aprox(x[i]);
+    }
+    free(x);
+    return result;
+}
+
+#undef NB
@@ -0,0 +1,103 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"./matrix.h"
+
+/*
+ * The number of columns factored per panel. Each panel is reduced with
+ * Householder reflections in place and then applied to the columns right of
+ * it at once, as three products over rows of plain approximations.
+ */
+#ifndef LINMATRIX_QR_BLOCK
+#define LINMATRIX_QR_BLOCK 32
+#endif
+
+/**
+ * @struct linmatrix_qr
+ * @brief Represents the Householder QR factorization A = Q * R of an m x n matrix.
+ *
+ * Q is the product H_0 * H_1 * ... of min(m, n) reflections
+ * H_k = I - tau[k] * v_k * v_k^T. R is stored on and above the diagonal of
+ * `qr` and each v_k below it, with its leading 1 left implicit. Every element
+ * is an approximation.
+ *
+ * The factorization is computed once in O(m * n^2) and can then be reused for
+ * any number of least-squares solves.
+ */
+typedef struct linmatrix_qr {
+    linmatrix qr;
+    realnum_aprox* tau;
+} linmatrix_qr;
+
+/**
+ * Computes the Householder QR factorization of a matrix.
+ *
+ * The columns are reduced in panels of LINMATRIX_QR_BLOCK, whose reflections
+ * are accumulated in the compact WY form I - V * T * V^T so the rest of the
+ * matrix is updated by matrix products.
+ *
+ * @param a The matrix to factor, left untouched.
+ * @return The factorization.
+ */
+linmatrix_qr linmatrix_qr_new(linmatrix* a);
+
+/**
+ * Computes the Householder QR factorization of a matrix in place.
+ *
+ * The factorization takes over the storage of `a`, which is left empty.
+ *
+ * @param a The matrix to factor.
+ * @return The factorization.
+ */
+linmatrix_qr linmatrix_qr_in_place(linmatrix* a);
+
+/**
+ * Frees the memory occupied by the given factorization.
+ *
+ * @param qr The factorization to free.
+ */
+void linmatrix_qr_free(linmatrix_qr* qr);
+
+/**
+ * Forms the first min(m, n) columns of Q.
+ *
+ * They are an orthonormal basis of the column space of a matrix of full
+ * column rank, so this is also how a set of vectors is orthonormalized.
+ *
+ * @param qr The factorization.
+ * @return The m x min(m, n) matrix with orthonormal columns.
+ */
+linmatrix linmatrix_qr_q(linmatrix_qr* qr);
+
+/**
+ * Copies the upper triangular factor.
+ *
+ * @param qr The factorization.
+ * @return The min(m, n) x n matrix R.
+ */
+linmatrix linmatrix_qr_r(linmatrix_qr* qr);
+
+/**
+ * Solves the least-squares problem of minimizing |A * x - b|.
+ *
+ * A must have at least as many rows as columns and full column rank; for a
+ * square A this is the solution of A * x = b.
+ *
+ * @param qr The factorization of A.
+ * @param b The right-hand side, with one element per row of A.
+ * @return The solution, with one element per column of A.
+ */
+linvector linmatrix_qr_solve(linmatrix_qr* qr, linvector* b);
+
+/**
+ * Solves the least-squares problem of every column of B at once.
+ *
+ * @param qr The factorization of A.
+ * @param b The right-hand sides, one per column.
+ * @return The solutions, one per column.
+ */
+linmatrix linmatrix_qr_solve_matrix(linmatrix_qr* qr, linmatrix* b);
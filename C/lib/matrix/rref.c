@@ -0,0 +1,225 @@
+#include"./rref.h"
+
+static realnum_aprox linmatrix_rref_magnitude(realnum* num) {
+    realnum_aprox value = realnum_as_aprox(num).value.aprox;
+    return value < 0 ? -value : value;
+}
+
+static bool linmatrix_rref_is_zero(realnum* num, realnum_aprox tolerance) {
+    switch (num->kind) {
+        case REALNUM_FRAC: return num->value.frac.num == 0;
+        case REALNUM_APROX: return (num->value.aprox < 0 ? -num->value.aprox : num->value.aprox) <= tolerance;
+        default: return linmatrix_rref_magnitude(num) == 0;
+    }
+}
+
+/*
+ * Replaces *dst by the exact integer value, releasing the old one.
+ */
+static void linmatrix_rref_set(realnum* dst, int64_t value) {
+    realnum_free(dst);
+    *dst = realnum_from_frac(value, 1);
+}
+
+/*
+ * Replaces *dst by *dst - factor * src, releasing the intermediate values.
+ */
+static void linmatrix_rref_eliminate(realnum* dst, realnum* factor, realnum* src) {
+    realnum product = realnum_mul(factor, src);
+    realnum diff = realnum_sub(dst, &product);
+    realnum_free(&product);
+    realnum_free(dst);
+    *dst = diff;
+}
+
+linmatrix_rref linmatrix_rref_in_place(linmatrix* a) {
+    size_t m = a->rows;
+    size_t n = a->cols;
+    linmatrix_rref rref;
+    rref.rref = *a;
+    size_t pivots = m < n ? m : n;
+    rref.pivots = malloc((pivots ? pivots : 1) * sizeof(size_t));
+    rref.rank = 0;
+    a->data = NULL;
+    a->rows = 0;
+    a->cols = 0;
+
+    realnum* data = rref.rref.data;
+    realnum_aprox scale = 0;
+    for (size_t i = 0; i < m * n; i++) {
+        realnum_aprox abs = linmatrix_rref_magnitude(&data[i]);
+        scale = abs > scale ? abs : scale;
+    }
+    realnum_aprox tolerance = (realnum_aprox)LINMATRIX_RREF_TOLERANCE * scale * (realnum_aprox)(m > n ? m : n);
+
+    size_t r = 0;
+    for (size_t c = 0; c < n && r < m; c++) {
+        size_t pivot_row = r;
+        realnum_aprox pivot_abs = linmatrix_rref_magnitude(&data[r * n + c]);
+        for (size_t i = r + 1; i < m; i++) {
+            realnum_aprox abs = linmatrix_rref_magnitude(&data[i * n + c]);
+            if (abs > pivot_abs) {
+                pivot_row = i;
+                pivot_abs = abs;
+            }
+        }
+        if (linmatrix_rref_is_zero(&data[pivot_row * n + c], tolerance)) {
+            // Round-off left in a column without a pivot is cleared so the rows below the rank end up zero.
+            for (size_t i = r; i < m; i++) {
+                linmatrix_rref_set(&data[i * n + c], 0);
+            }
+            continue;
+        }
+        if (pivot_row != r) {
+            // The rows not pivoted yet are zero left of column c.
+            for (size_t j = c; j < n; j++) {
+                realnum temp = data[r * n + j];
+                data[r * n + j] = data[pivot_row * n + j];
+                data[pivot_row * n + j] = temp;
+            }
+        }
+
+        realnum* pivot = &data[r * n];
+        for (size_t j = c + 1; j < n; j++) {
+            realnum quot = realnum_div(&pivot[j], &pivot[c]);
+            realnum_free(&pivot[j]);
+            pivot[j] = quot;
+        }
+        linmatrix_rref_set(&pivot[c], 1);
+        for (size_t i = 0; i < m; i++) {
+            realnum* row = &data[i * n];
+            if (i == r) {
+                continue;
+            }
+            if (!linmatrix_rref_is_zero(&row[c], tolerance)) {
+                for (size_t j = c + 1; j < n; j++) {
+                    linmatrix_rref_eliminate(&row[j], &row[c], &pivot[j]);
+                }
+            }
+            linmatrix_rref_set(&row[c], 0);
+        }
+        rref.pivots[r++] = c;
+    }
+    // Fractions are only reduced once they grow, reduce the result in one pass.
+    for (size_t i = 0; i < m * n; i++) {
+        if (data[i].kind == REALNUM_FRAC) {
+            data[i] = realnum_fracsimp(&data[i]);
+        }
+    }
+    rref.rank = r;
+    return rref;
+}
+
+linmatrix_rref linmatrix_rref_new(linmatrix* a) {
+    linmatrix copy = linmatrix_clone(a);
+    return linmatrix_rref_in_place(&copy);
+}
+
+void linmatrix_rref_free(linmatrix_rref* rref) {
+    linmatrix_free(&rref->rref);
+    free(rref->pivots);
+    rref->pivots = NULL;
+    rref->rank = 0;
+}
+
+linmatrix linmatrix_rref_null_space(linmatrix_rref* rref) {
+    size_t n = rref->rref.cols;
+    size_t nullity = n - rref->rank;
+    linmatrix basis = linmatrix_new(n, nullity);
+    size_t k = 0;
+    size_t q = 0;
+    for (size_t j = 0; j < n; j++) {
+        if (k < rref->rank && rref->pivots[k] == j) {
+            k++;
+            continue;
+        }
+        // The solution with free variable j set to 1 and the other free variables to 0.
+        linmatrix_rref_set(&basis.data[j * nullity + q], 1);
+        for (size_t p = 0; p < rref->rank; p++) {
+            realnum_free(&basis.data[rref->pivots[p] * nullity + q]);
+            basis.data[rref->pivots[p] * nullity + q] = realnum_neg(&rref->rref.data[p * n + j]);
+        }
+        q++;
+    }
+    return basis;
+}
+
+size_t linmatrix_rank(linmatrix* a) {
+    linmatrix_rref rref = linmatrix_rref_new(a);
+    size_t rank = rref.rank;
+    linmatrix_rref_free(&rref);
+    return rank;
+}
+
+linmatrix linmatrix_null_space(linmatrix* a) {
+    linmatrix_rref rref = linmatrix_rref_new(a);
+    linmatrix basis = linmatrix_rref_null_space(&rref);
+    linmatrix_rref_free(&rref);
+    return basis;
+}
+
+linmatrix linmatrix_column_space(linmatrix* a) {
+    linmatrix_rref rref = linmatrix_rref_new(a);
+    linmatrix basis = linmatrix_new(a->rows, rref.rank);
+    for (size_t i = 0; i < a->rows; i++) {
+        for (size_t k = 0; k < rref.rank; k++) {
+            realnum_free(&basis.data[i * rref.rank + k]);
+            basis.data[i * rref.rank + k] = realnum_clone(&a->data[i * a->cols + rref.pivots[k]]);
+        }
+    }
+    linmatrix_rref_free(&rref);
+    return basis;
+}
+
+bool linvector_independent(linvector* vecs, size_t n) {
+    if (n == 0) {
+        return true;
+    }
+    if (n > vecs[0].size) {
+        // More vectors than dimensions, checked before building anything.
+        for (size_t i = 1; i < n; i++) {
+            if (vecs[i].size != vecs[0].size) {
+                fprintf(stderr, "Error: all vectors must have the same size.\n");
+                exit(1);
+            }
+        }
+        return false;
+    }
+    // One vector per row, so the rank counts the independent vectors.
+    linmatrix rows = linmatrix_from_rows(vecs, n);
+    linmatrix_rref rref = linmatrix_rref_in_place(&rows);
+    bool independent = rref.rank == n;
+    linmatrix_rref_free(&rref);
+    return independent;
+}
+
+bool linvector_combination(linvector* vecs, size_t n, linvector* target, linvector* coefficients) {
+    size_t size = target->size;
+    for (size_t k = 0; k < n; k++) {
+        if (vecs[k].size != size) {
+            fprintf(stderr, "Error: all vectors must have the size of the target.\n");
+            exit(1);
+        }
+    }
+    // The augmented matrix [v_0 ... v_{n-1} | target], one vector per column.
+    linmatrix augmented = linmatrix_new(size, n + 1);
+    for (size_t i = 0; i < size; i++) {
+        for (size_t k = 0; k < n; k++) {
+            augmented.data[i * (n + 1) + k] = realnum_clone(&vecs[k].data[i]);
+        }
+        augmented.data[i * (n + 1) + n] = realnum_clone(&target->data[i]);
+    }
+    linmatrix_rref rref = linmatrix_rref_in_place(&augmented);
+    bool in_span = rref.rank == 0 || rref.pivots[rref.rank - 1] != n;
+    if (in_span) {
+        *coefficients = linvector_with_capacity(n ? n : 1);
+        for (size_t k = 0; k < n; k++) {
+            linvector_push(coefficients, realnum_from_frac(0, 1));
+        }
+        for (size_t p = 0; p < rref.rank; p++) {
+            coefficients->data[rref.pivots[p]] = realnum_clone(&rref.rref.data[p * (n + 1) + n]);
+        }
+    }
+    linmatrix_rref_free(&rref);
+    return in_span;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"./matrix.h"
+
+/*
+ * The relative magnitude under which an approximated entry counts as zero
+ * during elimination. It is scaled by the largest magnitude in the matrix and
+ * by its larger dimension; exact entries are only zero when they are.
+ */
+#ifndef LINMATRIX_RREF_TOLERANCE
+#if REALNUM_APROX_PRECISION == 32
+#define LINMATRIX_RREF_TOLERANCE 1e-5
+#elif REALNUM_APROX_PRECISION == 64
+#define LINMATRIX_RREF_TOLERANCE 1e-12
+#elif REALNUM_APROX_PRECISION == 80
+#define LINMATRIX_RREF_TOLERANCE 1e-15
+#else
+#define LINMATRIX_RREF_TOLERANCE 1e-28
+#endif
+#endif
+
+/**
+ * @struct linmatrix_rref
+ * @brief Represents the reduced row echelon form of a matrix.
+ *
+ * Row k of `rref` has its leading 1 in column `pivots[k]` for every k below
+ * `rank`, and every row from `rank` on is zero. The pivot columns of the
+ * original matrix are a basis of its column space and the non-pivot columns
+ * give a basis of its null space.
+ */
+typedef struct linmatrix_rref {
+    linmatrix rref;
+    size_t* pivots;
+    size_t rank;
+} linmatrix_rref;
+
+/**
+ * Computes the reduced row echelon form of a matrix by Gauss-Jordan elimination.
+ *
+ * Each column is pivoted on the entry of largest magnitude among the rows not
+ * pivoted yet, and eliminated from every other row, in O(rows * cols * rank).
+ * Exact elements are eliminated exactly; approximated ones under
+ * LINMATRIX_RREF_TOLERANCE are taken as zero.
+ *
+ * @param a The matrix to reduce, left untouched.
+ * @return The reduced form.
+ */
+linmatrix_rref linmatrix_rref_new(linmatrix* a);
+
+/**
+ * Computes the reduced row echelon form of a matrix in place.
+ *
+ * The reduced form takes over the storage of `a`, which is left empty.
+ *
+ * @param a The matrix to reduce.
+ * @return The reduced form.
+ */
+linmatrix_rref linmatrix_rref_in_place(linmatrix* a);
+
+/**
+ * Frees the memory occupied by the given reduced form.
+ *
+ * @param rref The reduced form to free.
+ */
+void linmatrix_rref_free(linmatrix_rref* rref);
+
+/**
+ * Calculates a basis of the null space from a reduced form.
+ *
+ * @param rref The reduced form of A.
+ * @return A cols x (cols - rank) matrix whose columns are a basis of the solutions of A * x = 0.
+ */
+linmatrix linmatrix_rref_null_space(linmatrix_rref* rref);
+
+/**
+ * Calculates the rank of a matrix.
+ *
+ * @param a The matrix.
+ * @return The number of linearly independent rows, and columns.
+ */
+size_t linmatrix_rank(linmatrix* a);
+
+/**
+ * Calculates a basis of the null space of a matrix.
+ *
+ * @param a The matrix.
+ * @return A cols x (cols - rank) matrix whose columns are a basis of the solutions of A * x = 0.
+ */
+linmatrix linmatrix_null_space(linmatrix* a);
+
+/**
+ * Calculates a basis of the column space of a matrix.
+ *
+ * @param a The matrix.
+ * @return A rows x rank matrix holding copies of the pivot columns of `a`.
+ */
+linmatrix linmatrix_column_space(linmatrix* a);
+
+/**
+ * Checks whether vectors are linearly independent with a single elimination.
+ *
+ * @param vecs The vectors, all of the same size.
+ * @param n The number of vectors.
+ * @return Whether no vector is a linear combination of the others.
+ */
+bool linvector_independent(linvector* vecs, size_t n);
+
+/**
+ * Finds coefficients c such that the sum of c[i] * vecs[i] is `target`.
+ *
+ * When the vectors are dependent the coefficients of the vectors that are not
+ * needed are set to zero.
+ *
+ * @param vecs The vectors, all of the size of `target`.
+ * @param n The number of vectors.
+ * @param target The vector to express.
+ * @param coefficients Set to a new vector of the n coefficients when `target` is in the span.
+ * @return Whether `target` is in the span of the vectors.
+ */
+bool linvector_combination(linvector* vecs, size_t n, linvector* target, linvector* coefficients);
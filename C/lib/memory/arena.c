@@ -0,0 +1,102 @@
+#include"./arena.h"
+#include"../stats/stats.h"
+#include<string.h>
+#include<stdio.h>
+
+#define ALIGNMENT (sizeof(max_align_t))
+
+static size_t linarena_align(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+static linarena_block* linarena_block_new(size_t size) {
+    linarena_block* block = malloc(sizeof(linarena_block) + size);
+    if (block == NULL) {
+        fprintf(stderr, "Error: could not allocate an arena block of %zu bytes.\n", size);
+        exit(1);
+    }
+    LINSTATS_ALLOC(LINSTATS_ARENA_BLOCK, sizeof(linarena_block) + size);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+linarena linarena_new(size_t block_size) {
+    linarena arena;
+    arena.head = NULL;
+    arena.current = NULL;
+    arena.block_size = block_size ? linarena_align(block_size) : LINARENA_DEFAULT_BLOCK_SIZE;
+    arena.last = NULL;
+    return arena;
+}
+
+void* linarena_alloc(linarena* arena, size_t size) {
+    size = linarena_align(size ? size : 1);
+    linarena_block* block = arena->current;
+    // Move on to the next block kept by a previous reset, or chain a new one.
+    while (block == NULL || block->size - block->used < size) {
+        if (block != NULL && block->next != NULL) {
+            block = block->next;
+            block->used = 0;
+            continue;
+        }
+        linarena_block* fresh = linarena_block_new(size > arena->block_size ? size : arena->block_size);
+        if (block == NULL) {
+            fresh->next = arena->head;
+            arena->head = fresh;
+        } else {
+            block->next = fresh;
+        }
+        block = fresh;
+    }
+    arena->current = block;
+    void* ptr = (unsigned char*)block->data + block->used;
+    block->used += size;
+    arena->last = ptr;
+    LINSTATS_ALLOC(LINSTATS_ARENA_ALLOC, size);
+    return ptr;
+}
+
+void* linarena_realloc(linarena* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) {
+        return linarena_alloc(arena, new_size);
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+    linarena_block* block = arena->current;
+    if (ptr == arena->last) {
+        size_t offset = (size_t)((unsigned char*)ptr - (unsigned char*)block->data);
+        size_t needed = linarena_align(new_size);
+        if (offset + needed <= block->size) {
+            block->used = offset + needed;
+            return ptr;
+        }
+    }
+    void* fresh = linarena_alloc(arena, new_size);
+    memcpy(fresh, ptr, old_size);
+    return fresh;
+}
+
+void linarena_reset(linarena* arena) {
+    if (arena->head != NULL) {
+        arena->head->used = 0;
+    }
+    arena->current = arena->head;
+    arena->last = NULL;
+}
+
+void linarena_free(linarena* arena) {
+    linarena_block* block = arena->head;
+    while (block != NULL) {
+        linarena_block* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->last = NULL;
+}
+
+#undef ALIGNMENT
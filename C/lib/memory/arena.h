@@ -0,0 +1,79 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+
+#define LINARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+/**
+ * @struct linarena_block
+ * @brief A chunk of memory owned by a linarena.
+ */
+typedef struct linarena_block {
+    struct linarena_block* next;
+    size_t size; /**< The number of usable bytes in `data`. */
+    size_t used; /**< The number of bytes handed out so far. */
+    max_align_t data[]; /**< The memory handed out by the arena. */
+} linarena_block;
+
+/**
+ * @struct linarena
+ * @brief A bump allocator for short-lived objects.
+ *
+ * Allocations are carved sequentially out of large blocks and are never freed
+ * one by one: linarena_reset releases all of them at once and keeps the blocks
+ * for reuse, so a request or frame loop reaches a steady state without calling
+ * malloc. An arena is not thread-safe; use one arena per thread.
+ */
+typedef struct linarena {
+    linarena_block* head; /**< The first block of the chain. */
+    linarena_block* current; /**< The block allocations are currently carved from. */
+    size_t block_size; /**< The minimum size of a new block. */
+    void* last; /**< The most recent allocation, which can grow in place. */
+} linarena;
+
+/**
+ * Creates a new empty linarena.
+ *
+ * @param block_size The minimum size of the blocks requested from malloc, 0 for LINARENA_DEFAULT_BLOCK_SIZE.
+ * @return The newly created linarena.
+ */
+linarena linarena_new(size_t block_size);
+
+/**
+ * Allocates memory from the arena, aligned for any type.
+ *
+ * @param arena The linarena to allocate from.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the allocated memory.
+ */
+void* linarena_alloc(linarena* arena, size_t size);
+
+/**
+ * Resizes an allocation made from the arena.
+ *
+ * The most recent allocation grows in place when its block has room, anything
+ * else is copied to a new allocation.
+ *
+ * @param arena The linarena the allocation comes from.
+ * @param ptr The allocation to resize, or NULL.
+ * @param old_size The current size of the allocation.
+ * @param new_size The requested size.
+ * @return A pointer to the resized allocation.
+ */
+void* linarena_realloc(linarena* arena, void* ptr, size_t old_size, size_t new_size);
+
+/**
+ * Releases every allocation of the arena at once, keeping its blocks for reuse.
+ *
+ * @param arena The linarena to reset.
+ */
+void linarena_reset(linarena* arena);
+
+/**
+ * Frees every block owned by the arena.
+ *
+ * @param arena The linarena to free.
+ */
+void linarena_free(linarena* arena);
@@ -0,0 +1,394 @@
+#include"./bigint.h"
+#include<string.h>
+
+#define LIMB_BITS 32
+#define LIMB_BASE (UINT64_C(1) << LIMB_BITS)
+
+static linbigint linbigint_with_capacity(size_t capacity) {
+    linbigint a;
+    a.negative = false;
+    a.size = 0;
+    a.capacity = capacity;
+    a.limbs = capacity ? malloc(capacity * sizeof(uint32_t)) : NULL;
+    if (capacity && a.limbs == NULL) {
+        fprintf(stderr, "Error: could not allocate a bigint of %zu limbs.\n", capacity);
+        exit(1);
+    }
+    return a;
+}
+
+/*
+ * Drops leading zero limbs and clears the sign of zero.
+ */
+static void linbigint_trim(linbigint* a) {
+    while (a->size > 0 && a->limbs[a->size - 1] == 0) {
+        a->size--;
+    }
+    if (a->size == 0) {
+        a->negative = false;
+    }
+}
+
+static int linbigint_cmp_abs(const linbigint* a, const linbigint* b) {
+    if (a->size != b->size) {
+        return a->size < b->size ? -1 : 1;
+    }
+    for (size_t i = a->size; i-- > 0;) {
+        if (a->limbs[i] != b->limbs[i]) {
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static linbigint linbigint_add_abs(const linbigint* a, const linbigint* b) {
+    if (a->size < b->size) {
+        const linbigint* t = a;
+        a = b;
+        b = t;
+    }
+    linbigint r = linbigint_with_capacity(a->size + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a->size; i++) {
+        uint64_t sum = (uint64_t)a->limbs[i] + (i < b->size ? b->limbs[i] : 0) + carry;
+        r.limbs[i] = (uint32_t)sum;
+        carry = sum >> LIMB_BITS;
+    }
+    r.limbs[a->size] = (uint32_t)carry;
+    r.size = a->size + 1;
+    linbigint_trim(&r);
+    return r;
+}
+
+/*
+ * Computes |a| - |b|, which requires |a| >= |b|.
+ */
+static linbigint linbigint_sub_abs(const linbigint* a, const linbigint* b) {
+    linbigint r = linbigint_with_capacity(a->size);
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a->size; i++) {
+        int64_t diff = (int64_t)a->limbs[i] - (i < b->size ? b->limbs[i] : 0) - borrow;
+        borrow = diff < 0;
+        r.limbs[i] = (uint32_t)(diff + (borrow ? (int64_t)LIMB_BASE : 0));
+    }
+    r.size = a->size;
+    linbigint_trim(&r);
+    return r;
+}
+
+/*
+ * Divides the magnitude of `u` (m limbs) by a single limb in place and returns
+ * the remainder.
+ */
+static uint32_t linbigint_divmod_limb(uint32_t* u, size_t m, uint32_t v) {
+    uint64_t rem = 0;
+    for (size_t i = m; i-- > 0;) {
+        uint64_t cur = (rem << LIMB_BITS) | u[i];
+        u[i] = (uint32_t)(cur / v);
+        rem = cur % v;
+    }
+    return (uint32_t)rem;
+}
+
+/*
+ * Knuth's algorithm D. Divides u (m limbs) by v (n limbs, n >= 2, m >= n, top
+ * limb non-zero), storing m - n + 1 quotient limbs in q and n remainder limbs
+ * in r.
+ */
+static void linbigint_divmod_knuth(const uint32_t* u, size_t m, const uint32_t* v, size_t n, uint32_t* q, uint32_t* r) {
+    int s = __builtin_clz(v[n - 1]);
+    uint32_t* vn = malloc(n * sizeof(uint32_t));
+    uint32_t* un = malloc((m + 1) * sizeof(uint32_t));
+
+    // Normalize so the top limb of the divisor has its high bit set.
+    for (size_t i = n - 1; i > 0; i--) {
+        vn[i] = (v[i] << s) | (s ? v[i - 1] >> (LIMB_BITS - s) : 0);
+    }
+    vn[0] = v[0] << s;
+    un[m] = s ? u[m - 1] >> (LIMB_BITS - s) : 0;
+    for (size_t i = m - 1; i > 0; i--) {
+        un[i] = (u[i] << s) | (s ? u[i - 1] >> (LIMB_BITS - s) : 0);
+    }
+    un[0] = u[0] << s;
+
+    for (size_t j = m - n + 1; j-- > 0;) {
+        // Estimate the quotient limb from the top two limbs, then correct it.
+        uint64_t top = ((uint64_t)un[j + n] << LIMB_BITS) | un[j + n - 1];
+        uint64_t qhat = top / vn[n - 1];
+        uint64_t rhat = top % vn[n - 1];
+        while (qhat >= LIMB_BASE || qhat * vn[n - 2] > ((rhat << LIMB_BITS) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= LIMB_BASE) {
+                break;
+            }
+        }
+
+        // Multiply and subtract.
+        int64_t borrow = 0;
+        int64_t t;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t p = qhat * vn[i];
+            t = (int64_t)un[i + j] - borrow - (int64_t)(p & 0xFFFFFFFF);
+            un[i + j] = (uint32_t)t;
+            borrow = (int64_t)(p >> LIMB_BITS) - (t >> LIMB_BITS);
+        }
+        t = (int64_t)un[j + n] - borrow;
+        un[j + n] = (uint32_t)t;
+
+        // The estimate was one too large, add the divisor back.
+        q[j] = (uint32_t)qhat;
+        if (t < 0) {
+            q[j]--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = (uint64_t)un[i + j] + vn[i] + carry;
+                un[i + j] = (uint32_t)sum;
+                carry = sum >> LIMB_BITS;
+            }
+            un[j + n] += (uint32_t)carry;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        r[i] = (un[i] >> s) | (s ? un[i + 1] << (LIMB_BITS - s) : 0);
+    }
+    free(vn);
+    free(un);
+}
+
+linbigint linbigint_new(void) {
+    return linbigint_with_capacity(0);
+}
+
+linbigint linbigint_from_i128(__int128 value) {
+    linbigint a = linbigint_with_capacity(4);
+    unsigned __int128 mag = value < 0 ? -(unsigned __int128)value : (unsigned __int128)value;
+    for (size_t i = 0; i < 4; i++) {
+        a.limbs[i] = (uint32_t)mag;
+        mag >>= LIMB_BITS;
+    }
+    a.size = 4;
+    a.negative = value < 0;
+    linbigint_trim(&a);
+    return a;
+}
+
+linbigint linbigint_parse(const char* digits, size_t length) {
+    // Every chunk of 9 digits adds less than 30 bits, so at most one limb.
+    linbigint a = linbigint_with_capacity(length / 9 + 2);
+    a.size = 0;
+    size_t i = 0;
+    while (i < length) {
+        // Fold in up to 9 digits at once: a = a * 10^k + chunk.
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (size_t k = 0; k < 9 && i < length; k++, i++) {
+            chunk = chunk * 10 + (uint32_t)(digits[i] - '0');
+            scale *= 10;
+        }
+        uint64_t carry = chunk;
+        for (size_t j = 0; j < a.size; j++) {
+            uint64_t cur = (uint64_t)a.limbs[j] * scale + carry;
+            a.limbs[j] = (uint32_t)cur;
+            carry = cur >> LIMB_BITS;
+        }
+        if (carry != 0) {
+            a.limbs[a.size++] = (uint32_t)carry;
+        }
+    }
+    return a;
+}
+
+linbigint linbigint_clone(const linbigint* a) {
+    linbigint clone = linbigint_with_capacity(a->size);
+    if (a->size) {
+        memcpy(clone.limbs, a->limbs, a->size * sizeof(uint32_t));
+    }
+    clone.size = a->size;
+    clone.negative = a->negative;
+    return clone;
+}
+
+void linbigint_free(linbigint* a) {
+    free(a->limbs);
+    a->limbs = NULL;
+    a->size = 0;
+    a->capacity = 0;
+    a->negative = false;
+}
+
+bool linbigint_is_zero(const linbigint* a) {
+    return a->size == 0;
+}
+
+int linbigint_cmp(const linbigint* a, const linbigint* b) {
+    if (a->negative != b->negative) {
+        return a->negative ? -1 : 1;
+    }
+    int cmp = linbigint_cmp_abs(a, b);
+    return a->negative ? -cmp : cmp;
+}
+
+linbigint linbigint_add(const linbigint* a, const linbigint* b) {
+    linbigint r;
+    if (a->negative == b->negative) {
+        r = linbigint_add_abs(a, b);
+        r.negative = a->negative;
+    } else if (linbigint_cmp_abs(a, b) >= 0) {
+        r = linbigint_sub_abs(a, b);
+        r.negative = a->negative;
+    } else {
+        r = linbigint_sub_abs(b, a);
+        r.negative = b->negative;
+    }
+    linbigint_trim(&r);
+    return r;
+}
+
+linbigint linbigint_sub(const linbigint* a, const linbigint* b) {
+    linbigint neg = *b;
+    neg.negative = !b->negative && b->size != 0;
+    return linbigint_add(a, &neg);
+}
+
+linbigint linbigint_mul(const linbigint* a, const linbigint* b) {
+    if (a->size == 0 || b->size == 0) {
+        return linbigint_new();
+    }
+    linbigint r = linbigint_with_capacity(a->size + b->size);
+    memset(r.limbs, 0, (a->size + b->size) * sizeof(uint32_t));
+    for (size_t i = 0; i < a->size; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b->size; j++) {
+            uint64_t cur = (uint64_t)a->limbs[i] * b->limbs[j] + r.limbs[i + j] + carry;
+            r.limbs[i + j] = (uint32_t)cur;
+            carry = cur >> LIMB_BITS;
+        }
+        r.limbs[i + b->size] = (uint32_t)carry;
+    }
+    r.size = a->size + b->size;
+    r.negative = a->negative != b->negative;
+    linbigint_trim(&r);
+    return r;
+}
+
+void linbigint_divmod(const linbigint* a, const linbigint* b, linbigint* quot, linbigint* rem) {
+    if (b->size == 0) {
+        fprintf(stderr, "Error: bigint division by zero.\n");
+        exit(1);
+    }
+    linbigint q;
+    linbigint r;
+    if (linbigint_cmp_abs(a, b) < 0) {
+        q = linbigint_new();
+        r = linbigint_clone(a);
+    } else if (b->size == 1) {
+        q = linbigint_clone(a);
+        uint32_t limb = linbigint_divmod_limb(q.limbs, q.size, b->limbs[0]);
+        r = linbigint_from_i128(limb);
+    } else {
+        q = linbigint_with_capacity(a->size - b->size + 1);
+        r = linbigint_with_capacity(b->size);
+        linbigint_divmod_knuth(a->limbs, a->size, b->limbs, b->size, q.limbs, r.limbs);
+        q.size = a->size - b->size + 1;
+        r.size = b->size;
+    }
+    q.negative = a->negative != b->negative;
+    r.negative = a->negative;
+    linbigint_trim(&q);
+    linbigint_trim(&r);
+    if (quot != NULL) {
+        *quot = q;
+    } else {
+        linbigint_free(&q);
+    }
+    if (rem != NULL) {
+        *rem = r;
+    } else {
+        linbigint_free(&r);
+    }
+}
+
+linbigint linbigint_gcd(const linbigint* a, const linbigint* b) {
+    linbigint x = linbigint_clone(a);
+    linbigint y = linbigint_clone(b);
+    x.negative = false;
+    y.negative = false;
+    while (y.size != 0) {
+        linbigint r;
+        linbigint_divmod(&x, &y, NULL, &r);
+        linbigint_free(&x);
+        x = y;
+        y = r;
+    }
+    linbigint_free(&y);
+    return x;
+}
+
+bool linbigint_to_i64(const linbigint* a, int64_t* out) {
+    if (a->size > 2) {
+        return false;
+    }
+    uint64_t mag = 0;
+    for (size_t i = a->size; i-- > 0;) {
+        mag = (mag << LIMB_BITS) | a->limbs[i];
+    }
+    if (mag > INT64_MAX) {
+        return false;
+    }
+    *out = a->negative ? -(int64_t)mag : (int64_t)mag;
+    return true;
+}
+
+__float128 linbigint_frexp(const linbigint* a, int64_t* exp) {
+    size_t skip = a->size > 4 ? a->size - 4 : 0;
+    __float128 mantissa = 0;
+    for (size_t i = a->size; i-- > skip;) {
+        mantissa = mantissa * (__float128)LIMB_BASE + a->limbs[i];
+    }
+    *exp = (int64_t)skip * LIMB_BITS;
+    return a->negative ? -mantissa : mantissa;
+}
+
+size_t linbigint_format(const linbigint* a, char* buf, size_t capacity) {
+    if (a->size == 0) {
+        return (size_t)snprintf(buf, capacity, "0");
+    }
+    // Peel off base 10^9 digits from a scratch copy, least significant first.
+    linbigint scratch = linbigint_clone(a);
+    size_t count = 0;
+    uint32_t* digits = malloc((a->size * 10 / 9 + 2) * sizeof(uint32_t));
+    while (scratch.size != 0) {
+        digits[count++] = linbigint_divmod_limb(scratch.limbs, scratch.size, 1000000000);
+        linbigint_trim(&scratch);
+    }
+    char group[16];
+    size_t length = (size_t)snprintf(group, sizeof(group), "%s%u", a->negative ? "-" : "", digits[count - 1]);
+    size_t total = length + (count - 1) * 9;
+    if (capacity != 0) {
+        size_t pos = length < capacity - 1 ? length : capacity - 1;
+        memcpy(buf, group, pos);
+        for (size_t i = count - 1; i-- > 0 && pos < capacity - 1;) {
+            snprintf(group, sizeof(group), "%09u", digits[i]);
+            size_t n = capacity - 1 - pos < 9 ? capacity - 1 - pos : 9;
+            memcpy(buf + pos, group, n);
+            pos += n;
+        }
+        buf[pos] = '\0';
+    }
+    free(digits);
+    linbigint_free(&scratch);
+    return total;
+}
+
+void linbigint_print(const linbigint* a) {
+    size_t length = linbigint_format(a, NULL, 0);
+    char* buf = malloc(length + 1);
+    linbigint_format(a, buf, length + 1);
+    printf("%s", buf);
+    free(buf);
+}
+
+#undef LIMB_BITS
+#undef LIMB_BASE
@@ -0,0 +1,165 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include<stdio.h>
+#include<quadmath.h>
+
+/**
+ * @struct linbigint
+ * @brief Represents an arbitrary precision integer.
+ *
+ * The magnitude is stored as little-endian 32-bit limbs with no leading zero
+ * limbs, so zero has a size of 0. The sign is kept separately and zero is never
+ * negative. Every function returns a newly allocated linbigint and leaves its
+ * operands untouched; results must be released with linbigint_free.
+ */
+typedef struct linbigint {
+    bool negative; /**< Whether the integer is below zero. */
+    size_t size; /**< The number of limbs in use. */
+    size_t capacity; /**< The number of limbs allocated. */
+    uint32_t* limbs; /**< The limbs of the magnitude, least significant first. */
+} linbigint;
+
+/**
+ * Creates a new linbigint equal to zero.
+ *
+ * @return The newly created linbigint.
+ */
+linbigint linbigint_new(void);
+
+/**
+ * Creates a new linbigint from a 128-bit integer.
+ *
+ * @param value The value of the linbigint.
+ * @return The newly created linbigint.
+ */
+linbigint linbigint_from_i128(__int128 value);
+
+/**
+ * Creates a new non-negative linbigint from decimal digits.
+ *
+ * @param digits The digits, which must all be between '0' and '9'.
+ * @param length The number of digits.
+ * @return The newly created linbigint.
+ */
+linbigint linbigint_parse(const char* digits, size_t length);
+
+/**
+ * Creates a new linbigint that is a copy of the given linbigint.
+ *
+ * @param a The linbigint to clone.
+ * @return The cloned linbigint.
+ */
+linbigint linbigint_clone(const linbigint* a);
+
+/**
+ * Frees the memory occupied by the given linbigint and sets it to zero.
+ *
+ * @param a The linbigint to free.
+ */
+void linbigint_free(linbigint* a);
+
+/**
+ * Checks whether the given linbigint is zero.
+ *
+ * @param a The linbigint.
+ * @return true if the linbigint is zero.
+ */
+bool linbigint_is_zero(const linbigint* a);
+
+/**
+ * Compares two linbigints.
+ *
+ * @param a The first linbigint.
+ * @param b The second linbigint.
+ * @return A negative value if a < b, 0 if they are equal, a positive value otherwise.
+ */
+int linbigint_cmp(const linbigint* a, const linbigint* b);
+
+/**
+ * Adds two linbigints.
+ *
+ * @param a The first linbigint.
+ * @param b The second linbigint.
+ * @return The sum of the two linbigints.
+ */
+linbigint linbigint_add(const linbigint* a, const linbigint* b);
+
+/**
+ * Subtracts the second linbigint from the first.
+ *
+ * @param a The first linbigint.
+ * @param b The second linbigint.
+ * @return The difference of the two linbigints.
+ */
+linbigint linbigint_sub(const linbigint* a, const linbigint* b);
+
+/**
+ * Multiplies two linbigints.
+ *
+ * @param a The first linbigint.
+ * @param b The second linbigint.
+ * @return The product of the two linbigints.
+ */
+linbigint linbigint_mul(const linbigint* a, const linbigint* b);
+
+/**
+ * Divides two linbigints, truncating toward zero.
+ *
+ * The remainder has the sign of the dividend.
+ *
+ * @param a The dividend.
+ * @param b The divisor, which must not be zero.
+ * @param quot Where the quotient is stored, may be NULL.
+ * @param rem Where the remainder is stored, may be NULL.
+ */
+void linbigint_divmod(const linbigint* a, const linbigint* b, linbigint* quot, linbigint* rem);
+
+/**
+ * Calculates the greatest common divisor of two linbigints.
+ *
+ * @param a The first linbigint.
+ * @param b The second linbigint.
+ * @return The non-negative greatest common divisor, 0 if both are 0.
+ */
+linbigint linbigint_gcd(const linbigint* a, const linbigint* b);
+
+/**
+ * Converts a linbigint to an int64 if it fits.
+ *
+ * @param a The linbigint.
+ * @param out Where the value is stored.
+ * @return false if the value is outside [-INT64_MAX, INT64_MAX].
+ */
+bool linbigint_to_i64(const linbigint* a, int64_t* out);
+
+/**
+ * Splits a linbigint into a mantissa and a power of two.
+ *
+ * The mantissa carries the leading 128 bits of the magnitude, so the value can
+ * be recovered as mantissa * 2^exp without overflowing a floating point type.
+ *
+ * @param a The linbigint.
+ * @param exp Where the power of two is stored.
+ * @return The mantissa.
+ */
+__float128 linbigint_frexp(const linbigint* a, int64_t* exp);
+
+/**
+ * Formats a linbigint in decimal, like snprintf.
+ *
+ * @param a The linbigint to format.
+ * @param buf The buffer to write to, NUL terminated when `capacity` is not 0.
+ * @param capacity The size of the buffer.
+ * @return The length of the full text, which was truncated if it is not below `capacity`.
+ */
+size_t linbigint_format(const linbigint* a, char* buf, size_t capacity);
+
+/**
+ * Prints a linbigint in decimal.
+ *
+ * @param a The linbigint to print.
+ */
+void linbigint_print(const linbigint* a);
@@ -31,15 +31,36 @@
  * fractional realnum object. The apply_op function applies a given operation
  * function to two realnum objects.
  *
+ * Fraction arithmetic widens to 128-bit intermediates, so a sum or product of
+ * two fractions is always exact before it is narrowed back. Results are only
+ * reduced once their terms pass REALNUM_FRAC_REDUCE_THRESHOLD, using a binary
+ * gcd, and results that still do not fit in int64 terms never wrap around.
+ *
+ * Rationals that outgrow int64 terms are promoted to REALNUM_BIGFRAC, backed by
+ * the linbigint type of bigint.h, and demoted again once a result fits. Only
+ * those numbers touch the heap, so realnum_clone and realnum_free are a single
+ * branch for the inline kinds.
+ *
  * The realnum_print and realnum_println functions print the value of a realnum
  * object to the console. The realnum_print_as_frac and realnum_print_as_aprox
  * functions print the value of a realnum object as a fractional or approximate
  * representation, respectively.
  */
 #include"realnum.h"
+#include"../stats/stats.h"
 
 #define BUF_SIZE 128
 
+static void realnum_print_aprox_value(realnum_aprox value, uint16_t precision) {
+#if REALNUM_APROX_PRECISION == 128
+    char buf[BUF_SIZE];
+    quadmath_snprintf (buf, sizeof buf, "%.*Qf", precision, value);
+    printf("%s", buf);
+#else
+    printf("%.*Lf", precision, (long double)value);
+#endif
+}
+
 realnum realnum_new() {
     realnum num;
     num.kind = REALNUM_FRAC;
@@ -56,22 +77,307 @@ realnum realnum_from_frac(int64_t num, int64_t den) {
     return frac;
 }
 
-realnum realnum_from_aprox(__float128 aprox) {
+realnum realnum_from_aprox(realnum_aprox aprox) {
     realnum num;
     num.kind = REALNUM_APROX;
     num.value.aprox = aprox;
     return num;
 }
 
+static uint64_t realnum_magnitude(int64_t x) {
+    return x < 0 ? -(uint64_t)x : (uint64_t)x;
+}
+
+static int realnum_ctz128(unsigned __int128 x) {
+    uint64_t low = (uint64_t)x;
+    return low != 0 ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(x >> 64));
+}
+
+/*
+ * Binary gcd over 128-bit magnitudes. Switches to the 64-bit loop as soon as
+ * both operands fit, which is after a few steps for the products realnum
+ * produces.
+ */
+static unsigned __int128 realnum_gcd128(unsigned __int128 a, unsigned __int128 b) {
+    if (a == 0) {
+        return b;
+    }
+    if (b == 0) {
+        return a;
+    }
+    int shift = realnum_ctz128(a | b);
+    a >>= realnum_ctz128(a);
+    do {
+        b >>= realnum_ctz128(b);
+        if ((a >> 64) == 0 && (b >> 64) == 0) {
+            return (unsigned __int128)realnum_gcd((uint64_t)a, (uint64_t)b) << shift;
+        }
+        if (a > b) {
+            unsigned __int128 t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+/*
+ * Multiplies an/ad by bn/bd. Large operands are cross-cancelled first, so two
+ * reduced fractions give a reduced product whose terms are as small as they
+ * can be before they are widened.
+ */
+static realnum realnum_frac_mul(int64_t an, int64_t ad, int64_t bn, int64_t bd) {
+    uint64_t limit = REALNUM_FRAC_REDUCE_THRESHOLD;
+    if ((realnum_magnitude(an) | realnum_magnitude(ad) | realnum_magnitude(bn) | realnum_magnitude(bd)) > limit) {
+        uint64_t g = realnum_gcd(realnum_magnitude(an), realnum_magnitude(bd));
+        if (g > 1 && g <= INT64_MAX) {
+            an /= (int64_t)g;
+            bd /= (int64_t)g;
+        }
+        g = realnum_gcd(realnum_magnitude(bn), realnum_magnitude(ad));
+        if (g > 1 && g <= INT64_MAX) {
+            bn /= (int64_t)g;
+            ad /= (int64_t)g;
+        }
+    }
+    return realnum_from_frac128((__int128)an * bn, (__int128)ad * bd);
+}
+
+uint64_t realnum_gcd(uint64_t a, uint64_t b) {
+    if (a == 0) {
+        return b;
+    }
+    if (b == 0) {
+        return a;
+    }
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+/*
+ * Moves the sign of a fraction to its numerator and reduces it by its gcd if
+ * its terms are past REALNUM_FRAC_REDUCE_THRESHOLD. Returns the magnitudes of
+ * the resulting terms.
+ */
+static void realnum_frac_reduce128(__int128* num, __int128* den, unsigned __int128* n, unsigned __int128* d) {
+    if (*den < 0) {
+        *num = -*num;
+        *den = -*den;
+    }
+    *n = *num < 0 ? -(unsigned __int128)*num : (unsigned __int128)*num;
+    *d = (unsigned __int128)*den;
+    if (*d != 0 && (*n > REALNUM_FRAC_REDUCE_THRESHOLD || *d > REALNUM_FRAC_REDUCE_THRESHOLD)) {
+        unsigned __int128 g = realnum_gcd128(*n, *d);
+        *n /= g;
+        *d /= g;
+        *num /= (__int128)g;
+        *den /= (__int128)g;
+    }
+}
+
+bool realnum_frac_narrow(__int128 num, __int128 den, int64_t* out_num, int64_t* out_den) {
+    unsigned __int128 n;
+    unsigned __int128 d;
+    realnum_frac_reduce128(&num, &den, &n, &d);
+    if (n > INT64_MAX || d > INT64_MAX) {
+        return false;
+    }
+    *out_num = (int64_t)num;
+    *out_den = (int64_t)den;
+    return true;
+}
+
+static realnum_aprox realnum_aprox_value(realnum* num) {
+    switch (num->kind) {
+        case REALNUM_FRAC:
+            return (realnum_aprox)num->value.frac.num / num->value.frac.den;
+        case REALNUM_BIGFRAC: {
+            // Divide the leading bits and apply the power of two afterwards, so
+            // terms far beyond the floating point range still give their ratio.
+            int64_t en;
+            int64_t ed;
+            __float128 mn = linbigint_frexp(&num->value.bigfrac->num, &en);
+            __float128 md = linbigint_frexp(&num->value.bigfrac->den, &ed);
+            int64_t e = en - ed;
+            e = e > INT16_MAX ? INT16_MAX : e < INT16_MIN ? INT16_MIN : e;
+#if REALNUM_APROX_PRECISION == 128
+            return ldexpq(mn / md, (int)e);
+#else
+            return (realnum_aprox)ldexpl((long double)(mn / md), (int)e);
+#endif
+        }
+        default:
+            return num->value.aprox;
+    }
+}
+
+/*
+ * Wraps reduced terms with a positive denominator, demoting them to a
+ * REALNUM_FRAC when both fit. Takes ownership of the terms.
+ */
+static realnum realnum_bigfrac_finish(linbigint num, linbigint den) {
+    int64_t n;
+    int64_t d;
+    if (linbigint_to_i64(&num, &n) && linbigint_to_i64(&den, &d)) {
+        linbigint_free(&num);
+        linbigint_free(&den);
+        return realnum_from_frac(n, d);
+    }
+    realnum result;
+    result.kind = REALNUM_BIGFRAC;
+    result.value.bigfrac = malloc(sizeof(realnum_bigfrac));
+    if (result.value.bigfrac == NULL) {
+        fprintf(stderr, "Error: could not allocate a bigfrac.\n");
+        exit(1);
+    }
+    result.value.bigfrac->num = num;
+    result.value.bigfrac->den = den;
+    return result;
+}
+
+/*
+ * Exposes the terms of an exact number as linbigints. The terms of a
+ * REALNUM_BIGFRAC are borrowed, those of a REALNUM_FRAC are built and must be
+ * given back with realnum_exact_release.
+ */
+static void realnum_exact_terms(realnum* x, linbigint* num, linbigint* den) {
+    if (x->kind == REALNUM_BIGFRAC) {
+        *num = x->value.bigfrac->num;
+        *den = x->value.bigfrac->den;
+    } else {
+        *num = linbigint_from_i128(x->value.frac.num);
+        *den = linbigint_from_i128(x->value.frac.den);
+    }
+}
+
+static void realnum_exact_release(realnum* x, linbigint* num, linbigint* den) {
+    if (x->kind != REALNUM_BIGFRAC) {
+        linbigint_free(num);
+        linbigint_free(den);
+    }
+}
+
+/*
+ * Records the promotion of a REALNUM_FRAC operand whose result had to stay a
+ * REALNUM_BIGFRAC.
+ */
+static realnum realnum_bigfrac_promoted(realnum* a, realnum* b, realnum result) {
+    if (result.kind == REALNUM_BIGFRAC && (a->kind == REALNUM_FRAC || b->kind == REALNUM_FRAC)) {
+        LINSTATS_ALLOC(LINSTATS_FRAC_OVERFLOW, sizeof(realnum_bigfrac));
+    }
+    return result;
+}
+
+static realnum realnum_bigfrac_add(realnum* a, realnum* b, bool subtract) {
+    linbigint an, ad, bn, bd;
+    realnum_exact_terms(a, &an, &ad);
+    realnum_exact_terms(b, &bn, &bd);
+    linbigint x = linbigint_mul(&an, &bd);
+    linbigint y = linbigint_mul(&bn, &ad);
+    linbigint num = subtract ? linbigint_sub(&x, &y) : linbigint_add(&x, &y);
+    linbigint den = linbigint_mul(&ad, &bd);
+    linbigint_free(&x);
+    linbigint_free(&y);
+    realnum_exact_release(a, &an, &ad);
+    realnum_exact_release(b, &bn, &bd);
+    return realnum_bigfrac_promoted(a, b, realnum_from_bigfrac(num, den));
+}
+
+static realnum realnum_bigfrac_mul(realnum* a, realnum* b, bool divide) {
+    linbigint an, ad, bn, bd;
+    realnum_exact_terms(a, &an, &ad);
+    realnum_exact_terms(b, &bn, &bd);
+    linbigint num = linbigint_mul(&an, divide ? &bd : &bn);
+    linbigint den = linbigint_mul(&ad, divide ? &bn : &bd);
+    realnum_exact_release(a, &an, &ad);
+    realnum_exact_release(b, &bn, &bd);
+    return realnum_bigfrac_promoted(a, b, realnum_from_bigfrac(num, den));
+}
+
+realnum realnum_from_bigfrac(linbigint num, linbigint den) {
+    if (linbigint_is_zero(&den)) {
+        realnum_aprox sign = linbigint_is_zero(&num) ? 0 : num.negative ? -1 : 1;
+        realnum_aprox zero = 0;
+        linbigint_free(&num);
+        linbigint_free(&den);
+        return realnum_from_aprox(sign / zero);
+    }
+    if (den.negative) {
+        den.negative = false;
+        num.negative = !num.negative && !linbigint_is_zero(&num);
+    }
+    linbigint g = linbigint_gcd(&num, &den);
+    if (g.size != 1 || g.limbs[0] != 1) {
+        linbigint q;
+        linbigint_divmod(&num, &g, &q, NULL);
+        linbigint_free(&num);
+        num = q;
+        linbigint_divmod(&den, &g, &q, NULL);
+        linbigint_free(&den);
+        den = q;
+    }
+    linbigint_free(&g);
+    return realnum_bigfrac_finish(num, den);
+}
+
+realnum realnum_clone(realnum* num) {
+    if (num->kind != REALNUM_BIGFRAC) {
+        return *num;
+    }
+    return realnum_bigfrac_finish(linbigint_clone(&num->value.bigfrac->num), linbigint_clone(&num->value.bigfrac->den));
+}
+
+void realnum_free(realnum* num) {
+    if (num->kind == REALNUM_BIGFRAC) {
+        linbigint_free(&num->value.bigfrac->num);
+        linbigint_free(&num->value.bigfrac->den);
+        free(num->value.bigfrac);
+    }
+    *num = realnum_new();
+}
+
+realnum realnum_from_frac128(__int128 num, __int128 den) {
+    unsigned __int128 n;
+    unsigned __int128 d;
+    realnum_frac_reduce128(&num, &den, &n, &d);
+    if (n <= INT64_MAX && d <= INT64_MAX) {
+        return realnum_from_frac((int64_t)num, (int64_t)den);
+    }
+    if (d == 0) {
+        return realnum_from_aprox((realnum_aprox)num / (realnum_aprox)den);
+    }
+    LINSTATS_ALLOC(LINSTATS_FRAC_OVERFLOW, sizeof(realnum_bigfrac));
+    return realnum_bigfrac_finish(linbigint_from_i128(num), linbigint_from_i128(den));
+}
+
 realnum realnum_add(realnum* a, realnum* b) {
     realnum result;
     if (a->kind == REALNUM_FRAC && b->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = a->value.frac.num * b->value.frac.den + b->value.frac.num * a->value.frac.den;
-        result.value.frac.den = a->value.frac.den * b->value.frac.den;
+        int64_t ad = a->value.frac.den;
+        int64_t bd = b->value.frac.den;
+        if (ad == bd) {
+            return realnum_from_frac128((__int128)a->value.frac.num + b->value.frac.num, ad);
+        }
+        return realnum_from_frac128((__int128)a->value.frac.num * bd + (__int128)b->value.frac.num * ad, (__int128)ad * bd);
+    } else if (a->kind != REALNUM_APROX && b->kind != REALNUM_APROX) {
+        return realnum_bigfrac_add(a, b, false);
     } else {
+        if (a->kind != b->kind) {
+            LINSTATS_COUNT(LINSTATS_APROX_PROMOTION);
+        }
         result.kind = REALNUM_APROX;
-        result.value.aprox = (a->kind == REALNUM_FRAC ? (long double)a->value.frac.num / a->value.frac.den : a->value.aprox) + (b->kind == REALNUM_FRAC ? (long double)b->value.frac.num / b->value.frac.den : b->value.aprox);
+        result.value.aprox = realnum_aprox_value(a) + realnum_aprox_value(b);
     }
     return result;
 }
@@ -79,12 +385,20 @@ realnum realnum_add(realnum* a, realnum* b) {
 realnum realnum_sub(realnum* a, realnum* b) {
     realnum result;
     if (a->kind == REALNUM_FRAC && b->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = a->value.frac.num * b->value.frac.den - b->value.frac.num * a->value.frac.den;
-        result.value.frac.den = a->value.frac.den * b->value.frac.den;
+        int64_t ad = a->value.frac.den;
+        int64_t bd = b->value.frac.den;
+        if (ad == bd) {
+            return realnum_from_frac128((__int128)a->value.frac.num - b->value.frac.num, ad);
+        }
+        return realnum_from_frac128((__int128)a->value.frac.num * bd - (__int128)b->value.frac.num * ad, (__int128)ad * bd);
+    } else if (a->kind != REALNUM_APROX && b->kind != REALNUM_APROX) {
+        return realnum_bigfrac_add(a, b, true);
     } else {
+        if (a->kind != b->kind) {
+            LINSTATS_COUNT(LINSTATS_APROX_PROMOTION);
+        }
         result.kind = REALNUM_APROX;
-        result.value.aprox = (a->kind == REALNUM_FRAC ? (long double)a->value.frac.num / a->value.frac.den : a->value.aprox) - (b->kind == REALNUM_FRAC ? (long double)b->value.frac.num / b->value.frac.den : b->value.aprox);
+        result.value.aprox = realnum_aprox_value(a) - realnum_aprox_value(b);
     }
     return result;
 }
@@ -92,12 +406,15 @@ realnum realnum_sub(realnum* a, realnum* b) {
 realnum realnum_mul(realnum* a, realnum* b) {
     realnum result;
     if (a->kind == REALNUM_FRAC && b->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = a->value.frac.num * b->value.frac.num;
-        result.value.frac.den = a->value.frac.den * b->value.frac.den;
+        return realnum_frac_mul(a->value.frac.num, a->value.frac.den, b->value.frac.num, b->value.frac.den);
+    } else if (a->kind != REALNUM_APROX && b->kind != REALNUM_APROX) {
+        return realnum_bigfrac_mul(a, b, false);
     } else {
+        if (a->kind != b->kind) {
+            LINSTATS_COUNT(LINSTATS_APROX_PROMOTION);
+        }
         result.kind = REALNUM_APROX;
-        result.value.aprox = (a->kind == REALNUM_FRAC ? (long double)a->value.frac.num / a->value.frac.den : a->value.aprox) * (b->kind == REALNUM_FRAC ? (long double)b->value.frac.num / b->value.frac.den : b->value.aprox);
+        result.value.aprox = realnum_aprox_value(a) * realnum_aprox_value(b);
     }
     return result;
 }
@@ -105,22 +422,32 @@ realnum realnum_mul(realnum* a, realnum* b) {
 realnum realnum_div(realnum* a, realnum* b) {
     realnum result;
     if (a->kind == REALNUM_FRAC && b->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = a->value.frac.num * b->value.frac.den;
-        result.value.frac.den = a->value.frac.den * b->value.frac.num;
+        return realnum_frac_mul(a->value.frac.num, a->value.frac.den, b->value.frac.den, b->value.frac.num);
+    } else if (a->kind != REALNUM_APROX && b->kind != REALNUM_APROX) {
+        return realnum_bigfrac_mul(a, b, true);
     } else {
+        if (a->kind != b->kind) {
+            LINSTATS_COUNT(LINSTATS_APROX_PROMOTION);
+        }
         result.kind = REALNUM_APROX;
-        result.value.aprox = (a->kind == REALNUM_FRAC ? (long double)a->value.frac.num / a->value.frac.den : a->value.aprox) / (b->kind == REALNUM_FRAC ? (long double)b->value.frac.num / b->value.frac.den : b->value.aprox);
+        result.value.aprox = realnum_aprox_value(a) / realnum_aprox_value(b);
     }
     return result;
 }
 
 realnum realnum_neg(realnum* num) {
     realnum result;
-    if (num->kind == REALNUM_FRAC) {
+    if (num->kind == REALNUM_FRAC && num->value.frac.num == INT64_MIN) {
+        return realnum_from_frac128(-(__int128)num->value.frac.num, (__int128)num->value.frac.den);
+    } else if (num->kind == REALNUM_FRAC) {
         result.kind = REALNUM_FRAC;
         result.value.frac.num = -num->value.frac.num;
         result.value.frac.den = num->value.frac.den;
+    } else if (num->kind == REALNUM_BIGFRAC) {
+        // Built like every other BIGFRAC result, so it is demoted when it fits.
+        linbigint n = linbigint_clone(&num->value.bigfrac->num);
+        n.negative = !n.negative;
+        return realnum_bigfrac_finish(n, linbigint_clone(&num->value.bigfrac->den));
     } else {
         result.kind = REALNUM_APROX;
         result.value.aprox = -num->value.aprox;
@@ -130,23 +457,37 @@ realnum realnum_neg(realnum* num) {
 
 realnum realnum_inv(realnum* num) {
     realnum result;
-    if (num->kind == REALNUM_FRAC) {
+    if (num->kind == REALNUM_FRAC && num->value.frac.num < 0) {
+        // -INT64_MIN does not fit an int64, the 128-bit path widens it.
+        return realnum_from_frac128((__int128)num->value.frac.den, (__int128)num->value.frac.num);
+    } else if (num->kind == REALNUM_FRAC) {
         result.kind = REALNUM_FRAC;
         result.value.frac.num = num->value.frac.den;
         result.value.frac.den = num->value.frac.num;
+    } else if (num->kind == REALNUM_BIGFRAC) {
+        linbigint n = linbigint_clone(&num->value.bigfrac->den);
+        linbigint d = linbigint_clone(&num->value.bigfrac->num);
+        n.negative = d.negative;
+        d.negative = false;
+        return realnum_bigfrac_finish(n, d);
     } else {
         result.kind = REALNUM_APROX;
-        result.value.aprox = 1 / (num->kind == REALNUM_FRAC ? (long double)num->value.frac.num / num->value.frac.den : num->value.aprox);
+        result.value.aprox = 1 / realnum_aprox_value(num);
     }
     return result;
 }
 
 realnum realnum_abs(realnum* num) {
     realnum result;
-    if (num->kind == REALNUM_FRAC) {
+    if (num->kind == REALNUM_FRAC && num->value.frac.num == INT64_MIN) {
+        return realnum_from_frac128(-(__int128)num->value.frac.num, (__int128)num->value.frac.den);
+    } else if (num->kind == REALNUM_FRAC) {
         result.kind = REALNUM_FRAC;
         result.value.frac.num = num->value.frac.num < 0 ? -num->value.frac.num : num->value.frac.num;
         result.value.frac.den = num->value.frac.den;
+    } else if (num->kind == REALNUM_BIGFRAC) {
+        result = realnum_clone(num);
+        result.value.bigfrac->num.negative = false;
     } else {
         result.kind = REALNUM_APROX;
         result.value.aprox = num->value.aprox < 0 ? -num->value.aprox : num->value.aprox;
@@ -154,15 +495,54 @@ realnum realnum_abs(realnum* num) {
     return result;
 }
 
+static uint64_t realnum_term_log2(uint64_t x) {
+    return x > 1 ? 63 - __builtin_clzll(x) : 0;
+}
+
+static uint64_t realnum_bigint_log2(const linbigint* x) {
+    if (x->size == 0) {
+        return 0;
+    }
+    return (x->size - 1) * 32 + realnum_term_log2(x->limbs[x->size - 1]);
+}
+
+/*
+ * The floor of log2 of both terms of an exact number, summed. A power of the
+ * number has about that many bits per unit of the exponent in its terms.
+ */
+static uint64_t realnum_exact_log2(realnum* num) {
+    if (num->kind == REALNUM_BIGFRAC) {
+        return realnum_bigint_log2(&num->value.bigfrac->num) + realnum_bigint_log2(&num->value.bigfrac->den);
+    }
+    return realnum_term_log2(realnum_magnitude(num->value.frac.num)) + realnum_term_log2(realnum_magnitude(num->value.frac.den));
+}
+
 realnum realnum_pow(realnum* num, realnum* exp) {
     realnum result;
-    if (num->kind == REALNUM_FRAC && exp->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = powl(num->value.frac.num, exp->value.frac.num);
-        result.value.frac.den = powl(num->value.frac.den, exp->value.frac.num);
+    uint64_t n = exp->kind == REALNUM_FRAC ? realnum_magnitude(exp->value.frac.num) : 0;
+    if (num->kind != REALNUM_APROX && exp->kind == REALNUM_FRAC && exp->value.frac.den == 1 &&
+        realnum_exact_log2(num) <= REALNUM_POW_EXACT_BITS / (n != 0 ? n : 1)) {
+        // Integer powers of exact numbers stay exact, by repeated squaring.
+        int64_t e = exp->value.frac.num;
+        realnum base = e < 0 ? realnum_inv(num) : realnum_clone(num);
+        result = realnum_from_frac(1, 1);
+        while (n != 0) {
+            if (n & 1) {
+                realnum temp = realnum_mul(&result, &base);
+                realnum_free(&result);
+                result = temp;
+            }
+            n >>= 1;
+            if (n != 0) {
+                realnum temp = realnum_mul(&base, &base);
+                realnum_free(&base);
+                base = temp;
+            }
+        }
+        realnum_free(&base);
     } else {
         result.kind = REALNUM_APROX;
-        result.value.aprox = powl(num->kind == REALNUM_FRAC ? (long double)num->value.frac.num / num->value.frac.den : num->value.aprox, exp->kind == REALNUM_FRAC ? (long double)exp->value.frac.num / exp->value.frac.den : exp->value.aprox);
+        result.value.aprox = powl(realnum_aprox_value(num), realnum_aprox_value(exp));
     }
     return result;
 }
@@ -175,7 +555,11 @@ realnum realnum_sqrt(realnum* num) {
         result.value.frac.den = sqrtl(num->value.frac.den);
     } else {
         result.kind = REALNUM_APROX;
-        result.value.aprox = sqrtl(num->kind == REALNUM_FRAC ? (long double)num->value.frac.num / num->value.frac.den : num->value.aprox);
+#if REALNUM_APROX_PRECISION == 128
+        result.value.aprox = sqrtq(realnum_aprox_value(num));
+#else
+        result.value.aprox = sqrtl(realnum_aprox_value(num));
+#endif
     }
     return result;
 }
@@ -188,7 +572,7 @@ realnum realnum_cbrt(realnum* num) {
         result.value.frac.den = cbrtl(num->value.frac.den);
     } else {
         result.kind = REALNUM_APROX;
-        result.value.aprox = cbrtl(num->kind == REALNUM_FRAC ? (long double)num->value.frac.num / num->value.frac.den : num->value.aprox);
+        result.value.aprox = cbrtl(realnum_aprox_value(num));
     }
     return result;
 }
@@ -201,17 +585,15 @@ realnum realnum_exp(realnum* num) {
         result.value.frac.den = expl(num->value.frac.den);
     } else {
         result.kind = REALNUM_APROX;
-        result.value.aprox = expl(num->kind == REALNUM_FRAC ? (long double)num->value.frac.num / num->value.frac.den : num->value.aprox);
+        result.value.aprox = expl(realnum_aprox_value(num));
     }
     return result;
 }
 
 realnum realnum_as_frac(realnum* num) {
     realnum result;
-    if (num->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = num->value.frac.num;
-        result.value.frac.den = num->value.frac.den;
+    if (num->kind != REALNUM_APROX) {
+        result = realnum_clone(num);
     } else {
         result.kind = REALNUM_FRAC;
         result.value.frac.num = num->value.aprox;
@@ -221,34 +603,25 @@ realnum realnum_as_frac(realnum* num) {
 }
 
 realnum realnum_as_aprox(realnum* num) {
-    realnum result;
-    if (num->kind == REALNUM_FRAC) {
-        result.kind = REALNUM_APROX;
-        result.value.aprox = (long double)num->value.frac.num / num->value.frac.den;
-    } else {
-        result.kind = REALNUM_APROX;
-        result.value.aprox = num->value.aprox;
-    }
-    return result;
+    return realnum_from_aprox(realnum_aprox_value(num));
 }
 
 realnum realnum_fracsimp(realnum* num) {
     realnum result;
     if (num->kind == REALNUM_FRAC) {
-        int64_t a = num->value.frac.num;
-        int64_t b = num->value.frac.den;
-        int64_t c;
-        while (b != 0) {
-            c = a % b;
-            a = b;
-            b = c;
+        // Reduced over 128 bits, so a gcd of 2^63 and a sign moved off an
+        // INT64_MIN denominator are exact; a term of 2^63 left after that is
+        // promoted by realnum_from_frac128.
+        __int128 a = num->value.frac.num;
+        __int128 b = num->value.frac.den;
+        uint64_t g = realnum_gcd(realnum_magnitude(num->value.frac.num), realnum_magnitude(num->value.frac.den));
+        if (g > 1) {
+            a /= (__int128)g;
+            b /= (__int128)g;
         }
-        result.kind = REALNUM_FRAC;
-        result.value.frac.num = num->value.frac.num / a;
-        result.value.frac.den = num->value.frac.den / a;
+        return realnum_from_frac128(a, b);
     } else {
-        result.kind = REALNUM_APROX;
-        result.value.aprox = num->value.aprox;
+        result = realnum_clone(num);
     }
     return result;
 }
@@ -260,10 +633,12 @@ realnum apply_op(realnum* a, realnum* b, realnum (*op)(realnum*, realnum*)) {
 void realnum_print(realnum* num, uint16_t precision) {
     if (num->kind == REALNUM_FRAC) {
         printf("%ld/%ld", num->value.frac.num, num->value.frac.den);
+    } else if (num->kind == REALNUM_BIGFRAC) {
+        linbigint_print(&num->value.bigfrac->num);
+        printf("/");
+        linbigint_print(&num->value.bigfrac->den);
     } else {
-        char buf[BUF_SIZE];
-        quadmath_snprintf (buf, sizeof buf, "%.*Qf", precision, num->value.aprox);
-        printf("%s", buf);
+        realnum_print_aprox_value(num->value.aprox, precision);
     }
 }
 
@@ -273,8 +648,8 @@ void realnum_println(realnum* num, uint16_t precision) {
 }
 
 void realnum_print_as_frac(realnum* num) {
-    if (num->kind == REALNUM_FRAC) {
-        printf("%ld/%ld", num->value.frac.num, num->value.frac.den);
+    if (num->kind != REALNUM_APROX) {
+        realnum_print(num, 0);
     } else {
         realnum frac = realnum_as_frac(num);
         realnum_print_as_frac(&frac);
@@ -282,14 +657,7 @@ void realnum_print_as_frac(realnum* num) {
 }
 
 void realnum_print_as_aprox(realnum* num, uint16_t precision) {
-    if (num->kind == REALNUM_FRAC) {
-        realnum aprox = realnum_as_aprox(num);
-        realnum_print_as_aprox(&aprox, precision);
-    } else {
-        char buf[BUF_SIZE];
-        quadmath_snprintf (buf, sizeof buf, "%.*Qf", precision, num->value.aprox);
-        printf("%s", buf);
-    }
+    realnum_print_aprox_value(realnum_aprox_value(num), precision);
 }
 
 #undef BUF_SIZE
@@ -6,16 +6,91 @@
 #include<quadmath.h>
 #include<math.h>
 #include<stdio.h>
+#include"./bigint.h"
+
+/*
+ * Precision of the REALNUM_APROX storage, chosen per build by defining
+ * REALNUM_APROX_PRECISION to 32 (float), 64 (double), 80 (long double) or
+ * 128 (__float128, the default). Everything but 128 runs on hardware floating
+ * point.
+ */
+#ifndef REALNUM_APROX_PRECISION
+#define REALNUM_APROX_PRECISION 128
+#endif
+
+#if REALNUM_APROX_PRECISION == 32
+typedef float realnum_aprox;
+#define REALNUM_DEFAULT_PRECISION REALNUM_FLOAT
+#elif REALNUM_APROX_PRECISION == 64
+typedef double realnum_aprox;
+#define REALNUM_DEFAULT_PRECISION REALNUM_DOUBLE
+#elif REALNUM_APROX_PRECISION == 80
+typedef long double realnum_aprox;
+#define REALNUM_DEFAULT_PRECISION REALNUM_LONG_DOUBLE
+#elif REALNUM_APROX_PRECISION == 128
+typedef __float128 realnum_aprox;
+#define REALNUM_DEFAULT_PRECISION REALNUM_QUAD
+#else
+#error "REALNUM_APROX_PRECISION must be 32, 64, 80 or 128"
+#endif
+
+/*
+ * Fractions whose numerator or denominator grow past this magnitude are reduced
+ * by their gcd after an operation, smaller ones are left as they are. Below it
+ * every int64 product and cross-product sum is exact, so the common case never
+ * pays for a gcd.
+ */
+#ifndef REALNUM_FRAC_REDUCE_THRESHOLD
+#define REALNUM_FRAC_REDUCE_THRESHOLD (INT64_C(1) << 31)
+#endif
+
+/*
+ * Integer powers of exact numbers are computed exactly while their terms are
+ * expected to stay within this many bits, and approximated past it, so a large
+ * exponent costs no more than the floating point pow.
+ */
+#ifndef REALNUM_POW_EXACT_BITS
+#define REALNUM_POW_EXACT_BITS (UINT64_C(1) << 16)
+#endif
 
 // TODO: Make realnum return a char* with its representation with all ops chained, but not undone unless if asked. (hard)
 
 typedef enum realnum_kind {
     REALNUM_FRAC, // Inteded form for a rational number
-    REALNUM_APROX // Approximated form for a real number (intended for irrational numbers)
+    REALNUM_APROX, // Approximated form for a real number (intended for irrational numbers)
+    REALNUM_BIGFRAC // Arbitrary precision form for a rational number that outgrew REALNUM_FRAC
 } realnum_kind;
 
+/**
+ * The floating point formats an approximated value can be stored in.
+ */
+typedef enum realnum_precision {
+    REALNUM_FLOAT,       // IEEE binary32
+    REALNUM_DOUBLE,      // IEEE binary64
+    REALNUM_LONG_DOUBLE, // The platform long double (x87 extended on x86)
+    REALNUM_QUAD         // IEEE binary128 through libquadmath
+} realnum_precision;
+
+/**
+ * The heap storage of a REALNUM_BIGFRAC number.
+ *
+ * It is always reduced, has a positive denominator, and never holds a value
+ * that fits a REALNUM_FRAC.
+ */
+typedef struct realnum_bigfrac {
+    linbigint num; /**< The numerator of the fraction. */
+    linbigint den; /**< The denominator of the fraction. */
+} realnum_bigfrac;
+
 /**
  * Represents a real number.
+ *
+ * Rationals are stored inline as a REALNUM_FRAC while their terms fit in int64
+ * and are promoted to a heap allocated REALNUM_BIGFRAC only when an operation
+ * outgrows that; results that fit again are demoted back. A REALNUM_BIGFRAC
+ * owns its storage: copies must be made with realnum_clone and every value
+ * released with realnum_free. The inline kinds need neither, so those calls
+ * cost a single branch for them.
  */
 typedef struct realnum {
     realnum_kind kind; /**< The "kind" of real number. */
@@ -24,7 +99,8 @@ typedef struct realnum {
             int64_t num; /**< The numerator of the fraction. */
             int64_t den; /**< The denominator of the fraction. */
         } frac; /**< The fraction value. */
-        __float128 aprox; /**< The approximate value. */
+        realnum_aprox aprox; /**< The approximate value. */
+        realnum_bigfrac* bigfrac; /**< The arbitrary precision fraction value, owned by the realnum. */
     } value; /**< The value of the real number. */
 } realnum;
 
@@ -50,7 +126,56 @@ realnum realnum_from_frac(int64_t num, int64_t den);
  * @param aprox The approximate value.
  * @return A pointer to the newly created realnum object.
  */
-realnum realnum_from_aprox(__float128 aprox);
+realnum realnum_from_aprox(realnum_aprox aprox);
+
+/**
+ * Creates a new realnum object from a fraction with 128-bit terms.
+ *
+ * The fraction is reduced if it is past REALNUM_FRAC_REDUCE_THRESHOLD and its
+ * sign moved to the numerator. If it still does not fit in int64 terms the
+ * result is promoted to REALNUM_BIGFRAC.
+ *
+ * @param num The numerator of the fraction.
+ * @param den The denominator of the fraction.
+ * @return The newly created realnum object.
+ */
+realnum realnum_from_frac128(__int128 num, __int128 den);
+
+/**
+ * Creates a new realnum object from an arbitrary precision fraction.
+ *
+ * Takes ownership of both terms. The fraction is reduced and demoted to
+ * REALNUM_FRAC when it fits; a zero denominator gives a REALNUM_APROX infinity
+ * or NaN.
+ *
+ * @param num The numerator of the fraction.
+ * @param den The denominator of the fraction.
+ * @return The newly created realnum object.
+ */
+realnum realnum_from_bigfrac(linbigint num, linbigint den);
+
+/**
+ * Narrows a fraction with 128-bit terms to int64 terms.
+ *
+ * The fraction is reduced if it is past REALNUM_FRAC_REDUCE_THRESHOLD and its
+ * sign moved to the numerator.
+ *
+ * @param num The numerator of the fraction.
+ * @param den The denominator of the fraction.
+ * @param out_num Where the narrowed numerator is stored.
+ * @param out_den Where the narrowed denominator is stored.
+ * @return false if the reduced fraction does not fit in int64 terms.
+ */
+bool realnum_frac_narrow(__int128 num, __int128 den, int64_t* out_num, int64_t* out_den);
+
+/**
+ * Calculates the greatest common divisor of two unsigned integers.
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return The greatest common divisor, 0 if both are 0.
+ */
+uint64_t realnum_gcd(uint64_t a, uint64_t b);
 
 /**
  * Allocates memory for a realnum object.
@@ -60,9 +185,19 @@ realnum realnum_from_aprox(__float128 aprox);
  */
 realnum realnum_allocate(realnum* num);
 
+/**
+ * Creates a copy of a realnum object.
+ *
+ * @param num The realnum object to copy.
+ * @return The copy, which owns its own storage.
+ */
+realnum realnum_clone(realnum* num);
+
 /**
  * Frees the memory allocated for a realnum object.
  *
+ * Only REALNUM_BIGFRAC numbers hold memory. The object is left as 0/1.
+ *
  * @param num The realnum object to free.
  */
 void realnum_free(realnum* num);
@@ -130,6 +265,9 @@ realnum realnum_abs(realnum* num);
 /**
  * Raises a realnum object to a power.
  *
+ * Integer powers of exact numbers are exact while the result is expected to fit
+ * in REALNUM_POW_EXACT_BITS, every other power is approximated.
+ *
  * @param num The realnum object to raise to a power.
  * @param exp The exponent.
  * @return The result of raising the realnum object to the power of exp.
@@ -179,6 +317,8 @@ realnum realnum_as_aprox(realnum* num);
 /**
  * Simplifies a realnum object as a fraction.
  *
+ * The result is fully reduced, has a positive denominator, and 0 is stored as 0/1.
+ *
  * @param num The realnum object to simplify as a fraction.
  * @return The simplified realnum object as a fraction.
  */
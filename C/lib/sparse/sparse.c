@@ -0,0 +1,331 @@
+#include"./sparse.h"
+#include"../stats/stats.h"
+
+/*
+ * Rows handed to a thread at a time by the OpenMP loops, and the number of
+ * stored elements below which products stay on the calling thread.
+ */
+#ifndef LINSPARSE_SCHEDULE_CHUNK
+#define LINSPARSE_SCHEDULE_CHUNK 64
+#endif
+#ifndef LINSPARSE_PARALLEL_THRESHOLD
+#define LINSPARSE_PARALLEL_THRESHOLD 65536
+#endif
+
+typedef struct linsparse_entry {
+    size_t minor;
+    realnum value;
+} linsparse_entry;
+
+static bool linsparse_is_zero(realnum* num) {
+    switch (num->kind) {
+        case REALNUM_FRAC: return num->value.frac.num == 0;
+        case REALNUM_APROX: return num->value.aprox == 0;
+        default: return false;
+    }
+}
+
+static int linsparse_entry_cmp(const void* a, const void* b) {
+    size_t x = ((const linsparse_entry*)a)->minor;
+    size_t y = ((const linsparse_entry*)b)->minor;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Replaces *acc by *acc + a * b, releasing the intermediate values.
+ */
+static void linsparse_accumulate(realnum* acc, realnum* a, realnum* b) {
+    realnum product = realnum_mul(a, b);
+    realnum sum = realnum_add(acc, &product);
+    realnum_free(&product);
+    realnum_free(acc);
+    *acc = sum;
+}
+
+static size_t linsparse_major_len(linsparse* mat) {
+    return mat->format == LINSPARSE_CSR ? mat->rows : mat->cols;
+}
+
+/*
+ * Allocates an empty matrix with room for `nnz` elements and zeroed offsets.
+ */
+static linsparse linsparse_alloc(linsparse_format format, size_t rows, size_t cols, size_t nnz) {
+    linsparse mat;
+    mat.format = format;
+    mat.rows = rows;
+    mat.cols = cols;
+    mat.nnz = 0;
+    mat.offsets = calloc((format == LINSPARSE_CSR ? rows : cols) + 1, sizeof(size_t));
+    mat.indices = malloc(nnz * sizeof(size_t));
+    mat.values = malloc(nnz * sizeof(realnum));
+    return mat;
+}
+
+linsparse_coo linsparse_coo_new(size_t rows, size_t cols) {
+    linsparse_coo coo;
+    coo.rows = rows;
+    coo.cols = cols;
+    coo.size = 0;
+    coo.capacity = 0;
+    coo.row_indices = NULL;
+    coo.col_indices = NULL;
+    coo.values = NULL;
+    return coo;
+}
+
+void linsparse_coo_push(linsparse_coo* coo, size_t row, size_t col, realnum value) {
+    if (row >= coo->rows || col >= coo->cols) {
+        fprintf(stderr, "Error: the position of a sparse element must be inside the matrix.\n");
+        exit(1);
+    }
+    if (coo->size == coo->capacity) {
+        coo->capacity = coo->capacity ? coo->capacity * 2 : LINVECTOR_DEFAULT_CAPACITY;
+        coo->row_indices = realloc(coo->row_indices, coo->capacity * sizeof(size_t));
+        coo->col_indices = realloc(coo->col_indices, coo->capacity * sizeof(size_t));
+        coo->values = realloc(coo->values, coo->capacity * sizeof(realnum));
+    }
+    coo->row_indices[coo->size] = row;
+    coo->col_indices[coo->size] = col;
+    coo->values[coo->size] = value;
+    coo->size++;
+}
+
+void linsparse_coo_free(linsparse_coo* coo) {
+    for (size_t i = 0; i < coo->size; i++) {
+        realnum_free(&coo->values[i]);
+    }
+    free(coo->row_indices);
+    free(coo->col_indices);
+    free(coo->values);
+    *coo = linsparse_coo_new(0, 0);
+}
+
+linsparse linsparse_from_coo(linsparse_coo* coo, linsparse_format format) {
+    size_t* major = format == LINSPARSE_CSR ? coo->row_indices : coo->col_indices;
+    size_t* minor = format == LINSPARSE_CSR ? coo->col_indices : coo->row_indices;
+    linsparse mat = linsparse_alloc(format, coo->rows, coo->cols, coo->size);
+    size_t n = linsparse_major_len(&mat);
+
+    // Counting sort by major index, then sort every row (column) by minor index.
+    for (size_t i = 0; i < coo->size; i++) {
+        mat.offsets[major[i] + 1]++;
+    }
+    for (size_t i = 0; i < n; i++) {
+        mat.offsets[i + 1] += mat.offsets[i];
+    }
+    size_t* cursor = malloc((n + 1) * sizeof(size_t));
+    memcpy(cursor, mat.offsets, (n + 1) * sizeof(size_t));
+    linsparse_entry* entries = malloc(coo->size * sizeof(linsparse_entry));
+    for (size_t i = 0; i < coo->size; i++) {
+        linsparse_entry* entry = &entries[cursor[major[i]]++];
+        entry->minor = minor[i];
+        entry->value = realnum_clone(&coo->values[i]);
+    }
+    free(cursor);
+
+    // Sum each run of equal positions and keep the non-zero results.
+    size_t nnz = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t start = mat.offsets[i];
+        size_t end = mat.offsets[i + 1];
+        qsort(&entries[start], end - start, sizeof(linsparse_entry), linsparse_entry_cmp);
+        mat.offsets[i] = nnz;
+        for (size_t p = start; p < end;) {
+            realnum sum = entries[p].value;
+            size_t q = p + 1;
+            for (; q < end && entries[q].minor == entries[p].minor; q++) {
+                realnum next = realnum_add(&sum, &entries[q].value);
+                realnum_free(&sum);
+                realnum_free(&entries[q].value);
+                sum = next;
+            }
+            if (linsparse_is_zero(&sum)) {
+                realnum_free(&sum);
+            } else {
+                mat.indices[nnz] = entries[p].minor;
+                mat.values[nnz] = sum;
+                nnz++;
+            }
+            p = q;
+        }
+    }
+    mat.offsets[n] = nnz;
+    mat.nnz = nnz;
+    free(entries);
+    return mat;
+}
+
+linsparse linsparse_from_dense(linmatrix* mat, linsparse_format format) {
+    size_t nnz = 0;
+    for (size_t i = 0; i < mat->rows * mat->cols; i++) {
+        nnz += !linsparse_is_zero(&mat->data[i]);
+    }
+    linsparse result = linsparse_alloc(format, mat->rows, mat->cols, nnz);
+    size_t n = linsparse_major_len(&result);
+    size_t m = format == LINSPARSE_CSR ? mat->cols : mat->rows;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < m; j++) {
+            realnum* value = format == LINSPARSE_CSR ? &mat->data[i * mat->cols + j] : &mat->data[j * mat->cols + i];
+            if (!linsparse_is_zero(value)) {
+                result.indices[result.nnz] = j;
+                result.values[result.nnz] = realnum_clone(value);
+                result.nnz++;
+            }
+        }
+        result.offsets[i + 1] = result.nnz;
+    }
+    return result;
+}
+
+linmatrix linsparse_to_dense(linsparse* mat) {
+    linmatrix result = linmatrix_new(mat->rows, mat->cols);
+    for (size_t i = 0; i < linsparse_major_len(mat); i++) {
+        for (size_t p = mat->offsets[i]; p < mat->offsets[i + 1]; p++) {
+            size_t row = mat->format == LINSPARSE_CSR ? i : mat->indices[p];
+            size_t col = mat->format == LINSPARSE_CSR ? mat->indices[p] : i;
+            result.data[row * mat->cols + col] = realnum_clone(&mat->values[p]);
+        }
+    }
+    return result;
+}
+
+linsparse linsparse_convert(linsparse* mat, linsparse_format format) {
+    linsparse result = linsparse_alloc(format, mat->rows, mat->cols, mat->nnz);
+    size_t n = linsparse_major_len(mat);
+    size_t m = linsparse_major_len(&result);
+    if (format == mat->format) {
+        memcpy(result.offsets, mat->offsets, (n + 1) * sizeof(size_t));
+        memcpy(result.indices, mat->indices, mat->nnz * sizeof(size_t));
+        for (size_t p = 0; p < mat->nnz; p++) {
+            result.values[p] = realnum_clone(&mat->values[p]);
+        }
+        result.nnz = mat->nnz;
+        return result;
+    }
+
+    // Counting transpose: walking the source in major order leaves every new
+    // row (column) sorted.
+    for (size_t p = 0; p < mat->nnz; p++) {
+        result.offsets[mat->indices[p] + 1]++;
+    }
+    for (size_t i = 0; i < m; i++) {
+        result.offsets[i + 1] += result.offsets[i];
+    }
+    size_t* cursor = malloc((m + 1) * sizeof(size_t));
+    memcpy(cursor, result.offsets, (m + 1) * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t p = mat->offsets[i]; p < mat->offsets[i + 1]; p++) {
+            size_t dst = cursor[mat->indices[p]]++;
+            result.indices[dst] = i;
+            result.values[dst] = realnum_clone(&mat->values[p]);
+        }
+    }
+    free(cursor);
+    result.nnz = mat->nnz;
+    return result;
+}
+
+void linsparse_free(linsparse* mat) {
+    for (size_t p = 0; p < mat->nnz; p++) {
+        realnum_free(&mat->values[p]);
+    }
+    free(mat->offsets);
+    free(mat->indices);
+    free(mat->values);
+    mat->offsets = NULL;
+    mat->indices = NULL;
+    mat->values = NULL;
+    mat->rows = 0;
+    mat->cols = 0;
+    mat->nnz = 0;
+}
+
+realnum linsparse_get(linsparse* mat, size_t row, size_t col) {
+    if (row >= mat->rows || col >= mat->cols) {
+        fprintf(stderr, "Error: index out of bounds.\n");
+        exit(1);
+    }
+    size_t major = mat->format == LINSPARSE_CSR ? row : col;
+    size_t minor = mat->format == LINSPARSE_CSR ? col : row;
+    size_t lo = mat->offsets[major];
+    size_t hi = mat->offsets[major + 1];
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (mat->indices[mid] < minor) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < mat->offsets[major + 1] && mat->indices[lo] == minor) {
+        return realnum_clone(&mat->values[lo]);
+    }
+    return realnum_new();
+}
+
+linvector linsparse_mul_vector(linsparse* mat, linvector* vec) {
+    if (mat->cols != vec->size) {
+        fprintf(stderr, "Error: the number of columns of the matrix must match the size of the vector.\n");
+        exit(1);
+    }
+    LINSTATS_KERNEL_BEGIN(mul);
+    linvector result = linvector_with_capacity(mat->rows);
+    for (size_t i = 0; i < mat->rows; i++) {
+        result.data[i] = realnum_new();
+    }
+    result.size = mat->rows;
+    if (mat->format == LINSPARSE_CSR) {
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, LINSPARSE_SCHEDULE_CHUNK) if (mat->nnz >= LINSPARSE_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = 0; i < mat->rows; i++) {
+            for (size_t p = mat->offsets[i]; p < mat->offsets[i + 1]; p++) {
+                linsparse_accumulate(&result.data[i], &mat->values[p], &vec->data[mat->indices[p]]);
+            }
+        }
+    } else {
+        for (size_t j = 0; j < mat->cols; j++) {
+            for (size_t p = mat->offsets[j]; p < mat->offsets[j + 1]; p++) {
+                linsparse_accumulate(&result.data[mat->indices[p]], &mat->values[p], &vec->data[j]);
+            }
+        }
+    }
+    LINSTATS_KERNEL_END(mul, LINSTATS_SPARSE_MUL);
+    return result;
+}
+
+linmatrix linsparse_mul_dense(linsparse* a, linmatrix* b) {
+    if (a->cols != b->rows) {
+        fprintf(stderr, "Error: the number of columns of the first matrix must match the number of rows of the second.\n");
+        exit(1);
+    }
+    size_t n = b->cols;
+    LINSTATS_KERNEL_BEGIN(mul);
+    linmatrix c = linmatrix_new(a->rows, n);
+    if (a->format == LINSPARSE_CSR) {
+        // Row i of C is the combination of the rows of B picked by row i of A.
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, LINSPARSE_SCHEDULE_CHUNK) if (a->nnz * n >= LINSPARSE_PARALLEL_THRESHOLD)
+        #endif
+        for (size_t i = 0; i < a->rows; i++) {
+            for (size_t p = a->offsets[i]; p < a->offsets[i + 1]; p++) {
+                realnum* b_row = &b->data[a->indices[p] * n];
+                for (size_t j = 0; j < n; j++) {
+                    linsparse_accumulate(&c.data[i * n + j], &a->values[p], &b_row[j]);
+                }
+            }
+        }
+    } else {
+        for (size_t k = 0; k < a->cols; k++) {
+            realnum* b_row = &b->data[k * n];
+            for (size_t p = a->offsets[k]; p < a->offsets[k + 1]; p++) {
+                realnum* c_row = &c.data[a->indices[p] * n];
+                for (size_t j = 0; j < n; j++) {
+                    linsparse_accumulate(&c_row[j], &a->values[p], &b_row[j]);
+                }
+            }
+        }
+    }
+    LINSTATS_KERNEL_END(mul, LINSTATS_SPARSE_MUL);
+    return c;
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include<string.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"../matrix/matrix.h"
+
+/**
+ * The compressed layouts a linsparse can be stored in.
+ */
+typedef enum linsparse_format {
+    LINSPARSE_CSR, // Compressed rows: fast row access, products parallelize over rows
+    LINSPARSE_CSC // Compressed columns: fast column access
+} linsparse_format;
+
+/**
+ * @struct linsparse_coo
+ * @brief A sparse matrix under construction, as a list of (row, col, value) triplets.
+ *
+ * Triplets can be pushed in any order and the same position may appear more
+ * than once, in which case the values are summed when the matrix is compressed
+ * with linsparse_from_coo. The builder owns the values pushed into it.
+ */
+typedef struct linsparse_coo {
+    size_t rows;
+    size_t cols;
+    size_t size;
+    size_t capacity;
+    size_t* row_indices;
+    size_t* col_indices;
+    realnum* values;
+} linsparse_coo;
+
+/**
+ * @struct linsparse
+ * @brief Represents a compressed sparse matrix.
+ *
+ * Only non-zero elements are stored. For LINSPARSE_CSR the elements of row i
+ * are `values[offsets[i]..offsets[i + 1]]` and `indices` holds their columns;
+ * for LINSPARSE_CSC the roles of rows and columns are swapped. The indices of
+ * every row (or column) are sorted and unique. The matrix owns its values.
+ */
+typedef struct linsparse {
+    linsparse_format format;
+    size_t rows;
+    size_t cols;
+    size_t nnz; /**< The number of stored elements. */
+    size_t* offsets; /**< One more entry than rows (CSR) or columns (CSC). */
+    size_t* indices;
+    realnum* values;
+} linsparse;
+
+/**
+ * Creates an empty triplet builder for a rows x cols matrix.
+ *
+ * @param rows The number of rows.
+ * @param cols The number of columns.
+ * @return The newly created builder.
+ */
+linsparse_coo linsparse_coo_new(size_t rows, size_t cols);
+
+/**
+ * Appends a triplet to the builder, which takes ownership of the value.
+ *
+ * @param coo The builder.
+ * @param row The row index.
+ * @param col The column index.
+ * @param value The value at (row, col), added to any earlier value there.
+ */
+void linsparse_coo_push(linsparse_coo* coo, size_t row, size_t col, realnum value);
+
+/**
+ * Frees the memory occupied by the given builder.
+ *
+ * @param coo The builder to free.
+ */
+void linsparse_coo_free(linsparse_coo* coo);
+
+/**
+ * Compresses the triplets of a builder, summing duplicates and dropping zeros.
+ *
+ * @param coo The builder, left untouched.
+ * @param format The layout of the result.
+ * @return The compressed matrix.
+ */
+linsparse linsparse_from_coo(linsparse_coo* coo, linsparse_format format);
+
+/**
+ * Creates a sparse matrix from the non-zero elements of a dense one.
+ *
+ * @param mat The dense matrix.
+ * @param format The layout of the result.
+ * @return The compressed matrix.
+ */
+linsparse linsparse_from_dense(linmatrix* mat, linsparse_format format);
+
+/**
+ * Creates a dense copy of a sparse matrix.
+ *
+ * @param mat The sparse matrix.
+ * @return The dense matrix.
+ */
+linmatrix linsparse_to_dense(linsparse* mat);
+
+/**
+ * Creates a copy of a sparse matrix in the given layout.
+ *
+ * @param mat The sparse matrix.
+ * @param format The layout of the result.
+ * @return The converted copy.
+ */
+linsparse linsparse_convert(linsparse* mat, linsparse_format format);
+
+/**
+ * Frees the memory occupied by the given sparse matrix.
+ *
+ * @param mat The sparse matrix to free.
+ */
+void linsparse_free(linsparse* mat);
+
+/**
+ * Returns a copy of the element at the given row and column.
+ *
+ * The row (CSR) or column (CSC) is binary searched, elements that are not
+ * stored are 0.
+ *
+ * @param mat The sparse matrix.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The element at (row, col).
+ */
+realnum linsparse_get(linsparse* mat, size_t row, size_t col);
+
+/**
+ * Multiplies a sparse matrix by a dense vector.
+ *
+ * CSR matrices compute one row per iteration and split the rows between
+ * threads when built with OpenMP; CSC matrices scatter column by column.
+ *
+ * @param mat The sparse matrix.
+ * @param vec The vector, with one element per column.
+ * @return The product, with one element per row.
+ */
+linvector linsparse_mul_vector(linsparse* mat, linvector* vec);
+
+/**
+ * Multiplies a sparse matrix by a dense matrix.
+ *
+ * Parallelized over the rows of the result like linsparse_mul_vector.
+ *
+ * @param a The sparse matrix.
+ * @param b The dense matrix, with one row per column of `a`.
+ * @return The dense product.
+ */
+linmatrix linsparse_mul_dense(linsparse* a, linmatrix* b);
@@ -0,0 +1,118 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include"./stats.h"
+#include<stdatomic.h>
+#include<time.h>
+
+static _Atomic uint64_t linstats_counts[LINSTATS_COUNTER_COUNT];
+static _Atomic uint64_t linstats_bytes[LINSTATS_COUNTER_COUNT];
+static _Atomic uint64_t linstats_calls[LINSTATS_KERNEL_COUNT];
+static _Atomic uint64_t linstats_nanoseconds[LINSTATS_KERNEL_COUNT];
+static linstats_trace_fn linstats_trace = NULL;
+static void* linstats_trace_user = NULL;
+
+static const char* const linstats_counter_names[LINSTATS_COUNTER_COUNT] = {
+    "aprox_promotion",
+    "frac_overflow",
+    "vector_alloc",
+    "vector_realloc",
+    "matrix_alloc",
+    "arena_alloc",
+    "arena_block",
+};
+
+static const char* const linstats_kernel_names[LINSTATS_KERNEL_COUNT] = {
+    "vector_dot",
+    "matrix_mul",
+    "matrix_transpose",
+    "matrix_lu",
+    "matrix_qr",
+    "matrix_cholesky",
+    "matrix_eigen",
+    "sparse_mul",
+    "lanczos",
+    "matrix_batch",
+};
+
+linstats linstats_snapshot(void) {
+    linstats stats;
+    for (size_t i = 0; i < LINSTATS_COUNTER_COUNT; i++) {
+        stats.counts[i] = atomic_load_explicit(&linstats_counts[i], memory_order_relaxed);
+        stats.bytes[i] = atomic_load_explicit(&linstats_bytes[i], memory_order_relaxed);
+    }
+    for (size_t i = 0; i < LINSTATS_KERNEL_COUNT; i++) {
+        stats.calls[i] = atomic_load_explicit(&linstats_calls[i], memory_order_relaxed);
+        stats.nanoseconds[i] = atomic_load_explicit(&linstats_nanoseconds[i], memory_order_relaxed);
+    }
+    return stats;
+}
+
+void linstats_reset(void) {
+    for (size_t i = 0; i < LINSTATS_COUNTER_COUNT; i++) {
+        atomic_store_explicit(&linstats_counts[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&linstats_bytes[i], 0, memory_order_relaxed);
+    }
+    for (size_t i = 0; i < LINSTATS_KERNEL_COUNT; i++) {
+        atomic_store_explicit(&linstats_calls[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&linstats_nanoseconds[i], 0, memory_order_relaxed);
+    }
+}
+
+void linstats_set_trace(linstats_trace_fn trace, void* user) {
+    linstats_trace = trace;
+    linstats_trace_user = user;
+}
+
+const char* linstats_counter_name(linstats_counter counter) {
+    return counter < LINSTATS_COUNTER_COUNT ? linstats_counter_names[counter] : "unknown";
+}
+
+const char* linstats_kernel_name(linstats_kernel kernel) {
+    return kernel < LINSTATS_KERNEL_COUNT ? linstats_kernel_names[kernel] : "unknown";
+}
+
+void linstats_print(linstats* stats, FILE* out) {
+    for (size_t i = 0; i < LINSTATS_COUNTER_COUNT; i++) {
+        if (stats->counts[i] != 0) {
+            fprintf(out, "%s: %llu (%llu bytes)\n", linstats_counter_names[i], (unsigned long long)stats->counts[i], (unsigned long long)stats->bytes[i]);
+        }
+    }
+    for (size_t i = 0; i < LINSTATS_KERNEL_COUNT; i++) {
+        if (stats->calls[i] != 0) {
+            fprintf(out, "%s: %llu calls, %.3f ms\n", linstats_kernel_names[i], (unsigned long long)stats->calls[i], (double)stats->nanoseconds[i] * 1e-6);
+        }
+    }
+}
+
+void linstats_record(linstats_counter counter, size_t bytes) {
+    atomic_fetch_add_explicit(&linstats_counts[counter], 1, memory_order_relaxed);
+    if (bytes != 0) {
+        atomic_fetch_add_explicit(&linstats_bytes[counter], bytes, memory_order_relaxed);
+    }
+}
+
+/*
+ * Reads a monotonic clock, so the durations survive adjustments of the wall
+ * clock. Only the last fallback is the wall clock.
+ */
+uint64_t linstats_now(void) {
+    struct timespec ts;
+#if defined(TIME_MONOTONIC)
+    timespec_get(&ts, TIME_MONOTONIC);
+#elif defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void linstats_kernel_done(linstats_kernel kernel, uint64_t start) {
+    uint64_t elapsed = linstats_now() - start;
+    atomic_fetch_add_explicit(&linstats_calls[kernel], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&linstats_nanoseconds[kernel], elapsed, memory_order_relaxed);
+    if (linstats_trace != NULL) {
+        linstats_trace(kernel, elapsed, linstats_trace_user);
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdio.h>
+
+/*
+ * Instrumentation of the hot paths, compiled in by defining LINALG_STATS to 1
+ * (`make STATS=1`). Without it every hook below expands to nothing, so a
+ * regular build pays no cost at all. The reading functions are always there
+ * and report zeros when the hooks were compiled out.
+ *
+ * Counters are updated with relaxed atomics, so they stay exact when the
+ * kernels run on several threads.
+ */
+#ifndef LINALG_STATS
+#define LINALG_STATS 0
+#endif
+
+/**
+ * @enum linstats_counter
+ * @brief The events that are counted, each with the bytes it allocated.
+ */
+typedef enum linstats_counter {
+    LINSTATS_APROX_PROMOTION, /**< An exact operand was approximated because the other one was. */
+    LINSTATS_FRAC_OVERFLOW, /**< A REALNUM_FRAC result or operand outgrew int64 and became a REALNUM_BIGFRAC. */
+    LINSTATS_VECTOR_ALLOC, /**< A linvector buffer was taken from malloc. */
+    LINSTATS_VECTOR_REALLOC, /**< A linvector buffer grew, through linvector_push or linvector_reserve. */
+    LINSTATS_MATRIX_ALLOC, /**< A linmatrix buffer was taken from malloc. */
+    LINSTATS_ARENA_ALLOC, /**< An allocation was carved from a linarena. */
+    LINSTATS_ARENA_BLOCK, /**< A linarena took a new block from malloc. */
+    LINSTATS_COUNTER_COUNT
+} linstats_counter;
+
+/**
+ * @enum linstats_kernel
+ * @brief The kernels whose calls are timed.
+ */
+typedef enum linstats_kernel {
+    LINSTATS_VECTOR_DOT, /**< linvector_view_dot and everything built on it. */
+    LINSTATS_MATRIX_MUL, /**< linmatrix_view_mul and everything built on it. */
+    LINSTATS_MATRIX_TRANSPOSE, /**< linmatrix_transpose and linmatrix_transpose_in_place. */
+    LINSTATS_MATRIX_LU, /**< linmatrix_lu_new and linmatrix_lu_in_place. */
+    LINSTATS_MATRIX_QR, /**< linmatrix_qr_new and linmatrix_qr_in_place. */
+    LINSTATS_MATRIX_CHOLESKY, /**< linmatrix_cholesky_new and linmatrix_cholesky_in_place. */
+    LINSTATS_MATRIX_EIGEN, /**< linmatrix_eigen_symmetric and everything built on it. */
+    LINSTATS_SPARSE_MUL, /**< The sparse matrix-vector and matrix-matrix products. */
+    LINSTATS_LANCZOS, /**< linoperator_eigen_top and linoperator_svd_top. */
+    LINSTATS_MATRIX_BATCH, /**< The batched products, factorizations and solves of linmatrix_batch. */
+    LINSTATS_KERNEL_COUNT
+} linstats_kernel;
+
+/**
+ * @struct linstats
+ * @brief A snapshot of everything recorded since the last linstats_reset.
+ */
+typedef struct linstats {
+    uint64_t counts[LINSTATS_COUNTER_COUNT]; /**< The number of events per counter. */
+    uint64_t bytes[LINSTATS_COUNTER_COUNT]; /**< The bytes allocated per counter. */
+    uint64_t calls[LINSTATS_KERNEL_COUNT]; /**< The number of calls per kernel. */
+    uint64_t nanoseconds[LINSTATS_KERNEL_COUNT]; /**< The total duration of the calls per kernel. */
+} linstats;
+
+/**
+ * A function called after every timed kernel call with its duration.
+ */
+typedef void (*linstats_trace_fn)(linstats_kernel kernel, uint64_t nanoseconds, void* user);
+
+/**
+ * Takes a snapshot of the statistics.
+ *
+ * @return The statistics recorded so far.
+ */
+linstats linstats_snapshot(void);
+
+/**
+ * Sets every statistic back to zero.
+ */
+void linstats_reset(void);
+
+/**
+ * Installs the function called after every timed kernel call, NULL to remove it.
+ *
+ * @param trace The function to call.
+ * @param user The pointer passed along to it.
+ */
+void linstats_set_trace(linstats_trace_fn trace, void* user);
+
+/**
+ * @param counter The counter.
+ * @return Its name, such as "vector_alloc".
+ */
+const char* linstats_counter_name(linstats_counter counter);
+
+/**
+ * @param kernel The kernel.
+ * @return Its name, such as "matrix_mul".
+ */
+const char* linstats_kernel_name(linstats_kernel kernel);
+
+/**
+ * Prints the non-zero statistics of a snapshot, one per line.
+ *
+ * @param stats The snapshot.
+ * @param out The stream to print to.
+ */
+void linstats_print(linstats* stats, FILE* out);
+
+/* The hooks the library calls, through the macros below. */
+void linstats_record(linstats_counter counter, size_t bytes);
+uint64_t linstats_now(void);
+void linstats_kernel_done(linstats_kernel kernel, uint64_t start);
+
+#if LINALG_STATS
+#define LINSTATS_COUNT(counter) linstats_record(counter, 0)
+#define LINSTATS_ALLOC(counter, bytes) linstats_record(counter, bytes)
+#define LINSTATS_KERNEL_BEGIN(name) uint64_t linstats_start_##name = linstats_now()
+#define LINSTATS_KERNEL_END(name, kernel) linstats_kernel_done(kernel, linstats_start_##name)
+#else
+#define LINSTATS_COUNT(counter) ((void)0)
+#define LINSTATS_ALLOC(counter, bytes) ((void)0)
+#define LINSTATS_KERNEL_BEGIN(name) ((void)0)
+#define LINSTATS_KERNEL_END(name, kernel) ((void)0)
+#endif
@@ -0,0 +1,284 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include"./storage.h"
+#include<stdio.h>
+#include<string.h>
+#if !defined(_WIN32)
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+/* Elements converted per write, so saving never copies a whole vector. */
+#ifndef LINSTORAGE_WRITE_CHUNK
+#define LINSTORAGE_WRITE_CHUNK 4096
+#endif
+
+// The elements start right after the header.
+_Static_assert(sizeof(linstorage_header) == LINSTORAGE_ALIGNMENT, "linstorage_header must fill one alignment unit");
+
+static linstorage_header linstorage_header_new(linstorage_shape shape, size_t rows, size_t cols) {
+    linstorage_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LINSTORAGE_MAGIC, sizeof(LINSTORAGE_MAGIC));
+    header.byte_order = LINSTORAGE_BYTE_ORDER;
+    header.version = LINSTORAGE_VERSION;
+    header.shape = (uint16_t)shape;
+    header.element = LINSTORAGE_REALNUM;
+    header.precision = REALNUM_APROX_PRECISION;
+    header.element_size = sizeof(realnum);
+    header.rows = rows;
+    header.cols = cols;
+    header.data_offset = LINSTORAGE_ALIGNMENT;
+    return header;
+}
+
+/*
+ * Returns the index of the first element that is not a self-contained number,
+ * such as a heap pointer or a fraction over zero, or `end` when there is none.
+ */
+static size_t linstorage_find_invalid(realnum* data, size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+        bool valid = data[i].kind == REALNUM_APROX || (data[i].kind == REALNUM_FRAC && data[i].value.frac.den != 0);
+        if (!valid) {
+            return i;
+        }
+    }
+    return end;
+}
+
+/*
+ * Writes the elements through a zeroed buffer, so the padding of the structs
+ * is written as zeros. Elements that cannot be stored are refused before the
+ * file is touched.
+ */
+static void linstorage_save(linstorage_shape shape, realnum* data, size_t rows, size_t cols, const char* path) {
+    size_t size = rows * cols;
+    size_t invalid = linstorage_find_invalid(data, 0, size);
+    if (invalid != size) {
+        fprintf(stderr, "Error: the element at %zu cannot be stored in %s, approximate it first.\n", invalid, path);
+        exit(1);
+    }
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: could not open %s for writing.\n", path);
+        exit(1);
+    }
+    linstorage_header header = linstorage_header_new(shape, rows, cols);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    realnum* buffer = malloc(LINSTORAGE_WRITE_CHUNK * sizeof(realnum));
+    for (size_t start = 0; ok && start < size; start += LINSTORAGE_WRITE_CHUNK) {
+        size_t count = size - start < LINSTORAGE_WRITE_CHUNK ? size - start : LINSTORAGE_WRITE_CHUNK;
+        memset(buffer, 0, count * sizeof(realnum));
+        for (size_t i = 0; i < count; i++) {
+            realnum* src = &data[start + i];
+            buffer[i].kind = src->kind;
+            if (src->kind == REALNUM_FRAC) {
+                buffer[i].value.frac.num = src->value.frac.num;
+                buffer[i].value.frac.den = src->value.frac.den;
+            } else {
+                buffer[i].value.aprox = src->value.aprox;
+            }
+        }
+        ok = fwrite(buffer, sizeof(realnum), count, file) == count;
+    }
+    free(buffer);
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Error: could not write %s.\n", path);
+        exit(1);
+    }
+}
+
+void linstorage_save_vector(linvector* vec, const char* path) {
+    linstorage_save(LINSTORAGE_VECTOR, vec->data, vec->size, 1, path);
+}
+
+void linstorage_save_matrix(linmatrix* mat, const char* path) {
+    linstorage_save(LINSTORAGE_MATRIX, mat->data, mat->rows, mat->cols, path);
+}
+
+/*
+ * Checks that a header describes a file of `length` bytes this build can use
+ * in place and returns the number of elements.
+ */
+static size_t linstorage_check_header(linstorage_header* header, size_t length, const char* path) {
+    const char* problem = NULL;
+    if (length < sizeof(linstorage_header) || memcmp(header->magic, LINSTORAGE_MAGIC, sizeof(LINSTORAGE_MAGIC)) != 0) {
+        problem = "is not a linstorage file";
+    } else if (header->byte_order != LINSTORAGE_BYTE_ORDER) {
+        problem = "was written with another byte order";
+    } else if (header->version != LINSTORAGE_VERSION) {
+        problem = "has an unsupported version";
+    } else if (header->shape != LINSTORAGE_VECTOR && header->shape != LINSTORAGE_MATRIX) {
+        problem = "holds an unknown shape";
+    } else if (header->element != LINSTORAGE_REALNUM || header->element_size != sizeof(realnum)) {
+        problem = "holds elements of another layout";
+    } else if (header->precision != REALNUM_APROX_PRECISION) {
+        problem = "was written with another REALNUM_APROX_PRECISION";
+    } else if (header->data_offset % LINSTORAGE_ALIGNMENT != 0 || header->data_offset < sizeof(linstorage_header)) {
+        problem = "has misaligned elements";
+    } else if (header->cols != 0 && header->rows > SIZE_MAX / sizeof(realnum) / header->cols) {
+        problem = "is too large";
+    } else if (length < header->data_offset || (length - header->data_offset) / sizeof(realnum) < header->rows * header->cols) {
+        problem = "is truncated";
+    }
+    if (problem != NULL) {
+        fprintf(stderr, "Error: %s %s.\n", path, problem);
+        exit(1);
+    }
+    return header->rows * header->cols;
+}
+
+static void linstorage_check_elements(realnum* data, size_t size, const char* path) {
+    size_t invalid = linstorage_find_invalid(data, 0, size);
+    if (invalid != size) {
+        fprintf(stderr, "Error: %s holds an invalid element at %zu.\n", path, invalid);
+        exit(1);
+    }
+}
+
+/* The length of a file, through the 64-bit offsets of Windows where long has 32 bits. */
+static size_t linstorage_length(FILE* file, const char* path) {
+#if defined(_WIN32)
+    bool ok = _fseeki64(file, 0, SEEK_END) == 0;
+    int64_t length = ok ? _ftelli64(file) : -1;
+#else
+    bool ok = fseeko(file, 0, SEEK_END) == 0;
+    int64_t length = ok ? (int64_t)ftello(file) : -1;
+#endif
+    if (length < 0) {
+        fprintf(stderr, "Error: could not read %s.\n", path);
+        exit(1);
+    }
+    rewind(file);
+    return (size_t)length;
+}
+
+/* Reads the elements of a file into `*data`, allocated with malloc. */
+static linstorage_header linstorage_load(const char* path, realnum** data) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: could not open %s for reading.\n", path);
+        exit(1);
+    }
+    size_t length = linstorage_length(file, path);
+    linstorage_header header;
+    memset(&header, 0, sizeof(header));
+    if (length >= sizeof(header) && fread(&header, sizeof(header), 1, file) != 1) {
+        length = 0;
+    }
+    size_t size = linstorage_check_header(&header, length, path);
+    *data = malloc((size ? size : 1) * sizeof(realnum));
+    bool ok = fseek(file, (long)header.data_offset, SEEK_SET) == 0 && fread(*data, sizeof(realnum), size, file) == size;
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "Error: could not read %s.\n", path);
+        exit(1);
+    }
+    linstorage_check_elements(*data, size, path);
+    return header;
+}
+
+linvector linstorage_load_vector(const char* path) {
+    realnum* data;
+    linstorage_header header = linstorage_load(path, &data);
+    if (header.shape != LINSTORAGE_VECTOR) {
+        fprintf(stderr, "Error: %s does not hold a vector.\n", path);
+        exit(1);
+    }
+    return linvector_with_data(data, header.rows);
+}
+
+linmatrix linstorage_load_matrix(const char* path) {
+    realnum* data;
+    linstorage_header header = linstorage_load(path, &data);
+    if (header.shape != LINSTORAGE_MATRIX) {
+        fprintf(stderr, "Error: %s does not hold a matrix.\n", path);
+        exit(1);
+    }
+    return linmatrix_with_data(data, header.rows, header.cols);
+}
+
+linstorage_map linstorage_map_open(const char* path) {
+    linstorage_map map;
+#if defined(_WIN32)
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: could not open %s for reading.\n", path);
+        exit(1);
+    }
+    map.length = linstorage_length(file, path);
+    map.base = malloc(map.length ? map.length : 1);
+    bool ok = fread(map.base, 1, map.length, file) == map.length;
+    fclose(file);
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "Error: could not open %s for reading.\n", path);
+        exit(1);
+    }
+    map.length = (size_t)st.st_size;
+    map.base = map.length ? mmap(NULL, map.length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : NULL;
+    bool ok = map.base != MAP_FAILED;
+    close(fd);
+#endif
+    if (!ok) {
+        fprintf(stderr, "Error: could not map %s.\n", path);
+        exit(1);
+    }
+    memset(&map.header, 0, sizeof(map.header));
+    if (map.length >= sizeof(map.header)) {
+        memcpy(&map.header, map.base, sizeof(map.header));
+    }
+    linstorage_check_header(&map.header, map.length, path);
+    return map;
+}
+
+bool linstorage_map_check(linstorage_map* map, size_t start, size_t count) {
+    size_t size = map->header.rows * map->header.cols;
+    if (start > size || count > size - start) {
+        return false;
+    }
+    realnum* data = (realnum*)((unsigned char*)map->base + map->header.data_offset);
+    return linstorage_find_invalid(data, start, start + count) == start + count;
+}
+
+linvector_view linstorage_map_vector(linstorage_map* map) {
+    if (map->header.shape != LINSTORAGE_VECTOR) {
+        fprintf(stderr, "Error: the mapped file does not hold a vector.\n");
+        exit(1);
+    }
+    linvector_view view;
+    view.size = map->header.rows;
+    view.stride = 1;
+    view.data = (realnum*)((unsigned char*)map->base + map->header.data_offset);
+    return view;
+}
+
+linmatrix_view linstorage_map_matrix(linstorage_map* map) {
+    linmatrix_view view;
+    view.rows = map->header.rows;
+    view.cols = map->header.cols;
+    view.row_stride = map->header.cols;
+    view.col_stride = 1;
+    view.data = (realnum*)((unsigned char*)map->base + map->header.data_offset);
+    return view;
+}
+
+void linstorage_map_close(linstorage_map* map) {
+#if defined(_WIN32)
+    free(map->base);
+#else
+    if (map->base != NULL) {
+        munmap(map->base, map->length);
+    }
+#endif
+    map->base = NULL;
+    map->length = 0;
+}
+
+#undef LINSTORAGE_WRITE_CHUNK
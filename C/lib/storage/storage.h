@@ -0,0 +1,168 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"../matrix/matrix.h"
+
+/*
+ * Binary storage of vectors and matrices.
+ *
+ * A file is a 64-byte linstorage_header followed, at `data_offset`, by the
+ * elements in row-major order exactly as they are laid out in memory, so a
+ * file can be mapped and its elements used in place. Files are only portable
+ * between builds with the same byte order, element layout and
+ * REALNUM_APROX_PRECISION, all of which the header records and the readers
+ * check.
+ *
+ * REALNUM_BIGFRAC elements live on the heap and cannot be stored, nor can
+ * fractions over zero; saving either is an error, so a vector that is saved
+ * and loaded back is always unchanged.
+ */
+#define LINSTORAGE_MAGIC "LINALGB"
+#define LINSTORAGE_VERSION 1
+#define LINSTORAGE_BYTE_ORDER 0x01020304u
+#define LINSTORAGE_ALIGNMENT 64
+
+/**
+ * @enum linstorage_shape
+ * @brief What a file holds.
+ */
+typedef enum linstorage_shape {
+    LINSTORAGE_VECTOR = 1, /**< A vector of `rows` elements, `cols` is 1. */
+    LINSTORAGE_MATRIX = 2
+} linstorage_shape;
+
+/**
+ * @enum linstorage_element
+ * @brief The in-memory layout the elements of a file were written in.
+ */
+typedef enum linstorage_element {
+    LINSTORAGE_REALNUM = 1, /**< The realnum struct of this library. */
+    LINSTORAGE_LINNUM = 2 /**< The LinNum of the Rust crate. */
+} linstorage_element;
+
+/**
+ * @struct linstorage_header
+ * @brief The first 64 bytes of a file.
+ */
+typedef struct linstorage_header {
+    char magic[8]; /**< LINSTORAGE_MAGIC, NUL terminated. */
+    uint32_t byte_order; /**< LINSTORAGE_BYTE_ORDER in the byte order of the writer. */
+    uint16_t version; /**< LINSTORAGE_VERSION. */
+    uint16_t shape; /**< A linstorage_shape. */
+    uint16_t element; /**< A linstorage_element. */
+    uint16_t precision; /**< The REALNUM_APROX_PRECISION of the writer. */
+    uint32_t element_size; /**< The size of one element in bytes. */
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t data_offset; /**< Where the elements start, a multiple of LINSTORAGE_ALIGNMENT. */
+    uint64_t reserved[2]; /**< Zero. */
+} linstorage_header;
+
+/**
+ * @struct linstorage_map
+ * @brief A file mapped into memory.
+ *
+ * The mapping is private: elements written through the views change the
+ * mapped pages but never the file.
+ */
+typedef struct linstorage_map {
+    linstorage_header header;
+    void* base; /**< The start of the mapping. */
+    size_t length; /**< The length of the mapping in bytes. */
+} linstorage_map;
+
+/**
+ * Writes a vector to a file, replacing it.
+ *
+ * Exits with an error, before the file is opened, if an element is a
+ * REALNUM_BIGFRAC or a fraction over zero.
+ *
+ * @param vec The vector to write.
+ * @param path The path of the file.
+ */
+void linstorage_save_vector(linvector* vec, const char* path);
+
+/**
+ * Writes a matrix to a file, replacing it.
+ *
+ * Exits with an error, before the file is opened, if an element is a
+ * REALNUM_BIGFRAC or a fraction over zero.
+ *
+ * @param mat The matrix to write.
+ * @param path The path of the file.
+ */
+void linstorage_save_matrix(linmatrix* mat, const char* path);
+
+/**
+ * Reads a vector file into a new linvector with a single read.
+ *
+ * Every element is checked as linstorage_map_check does.
+ *
+ * @param path The path of the file.
+ * @return The vector.
+ */
+linvector linstorage_load_vector(const char* path);
+
+/**
+ * Reads a matrix file into a new linmatrix with a single read.
+ *
+ * Every element is checked as linstorage_map_check does.
+ *
+ * @param path The path of the file.
+ * @return The matrix.
+ */
+linmatrix linstorage_load_matrix(const char* path);
+
+/**
+ * Maps a vector or matrix file into memory without reading it.
+ *
+ * Only the header is read and checked; pages of elements are read once they
+ * are accessed. The elements themselves are trusted: files that may not come
+ * from linstorage_save_vector or linstorage_save_matrix should be checked with
+ * linstorage_map_check, over the range that is about to be used, before any
+ * kernel reads them. Where mmap is not available the file is read into memory
+ * instead.
+ *
+ * @param path The path of the file.
+ * @return The mapping, to be closed with linstorage_map_close.
+ */
+linstorage_map linstorage_map_open(const char* path);
+
+/**
+ * Checks that a range of mapped elements are all a REALNUM_APROX or a
+ * REALNUM_FRAC with a non-zero denominator. Only the pages of the range are read.
+ *
+ * @param map The mapping.
+ * @param start The index of the first element to check, in row-major order.
+ * @param count The number of elements to check.
+ * @return false if an element is invalid or the range is past the end.
+ */
+bool linstorage_map_check(linstorage_map* map, size_t start, size_t count);
+
+/**
+ * Returns a view of the elements of a mapped vector file.
+ *
+ * @param map The mapping.
+ * @return The view, valid until the mapping is closed.
+ */
+linvector_view linstorage_map_vector(linstorage_map* map);
+
+/**
+ * Returns a view of the elements of a mapped file as a matrix. A vector file
+ * is a single column.
+ *
+ * @param map The mapping.
+ * @return The view, valid until the mapping is closed.
+ */
+linmatrix_view linstorage_map_matrix(linstorage_map* map);
+
+/**
+ * Unmaps a file.
+ *
+ * @param map The mapping to close.
+ */
+void linstorage_map_close(linstorage_map* map);
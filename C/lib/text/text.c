@@ -0,0 +1,412 @@
+#include"./text.h"
+#include<string.h>
+#include<math.h>
+
+/*
+ * The significant digits tried for an approximation: the short count reads
+ * back most values that came from decimal text, the long one reads back every
+ * value of the precision.
+ */
+#if REALNUM_APROX_PRECISION == 32
+#define SHORT_DIGITS 6
+#define LONG_DIGITS 9
+#elif REALNUM_APROX_PRECISION == 64
+#define SHORT_DIGITS 15
+#define LONG_DIGITS 17
+#elif REALNUM_APROX_PRECISION == 80
+#define SHORT_DIGITS 18
+#define LONG_DIGITS 21
+#else
+#define SHORT_DIGITS 33
+#define LONG_DIGITS 36
+#endif
+
+/*
+ * Where formatted text goes: the caller's buffer, or a chunk that is flushed to
+ * a stream whenever it fills up.
+ */
+typedef struct lintext_out {
+    FILE* file; /* NULL when writing to the caller's buffer. */
+    char* buf;
+    size_t capacity;
+    size_t used;
+    size_t total; /* The length of everything put so far. */
+} lintext_out;
+
+static void lintext_flush(lintext_out* out) {
+    if (out->used != 0 && fwrite(out->buf, 1, out->used, out->file) != out->used) {
+        fprintf(stderr, "Error: could not write the text.\n");
+        exit(1);
+    }
+    out->used = 0;
+}
+
+static void lintext_put(lintext_out* out, const char* s, size_t n) {
+    out->total += n;
+    if (out->file == NULL) {
+        // Keep one byte for the NUL and drop whatever does not fit.
+        size_t room = out->capacity > out->used + 1 ? out->capacity - out->used - 1 : 0;
+        n = n < room ? n : room;
+        if (n == 0) {
+            return;
+        }
+    } else if (out->used + n > out->capacity) {
+        lintext_flush(out);
+        // A token larger than the chunk bypasses it.
+        if (n > out->capacity) {
+            if (fwrite(s, 1, n, out->file) != n) {
+                fprintf(stderr, "Error: could not write the text.\n");
+                exit(1);
+            }
+            return;
+        }
+    }
+    memcpy(out->buf + out->used, s, n);
+    out->used += n;
+}
+
+static size_t lintext_format_int(int64_t value, char* out) {
+    char digits[20];
+    uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+    size_t count = 0;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    size_t length = 0;
+    if (value < 0) {
+        out[length++] = '-';
+    }
+    while (count > 0) {
+        out[length++] = digits[--count];
+    }
+    return length;
+}
+
+static size_t lintext_print_aprox(realnum_aprox value, int digits, char* out) {
+#if REALNUM_APROX_PRECISION == 128
+    return (size_t)quadmath_snprintf(out, LINTEXT_MAX_TOKEN, "%.*Qg", digits, value);
+#elif REALNUM_APROX_PRECISION == 80
+    return (size_t)snprintf(out, LINTEXT_MAX_TOKEN, "%.*Lg", digits, value);
+#else
+    return (size_t)snprintf(out, LINTEXT_MAX_TOKEN, "%.*g", digits, (double)value);
+#endif
+}
+
+static realnum_aprox lintext_scan_aprox(const char* s, char** end) {
+#if REALNUM_APROX_PRECISION == 128
+    return strtoflt128(s, end);
+#elif REALNUM_APROX_PRECISION == 80
+    return strtold(s, end);
+#elif REALNUM_APROX_PRECISION == 64
+    return strtod(s, end);
+#else
+    return strtof(s, end);
+#endif
+}
+
+static size_t lintext_format_aprox(realnum_aprox value, char* out) {
+    size_t length = lintext_print_aprox(value, SHORT_DIGITS, out);
+    if (lintext_scan_aprox(out, NULL) != value) {
+        length = lintext_print_aprox(value, LONG_DIGITS, out);
+    }
+    // An integral value needs a point to read back as an approximation.
+    if (strpbrk(out, ".einIN") == NULL) {
+        out[length++] = '.';
+        out[length++] = '0';
+        out[length] = '\0';
+    }
+    return length;
+}
+
+/* Puts one element, through a scratch buffer of LINTEXT_MAX_TOKEN bytes. */
+static void lintext_put_realnum(lintext_out* out, realnum* num, char* scratch) {
+    size_t length;
+    if (num->kind == REALNUM_FRAC) {
+        length = lintext_format_int(num->value.frac.num, scratch);
+        if (num->value.frac.den != 1) {
+            scratch[length++] = '/';
+            length += lintext_format_int(num->value.frac.den, scratch + length);
+        }
+    } else if (num->kind == REALNUM_BIGFRAC) {
+        linbigint* den = &num->value.bigfrac->den;
+        bool integer = den->size == 1 && den->limbs[0] == 1;
+        size_t num_length = linbigint_format(&num->value.bigfrac->num, NULL, 0);
+        size_t den_length = integer ? 0 : linbigint_format(den, NULL, 0);
+        char* text = malloc(num_length + den_length + 2);
+        linbigint_format(&num->value.bigfrac->num, text, num_length + 1);
+        length = num_length;
+        if (!integer) {
+            text[length++] = '/';
+            length += linbigint_format(den, text + length, den_length + 1);
+        }
+        lintext_put(out, text, length);
+        free(text);
+        return;
+    } else {
+        length = lintext_format_aprox(num->value.aprox, scratch);
+    }
+    lintext_put(out, scratch, length);
+}
+
+static void lintext_put_row(lintext_out* out, realnum* data, size_t size, char sep) {
+    char scratch[LINTEXT_MAX_TOKEN];
+    for (size_t i = 0; i < size; i++) {
+        if (i != 0) {
+            lintext_put(out, &sep, 1);
+        }
+        lintext_put_realnum(out, &data[i], scratch);
+    }
+    lintext_put(out, "\n", 1);
+}
+
+static lintext_out lintext_to_buffer(char* buf, size_t capacity) {
+    return (lintext_out){NULL, buf, capacity, 0, 0};
+}
+
+static size_t lintext_finish_buffer(lintext_out* out) {
+    if (out->capacity != 0) {
+        out->buf[out->used] = '\0';
+    }
+    return out->total;
+}
+
+static lintext_out lintext_to_file(FILE* file) {
+    return (lintext_out){file, malloc(LINTEXT_CHUNK), LINTEXT_CHUNK, 0, 0};
+}
+
+static void lintext_finish_file(lintext_out* out) {
+    lintext_flush(out);
+    free(out->buf);
+}
+
+size_t lintext_format_realnum(realnum* num, char* buf, size_t capacity) {
+    char scratch[LINTEXT_MAX_TOKEN];
+    lintext_out out = lintext_to_buffer(buf, capacity);
+    lintext_put_realnum(&out, num, scratch);
+    return lintext_finish_buffer(&out);
+}
+
+size_t lintext_format_vector(linvector* vec, char sep, char* buf, size_t capacity) {
+    lintext_out out = lintext_to_buffer(buf, capacity);
+    lintext_put_row(&out, vec->data, vec->size, sep);
+    return lintext_finish_buffer(&out);
+}
+
+size_t lintext_format_matrix(linmatrix* mat, char sep, char* buf, size_t capacity) {
+    lintext_out out = lintext_to_buffer(buf, capacity);
+    for (size_t i = 0; i < mat->rows; i++) {
+        lintext_put_row(&out, &mat->data[i * mat->cols], mat->cols, sep);
+    }
+    return lintext_finish_buffer(&out);
+}
+
+void lintext_write_vector(linvector* vec, char sep, FILE* file) {
+    lintext_out out = lintext_to_file(file);
+    lintext_put_row(&out, vec->data, vec->size, sep);
+    lintext_finish_file(&out);
+}
+
+void lintext_write_matrix(linmatrix* mat, char sep, FILE* file) {
+    lintext_out out = lintext_to_file(file);
+    for (size_t i = 0; i < mat->rows; i++) {
+        lintext_put_row(&out, &mat->data[i * mat->cols], mat->cols, sep);
+    }
+    lintext_finish_file(&out);
+}
+
+static bool lintext_is_separator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '[' || c == ']' || c == '\r';
+}
+
+static void lintext_invalid(const char* token, size_t length, size_t line, size_t field) {
+    fprintf(stderr, "Error: invalid number \"%.*s\" at line %zu, field %zu.\n", (int)length, token, line, field);
+    exit(1);
+}
+
+/*
+ * Reads the digits at the start of s as a magnitude of at most `limit`.
+ * Returns the number of digits, 0 when there are none or they overflow.
+ */
+static size_t lintext_scan_digits(const char* s, size_t length, uint64_t limit, uint64_t* value) {
+    uint64_t v = 0;
+    size_t i = 0;
+    while (i < length && s[i] >= '0' && s[i] <= '9') {
+        uint64_t digit = (uint64_t)(s[i] - '0');
+        if (v > (limit - digit) / 10) {
+            return 0;
+        }
+        v = v * 10 + digit;
+        i++;
+    }
+    *value = v;
+    return i;
+}
+
+static size_t lintext_count_digits(const char* s, size_t length) {
+    size_t i = 0;
+    while (i < length && s[i] >= '0' && s[i] <= '9') {
+        i++;
+    }
+    return i;
+}
+
+/*
+ * Parses the digits of an integer or fraction, inline when both terms fit in
+ * int64 and through linbigint otherwise.
+ */
+static realnum lintext_parse_exact(const char* n, size_t n_length, bool negative, const char* d, size_t d_length, bool* valid) {
+    uint64_t num;
+    uint64_t den = 1;
+    *valid = true;
+    if (lintext_scan_digits(n, n_length, negative ? (uint64_t)INT64_MAX + 1 : INT64_MAX, &num) == n_length &&
+        (d_length == 0 || lintext_scan_digits(d, d_length, INT64_MAX, &den) == d_length)) {
+        *valid = den != 0;
+        return realnum_from_frac(negative ? (int64_t)(0 - num) : (int64_t)num, (int64_t)den);
+    }
+    linbigint big_num = linbigint_parse(n, n_length);
+    linbigint big_den = d_length == 0 ? linbigint_from_i128(1) : linbigint_parse(d, d_length);
+    big_num.negative = negative && !linbigint_is_zero(&big_num);
+    if (linbigint_is_zero(&big_den)) {
+        linbigint_free(&big_num);
+        linbigint_free(&big_den);
+        *valid = false;
+        return realnum_new();
+    }
+    return realnum_from_bigfrac(big_num, big_den);
+}
+
+/* Parses one element, exact when it is an integer or fraction. */
+static realnum lintext_parse_token(const char* s, size_t length, size_t line, size_t field) {
+    size_t i = 0;
+    bool negative = s[0] == '-';
+    if (s[0] == '-' || s[0] == '+') {
+        i++;
+    }
+    size_t digits = lintext_count_digits(s + i, length - i);
+    if (digits != 0 && (i + digits == length || s[i + digits] == '/')) {
+        const char* den = s + i + digits + 1;
+        size_t den_digits = 0;
+        if (i + digits != length) {
+            den_digits = lintext_count_digits(den, length - i - digits - 1);
+            if (den_digits == 0 || i + digits + 1 + den_digits != length) {
+                lintext_invalid(s, length, line, field);
+            }
+        }
+        bool valid;
+        realnum result = lintext_parse_exact(s + i, digits, negative, den, den_digits, &valid);
+        if (!valid) {
+            lintext_invalid(s, length, line, field);
+        }
+        return result;
+    }
+    if (length >= LINTEXT_MAX_TOKEN) {
+        lintext_invalid(s, length, line, field);
+    }
+    char token[LINTEXT_MAX_TOKEN];
+    memcpy(token, s, length);
+    token[length] = '\0';
+    char* end;
+    realnum_aprox value = lintext_scan_aprox(token, &end);
+    if (end != token + length) {
+        lintext_invalid(s, length, line, field);
+    }
+    return realnum_from_aprox(value);
+}
+
+/*
+ * Parses every element of the text into a growing array. With `rows` it also
+ * checks the text is a rectangle of lines and reports its shape.
+ */
+static realnum* lintext_parse(const char* text, size_t length, size_t* size, size_t* rows, size_t* cols) {
+    size_t capacity = LINVECTOR_DEFAULT_CAPACITY;
+    realnum* data = malloc(capacity * sizeof(realnum));
+    size_t count = 0;
+    size_t line = 1;
+    size_t field = 0;
+    if (rows != NULL) {
+        *rows = 0;
+        *cols = 0;
+    }
+    for (size_t i = 0; i <= length; i++) {
+        if (i == length || text[i] == '\n') {
+            if (rows != NULL && field != 0) {
+                if (*rows != 0 && field != *cols) {
+                    fprintf(stderr, "Error: line %zu has %zu elements instead of %zu.\n", line, field, *cols);
+                    exit(1);
+                }
+                *cols = field;
+                (*rows)++;
+            }
+            line++;
+            field = 0;
+            continue;
+        }
+        if (lintext_is_separator(text[i])) {
+            continue;
+        }
+        size_t start = i;
+        while (i < length && text[i] != '\n' && !lintext_is_separator(text[i])) {
+            i++;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity * sizeof(realnum));
+        }
+        data[count++] = lintext_parse_token(text + start, i - start, line, ++field);
+        i--;
+    }
+    *size = count;
+    return data;
+}
+
+linvector lintext_parse_vector(const char* text, size_t length) {
+    size_t size;
+    realnum* data = lintext_parse(text, length, &size, NULL, NULL);
+    return linvector_with_data(data, size);
+}
+
+linmatrix lintext_parse_matrix(const char* text, size_t length) {
+    size_t size;
+    size_t rows;
+    size_t cols;
+    realnum* data = lintext_parse(text, length, &size, &rows, &cols);
+    return linmatrix_with_data(data, rows, cols);
+}
+
+/* Reads a whole stream into a malloc'd buffer. */
+static char* lintext_slurp(FILE* in, size_t* length) {
+    size_t capacity = LINTEXT_CHUNK;
+    char* text = malloc(capacity);
+    size_t used = 0;
+    size_t n;
+    while ((n = fread(text + used, 1, capacity - used, in)) > 0) {
+        used += n;
+        if (used == capacity) {
+            capacity *= 2;
+            text = realloc(text, capacity);
+        }
+    }
+    if (ferror(in)) {
+        fprintf(stderr, "Error: could not read the text.\n");
+        exit(1);
+    }
+    *length = used;
+    return text;
+}
+
+linvector lintext_read_vector(FILE* in) {
+    size_t length;
+    char* text = lintext_slurp(in, &length);
+    linvector vec = lintext_parse_vector(text, length);
+    free(text);
+    return vec;
+}
+
+linmatrix lintext_read_matrix(FILE* in) {
+    size_t length;
+    char* text = lintext_slurp(in, &length);
+    linmatrix mat = lintext_parse_matrix(text, length);
+    free(text);
+    return mat;
+}
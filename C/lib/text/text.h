@@ -0,0 +1,117 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include<stdio.h>
+#include"../numeric/realnum.h"
+#include"../vector/vector.h"
+#include"../matrix/matrix.h"
+
+/*
+ * Bulk text formatting and parsing of vectors and matrices.
+ *
+ * Elements are written as the shortest text that parses back to the same
+ * value: "n" or "n/d" for exact numbers, and for approximations as few digits
+ * as REALNUM_APROX_PRECISION allows, always with a '.', an exponent or
+ * inf/nan so they read back as approximations. Matrices are written one row
+ * per line. Output is collected in chunks of LINTEXT_CHUNK bytes, so a
+ * FILE* sees one fwrite per chunk instead of one printf per element.
+ *
+ * The parsers accept elements separated by any mix of spaces, tabs, commas,
+ * semicolons and brackets, so CSV, whitespace separated text and the output
+ * of linmatrix_print all read back. Integers and "n/d" become exact numbers,
+ * REALNUM_BIGFRAC when their terms are beyond int64, and everything else an
+ * approximation.
+ */
+#ifndef LINTEXT_CHUNK
+#define LINTEXT_CHUNK (64 * 1024)
+#endif
+/* The longest element the parsers accept, in characters. */
+#define LINTEXT_MAX_TOKEN 128
+
+/**
+ * Formats a realnum, like snprintf.
+ *
+ * @param num The number to format.
+ * @param buf The buffer to write to, NUL terminated when `capacity` is not 0.
+ * @param capacity The size of the buffer.
+ * @return The length of the full text, which was truncated if it is not below `capacity`.
+ */
+size_t lintext_format_realnum(realnum* num, char* buf, size_t capacity);
+
+/**
+ * Formats a vector as one line of elements separated by `sep`, like snprintf.
+ *
+ * @param vec The vector to format.
+ * @param sep The separator, such as ' ' or ','.
+ * @param buf The buffer to write to, NUL terminated when `capacity` is not 0.
+ * @param capacity The size of the buffer.
+ * @return The length of the full text, which was truncated if it is not below `capacity`.
+ */
+size_t lintext_format_vector(linvector* vec, char sep, char* buf, size_t capacity);
+
+/**
+ * Formats a matrix as one line per row of elements separated by `sep`, like
+ * snprintf.
+ *
+ * @param mat The matrix to format.
+ * @param sep The separator, such as ' ' or ','.
+ * @param buf The buffer to write to, NUL terminated when `capacity` is not 0.
+ * @param capacity The size of the buffer.
+ * @return The length of the full text, which was truncated if it is not below `capacity`.
+ */
+size_t lintext_format_matrix(linmatrix* mat, char sep, char* buf, size_t capacity);
+
+/**
+ * Writes a vector to a stream as lintext_format_vector formats it.
+ *
+ * @param vec The vector to write.
+ * @param sep The separator, such as ' ' or ','.
+ * @param out The stream to write to.
+ */
+void lintext_write_vector(linvector* vec, char sep, FILE* out);
+
+/**
+ * Writes a matrix to a stream as lintext_format_matrix formats it.
+ *
+ * @param mat The matrix to write.
+ * @param sep The separator, such as ' ' or ','.
+ * @param out The stream to write to.
+ */
+void lintext_write_matrix(linmatrix* mat, char sep, FILE* out);
+
+/**
+ * Parses every element of a text as one vector, whatever the lines.
+ *
+ * @param text The text, which does not need to be NUL terminated.
+ * @param length The length of the text.
+ * @return The vector.
+ */
+linvector lintext_parse_vector(const char* text, size_t length);
+
+/**
+ * Parses a text with one row per line into a matrix. Blank lines are skipped
+ * and every other line must have the same number of elements.
+ *
+ * @param text The text, which does not need to be NUL terminated.
+ * @param length The length of the text.
+ * @return The matrix.
+ */
+linmatrix lintext_parse_matrix(const char* text, size_t length);
+
+/**
+ * Reads a stream to its end and parses it with lintext_parse_vector.
+ *
+ * @param in The stream to read.
+ * @return The vector.
+ */
+linvector lintext_read_vector(FILE* in);
+
+/**
+ * Reads a stream to its end and parses it with lintext_parse_matrix.
+ *
+ * @param in The stream to read.
+ * @return The matrix.
+ */
+linmatrix lintext_read_matrix(FILE* in);
@@ -0,0 +1,548 @@
+#include"./hvector.h"
+#include"./simd.h"
+
+static size_t linhvector_element_size(realnum_precision precision) {
+    switch (precision) {
+        case REALNUM_FLOAT: return sizeof(float);
+        case REALNUM_DOUBLE: return sizeof(double);
+        case REALNUM_LONG_DOUBLE: return sizeof(long double);
+        default: return sizeof(__float128);
+    }
+}
+
+/*
+ * Reads element `i` of an APROX vector widened to the largest precision.
+ */
+static __float128 linhvector_load(linhvector* vec, size_t i) {
+    switch (vec->precision) {
+        case REALNUM_FLOAT: return vec->data.f32[i];
+        case REALNUM_DOUBLE: return vec->data.f64[i];
+        case REALNUM_LONG_DOUBLE: return vec->data.f80[i];
+        default: return vec->data.f128[i];
+    }
+}
+
+/*
+ * Writes element `i` of an APROX vector, rounding to its precision.
+ */
+static void linhvector_store(linhvector* vec, size_t i, __float128 value) {
+    switch (vec->precision) {
+        case REALNUM_FLOAT: vec->data.f32[i] = value; break;
+        case REALNUM_DOUBLE: vec->data.f64[i] = value; break;
+        case REALNUM_LONG_DOUBLE: vec->data.f80[i] = value; break;
+        default: vec->data.f128[i] = value; break;
+    }
+}
+
+/*
+ * Orders the representations from the narrowest to the widest:
+ * FRAC < FLOAT < DOUBLE < LONG_DOUBLE < QUAD.
+ */
+static int linhvector_rank(linhvector* vec) {
+    return vec->kind == REALNUM_FRAC ? -1 : (int)vec->precision;
+}
+
+static void linhvector_reserve(linhvector* vec, size_t capacity) {
+    if (capacity <= vec->capacity) {
+        return;
+    }
+    if (vec->kind == REALNUM_FRAC) {
+        vec->data.frac.num = realloc(vec->data.frac.num, capacity * sizeof(int64_t));
+        vec->data.frac.den = realloc(vec->data.frac.den, capacity * sizeof(int64_t));
+    } else {
+        vec->data.aprox = realloc(vec->data.aprox, capacity * linhvector_element_size(vec->precision));
+    }
+    vec->capacity = capacity;
+}
+
+/*
+ * Converts a REALNUM_FRAC vector to REALNUM_APROX of the default precision in place.
+ */
+static void linhvector_promote(linhvector* vec) {
+    if (vec->kind == REALNUM_APROX) {
+        return;
+    }
+    linhvector aprox = linhvector_to_precision(vec, REALNUM_DEFAULT_PRECISION);
+    linhvector_reserve(&aprox, vec->capacity);
+    linhvector_free(vec);
+    *vec = aprox;
+}
+
+linhvector linhvector_with_capacity(realnum_kind kind, size_t capacity) {
+    if (kind == REALNUM_APROX) {
+        return linhvector_with_precision(REALNUM_DEFAULT_PRECISION, capacity);
+    }
+    linhvector vec;
+    vec.size = 0;
+    vec.capacity = capacity;
+    vec.kind = REALNUM_FRAC;
+    vec.precision = REALNUM_DEFAULT_PRECISION;
+    vec.data.frac.num = malloc(capacity * sizeof(int64_t));
+    vec.data.frac.den = malloc(capacity * sizeof(int64_t));
+    return vec;
+}
+
+linhvector linhvector_with_precision(realnum_precision precision, size_t capacity) {
+    linhvector vec;
+    vec.size = 0;
+    vec.capacity = capacity;
+    vec.kind = REALNUM_APROX;
+    vec.precision = precision;
+    vec.data.aprox = malloc(capacity * linhvector_element_size(precision));
+    return vec;
+}
+
+linhvector linhvector_zero(realnum_kind kind, size_t size) {
+    linhvector vec = linhvector_with_capacity(kind, size);
+    if (kind == REALNUM_FRAC) {
+        for (size_t i = 0; i < size; i++) {
+            vec.data.frac.num[i] = 0;
+            vec.data.frac.den[i] = 1;
+        }
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            linhvector_store(&vec, i, 0);
+        }
+    }
+    vec.size = size;
+    return vec;
+}
+
+linhvector linhvector_from_linvector(linvector* vec) {
+    for (size_t i = 0; i < vec->size; i++) {
+        if (vec->data[i].kind != REALNUM_FRAC) {
+            return linhvector_from_linvector_with_precision(vec, REALNUM_DEFAULT_PRECISION);
+        }
+    }
+    linhvector hvec = linhvector_with_capacity(REALNUM_FRAC, vec->size);
+    for (size_t i = 0; i < vec->size; i++) {
+        hvec.data.frac.num[i] = vec->data[i].value.frac.num;
+        hvec.data.frac.den[i] = vec->data[i].value.frac.den;
+    }
+    hvec.size = vec->size;
+    return hvec;
+}
+
+linhvector linhvector_from_linvector_with_precision(linvector* vec, realnum_precision precision) {
+    linhvector hvec = linhvector_with_precision(precision, vec->size);
+    for (size_t i = 0; i < vec->size; i++) {
+        linhvector_store(&hvec, i, realnum_as_aprox(&vec->data[i]).value.aprox);
+    }
+    hvec.size = vec->size;
+    return hvec;
+}
+
+linvector linhvector_to_linvector(linhvector* vec) {
+    linvector result = linvector_with_capacity(vec->size);
+    for (size_t i = 0; i < vec->size; i++) {
+        result.data[i] = linhvector_get(vec, i);
+    }
+    result.size = vec->size;
+    return result;
+}
+
+linhvector linhvector_as_aprox(linhvector* vec) {
+    if (vec->kind == REALNUM_FRAC) {
+        return linhvector_to_precision(vec, REALNUM_DEFAULT_PRECISION);
+    }
+    return linhvector_to_precision(vec, vec->precision);
+}
+
+linhvector linhvector_to_precision(linhvector* vec, realnum_precision precision) {
+    linhvector result = linhvector_with_precision(precision, vec->size);
+    if (vec->kind == REALNUM_FRAC && precision == REALNUM_QUAD) {
+        /* Long double would cut a quad result short, so divide in software. */
+        for (size_t i = 0; i < vec->size; i++) {
+            result.data.f128[i] = (__float128)vec->data.frac.num[i] / vec->data.frac.den[i];
+        }
+    } else if (vec->kind == REALNUM_FRAC) {
+        for (size_t i = 0; i < vec->size; i++) {
+            linhvector_store(&result, i, (long double)vec->data.frac.num[i] / vec->data.frac.den[i]);
+        }
+    } else {
+        for (size_t i = 0; i < vec->size; i++) {
+            linhvector_store(&result, i, linhvector_load(vec, i));
+        }
+    }
+    result.size = vec->size;
+    return result;
+}
+
+linhvector linhvector_clone(linhvector* vec) {
+    if (vec->kind == REALNUM_APROX) {
+        return linhvector_to_precision(vec, vec->precision);
+    }
+    linhvector clone = linhvector_with_capacity(REALNUM_FRAC, vec->size);
+    for (size_t i = 0; i < vec->size; i++) {
+        clone.data.frac.num[i] = vec->data.frac.num[i];
+        clone.data.frac.den[i] = vec->data.frac.den[i];
+    }
+    clone.size = vec->size;
+    return clone;
+}
+
+void linhvector_free(linhvector* vec) {
+    if (vec->kind == REALNUM_FRAC) {
+        free(vec->data.frac.num);
+        free(vec->data.frac.den);
+    } else {
+        free(vec->data.aprox);
+    }
+    vec->size = 0;
+    vec->capacity = 0;
+}
+
+realnum linhvector_get(linhvector* vec, size_t index) {
+    if (index >= vec->size) {
+        fprintf(stderr, "Error: vector index out of bounds.\n");
+        exit(1);
+    }
+    if (vec->kind == REALNUM_FRAC) {
+        return realnum_from_frac(vec->data.frac.num[index], vec->data.frac.den[index]);
+    }
+    return realnum_from_aprox(linhvector_load(vec, index));
+}
+
+void linhvector_set(linhvector* vec, size_t index, realnum value) {
+    if (index >= vec->size) {
+        fprintf(stderr, "Error: vector index out of bounds.\n");
+        exit(1);
+    }
+    if (value.kind != vec->kind) {
+        linhvector_promote(vec);
+    }
+    if (vec->kind == REALNUM_FRAC) {
+        vec->data.frac.num[index] = value.value.frac.num;
+        vec->data.frac.den[index] = value.value.frac.den;
+    } else {
+        linhvector_store(vec, index, realnum_as_aprox(&value).value.aprox);
+    }
+}
+
+void linhvector_push(linhvector* vec, realnum value) {
+    if (vec->size == vec->capacity) {
+        linhvector_reserve(vec, vec->capacity ? vec->capacity * 2 : LINVECTOR_DEFAULT_CAPACITY);
+    }
+    // Promote before growing, so the promotion never reads the unwritten slot.
+    if (value.kind != vec->kind) {
+        linhvector_promote(vec);
+    }
+    vec->size++;
+    linhvector_set(vec, vec->size - 1, value);
+}
+
+void linhvector_print(linhvector* vec, uint16_t precision) {
+    printf("[");
+    for (size_t i = 0; i < vec->size; i++) {
+        realnum num = linhvector_get(vec, i);
+        realnum_print(&num, precision);
+        if (i < vec->size - 1) {
+            printf(", ");
+        }
+    }
+    printf("]");
+}
+
+/*
+ * Element-wise kernels. Each loop body is branch free so the compiler can
+ * vectorize it; the kind and precision of the operands are resolved once by
+ * the caller. Float and double vectors go through the explicit SIMD kernels of
+ * simd.h instead.
+ */
+
+/*
+ * The FRAC kernels take a plain int64 loop when every term is below 2^31, where
+ * products and cross-product sums cannot overflow, and otherwise go element by
+ * element through 128-bit intermediates. They return false if a result does not
+ * fit in int64 terms even after reduction; the caller then redoes the operation
+ * in REALNUM_APROX.
+ */
+#define LINHVECTOR_FRAC_SMALL (UINT64_C(1) << 31)
+
+static uint64_t linhvector_magnitude(int64_t x) {
+    return x < 0 ? -(uint64_t)x : (uint64_t)x;
+}
+
+static bool linhvector_frac_small(size_t n, const int64_t* restrict num, const int64_t* restrict den) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < n; i++) {
+        bits |= linhvector_magnitude(num[i]) | linhvector_magnitude(den[i]);
+    }
+    return bits < LINHVECTOR_FRAC_SMALL;
+}
+
+static bool linhvector_frac_add(size_t n, const int64_t* restrict an, const int64_t* restrict ad, const int64_t* restrict bn, const int64_t* restrict bd, int64_t* restrict rn, int64_t* restrict rd) {
+    if (linhvector_frac_small(n, an, ad) && linhvector_frac_small(n, bn, bd)) {
+        for (size_t i = 0; i < n; i++) {
+            rn[i] = an[i] * bd[i] + bn[i] * ad[i];
+            rd[i] = ad[i] * bd[i];
+        }
+        return true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!realnum_frac_narrow((__int128)an[i] * bd[i] + (__int128)bn[i] * ad[i], (__int128)ad[i] * bd[i], &rn[i], &rd[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool linhvector_frac_sub(size_t n, const int64_t* restrict an, const int64_t* restrict ad, const int64_t* restrict bn, const int64_t* restrict bd, int64_t* restrict rn, int64_t* restrict rd) {
+    if (linhvector_frac_small(n, an, ad) && linhvector_frac_small(n, bn, bd)) {
+        for (size_t i = 0; i < n; i++) {
+            rn[i] = an[i] * bd[i] - bn[i] * ad[i];
+            rd[i] = ad[i] * bd[i];
+        }
+        return true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!realnum_frac_narrow((__int128)an[i] * bd[i] - (__int128)bn[i] * ad[i], (__int128)ad[i] * bd[i], &rn[i], &rd[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool linhvector_frac_scale(size_t n, const int64_t* restrict an, const int64_t* restrict ad, int64_t sn, int64_t sd, int64_t* restrict rn, int64_t* restrict rd) {
+    if ((linhvector_magnitude(sn) | linhvector_magnitude(sd)) < LINHVECTOR_FRAC_SMALL && linhvector_frac_small(n, an, ad)) {
+        for (size_t i = 0; i < n; i++) {
+            rn[i] = an[i] * sn;
+            rd[i] = ad[i] * sd;
+        }
+        return true;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!realnum_frac_narrow((__int128)an[i] * sn, (__int128)ad[i] * sd, &rn[i], &rd[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#undef LINHVECTOR_FRAC_SMALL
+
+#define LINHVECTOR_APROX_KERNELS(suffix, type) \
+    static void linhvector_add_##suffix(size_t n, const type* restrict a, const type* restrict b, type* restrict r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] + b[i]; \
+        } \
+    } \
+    static void linhvector_sub_##suffix(size_t n, const type* restrict a, const type* restrict b, type* restrict r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] - b[i]; \
+        } \
+    } \
+    static void linhvector_scale_##suffix(size_t n, const type* restrict a, type s, type* restrict r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] * s; \
+        } \
+    } \
+    static void linhvector_div_##suffix(size_t n, const type* restrict a, type s, type* restrict r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] / s; \
+        } \
+    } \
+    static type linhvector_dot_##suffix(size_t n, const type* restrict a, const type* restrict b) { \
+        type sum = 0; \
+        for (size_t i = 0; i < n; i++) { \
+            sum += a[i] * b[i]; \
+        } \
+        return sum; \
+    }
+
+LINHVECTOR_APROX_KERNELS(f80, long double)
+LINHVECTOR_APROX_KERNELS(f128, __float128)
+
+#undef LINHVECTOR_APROX_KERNELS
+
+/*
+ * Resolves the representations of a binary operation. When they differ the
+ * narrower operand is replaced by a copy in the wider precision stored in
+ * `temp`, which the caller must free if `*converted` is set.
+ */
+static void linhvector_unify(linhvector** a, linhvector** b, linhvector* temp, bool* converted) {
+    *converted = false;
+    if (linhvector_rank(*a) == linhvector_rank(*b)) {
+        return;
+    }
+    if (linhvector_rank(*a) < linhvector_rank(*b)) {
+        *temp = linhvector_to_precision(*a, (*b)->precision);
+        *a = temp;
+    } else {
+        *temp = linhvector_to_precision(*b, (*a)->precision);
+        *b = temp;
+    }
+    *converted = true;
+}
+
+/*
+ * Redoes a FRAC operation whose result overflowed on REALNUM_APROX copies of
+ * its operands.
+ */
+static linhvector linhvector_aprox_fallback(linhvector* a, linhvector* b, linhvector (*op)(linhvector*, linhvector*)) {
+    linhvector ta = linhvector_as_aprox(a);
+    linhvector tb = linhvector_as_aprox(b);
+    linhvector result = op(&ta, &tb);
+    linhvector_free(&ta);
+    linhvector_free(&tb);
+    return result;
+}
+
+linhvector linhvector_add(linhvector* a, linhvector* b) {
+    if (a->size != b->size) {
+        fprintf(stderr, "Error: vectors must have the same size to be added.\n");
+        exit(1);
+    }
+    linhvector temp;
+    bool converted;
+    linhvector_unify(&a, &b, &temp, &converted);
+    linhvector result;
+    if (a->kind == REALNUM_FRAC) {
+        result = linhvector_with_capacity(REALNUM_FRAC, a->size);
+        if (!linhvector_frac_add(a->size, a->data.frac.num, a->data.frac.den, b->data.frac.num, b->data.frac.den, result.data.frac.num, result.data.frac.den)) {
+            linhvector_free(&result);
+            result = linhvector_aprox_fallback(a, b, linhvector_add);
+        }
+    } else {
+        result = linhvector_with_precision(a->precision, a->size);
+        switch (a->precision) {
+            case REALNUM_FLOAT: linsimd_add_f32(a->size, a->data.f32, b->data.f32, result.data.f32); break;
+            case REALNUM_DOUBLE: linsimd_add_f64(a->size, a->data.f64, b->data.f64, result.data.f64); break;
+            case REALNUM_LONG_DOUBLE: linhvector_add_f80(a->size, a->data.f80, b->data.f80, result.data.f80); break;
+            case REALNUM_QUAD: linhvector_add_f128(a->size, a->data.f128, b->data.f128, result.data.f128); break;
+        }
+    }
+    result.size = a->size;
+    if (converted) {
+        linhvector_free(&temp);
+    }
+    return result;
+}
+
+linhvector linhvector_sub(linhvector* a, linhvector* b) {
+    if (a->size != b->size) {
+        fprintf(stderr, "Error: vectors must have the same size to be subtracted.\n");
+        exit(1);
+    }
+    linhvector temp;
+    bool converted;
+    linhvector_unify(&a, &b, &temp, &converted);
+    linhvector result;
+    if (a->kind == REALNUM_FRAC) {
+        result = linhvector_with_capacity(REALNUM_FRAC, a->size);
+        if (!linhvector_frac_sub(a->size, a->data.frac.num, a->data.frac.den, b->data.frac.num, b->data.frac.den, result.data.frac.num, result.data.frac.den)) {
+            linhvector_free(&result);
+            result = linhvector_aprox_fallback(a, b, linhvector_sub);
+        }
+    } else {
+        result = linhvector_with_precision(a->precision, a->size);
+        switch (a->precision) {
+            case REALNUM_FLOAT: linsimd_sub_f32(a->size, a->data.f32, b->data.f32, result.data.f32); break;
+            case REALNUM_DOUBLE: linsimd_sub_f64(a->size, a->data.f64, b->data.f64, result.data.f64); break;
+            case REALNUM_LONG_DOUBLE: linhvector_sub_f80(a->size, a->data.f80, b->data.f80, result.data.f80); break;
+            case REALNUM_QUAD: linhvector_sub_f128(a->size, a->data.f128, b->data.f128, result.data.f128); break;
+        }
+    }
+    result.size = a->size;
+    if (converted) {
+        linhvector_free(&temp);
+    }
+    return result;
+}
+
+linhvector linhvector_mul(linhvector* a, realnum scalar) {
+    linhvector result;
+    if (a->kind == REALNUM_FRAC && scalar.kind == REALNUM_FRAC) {
+        result = linhvector_with_capacity(REALNUM_FRAC, a->size);
+        if (!linhvector_frac_scale(a->size, a->data.frac.num, a->data.frac.den, scalar.value.frac.num, scalar.value.frac.den, result.data.frac.num, result.data.frac.den)) {
+            linhvector_free(&result);
+            linhvector temp = linhvector_as_aprox(a);
+            result = linhvector_mul(&temp, scalar);
+            linhvector_free(&temp);
+            return result;
+        }
+    } else if (a->kind == REALNUM_FRAC) {
+        linhvector temp = linhvector_as_aprox(a);
+        result = linhvector_mul(&temp, scalar);
+        linhvector_free(&temp);
+        return result;
+    } else {
+        realnum_aprox s = realnum_as_aprox(&scalar).value.aprox;
+        result = linhvector_with_precision(a->precision, a->size);
+        switch (a->precision) {
+            case REALNUM_FLOAT: linsimd_scale_f32(a->size, a->data.f32, s, result.data.f32); break;
+            case REALNUM_DOUBLE: linsimd_scale_f64(a->size, a->data.f64, s, result.data.f64); break;
+            case REALNUM_LONG_DOUBLE: linhvector_scale_f80(a->size, a->data.f80, s, result.data.f80); break;
+            case REALNUM_QUAD: linhvector_scale_f128(a->size, a->data.f128, s, result.data.f128); break;
+        }
+    }
+    result.size = a->size;
+    return result;
+}
+
+linhvector linhvector_div(linhvector* a, realnum scalar) {
+    if (a->kind == REALNUM_FRAC) {
+        realnum inv = realnum_inv(&scalar);
+        linhvector result = linhvector_mul(a, inv);
+        realnum_free(&inv);
+        return result;
+    }
+    realnum_aprox s = realnum_as_aprox(&scalar).value.aprox;
+    linhvector result = linhvector_with_precision(a->precision, a->size);
+    switch (a->precision) {
+        case REALNUM_FLOAT: linsimd_div_f32(a->size, a->data.f32, s, result.data.f32); break;
+        case REALNUM_DOUBLE: linsimd_div_f64(a->size, a->data.f64, s, result.data.f64); break;
+        case REALNUM_LONG_DOUBLE: linhvector_div_f80(a->size, a->data.f80, s, result.data.f80); break;
+        case REALNUM_QUAD: linhvector_div_f128(a->size, a->data.f128, s, result.data.f128); break;
+    }
+    result.size = a->size;
+    return result;
+}
+
+realnum linhvector_dot(linhvector* a, linhvector* b) {
+    if (a->size != b->size) {
+        fprintf(stderr, "Error: vectors must have the same size to calculate the dot product.\n");
+        exit(1);
+    }
+    linhvector temp;
+    bool converted;
+    linhvector_unify(&a, &b, &temp, &converted);
+    realnum result;
+    if (a->kind == REALNUM_FRAC) {
+        result = realnum_new();
+        for (size_t i = 0; i < a->size; i++) {
+            realnum x = realnum_from_frac(a->data.frac.num[i], a->data.frac.den[i]);
+            realnum y = realnum_from_frac(b->data.frac.num[i], b->data.frac.den[i]);
+            realnum temp_product = realnum_mul(&x, &y);
+            realnum sum = realnum_add(&result, &temp_product);
+            realnum_free(&result);
+            realnum_free(&temp_product);
+            result = sum;
+        }
+    } else {
+        realnum_aprox sum = 0;
+        switch (a->precision) {
+            case REALNUM_FLOAT: sum = linsimd_dot_f32(a->size, a->data.f32, b->data.f32); break;
+            case REALNUM_DOUBLE: sum = linsimd_dot_f64(a->size, a->data.f64, b->data.f64); break;
+            case REALNUM_LONG_DOUBLE: sum = linhvector_dot_f80(a->size, a->data.f80, b->data.f80); break;
+            case REALNUM_QUAD: sum = linhvector_dot_f128(a->size, a->data.f128, b->data.f128); break;
+        }
+        result = realnum_from_aprox(sum);
+    }
+    if (converted) {
+        linhvector_free(&temp);
+    }
+    return result;
+}
+
+realnum linhvector_norm(linhvector* a) {
+    realnum dot = linhvector_dot(a, a);
+    realnum res = realnum_as_aprox(&dot);
+    realnum_free(&dot);
+    return realnum_sqrt(&res);
+}
+
+linhvector linhvector_normalize(linhvector* a) {
+    realnum norm = linhvector_norm(a);
+    return linhvector_div(a, norm);
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"../numeric/realnum.h"
+#include"./vector.h"
+
+/**
+ * @struct linhvector
+ * @brief Represents a homogeneous linear vector.
+ *
+ * Unlike `linvector`, which stores one tagged `realnum` per element, a
+ * `linhvector` records a single kind for the whole buffer and stores its
+ * elements as structure-of-arrays: a numerator and a denominator array for
+ * REALNUM_FRAC, or one flat floating point array for REALNUM_APROX. Loops over
+ * it never branch on the kind of an element.
+ *
+ * REALNUM_APROX vectors additionally carry their own floating point precision,
+ * independent of the precision realnum was built with, so a pipeline that only
+ * needs doubles runs on hardware floating point.
+ *
+ * Operations that mix kinds or precisions convert the narrower operand once, up
+ * front (FRAC < FLOAT < DOUBLE < LONG_DOUBLE < QUAD), and produce a result of
+ * the wider one.
+ */
+typedef struct linhvector {
+    size_t size;
+    size_t capacity;
+    realnum_kind kind;
+    realnum_precision precision; /**< The precision of a REALNUM_APROX vector. */
+    union {
+        struct {
+            int64_t* num; /**< The numerators of the elements. */
+            int64_t* den; /**< The denominators of the elements. */
+        } frac; /**< The buffers of a REALNUM_FRAC vector. */
+        void* aprox; /**< The buffer of a REALNUM_APROX vector, typed by one of the members below. */
+        float* f32;
+        double* f64;
+        long double* f80;
+        __float128* f128;
+    } data;
+} linhvector;
+
+/**
+ * Creates a new empty linhvector of the given kind with the specified capacity.
+ *
+ * @param kind The kind of every element of the linhvector.
+ * @param capacity The capacity of the linhvector.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_with_capacity(realnum_kind kind, size_t capacity);
+
+/**
+ * Creates a new empty REALNUM_APROX linhvector of the given precision with the specified capacity.
+ *
+ * @param precision The floating point precision of the elements.
+ * @param capacity The capacity of the linhvector.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_with_precision(realnum_precision precision, size_t capacity);
+
+/**
+ * Creates a new linhvector of the specified size with all elements set to 0.
+ *
+ * @param kind The kind of every element of the linhvector.
+ * @param size The size of the linhvector.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_zero(realnum_kind kind, size_t size);
+
+/**
+ * Converts a linvector to a linhvector.
+ *
+ * The result is REALNUM_FRAC if every element of the linvector is a fraction,
+ * REALNUM_APROX of REALNUM_DEFAULT_PRECISION otherwise. There is no
+ * REALNUM_BIGFRAC storage, such elements are approximated like APROX ones.
+ *
+ * @param vec The linvector to convert.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_from_linvector(linvector* vec);
+
+/**
+ * Converts a linvector to a REALNUM_APROX linhvector of the given precision.
+ *
+ * @param vec The linvector to convert.
+ * @param precision The floating point precision of the result.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_from_linvector_with_precision(linvector* vec, realnum_precision precision);
+
+/**
+ * Converts a linhvector back to a linvector.
+ *
+ * @param vec The linhvector to convert.
+ * @return The newly created linvector.
+ */
+linvector linhvector_to_linvector(linhvector* vec);
+
+/**
+ * Creates a REALNUM_APROX copy of the given linhvector.
+ *
+ * APROX vectors keep their precision, FRAC vectors are converted to
+ * REALNUM_DEFAULT_PRECISION.
+ *
+ * @param vec The linhvector to convert.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_as_aprox(linhvector* vec);
+
+/**
+ * Creates a REALNUM_APROX copy of the given linhvector with the given precision.
+ *
+ * @param vec The linhvector to convert.
+ * @param precision The floating point precision of the result.
+ * @return The newly created linhvector.
+ */
+linhvector linhvector_to_precision(linhvector* vec, realnum_precision precision);
+
+/**
+ * Creates a new linhvector that is a copy of the given linhvector.
+ *
+ * @param vec The linhvector to clone.
+ * @return The cloned linhvector.
+ */
+linhvector linhvector_clone(linhvector* vec);
+
+/**
+ * Frees the memory occupied by the given linhvector.
+ *
+ * @param vec The linhvector to free.
+ */
+void linhvector_free(linhvector* vec);
+
+/**
+ * Returns the element at the given index.
+ *
+ * @param vec The linhvector.
+ * @param index The index of the element.
+ * @return The element as a realnum.
+ */
+realnum linhvector_get(linhvector* vec, size_t index);
+
+/**
+ * Sets the element at the given index.
+ *
+ * Storing a REALNUM_APROX value into a REALNUM_FRAC vector converts the whole
+ * vector to REALNUM_APROX first. Values stored into an APROX vector are rounded
+ * to its precision.
+ *
+ * @param vec The linhvector.
+ * @param index The index of the element.
+ * @param value The value to store.
+ */
+void linhvector_set(linhvector* vec, size_t index, realnum value);
+
+/**
+ * Adds a value to the end of the linhvector.
+ *
+ * Pushing a REALNUM_APROX value into a REALNUM_FRAC vector converts the whole
+ * vector to REALNUM_APROX first.
+ *
+ * @param vec The linhvector to push the value to.
+ * @param value The value to be added to the linhvector.
+ */
+void linhvector_push(linhvector* vec, realnum value);
+
+/**
+ * Prints the elements of a linhvector.
+ *
+ * @param vec The linhvector to be printed.
+ * @param precision The number of decimal places to print.
+ */
+void linhvector_print(linhvector* vec, uint16_t precision);
+
+/**
+ * Adds two linhvectors element-wise and returns the result.
+ *
+ * @param a The first linhvector.
+ * @param b The second linhvector.
+ * @return The result of the addition.
+ */
+linhvector linhvector_add(linhvector* a, linhvector* b);
+
+/**
+ * Subtracts the second linhvector from the first linhvector element-wise and returns the result.
+ *
+ * @param a The first linhvector.
+ * @param b The second linhvector.
+ * @return The result of the subtraction.
+ */
+linhvector linhvector_sub(linhvector* a, linhvector* b);
+
+/**
+ * Multiplies each element of the linhvector by the given scalar and returns the result.
+ *
+ * @param a The linhvector.
+ * @param scalar The scalar value.
+ * @return The result of the multiplication.
+ */
+linhvector linhvector_mul(linhvector* a, realnum scalar);
+
+/**
+ * Divides each element of the linhvector by the given scalar and returns the result.
+ *
+ * @param a The linhvector.
+ * @param scalar The scalar value.
+ * @return The result of the division.
+ */
+linhvector linhvector_div(linhvector* a, realnum scalar);
+
+/**
+ * Calculates the dot product of two linhvectors and returns the result.
+ *
+ * @param a The first linhvector.
+ * @param b The second linhvector.
+ * @return The dot product of the two linhvectors.
+ */
+realnum linhvector_dot(linhvector* a, linhvector* b);
+
+/**
+ * Calculates the Euclidean norm (magnitude) of the linhvector.
+ *
+ * @param a The linhvector.
+ * @return The Euclidean norm of the linhvector.
+ */
+realnum linhvector_norm(linhvector* a);
+
+/**
+ * Normalizes the linhvector to have a magnitude of 1 and returns the result.
+ *
+ * @param a The linhvector.
+ * @return The normalized linhvector.
+ */
+linhvector linhvector_normalize(linhvector* a);
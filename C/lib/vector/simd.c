@@ -0,0 +1,507 @@
+#include"./simd.h"
+#include<stdatomic.h>
+#include<math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LINSIMD_X86 1
+#include<immintrin.h>
+#elif defined(__aarch64__)
+#define LINSIMD_ARM64 1
+#include<arm_neon.h>
+#endif
+
+static _Atomic int linsimd_selected = -1;
+
+linsimd_isa linsimd_detect(void) {
+#if defined(LINSIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return LINSIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return LINSIMD_AVX2;
+    }
+    return LINSIMD_SCALAR;
+#elif defined(LINSIMD_ARM64)
+    return LINSIMD_NEON;
+#else
+    return LINSIMD_SCALAR;
+#endif
+}
+
+linsimd_isa linsimd_active(void) {
+    int isa = atomic_load_explicit(&linsimd_selected, memory_order_relaxed);
+    if (isa < 0) {
+        isa = linsimd_detect();
+        atomic_store_explicit(&linsimd_selected, isa, memory_order_relaxed);
+    }
+    return (linsimd_isa)isa;
+}
+
+linsimd_isa linsimd_force(linsimd_isa isa) {
+    linsimd_isa detected = linsimd_detect();
+    bool supported = isa == LINSIMD_SCALAR || isa == detected || (detected == LINSIMD_AVX512 && isa == LINSIMD_AVX2);
+    if (!supported) {
+        isa = detected;
+    }
+    atomic_store_explicit(&linsimd_selected, isa, memory_order_relaxed);
+    return isa;
+}
+
+/*
+ * Portable kernels. The dot products keep four partial sums so the additions
+ * are independent and can overlap, like the vector versions below.
+ */
+
+#define LINSIMD_SCALAR_KERNELS(suffix, type) \
+    static type linsimd_dot_##suffix##_scalar(size_t n, const type* a, const type* b) { \
+        type acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0; \
+        size_t i = 0; \
+        for (; i + 4 <= n; i += 4) { \
+            acc0 += a[i] * b[i]; \
+            acc1 += a[i + 1] * b[i + 1]; \
+            acc2 += a[i + 2] * b[i + 2]; \
+            acc3 += a[i + 3] * b[i + 3]; \
+        } \
+        for (; i < n; i++) { \
+            acc0 += a[i] * b[i]; \
+        } \
+        return (acc0 + acc1) + (acc2 + acc3); \
+    } \
+    static void linsimd_add_##suffix##_scalar(size_t n, const type* a, const type* b, type* r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] + b[i]; \
+        } \
+    } \
+    static void linsimd_sub_##suffix##_scalar(size_t n, const type* a, const type* b, type* r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] - b[i]; \
+        } \
+    } \
+    static void linsimd_scale_##suffix##_scalar(size_t n, const type* a, type s, type* r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] * s; \
+        } \
+    } \
+    static void linsimd_div_##suffix##_scalar(size_t n, const type* a, type s, type* r) { \
+        for (size_t i = 0; i < n; i++) { \
+            r[i] = a[i] / s; \
+        } \
+    }
+
+LINSIMD_SCALAR_KERNELS(f64, double)
+LINSIMD_SCALAR_KERNELS(f32, float)
+
+#undef LINSIMD_SCALAR_KERNELS
+
+/*
+ * Per-vector bodies of the 3D batch kernels, shared by the portable kernels and
+ * the tails of the vector ones. Every result is computed before it is stored so
+ * the output may alias an input.
+ */
+
+static void linsimd_cross3_one(size_t i, const double* const a[3], const double* const b[3], double* const r[3]) {
+    double x = a[1][i] * b[2][i] - a[2][i] * b[1][i];
+    double y = a[2][i] * b[0][i] - a[0][i] * b[2][i];
+    double z = a[0][i] * b[1][i] - a[1][i] * b[0][i];
+    r[0][i] = x;
+    r[1][i] = y;
+    r[2][i] = z;
+}
+
+static void linsimd_dot3_one(size_t i, const double* const a[3], const double* const b[3], double* r) {
+    r[i] = (a[0][i] * b[0][i] + a[1][i] * b[1][i]) + a[2][i] * b[2][i];
+}
+
+static void linsimd_normalize3_one(size_t i, const double* const a[3], double* const r[3]) {
+    double norm2 = (a[0][i] * a[0][i] + a[1][i] * a[1][i]) + a[2][i] * a[2][i];
+    double inv = norm2 > 0 ? 1.0 / sqrt(norm2) : 0.0;
+    for (size_t k = 0; k < 3; k++) {
+        r[k][i] = a[k][i] * inv;
+    }
+}
+
+static void linsimd_cross3_f64_scalar(size_t n, const double* const a[3], const double* const b[3], double* const r[3]) {
+    for (size_t i = 0; i < n; i++) {
+        linsimd_cross3_one(i, a, b, r);
+    }
+}
+
+static void linsimd_dot3_f64_scalar(size_t n, const double* const a[3], const double* const b[3], double* r) {
+    for (size_t i = 0; i < n; i++) {
+        linsimd_dot3_one(i, a, b, r);
+    }
+}
+
+static void linsimd_normalize3_f64_scalar(size_t n, const double* const a[3], double* const r[3]) {
+    for (size_t i = 0; i < n; i++) {
+        linsimd_normalize3_one(i, a, r);
+    }
+}
+
+/*
+ * 3D batch kernels for one instruction set. `keep(inv, norm2)` zeroes the
+ * lanes of `inv` whose squared norm is not positive.
+ */
+
+#define LINSIMD_VEC3_KERNELS(isa, attr, vtype, width, load, store, add, sub, mul, div, sqrt, set1, keep) \
+    attr \
+    static void linsimd_cross3_f64_##isa(size_t n, const double* const a[3], const double* const b[3], double* const r[3]) { \
+        size_t i = 0; \
+        for (; i + width <= n; i += width) { \
+            vtype ax = load(a[0] + i), ay = load(a[1] + i), az = load(a[2] + i); \
+            vtype bx = load(b[0] + i), by = load(b[1] + i), bz = load(b[2] + i); \
+            store(r[0] + i, sub(mul(ay, bz), mul(az, by))); \
+            store(r[1] + i, sub(mul(az, bx), mul(ax, bz))); \
+            store(r[2] + i, sub(mul(ax, by), mul(ay, bx))); \
+        } \
+        for (; i < n; i++) { \
+            linsimd_cross3_one(i, a, b, r); \
+        } \
+    } \
+    attr \
+    static void linsimd_dot3_f64_##isa(size_t n, const double* const a[3], const double* const b[3], double* r) { \
+        size_t i = 0; \
+        for (; i + width <= n; i += width) { \
+            vtype xx = mul(load(a[0] + i), load(b[0] + i)); \
+            vtype yy = mul(load(a[1] + i), load(b[1] + i)); \
+            vtype zz = mul(load(a[2] + i), load(b[2] + i)); \
+            store(r + i, add(add(xx, yy), zz)); \
+        } \
+        for (; i < n; i++) { \
+            linsimd_dot3_one(i, a, b, r); \
+        } \
+    } \
+    attr \
+    static void linsimd_normalize3_f64_##isa(size_t n, const double* const a[3], double* const r[3]) { \
+        size_t i = 0; \
+        for (; i + width <= n; i += width) { \
+            vtype x = load(a[0] + i), y = load(a[1] + i), z = load(a[2] + i); \
+            vtype norm2 = add(add(mul(x, x), mul(y, y)), mul(z, z)); \
+            vtype inv = keep(div(set1(1.0), sqrt(norm2)), norm2); \
+            store(r[0] + i, mul(x, inv)); \
+            store(r[1] + i, mul(y, inv)); \
+            store(r[2] + i, mul(z, inv)); \
+        } \
+        for (; i < n; i++) { \
+            linsimd_normalize3_one(i, a, r); \
+        } \
+    }
+
+/*
+ * Element-wise kernels shared by every instruction set: `vop` combines two
+ * registers of `width` lanes, the tail is finished with the scalar operator.
+ */
+
+#define LINSIMD_BINARY_KERNEL(name, isa, attr, type, width, load, store, vop, sop) \
+    attr \
+    static void linsimd_##name##_##isa(size_t n, const type* a, const type* b, type* r) { \
+        size_t i = 0; \
+        for (; i + width <= n; i += width) { \
+            store(r + i, vop(load(a + i), load(b + i))); \
+        } \
+        for (; i < n; i++) { \
+            r[i] = a[i] sop b[i]; \
+        } \
+    }
+
+#define LINSIMD_SCALAR_OP_KERNEL(name, isa, attr, type, width, load, store, set1, vop, sop) \
+    attr \
+    static void linsimd_##name##_##isa(size_t n, const type* a, type s, type* r) { \
+        size_t i = 0; \
+        for (; i + width <= n; i += width) { \
+            store(r + i, vop(load(a + i), set1(s))); \
+        } \
+        for (; i < n; i++) { \
+            r[i] = a[i] sop s; \
+        } \
+    }
+
+#if defined(LINSIMD_X86)
+
+#define LINSIMD_AVX2_TARGET __attribute__((target("avx2,fma")))
+#define LINSIMD_AVX512_TARGET __attribute__((target("avx512f")))
+
+LINSIMD_BINARY_KERNEL(add_f64, avx2, LINSIMD_AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, +)
+LINSIMD_BINARY_KERNEL(sub_f64, avx2, LINSIMD_AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sub_pd, -)
+LINSIMD_SCALAR_OP_KERNEL(scale_f64, avx2, LINSIMD_AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_mul_pd, *)
+LINSIMD_SCALAR_OP_KERNEL(div_f64, avx2, LINSIMD_AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_div_pd, /)
+LINSIMD_BINARY_KERNEL(add_f32, avx2, LINSIMD_AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, +)
+LINSIMD_BINARY_KERNEL(sub_f32, avx2, LINSIMD_AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sub_ps, -)
+LINSIMD_SCALAR_OP_KERNEL(scale_f32, avx2, LINSIMD_AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_mul_ps, *)
+LINSIMD_SCALAR_OP_KERNEL(div_f32, avx2, LINSIMD_AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_div_ps, /)
+
+LINSIMD_BINARY_KERNEL(add_f64, avx512, LINSIMD_AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, +)
+LINSIMD_BINARY_KERNEL(sub_f64, avx512, LINSIMD_AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_sub_pd, -)
+LINSIMD_SCALAR_OP_KERNEL(scale_f64, avx512, LINSIMD_AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_mul_pd, *)
+LINSIMD_SCALAR_OP_KERNEL(div_f64, avx512, LINSIMD_AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_div_pd, /)
+LINSIMD_BINARY_KERNEL(add_f32, avx512, LINSIMD_AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, +)
+LINSIMD_BINARY_KERNEL(sub_f32, avx512, LINSIMD_AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_sub_ps, -)
+LINSIMD_SCALAR_OP_KERNEL(scale_f32, avx512, LINSIMD_AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_mul_ps, *)
+LINSIMD_SCALAR_OP_KERNEL(div_f32, avx512, LINSIMD_AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_div_ps, /)
+
+#define LINSIMD_AVX2_KEEP(inv, norm2) _mm256_and_pd(inv, _mm256_cmp_pd(norm2, _mm256_setzero_pd(), _CMP_GT_OQ))
+#define LINSIMD_AVX512_KEEP(inv, norm2) _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(norm2, _mm512_setzero_pd(), _CMP_GT_OQ), inv)
+
+LINSIMD_VEC3_KERNELS(avx2, LINSIMD_AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_div_pd, _mm256_sqrt_pd, _mm256_set1_pd, LINSIMD_AVX2_KEEP)
+LINSIMD_VEC3_KERNELS(avx512, LINSIMD_AVX512_TARGET, __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_div_pd, _mm512_sqrt_pd, _mm512_set1_pd, LINSIMD_AVX512_KEEP)
+
+#undef LINSIMD_AVX2_KEEP
+#undef LINSIMD_AVX512_KEEP
+
+/*
+ * Dot products use four independent FMA accumulators to hide the FMA latency,
+ * then reduce them pairwise.
+ */
+
+LINSIMD_AVX2_TARGET
+static double linsimd_dot_f64_avx2(size_t n, const double* a, const double* b) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), acc3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+    }
+    acc0 = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+LINSIMD_AVX2_TARGET
+static float linsimd_dot_f32_avx2(size_t n, const float* a, const float* b) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    acc0 = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    __m128 quad = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+    float sum = _mm_cvtss_f32(_mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1)));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+LINSIMD_AVX512_TARGET
+static double linsimd_dot_f64_avx512(size_t n, const double* a, const double* b) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+        acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 16), _mm512_loadu_pd(b + i + 16), acc2);
+        acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 24), _mm512_loadu_pd(b + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+    }
+    if (i < n) {
+        __mmask8 mask = (__mmask8)((1u << (n - i)) - 1);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i), acc1);
+    }
+    acc0 = _mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3));
+    return _mm512_reduce_add_pd(acc0);
+}
+
+LINSIMD_AVX512_TARGET
+static float linsimd_dot_f32_avx512(size_t n, const float* a, const float* b) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), acc3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    if (i < n) {
+        __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc1);
+    }
+    acc0 = _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3));
+    return _mm512_reduce_add_ps(acc0);
+}
+
+#elif defined(LINSIMD_ARM64)
+
+#define LINSIMD_NEON_SET1_F64(s) vdupq_n_f64(s)
+#define LINSIMD_NEON_SET1_F32(s) vdupq_n_f32(s)
+
+LINSIMD_BINARY_KERNEL(add_f64, neon, , double, 2, vld1q_f64, vst1q_f64, vaddq_f64, +)
+LINSIMD_BINARY_KERNEL(sub_f64, neon, , double, 2, vld1q_f64, vst1q_f64, vsubq_f64, -)
+LINSIMD_SCALAR_OP_KERNEL(scale_f64, neon, , double, 2, vld1q_f64, vst1q_f64, LINSIMD_NEON_SET1_F64, vmulq_f64, *)
+LINSIMD_SCALAR_OP_KERNEL(div_f64, neon, , double, 2, vld1q_f64, vst1q_f64, LINSIMD_NEON_SET1_F64, vdivq_f64, /)
+LINSIMD_BINARY_KERNEL(add_f32, neon, , float, 4, vld1q_f32, vst1q_f32, vaddq_f32, +)
+LINSIMD_BINARY_KERNEL(sub_f32, neon, , float, 4, vld1q_f32, vst1q_f32, vsubq_f32, -)
+LINSIMD_SCALAR_OP_KERNEL(scale_f32, neon, , float, 4, vld1q_f32, vst1q_f32, LINSIMD_NEON_SET1_F32, vmulq_f32, *)
+LINSIMD_SCALAR_OP_KERNEL(div_f32, neon, , float, 4, vld1q_f32, vst1q_f32, LINSIMD_NEON_SET1_F32, vdivq_f32, /)
+
+#define LINSIMD_NEON_KEEP(inv, norm2) vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(inv), vcgtq_f64(norm2, vdupq_n_f64(0))))
+
+LINSIMD_VEC3_KERNELS(neon, , float64x2_t, 2, vld1q_f64, vst1q_f64, vaddq_f64, vsubq_f64, vmulq_f64, vdivq_f64, vsqrtq_f64, vdupq_n_f64, LINSIMD_NEON_KEEP)
+
+#undef LINSIMD_NEON_KEEP
+
+static double linsimd_dot_f64_neon(size_t n, const double* a, const double* b) {
+    float64x2_t acc0 = vdupq_n_f64(0);
+    float64x2_t acc1 = vdupq_n_f64(0);
+    float64x2_t acc2 = vdupq_n_f64(0);
+    float64x2_t acc3 = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+        acc1 = vfmaq_f64(acc1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+        acc2 = vfmaq_f64(acc2, vld1q_f64(a + i + 4), vld1q_f64(b + i + 4));
+        acc3 = vfmaq_f64(acc3, vld1q_f64(a + i + 6), vld1q_f64(b + i + 6));
+    }
+    for (; i + 2 <= n; i += 2) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+    }
+    double sum = vaddvq_f64(vaddq_f64(vaddq_f64(acc0, acc1), vaddq_f64(acc2, acc3)));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static float linsimd_dot_f32_neon(size_t n, const float* a, const float* b) {
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    float32x4_t acc2 = vdupq_n_f32(0);
+    float32x4_t acc3 = vdupq_n_f32(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc2 = vfmaq_f32(acc2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        acc3 = vfmaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float sum = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#endif
+
+#if defined(LINSIMD_X86)
+#undef LINSIMD_AVX2_TARGET
+#undef LINSIMD_AVX512_TARGET
+#endif
+#undef LINSIMD_BINARY_KERNEL
+#undef LINSIMD_SCALAR_OP_KERNEL
+#undef LINSIMD_VEC3_KERNELS
+
+/*
+ * Public entry points: dispatch on the active instruction set.
+ */
+
+/*
+ * `ret` is `return` for the kernels producing a value and empty otherwise.
+ */
+#if defined(LINSIMD_X86)
+#define LINSIMD_DISPATCH(ret, name, ...) \
+    switch (linsimd_active()) { \
+        case LINSIMD_AVX512: ret linsimd_##name##_avx512(__VA_ARGS__); break; \
+        case LINSIMD_AVX2: ret linsimd_##name##_avx2(__VA_ARGS__); break; \
+        default: ret linsimd_##name##_scalar(__VA_ARGS__); break; \
+    }
+#elif defined(LINSIMD_ARM64)
+#define LINSIMD_DISPATCH(ret, name, ...) \
+    switch (linsimd_active()) { \
+        case LINSIMD_NEON: ret linsimd_##name##_neon(__VA_ARGS__); break; \
+        default: ret linsimd_##name##_scalar(__VA_ARGS__); break; \
+    }
+#else
+#define LINSIMD_DISPATCH(ret, name, ...) \
+    ret linsimd_##name##_scalar(__VA_ARGS__);
+#endif
+
+double linsimd_dot_f64(size_t n, const double* a, const double* b) {
+    LINSIMD_DISPATCH(return, dot_f64, n, a, b)
+}
+
+float linsimd_dot_f32(size_t n, const float* a, const float* b) {
+    LINSIMD_DISPATCH(return, dot_f32, n, a, b)
+}
+
+void linsimd_add_f64(size_t n, const double* a, const double* b, double* r) {
+    LINSIMD_DISPATCH(, add_f64, n, a, b, r)
+}
+
+void linsimd_add_f32(size_t n, const float* a, const float* b, float* r) {
+    LINSIMD_DISPATCH(, add_f32, n, a, b, r)
+}
+
+void linsimd_sub_f64(size_t n, const double* a, const double* b, double* r) {
+    LINSIMD_DISPATCH(, sub_f64, n, a, b, r)
+}
+
+void linsimd_sub_f32(size_t n, const float* a, const float* b, float* r) {
+    LINSIMD_DISPATCH(, sub_f32, n, a, b, r)
+}
+
+void linsimd_scale_f64(size_t n, const double* a, double s, double* r) {
+    LINSIMD_DISPATCH(, scale_f64, n, a, s, r)
+}
+
+void linsimd_scale_f32(size_t n, const float* a, float s, float* r) {
+    LINSIMD_DISPATCH(, scale_f32, n, a, s, r)
+}
+
+void linsimd_div_f64(size_t n, const double* a, double s, double* r) {
+    LINSIMD_DISPATCH(, div_f64, n, a, s, r)
+}
+
+void linsimd_div_f32(size_t n, const float* a, float s, float* r) {
+    LINSIMD_DISPATCH(, div_f32, n, a, s, r)
+}
+
+void linsimd_cross3_f64(size_t n, const double* const a[3], const double* const b[3], double* const r[3]) {
+    LINSIMD_DISPATCH(, cross3_f64, n, a, b, r)
+}
+
+void linsimd_dot3_f64(size_t n, const double* const a[3], const double* const b[3], double* r) {
+    LINSIMD_DISPATCH(, dot3_f64, n, a, b, r)
+}
+
+void linsimd_normalize3_f64(size_t n, const double* const a[3], double* const r[3]) {
+    LINSIMD_DISPATCH(, normalize3_f64, n, a, r)
+}
+
+#undef LINSIMD_DISPATCH
@@ -0,0 +1,180 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+
+/**
+ * The instruction sets the floating point vector kernels are implemented for.
+ */
+typedef enum linsimd_isa {
+    LINSIMD_SCALAR, // Portable C, unrolled
+    LINSIMD_NEON,   // AArch64 Advanced SIMD
+    LINSIMD_AVX2,   // x86-64 AVX2 + FMA
+    LINSIMD_AVX512  // x86-64 AVX-512F
+} linsimd_isa;
+
+/**
+ * Returns the best instruction set supported by the running CPU.
+ *
+ * @return The detected instruction set.
+ */
+linsimd_isa linsimd_detect(void);
+
+/**
+ * Returns the instruction set the kernels currently dispatch to.
+ *
+ * Defaults to linsimd_detect() on first use.
+ *
+ * @return The active instruction set.
+ */
+linsimd_isa linsimd_active(void);
+
+/**
+ * Forces the kernels to dispatch to the given instruction set.
+ *
+ * Requests for an instruction set the CPU does not support fall back to the
+ * detected one.
+ *
+ * @param isa The instruction set to use.
+ * @return The instruction set actually selected.
+ */
+linsimd_isa linsimd_force(linsimd_isa isa);
+
+/**
+ * Calculates the dot product of two double arrays.
+ *
+ * The sum is accumulated in several independent vector registers, so its
+ * rounding differs from a serial loop.
+ *
+ * @param n The number of elements.
+ * @param a The first array.
+ * @param b The second array.
+ * @return The dot product.
+ */
+double linsimd_dot_f64(size_t n, const double* a, const double* b);
+
+/**
+ * Calculates the dot product of two float arrays.
+ *
+ * @param n The number of elements.
+ * @param a The first array.
+ * @param b The second array.
+ * @return The dot product.
+ */
+float linsimd_dot_f32(size_t n, const float* a, const float* b);
+
+/**
+ * Computes r[i] = a[i] + b[i]. `r` may alias `a` or `b`.
+ *
+ * @param n The number of elements.
+ * @param a The first array.
+ * @param b The second array.
+ * @param r The output array.
+ */
+void linsimd_add_f64(size_t n, const double* a, const double* b, double* r);
+
+/**
+ * Computes r[i] = a[i] + b[i]. `r` may alias `a` or `b`.
+ *
+ * @param n The number of elements.
+ * @param a The first array.
+ * @param b The second array.
+ * @param r The output array.
+ */
+void linsimd_add_f32(size_t n, const float* a, const float* b, float* r);
+
+/**
+ * Computes r[i] = a[i] - b[i]. `r` may alias `a` or `b`.
+ *
+ * @param n The number of elements.
+ * @param a The first array.
+ * @param b The second array.
+ * @param r The output array.
+ */
+void linsimd_sub_f64(size_t n, const double* a, const double* b, double* r);
+
+/**
+ * Computes r[i] = a[i] - b[i]. `r` may alias `a` or `b`.
+ *
+ * @param n The number of elements.
+ * @param a The first array.
+ * @param b The second array.
+ * @param r The output array.
+ */
+void linsimd_sub_f32(size_t n, const float* a, const float* b, float* r);
+
+/**
+ * Computes r[i] = a[i] * s. `r` may alias `a`.
+ *
+ * @param n The number of elements.
+ * @param a The input array.
+ * @param s The scalar.
+ * @param r The output array.
+ */
+void linsimd_scale_f64(size_t n, const double* a, double s, double* r);
+
+/**
+ * Computes r[i] = a[i] * s. `r` may alias `a`.
+ *
+ * @param n The number of elements.
+ * @param a The input array.
+ * @param s The scalar.
+ * @param r The output array.
+ */
+void linsimd_scale_f32(size_t n, const float* a, float s, float* r);
+
+/**
+ * Computes r[i] = a[i] / s. `r` may alias `a`.
+ *
+ * @param n The number of elements.
+ * @param a The input array.
+ * @param s The scalar.
+ * @param r The output array.
+ */
+void linsimd_div_f64(size_t n, const double* a, double s, double* r);
+
+/**
+ * Computes r[i] = a[i] / s. `r` may alias `a`.
+ *
+ * @param n The number of elements.
+ * @param a The input array.
+ * @param s The scalar.
+ * @param r The output array.
+ */
+void linsimd_div_f32(size_t n, const float* a, float s, float* r);
+
+/*
+ * Kernels over batches of 3D vectors stored as structure-of-arrays: `a[0]`,
+ * `a[1]` and `a[2]` are the x, y and z arrays of n vectors. They use plain
+ * multiplies and adds rather than FMA, so every instruction set rounds exactly
+ * like the scalar code.
+ */
+
+/**
+ * Computes the cross products r[i] = a[i] x b[i]. `r` may alias `a` or `b`.
+ *
+ * @param n The number of vectors.
+ * @param a The x, y and z arrays of the first vectors.
+ * @param b The x, y and z arrays of the second vectors.
+ * @param r The x, y and z arrays of the output.
+ */
+void linsimd_cross3_f64(size_t n, const double* const a[3], const double* const b[3], double* const r[3]);
+
+/**
+ * Computes the dot products r[i] = a[i] . b[i].
+ *
+ * @param n The number of vectors.
+ * @param a The x, y and z arrays of the first vectors.
+ * @param b The x, y and z arrays of the second vectors.
+ * @param r The output array.
+ */
+void linsimd_dot3_f64(size_t n, const double* const a[3], const double* const b[3], double* r);
+
+/**
+ * Scales every vector to unit length. Zero vectors stay zero. `r` may alias `a`.
+ *
+ * @param n The number of vectors.
+ * @param a The x, y and z arrays of the input.
+ * @param r The x, y and z arrays of the output.
+ */
+void linsimd_normalize3_f64(size_t n, const double* const a[3], double* const r[3]);
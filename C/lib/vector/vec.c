@@ -0,0 +1,229 @@
+#include"./vec.h"
+#include"./simd.h"
+#include<math.h>
+
+linvec2 linvec2_add(linvec2 a, linvec2 b) {
+    return (linvec2){a.x + b.x, a.y + b.y};
+}
+
+linvec3 linvec3_add(linvec3 a, linvec3 b) {
+    return (linvec3){a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+linvec4 linvec4_add(linvec4 a, linvec4 b) {
+    return (linvec4){a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+
+linvec2 linvec2_sub(linvec2 a, linvec2 b) {
+    return (linvec2){a.x - b.x, a.y - b.y};
+}
+
+linvec3 linvec3_sub(linvec3 a, linvec3 b) {
+    return (linvec3){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+linvec4 linvec4_sub(linvec4 a, linvec4 b) {
+    return (linvec4){a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+}
+
+linvec2 linvec2_scale(linvec2 a, double s) {
+    return (linvec2){a.x * s, a.y * s};
+}
+
+linvec3 linvec3_scale(linvec3 a, double s) {
+    return (linvec3){a.x * s, a.y * s, a.z * s};
+}
+
+linvec4 linvec4_scale(linvec4 a, double s) {
+    return (linvec4){a.x * s, a.y * s, a.z * s, a.w * s};
+}
+
+double linvec2_dot(linvec2 a, linvec2 b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+double linvec3_dot(linvec3 a, linvec3 b) {
+    return (a.x * b.x + a.y * b.y) + a.z * b.z;
+}
+
+double linvec4_dot(linvec4 a, linvec4 b) {
+    return (a.x * b.x + a.y * b.y) + (a.z * b.z + a.w * b.w);
+}
+
+double linvec2_norm(linvec2 a) {
+    return sqrt(linvec2_dot(a, a));
+}
+
+double linvec3_norm(linvec3 a) {
+    return sqrt(linvec3_dot(a, a));
+}
+
+double linvec4_norm(linvec4 a) {
+    return sqrt(linvec4_dot(a, a));
+}
+
+/*
+ * Returns the factor that scales a vector of the given squared norm to unit
+ * length, 0 for the zero vector.
+ */
+static double linvec_inv_norm(double norm2) {
+    return norm2 > 0 ? 1.0 / sqrt(norm2) : 0.0;
+}
+
+linvec2 linvec2_normalize(linvec2 a) {
+    return linvec2_scale(a, linvec_inv_norm(linvec2_dot(a, a)));
+}
+
+linvec3 linvec3_normalize(linvec3 a) {
+    return linvec3_scale(a, linvec_inv_norm(linvec3_dot(a, a)));
+}
+
+linvec4 linvec4_normalize(linvec4 a) {
+    return linvec4_scale(a, linvec_inv_norm(linvec4_dot(a, a)));
+}
+
+/*
+ * Approximates the elements of a linvector of exactly `size` elements into `out`.
+ */
+static void linvec_read(linvector* vec, size_t size, double* out) {
+    if (vec->size != size) {
+        fprintf(stderr, "Error: the size of the vector must match the size of the fixed-size vector.\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < size; i++) {
+        out[i] = (double)realnum_as_aprox(&vec->data[i]).value.aprox;
+    }
+}
+
+static linvector linvec_write(const double* values, size_t size) {
+    linvector vec = linvector_with_capacity(size);
+    for (size_t i = 0; i < size; i++) {
+        vec.data[i] = realnum_from_aprox(values[i]);
+    }
+    vec.size = size;
+    return vec;
+}
+
+linvec2 linvec2_from_linvector(linvector* vec) {
+    double v[2];
+    linvec_read(vec, 2, v);
+    return (linvec2){v[0], v[1]};
+}
+
+linvec3 linvec3_from_linvector(linvector* vec) {
+    double v[3];
+    linvec_read(vec, 3, v);
+    return (linvec3){v[0], v[1], v[2]};
+}
+
+linvec4 linvec4_from_linvector(linvector* vec) {
+    double v[4];
+    linvec_read(vec, 4, v);
+    return (linvec4){v[0], v[1], v[2], v[3]};
+}
+
+linvector linvec2_to_linvector(linvec2 a) {
+    return linvec_write((double[]){a.x, a.y}, 2);
+}
+
+linvector linvec3_to_linvector(linvec3 a) {
+    return linvec_write((double[]){a.x, a.y, a.z}, 3);
+}
+
+linvector linvec4_to_linvector(linvec4 a) {
+    return linvec_write((double[]){a.x, a.y, a.z, a.w}, 4);
+}
+
+double linvec2_cross(linvec2 a, linvec2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+linvec3 linvec3_cross(linvec3 a, linvec3 b) {
+    return (linvec3){a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+linvec3_batch linvec3_batch_with_capacity(size_t capacity) {
+    linvec3_batch batch;
+    batch.size = 0;
+    batch.capacity = 0;
+    batch.x = NULL;
+    batch.y = NULL;
+    batch.z = NULL;
+    linvec3_batch_reserve(&batch, capacity);
+    return batch;
+}
+
+linvec3_batch linvec3_batch_zero(size_t size) {
+    linvec3_batch batch = linvec3_batch_with_capacity(size);
+    for (size_t i = 0; i < size; i++) {
+        batch.x[i] = 0;
+        batch.y[i] = 0;
+        batch.z[i] = 0;
+    }
+    batch.size = size;
+    return batch;
+}
+
+void linvec3_batch_reserve(linvec3_batch* batch, size_t capacity) {
+    if (capacity <= batch->capacity) {
+        return;
+    }
+    batch->x = realloc(batch->x, capacity * sizeof(double));
+    batch->y = realloc(batch->y, capacity * sizeof(double));
+    batch->z = realloc(batch->z, capacity * sizeof(double));
+    batch->capacity = capacity;
+}
+
+void linvec3_batch_push(linvec3_batch* batch, linvec3 value) {
+    if (batch->size == batch->capacity) {
+        linvec3_batch_reserve(batch, batch->capacity ? batch->capacity * 2 : LINVECTOR_DEFAULT_CAPACITY);
+    }
+    linvec3_batch_set(batch, batch->size++, value);
+}
+
+linvec3 linvec3_batch_get(linvec3_batch* batch, size_t index) {
+    return (linvec3){batch->x[index], batch->y[index], batch->z[index]};
+}
+
+void linvec3_batch_set(linvec3_batch* batch, size_t index, linvec3 value) {
+    batch->x[index] = value.x;
+    batch->y[index] = value.y;
+    batch->z[index] = value.z;
+}
+
+void linvec3_batch_free(linvec3_batch* batch) {
+    free(batch->x);
+    free(batch->y);
+    free(batch->z);
+    batch->x = NULL;
+    batch->y = NULL;
+    batch->z = NULL;
+    batch->size = 0;
+    batch->capacity = 0;
+}
+
+void linvec3_batch_cross(linvec3_batch* dst, linvec3_batch* a, linvec3_batch* b) {
+    if (a->size != b->size) {
+        fprintf(stderr, "Error: batches must have the same size for a cross product.\n");
+        exit(1);
+    }
+    size_t n = a->size;
+    linvec3_batch_reserve(dst, n);
+    linsimd_cross3_f64(n, (const double* const[]){a->x, a->y, a->z}, (const double* const[]){b->x, b->y, b->z}, (double* const[]){dst->x, dst->y, dst->z});
+    dst->size = n;
+}
+
+void linvec3_batch_dot(double* dst, linvec3_batch* a, linvec3_batch* b) {
+    if (a->size != b->size) {
+        fprintf(stderr, "Error: batches must have the same size for a dot product.\n");
+        exit(1);
+    }
+    linsimd_dot3_f64(a->size, (const double* const[]){a->x, a->y, a->z}, (const double* const[]){b->x, b->y, b->z}, dst);
+}
+
+void linvec3_batch_normalize(linvec3_batch* dst, linvec3_batch* a) {
+    size_t n = a->size;
+    linvec3_batch_reserve(dst, n);
+    linsimd_normalize3_f64(n, (const double* const[]){a->x, a->y, a->z}, (double* const[]){dst->x, dst->y, dst->z});
+    dst->size = n;
+}
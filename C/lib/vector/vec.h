@@ -0,0 +1,249 @@
+#pragma once
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include"./vector.h"
+
+/*
+ * Fixed-size vectors of doubles for geometry code.
+ *
+ * Unlike `linvector` these never allocate: they are plain structs passed and
+ * returned by value. Large numbers of 3D vectors are better kept in a
+ * linvec3_batch, whose kernels process several vectors per instruction.
+ */
+
+/**
+ * @struct linvec2
+ * @brief A 2D vector of doubles.
+ */
+typedef struct linvec2 {
+    double x;
+    double y;
+} linvec2;
+
+/**
+ * @struct linvec3
+ * @brief A 3D vector of doubles.
+ */
+typedef struct linvec3 {
+    double x;
+    double y;
+    double z;
+} linvec3;
+
+/**
+ * @struct linvec4
+ * @brief A 4D vector of doubles.
+ */
+typedef struct linvec4 {
+    double x;
+    double y;
+    double z;
+    double w;
+} linvec4;
+
+/**
+ * @struct linvec3_batch
+ * @brief A growable batch of 3D vectors stored as structure-of-arrays.
+ *
+ * The x, y and z components of vector i are `x[i]`, `y[i]` and `z[i]`, so the
+ * batch kernels load the same component of consecutive vectors into one SIMD
+ * register, see the 3D kernels of simd.h.
+ */
+typedef struct linvec3_batch {
+    size_t size;
+    size_t capacity;
+    double* x;
+    double* y;
+    double* z;
+} linvec3_batch;
+
+/**
+ * Adds two vectors component-wise.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The sum.
+ */
+linvec2 linvec2_add(linvec2 a, linvec2 b);
+linvec3 linvec3_add(linvec3 a, linvec3 b);
+linvec4 linvec4_add(linvec4 a, linvec4 b);
+
+/**
+ * Subtracts the second vector from the first component-wise.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The difference.
+ */
+linvec2 linvec2_sub(linvec2 a, linvec2 b);
+linvec3 linvec3_sub(linvec3 a, linvec3 b);
+linvec4 linvec4_sub(linvec4 a, linvec4 b);
+
+/**
+ * Multiplies every component of a vector by a scalar.
+ *
+ * @param a The vector.
+ * @param s The scalar.
+ * @return The scaled vector.
+ */
+linvec2 linvec2_scale(linvec2 a, double s);
+linvec3 linvec3_scale(linvec3 a, double s);
+linvec4 linvec4_scale(linvec4 a, double s);
+
+/**
+ * Calculates the dot product of two vectors.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The dot product.
+ */
+double linvec2_dot(linvec2 a, linvec2 b);
+double linvec3_dot(linvec3 a, linvec3 b);
+double linvec4_dot(linvec4 a, linvec4 b);
+
+/**
+ * Calculates the Euclidean norm of a vector.
+ *
+ * @param a The vector.
+ * @return The norm.
+ */
+double linvec2_norm(linvec2 a);
+double linvec3_norm(linvec3 a);
+double linvec4_norm(linvec4 a);
+
+/**
+ * Scales a vector to unit length. The zero vector stays zero.
+ *
+ * @param a The vector.
+ * @return The normalized vector.
+ */
+linvec2 linvec2_normalize(linvec2 a);
+linvec3 linvec3_normalize(linvec3 a);
+linvec4 linvec4_normalize(linvec4 a);
+
+/**
+ * Converts a linvector of matching size, approximating its elements.
+ *
+ * @param vec The linvector, which must have 2, 3 or 4 elements respectively.
+ * @return The fixed-size vector.
+ */
+linvec2 linvec2_from_linvector(linvector* vec);
+linvec3 linvec3_from_linvector(linvector* vec);
+linvec4 linvec4_from_linvector(linvector* vec);
+
+/**
+ * Converts a fixed-size vector to a heap allocated linvector of REALNUM_APROX elements.
+ *
+ * @param a The vector.
+ * @return The newly created linvector.
+ */
+linvector linvec2_to_linvector(linvec2 a);
+linvector linvec3_to_linvector(linvec3 a);
+linvector linvec4_to_linvector(linvec4 a);
+
+/**
+ * Calculates the z component of the cross product of two 2D vectors.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return a.x * b.y - a.y * b.x.
+ */
+double linvec2_cross(linvec2 a, linvec2 b);
+
+/**
+ * Calculates the cross product of two 3D vectors.
+ *
+ * @param a The first vector.
+ * @param b The second vector.
+ * @return The cross product.
+ */
+linvec3 linvec3_cross(linvec3 a, linvec3 b);
+
+/**
+ * Creates a new empty batch with the specified capacity.
+ *
+ * @param capacity The number of vectors to make room for.
+ * @return The newly created batch.
+ */
+linvec3_batch linvec3_batch_with_capacity(size_t capacity);
+
+/**
+ * Creates a new batch of the specified size with every vector set to 0.
+ *
+ * @param size The number of vectors.
+ * @return The newly created batch.
+ */
+linvec3_batch linvec3_batch_zero(size_t size);
+
+/**
+ * Reserves memory for at least the specified number of vectors.
+ *
+ * @param batch The batch.
+ * @param capacity The number of vectors to make room for.
+ */
+void linvec3_batch_reserve(linvec3_batch* batch, size_t capacity);
+
+/**
+ * Appends a vector to the batch.
+ *
+ * @param batch The batch.
+ * @param value The vector to append.
+ */
+void linvec3_batch_push(linvec3_batch* batch, linvec3 value);
+
+/**
+ * Returns the vector at the given index.
+ *
+ * @param batch The batch.
+ * @param index The index of the vector.
+ * @return The vector.
+ */
+linvec3 linvec3_batch_get(linvec3_batch* batch, size_t index);
+
+/**
+ * Replaces the vector at the given index.
+ *
+ * @param batch The batch.
+ * @param index The index of the vector.
+ * @param value The vector to store.
+ */
+void linvec3_batch_set(linvec3_batch* batch, size_t index, linvec3 value);
+
+/**
+ * Frees the memory occupied by the given batch.
+ *
+ * @param batch The batch to free.
+ */
+void linvec3_batch_free(linvec3_batch* batch);
+
+/**
+ * Computes the cross products dst[i] = a[i] x b[i].
+ *
+ * `dst` is resized to the size of the inputs and may be `a` or `b`.
+ *
+ * @param dst The batch to store the results in.
+ * @param a The first batch.
+ * @param b The second batch, of the same size.
+ */
+void linvec3_batch_cross(linvec3_batch* dst, linvec3_batch* a, linvec3_batch* b);
+
+/**
+ * Computes the dot products dst[i] = a[i] . b[i].
+ *
+ * @param dst The array to store the results in, with room for `a->size` values.
+ * @param a The first batch.
+ * @param b The second batch, of the same size.
+ */
+void linvec3_batch_dot(double* dst, linvec3_batch* a, linvec3_batch* b);
+
+/**
+ * Scales every vector of a batch to unit length. Zero vectors stay zero.
+ *
+ * `dst` is resized to the size of `a` and may be `a`.
+ *
+ * @param dst The batch to store the results in.
+ * @param a The batch to normalize.
+ */
+void linvec3_batch_normalize(linvec3_batch* dst, linvec3_batch* a);
@@ -1,4 +1,5 @@
 #include"./vector.h"
+#include"../stats/stats.h"
 
 linvector linvector_new(size_t n, ...) {
     linvector vec = linvector_with_capacity(n+1);
@@ -17,6 +18,35 @@ linvector linvector_with_capacity(size_t capacity) {
     vec.size = 0;
     vec.capacity = capacity;
     vec.data = malloc(capacity * sizeof(realnum));
+    vec.arena = NULL;
+    vec.borrowed = false;
+    LINSTATS_ALLOC(LINSTATS_VECTOR_ALLOC, capacity * sizeof(realnum));
+    return vec;
+}
+
+linvector linvector_with_capacity_in(linarena* arena, size_t capacity) {
+    linvector vec;
+    vec.size = 0;
+    vec.capacity = capacity;
+    vec.data = linarena_alloc(arena, capacity * sizeof(realnum));
+    vec.arena = arena;
+    vec.borrowed = false;
+    return vec;
+}
+
+linvector linvector_with_data(realnum* data, size_t size) {
+    linvector vec;
+    vec.size = size;
+    vec.capacity = size;
+    vec.data = data;
+    vec.arena = NULL;
+    vec.borrowed = false;
+    return vec;
+}
+
+linvector linvector_borrow(realnum* data, size_t size) {
+    linvector vec = linvector_with_data(data, size);
+    vec.borrowed = true;
     return vec;
 }
 
@@ -25,15 +55,39 @@ linvector* linvector_clone(linvector* vec) {
     clone->size = vec->size;
     clone->capacity = vec->size;
     clone->data = malloc(vec->size * sizeof(realnum));
+    clone->arena = NULL;
+    clone->borrowed = false;
+    LINSTATS_ALLOC(LINSTATS_VECTOR_ALLOC, vec->size * sizeof(realnum));
+
+    for (size_t i = 0; i < vec->size; i++) {
+        clone->data[i] = realnum_clone(&vec->data[i]);
+    }
+    return clone;
+}
 
+linvector linvector_clone_in(linarena* arena, linvector* vec) {
+    linvector clone = linvector_with_capacity_in(arena, vec->size);
     for (size_t i = 0; i < vec->size; i++) {
-        clone->data[i] = vec->data[i];
+        clone.data[i] = realnum_clone(&vec->data[i]);
     }
+    clone.size = vec->size;
     return clone;
 }
 
 void linvector_free(linvector* vec) {
-    free(vec->data);
+    if (vec->borrowed) {
+        vec->data = NULL;
+        vec->size = 0;
+        vec->capacity = 0;
+        return;
+    }
+    for (size_t i = 0; i < vec->size; i++) {
+        realnum_free(&vec->data[i]);
+    }
+    if (vec->arena == NULL) {
+        free(vec->data);
+    }
+    vec->data = NULL;
     vec->size = 0;
     vec->capacity = 0;
 }
@@ -49,97 +103,368 @@ void linvector_print(linvector* vec, uint16_t precision) {
     printf("]");
 }
 
+void linvector_reserve(linvector* vec, size_t capacity) {
+    if (capacity <= vec->capacity) {
+        return;
+    }
+    if (vec->borrowed) {
+        fprintf(stderr, "Error: a linvector that borrows its elements cannot grow.\n");
+        exit(1);
+    }
+    if (vec->arena != NULL) {
+        vec->data = linarena_realloc(vec->arena, vec->data, vec->capacity * sizeof(realnum), capacity * sizeof(realnum));
+    } else {
+        vec->data = realloc(vec->data, capacity * sizeof(realnum));
+    }
+    LINSTATS_ALLOC(LINSTATS_VECTOR_REALLOC, (capacity - vec->capacity) * sizeof(realnum));
+    vec->capacity = capacity;
+}
+
 void linvector_push(linvector* vec, realnum value) {
     if (vec->size == vec->capacity) {
-        vec->capacity *= 2;
-        vec->data = realloc(vec->data, vec->capacity * sizeof(realnum));
+        linvector_reserve(vec, vec->capacity ? vec->capacity * 2 : LINVECTOR_DEFAULT_CAPACITY);
     }
     vec->data[(vec->size)++] = value;
 }
 
-linvector linvector_add(linvector* vec1, linvector* vec2) {
+/*
+ * Stores a freshly computed element of `dst`, releasing the one it replaces.
+ */
+static void linvector_store(linvector* dst, size_t index, realnum value) {
+    if (index < dst->size) {
+        realnum_free(&dst->data[index]);
+    }
+    dst->data[index] = value;
+}
+
+/*
+ * Sets the size of `dst` after it was filled, releasing the elements past it.
+ */
+static void linvector_truncate(linvector* dst, size_t size) {
+    for (size_t i = size; i < dst->size; i++) {
+        realnum_free(&dst->data[i]);
+    }
+    dst->size = size;
+}
+
+void linvector_add_into(linvector* dst, linvector* vec1, linvector* vec2) {
     if (vec1->size != vec2->size) {
         fprintf(stderr, "Error: vectors must have the same size to be added.\n");
         exit(1);
     }
-    linvector vec3 = linvector_with_capacity(vec1->size);
+    linvector_reserve(dst, vec1->size);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (vec1->size >= LINVECTOR_PARALLEL_THRESHOLD)
+    #endif
     for (size_t i = 0; i < vec1->size; i++) {
-        vec3.data[i] = realnum_add(&vec1->data[i], &vec2->data[i]);
+        linvector_store(dst, i, realnum_add(&vec1->data[i], &vec2->data[i]));
     }
-    vec3.size = vec1->size;
-    return vec3;
+    linvector_truncate(dst, vec1->size);
 }
 
-linvector linvector_sub(linvector* vec1, linvector* vec2) {
+void linvector_sub_into(linvector* dst, linvector* vec1, linvector* vec2) {
     if (vec1->size != vec2->size) {
         fprintf(stderr, "Error: vectors must have the same size to be subtracted.\n");
         exit(1);
     }
-    linvector vec3 = linvector_with_capacity(vec1->size);
+    linvector_reserve(dst, vec1->size);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (vec1->size >= LINVECTOR_PARALLEL_THRESHOLD)
+    #endif
     for (size_t i = 0; i < vec1->size; i++) {
-        vec3.data[i] = realnum_sub(&vec1->data[i], &vec2->data[i]);
+        linvector_store(dst, i, realnum_sub(&vec1->data[i], &vec2->data[i]));
     }
-    vec3.size = vec1->size;
+    linvector_truncate(dst, vec1->size);
+}
+
+void linvector_mul_into(linvector* dst, linvector* a, realnum scalar) {
+    linvector_reserve(dst, a->size);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= LINVECTOR_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < a->size; i++) {
+        linvector_store(dst, i, realnum_mul(&a->data[i], &scalar));
+    }
+    linvector_truncate(dst, a->size);
+}
+
+void linvector_div_into(linvector* dst, linvector* a, realnum scalar) {
+    linvector_reserve(dst, a->size);
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= LINVECTOR_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < a->size; i++) {
+        linvector_store(dst, i, realnum_div(&a->data[i], &scalar));
+    }
+    linvector_truncate(dst, a->size);
+}
+
+void linvector_normalize_into(linvector* dst, linvector* vec) {
+    realnum norm = linvector_norm(vec);
+    linvector_div_into(dst, vec, norm);
+    realnum_free(&norm);
+}
+
+void linvector_cross_into(linvector* dst, linvector* vec1, linvector* vec2) {
+    if (vec1->size != 3 || vec2->size != 3) {
+        fprintf(stderr, "Error: cross product is only applicable to 3D vectors.\n");
+        exit(1);
+    }
+    realnum result[3];
+    realnum temp1 = realnum_mul(&vec1->data[1], &vec2->data[2]);
+    realnum temp2 = realnum_mul(&vec1->data[2], &vec2->data[1]);
+    result[0] = realnum_sub(&temp1, &temp2);
+    realnum_free(&temp1);
+    realnum_free(&temp2);
+
+    temp1 = realnum_mul(&vec1->data[2], &vec2->data[0]);
+    temp2 = realnum_mul(&vec1->data[0], &vec2->data[2]);
+    result[1] = realnum_sub(&temp1, &temp2);
+    realnum_free(&temp1);
+    realnum_free(&temp2);
+
+    temp1 = realnum_mul(&vec1->data[0], &vec2->data[1]);
+    temp2 = realnum_mul(&vec1->data[1], &vec2->data[0]);
+    result[2] = realnum_sub(&temp1, &temp2);
+    realnum_free(&temp1);
+    realnum_free(&temp2);
+
+    linvector_reserve(dst, 3);
+    for (size_t i = 0; i < 3; i++) {
+        linvector_store(dst, i, result[i]);
+    }
+    linvector_truncate(dst, 3);
+}
+
+void linvector_add_assign(linvector* a, linvector* b) {
+    linvector_add_into(a, a, b);
+}
+
+void linvector_sub_assign(linvector* a, linvector* b) {
+    linvector_sub_into(a, a, b);
+}
+
+void linvector_mul_assign(linvector* a, realnum scalar) {
+    linvector_mul_into(a, a, scalar);
+}
+
+void linvector_div_assign(linvector* a, realnum scalar) {
+    linvector_div_into(a, a, scalar);
+}
+
+void linvector_normalize_assign(linvector* a) {
+    linvector_normalize_into(a, a);
+}
+
+void linvector_axpy(linvector* y, realnum alpha, linvector* x) {
+    linvector_view yv = linvector_view_of(y);
+    linvector_view xv = linvector_view_of(x);
+    linvector_view_axpy(&yv, alpha, &xv);
+}
+
+linvector linvector_add(linvector* vec1, linvector* vec2) {
+    linvector vec3 = linvector_with_capacity(vec1->size);
+    linvector_add_into(&vec3, vec1, vec2);
+    return vec3;
+}
+
+linvector linvector_sub(linvector* vec1, linvector* vec2) {
+    linvector vec3 = linvector_with_capacity(vec1->size);
+    linvector_sub_into(&vec3, vec1, vec2);
     return vec3;
 }
 
 linvector linvector_mul(linvector* a, realnum scalar) {
     linvector vec = linvector_with_capacity(a->size);
-    for (size_t i = 0; i < a->size; i++) {
-        vec.data[i] = realnum_mul(&a->data[i], &scalar);
-    }
-    vec.size = a->size;
+    linvector_mul_into(&vec, a, scalar);
     return vec;
 }
 
 linvector linvector_div(linvector* a, realnum scalar) {
     linvector vec = linvector_with_capacity(a->size);
-    for (size_t i = 0; i < a->size; i++) {
-        vec.data[i] = realnum_div(&a->data[i], &scalar);
-    }
-    vec.size = a->size;
+    linvector_div_into(&vec, a, scalar);
     return vec;
 }
 
 realnum linvector_dot(linvector* vec1, linvector* vec2) {
-    if (vec1->size != vec2->size) {
-        fprintf(stderr, "Error: vectors must have the same size to calculate the dot product.\n");
-        exit(1);
-    }
-    realnum result = realnum_from_aprox(0.0);
-    for (size_t i = 0; i < vec1->size; i++) {
-        realnum temp = realnum_mul(&vec1->data[i], &vec2->data[i]);
-        result = realnum_add(&result, &temp);
-    }
-    return result;
+    linvector_view a = linvector_view_of(vec1);
+    linvector_view b = linvector_view_of(vec2);
+    return linvector_view_dot(&a, &b);
 }
 
 realnum linvector_norm(linvector* vec) {
     realnum res = linvector_dot(vec, vec);
-    return realnum_sqrt(&res);
+    realnum norm = realnum_sqrt(&res);
+    realnum_free(&res);
+    return norm;
 }
 
 linvector linvector_normalize(linvector* vec) {
-    realnum norm = linvector_norm(vec);
-    return linvector_div(vec, norm);
+    linvector result = linvector_with_capacity(vec->size);
+    linvector_normalize_into(&result, vec);
+    return result;
 }
 
 linvector linvector_cross(linvector* vec1, linvector* vec2) {
-    if (vec1->size != 3 || vec2->size != 3) {
-        fprintf(stderr, "Error: cross product is only applicable to 3D vectors.\n");
+    linvector vec3 = linvector_with_capacity(3);
+    linvector_cross_into(&vec3, vec1, vec2);
+    return vec3;
+}
+
+linvector_view linvector_view_of(linvector* vec) {
+    return (linvector_view){vec->size, 1, vec->data};
+}
+
+linvector_view linvector_view_slice(linvector_view* view, size_t start, size_t size, size_t stride) {
+    if (stride == 0 || (size > 0 && start + (size - 1) * stride >= view->size)) {
+        fprintf(stderr, "Error: vector view out of bounds.\n");
         exit(1);
     }
-    linvector vec3 = linvector_with_capacity(3);
-    realnum temp1 = realnum_mul(&vec1->data[1], &vec2->data[2]);
-    realnum temp2 = realnum_mul(&vec1->data[2], &vec2->data[1]);
-    vec3.data[0] = realnum_sub(&temp1, &temp2);
+    return (linvector_view){size, view->stride * stride, size > 0 ? view->data + start * view->stride : view->data};
+}
 
-    temp1 = realnum_mul(&vec1->data[2], &vec2->data[0]);
-    temp2 = realnum_mul(&vec1->data[0], &vec2->data[2]);
-    vec3.data[1] = realnum_sub(&temp1, &temp2);
+realnum linvector_view_get(linvector_view* view, size_t index) {
+    if (index >= view->size) {
+        fprintf(stderr, "Error: vector view index out of bounds.\n");
+        exit(1);
+    }
+    return view->data[index * view->stride];
+}
 
-    temp1 = realnum_mul(&vec1->data[0], &vec2->data[1]);
-    temp2 = realnum_mul(&vec1->data[1], &vec2->data[0]);
-    vec3.data[2] = realnum_sub(&temp1, &temp2);
-    return vec3;
+void linvector_view_set(linvector_view* view, size_t index, realnum value) {
+    if (index >= view->size) {
+        fprintf(stderr, "Error: vector view index out of bounds.\n");
+        exit(1);
+    }
+    realnum_free(&view->data[index * view->stride]);
+    view->data[index * view->stride] = value;
+}
+
+linvector linvector_view_to_vector(linvector_view* view) {
+    linvector vec = linvector_with_capacity(view->size);
+    for (size_t i = 0; i < view->size; i++) {
+        vec.data[i] = realnum_clone(&view->data[i * view->stride]);
+    }
+    vec.size = view->size;
+    return vec;
+}
+
+/*
+ * A running sum of approximated values. Under LINVECTOR_SUM_NEUMAIER `comp`
+ * collects the rounding error of every addition, to be added back at the end.
+ */
+typedef struct linvector_accumulator {
+    realnum_aprox sum;
+    realnum_aprox comp;
+} linvector_accumulator;
+
+static void linvector_accumulate(linvector_accumulator* acc, realnum_aprox x) {
+    #if LINVECTOR_SUMMATION == LINVECTOR_SUM_NEUMAIER
+    realnum_aprox t = acc->sum + x;
+    realnum_aprox abs_sum = acc->sum < 0 ? -acc->sum : acc->sum;
+    realnum_aprox abs_x = x < 0 ? -x : x;
+    acc->comp += abs_sum >= abs_x ? (acc->sum - t) + x : (x - t) + acc->sum;
+    acc->sum = t;
+    #else
+    acc->sum += x;
+    #endif
+}
+
+static realnum_aprox linvector_accumulated(linvector_accumulator* acc) {
+    // An infinite sum leaves a NaN compensation behind, the sum alone is right.
+    return acc->comp == acc->comp ? acc->sum + acc->comp : acc->sum;
+}
+
+/*
+ * Sums a[i] * b[i] for i in [begin, end) with the method of LINVECTOR_SUMMATION.
+ */
+static realnum_aprox linvector_view_dot_range(linvector_view* a, linvector_view* b, size_t begin, size_t end) {
+    #if LINVECTOR_SUMMATION == LINVECTOR_SUM_PAIRWISE
+    if (end - begin > LINVECTOR_PAIRWISE_BLOCK) {
+        size_t mid = begin + (end - begin) / 2;
+        return linvector_view_dot_range(a, b, begin, mid) + linvector_view_dot_range(a, b, mid, end);
+    }
+    #endif
+    linvector_accumulator acc = {0, 0};
+    for (size_t i = begin; i < end; i++) {
+        realnum product = realnum_mul(&a->data[i * a->stride], &b->data[i * b->stride]);
+        linvector_accumulate(&acc, realnum_as_aprox(&product).value.aprox);
+        realnum_free(&product);
+    }
+    return linvector_accumulated(&acc);
+}
+
+/*
+ * Adds up `n` > 0 partial sums as a balanced tree, neighbours first, and frees
+ * the array. The order of the additions only depends on `n`.
+ */
+static realnum linvector_sum_pairwise(realnum* values, size_t n) {
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t i = 0; i + width < n; i += 2 * width) {
+            realnum sum = realnum_add(&values[i], &values[i + width]);
+            realnum_free(&values[i]);
+            realnum_free(&values[i + width]);
+            values[i] = sum;
+        }
+    }
+    realnum result = values[0];
+    free(values);
+    return result;
+}
+
+realnum linvector_view_dot(linvector_view* a, linvector_view* b) {
+    if (a->size != b->size) {
+        fprintf(stderr, "Error: vectors must have the same size to calculate the dot product.\n");
+        exit(1);
+    }
+    size_t n = a->size;
+    LINSTATS_KERNEL_BEGIN(dot);
+    realnum result;
+    if (n < LINVECTOR_PARALLEL_THRESHOLD) {
+        result = realnum_from_aprox(linvector_view_dot_range(a, b, 0, n));
+    } else {
+        size_t chunks = (n + LINVECTOR_REDUCE_CHUNK - 1) / LINVECTOR_REDUCE_CHUNK;
+        realnum* partial = malloc(chunks * sizeof(realnum));
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (size_t c = 0; c < chunks; c++) {
+            size_t begin = c * LINVECTOR_REDUCE_CHUNK;
+            size_t end = n - begin < LINVECTOR_REDUCE_CHUNK ? n : begin + LINVECTOR_REDUCE_CHUNK;
+            partial[c] = realnum_from_aprox(linvector_view_dot_range(a, b, begin, end));
+        }
+        result = linvector_sum_pairwise(partial, chunks);
+    }
+    LINSTATS_KERNEL_END(dot, LINSTATS_VECTOR_DOT);
+    return result;
+}
+
+void linvector_view_axpy(linvector_view* y, realnum alpha, linvector_view* x) {
+    if (x->size != y->size) {
+        fprintf(stderr, "Error: vectors must have the same size for axpy.\n");
+        exit(1);
+    }
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (x->size >= LINVECTOR_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < x->size; i++) {
+        realnum* dst = &y->data[i * y->stride];
+        realnum temp = realnum_mul(&alpha, &x->data[i * x->stride]);
+        realnum sum = realnum_add(&temp, dst);
+        realnum_free(&temp);
+        realnum_free(dst);
+        *dst = sum;
+    }
+}
+
+void linvector_view_scale(linvector_view* a, realnum scalar) {
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (a->size >= LINVECTOR_PARALLEL_THRESHOLD)
+    #endif
+    for (size_t i = 0; i < a->size; i++) {
+        realnum* dst = &a->data[i * a->stride];
+        realnum product = realnum_mul(dst, &scalar);
+        realnum_free(dst);
+        *dst = product;
+    }
 }
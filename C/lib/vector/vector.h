@@ -5,9 +5,49 @@
 #include<stdlib.h>
 #include<stdarg.h>
 #include"../numeric/realnum.h"
+#include"../memory/arena.h"
 
 #define LINVECTOR_DEFAULT_CAPACITY 16
 
+/*
+ * Elementwise operations and reductions over vectors of at least
+ * LINVECTOR_PARALLEL_THRESHOLD elements are split between threads when built
+ * with OpenMP. Such reductions always sum fixed chunks of LINVECTOR_REDUCE_CHUNK
+ * elements and combine the partial sums pairwise, so their result depends
+ * neither on the number of threads nor on whether OpenMP is enabled.
+ */
+#ifndef LINVECTOR_PARALLEL_THRESHOLD
+#define LINVECTOR_PARALLEL_THRESHOLD 65536
+#endif
+#ifndef LINVECTOR_REDUCE_CHUNK
+#define LINVECTOR_REDUCE_CHUNK 4096
+#endif
+
+/*
+ * How dot products and norms add up their terms, chosen per build by defining
+ * LINVECTOR_SUMMATION to one of:
+ *
+ * - LINVECTOR_SUM_SERIAL: a single running sum, whose error grows with the
+ *   length of the vectors.
+ * - LINVECTOR_SUM_NEUMAIER (default): a running sum plus a second one that
+ *   collects the rounding error of every addition (Kahan-Neumaier), accurate to
+ *   about one rounding of the result whatever the length.
+ * - LINVECTOR_SUM_PAIRWISE: halves the range recursively down to blocks of
+ *   LINVECTOR_PAIRWISE_BLOCK terms summed serially, so the error grows with the
+ *   logarithm of the length and the blocks are independent.
+ *
+ * The terms are added as REALNUM_APROX values, which the result always was.
+ */
+#define LINVECTOR_SUM_SERIAL 0
+#define LINVECTOR_SUM_NEUMAIER 1
+#define LINVECTOR_SUM_PAIRWISE 2
+#ifndef LINVECTOR_SUMMATION
+#define LINVECTOR_SUMMATION LINVECTOR_SUM_NEUMAIER
+#endif
+#ifndef LINVECTOR_PAIRWISE_BLOCK
+#define LINVECTOR_PAIRWISE_BLOCK 32
+#endif
+
 // #define linvector_print(vec) linvector_print(vec, 4)
 
 
@@ -19,13 +59,38 @@
  * @brief Represents a linear vector.
  *
  * The `linvector` struct stores information about a linear vector, including its size, capacity, and data.
+ * When `arena` is set the data buffer is drawn from that linarena instead of the heap and is
+ * released by linarena_reset rather than linvector_free.
+ *
+ * A linvector owns its elements: values pushed into it are taken over, and
+ * REALNUM_BIGFRAC elements are released by linvector_free in either case.
+ * The exception is a linvector made by linvector_borrow, which sets
+ * `borrowed`: its buffer and elements stay the caller's, linvector_free leaves
+ * both alone, and it cannot grow.
  */
 typedef struct linvector {
     size_t size;
     size_t capacity;
     realnum* data;
+    linarena* arena;
+    bool borrowed;
 } linvector;
 
+/**
+ * @struct linvector_view
+ * @brief A strided window onto elements owned by a linvector or a linmatrix.
+ *
+ * Element i of the view is `data[i * stride]`, so a slice of a linvector, a
+ * row or a column of a linmatrix and every n-th element of either are all
+ * views of the same buffer. A view never owns its elements: it is not freed,
+ * and it is only valid while the buffer it points into is.
+ */
+typedef struct linvector_view {
+    size_t size;
+    size_t stride;
+    realnum* data;
+} linvector_view;
+
 /**
  * Creates a new linvector with default capacity.
  *
@@ -44,7 +109,21 @@ linvector linvector_new(size_t n, ...);
 linvector linvector_with_capacity(size_t capacity);
 
 /**
- * Creates a new linvector with the specified data and size.
+ * Creates a new linvector with the specified capacity whose buffer is drawn from an arena.
+ *
+ * Growing the linvector through linvector_push or linvector_reserve also draws from the arena.
+ *
+ * @param arena The linarena to allocate from.
+ * @param capacity The capacity of the linvector.
+ * @return The newly created linvector.
+ */
+linvector linvector_with_capacity_in(linarena* arena, size_t capacity);
+
+/**
+ * Creates a new linvector that adopts a heap buffer of elements without copying it.
+ *
+ * The linvector takes ownership of the buffer, which must come from malloc,
+ * and of its `size` elements: linvector_free releases both.
  *
  * @param data The data array for the linvector.
  * @param size The size of the linvector.
@@ -52,6 +131,19 @@ linvector linvector_with_capacity(size_t capacity);
  */
 linvector linvector_with_data(realnum* data, size_t size);
 
+/**
+ * Creates a new linvector over elements it does not own, without copying them.
+ *
+ * The elements can be read and written through the linvector, but it never
+ * grows, and linvector_free releases neither the buffer nor the elements. It
+ * is only valid while `data` is.
+ *
+ * @param data The elements to borrow.
+ * @param size The number of elements.
+ * @return The newly created linvector.
+ */
+linvector linvector_borrow(realnum* data, size_t size);
+
 /**
  * Prints the elements of a vector.
  *
@@ -68,17 +160,40 @@ void linvector_print(linvector* vec, uint16_t precision);
  */
 linvector* linvector_clone(linvector* vec);
 
+/**
+ * Creates a copy of the given linvector whose buffer is drawn from an arena.
+ *
+ * Unlike linvector_clone, the linvector itself is returned by value and its buffer is not heap allocated.
+ *
+ * @param arena The linarena to allocate from.
+ * @param vec The linvector to clone.
+ * @return The cloned linvector.
+ */
+linvector linvector_clone_in(linarena* arena, linvector* vec);
+
 /**
  * Adds a value to the end of the linear vector.
  *
+ * The linear vector takes ownership of the value.
+ *
  * @param vec The linear vector to push the value to.
  * @param value The value to be added to the linear vector.
  */
 void linvector_push(linvector* vec, realnum value);
 
+/**
+ * Ensures the linvector can hold at least `capacity` elements without reallocating.
+ *
+ * @param vec The linvector to grow.
+ * @param capacity The minimum capacity.
+ */
+void linvector_reserve(linvector* vec, size_t capacity);
+
 /**
  * Frees the memory occupied by the given linvector.
  *
+ * Releases every element, but buffers drawn from an arena are left to linarena_reset.
+ *
  * @param vec The linvector to free.
  */
 void linvector_free(linvector* vec);
@@ -122,6 +237,9 @@ linvector linvector_div(linvector* a, realnum scalar);
 /**
  * Calculates the dot product of two linvectors and returns the result.
  *
+ * The products are added up as set by LINVECTOR_SUMMATION, and long
+ * linvectors are reduced in chunks, see linvector_view_dot.
+ *
  * @param a The first linvector.
  * @param b The second linvector.
  * @return The dot product of the two linvectors.
@@ -154,6 +272,110 @@ linvector linvector_normalize(linvector* a);
  */
 linvector linvector_cross(linvector* a, linvector* b);
 
+/**
+ * Adds two linvectors element-wise and stores the result in `dst`.
+ *
+ * `dst` must be an initialized linvector and may be `a` or `b` itself. It only
+ * reallocates when its capacity is smaller than the size of the operands.
+ *
+ * @param dst The linvector receiving the result.
+ * @param a The first linvector.
+ * @param b The second linvector.
+ */
+void linvector_add_into(linvector* dst, linvector* a, linvector* b);
+
+/**
+ * Subtracts the second linvector from the first element-wise and stores the result in `dst`.
+ *
+ * @param dst The linvector receiving the result, may be `a` or `b`.
+ * @param a The first linvector.
+ * @param b The second linvector.
+ */
+void linvector_sub_into(linvector* dst, linvector* a, linvector* b);
+
+/**
+ * Multiplies each element of the linvector by the given scalar and stores the result in `dst`.
+ *
+ * @param dst The linvector receiving the result, may be `a`.
+ * @param a The linvector.
+ * @param scalar The scalar value.
+ */
+void linvector_mul_into(linvector* dst, linvector* a, realnum scalar);
+
+/**
+ * Divides each element of the linvector by the given scalar and stores the result in `dst`.
+ *
+ * @param dst The linvector receiving the result, may be `a`.
+ * @param a The linvector.
+ * @param scalar The scalar value.
+ */
+void linvector_div_into(linvector* dst, linvector* a, realnum scalar);
+
+/**
+ * Normalizes the linvector to have a magnitude of 1 and stores the result in `dst`.
+ *
+ * @param dst The linvector receiving the result, may be `a`.
+ * @param a The linvector.
+ */
+void linvector_normalize_into(linvector* dst, linvector* a);
+
+/**
+ * Calculates the cross product of two 3D linvectors and stores the result in `dst`.
+ *
+ * @param dst The linvector receiving the result, may be `a` or `b`.
+ * @param a The first 3D linvector.
+ * @param b The second 3D linvector.
+ */
+void linvector_cross_into(linvector* dst, linvector* a, linvector* b);
+
+/**
+ * Adds `b` to `a` element-wise in place (a += b).
+ *
+ * @param a The linvector to update.
+ * @param b The linvector to add.
+ */
+void linvector_add_assign(linvector* a, linvector* b);
+
+/**
+ * Subtracts `b` from `a` element-wise in place (a -= b).
+ *
+ * @param a The linvector to update.
+ * @param b The linvector to subtract.
+ */
+void linvector_sub_assign(linvector* a, linvector* b);
+
+/**
+ * Multiplies each element of the linvector by the given scalar in place (a *= scalar).
+ *
+ * @param a The linvector to update.
+ * @param scalar The scalar value.
+ */
+void linvector_mul_assign(linvector* a, realnum scalar);
+
+/**
+ * Divides each element of the linvector by the given scalar in place (a /= scalar).
+ *
+ * @param a The linvector to update.
+ * @param scalar The scalar value.
+ */
+void linvector_div_assign(linvector* a, realnum scalar);
+
+/**
+ * Normalizes the linvector in place to have a magnitude of 1.
+ *
+ * @param a The linvector to update.
+ */
+void linvector_normalize_assign(linvector* a);
+
+/**
+ * Computes y = alpha * x + y in place, in a single pass over both linvectors.
+ *
+ * @param y The linvector to update.
+ * @param alpha The scalar multiplying `x`.
+ * @param x The linvector to add.
+ */
+void linvector_axpy(linvector* y, realnum alpha, linvector* x);
+
 /**
  * Creates a new linvector of the specified size with all elements set to 0.
  *
@@ -261,3 +483,79 @@ linvector linvector_rotate_z(linvector* a, realnum angle);
  */
 linvector linvector_translate(linvector* a, linvector* b);
 
+/**
+ * Returns a view of all the elements of a linvector.
+ *
+ * @param vec The linvector.
+ * @return The view.
+ */
+linvector_view linvector_view_of(linvector* vec);
+
+/**
+ * Returns a view of `size` elements of a view, starting at `start` and taking
+ * every `stride`-th element.
+ *
+ * @param view The view to slice.
+ * @param start The index of the first element.
+ * @param size The number of elements.
+ * @param stride The distance between consecutive elements, at least 1.
+ * @return The sliced view, sharing the elements of `view`.
+ */
+linvector_view linvector_view_slice(linvector_view* view, size_t start, size_t size, size_t stride);
+
+/**
+ * Returns the element at the given index of a view.
+ *
+ * @param view The view.
+ * @param index The index of the element.
+ * @return The element, still owned by the underlying buffer.
+ */
+realnum linvector_view_get(linvector_view* view, size_t index);
+
+/**
+ * Replaces the element at the given index of a view, releasing the old one.
+ *
+ * @param view The view.
+ * @param index The index of the element.
+ * @param value The new element, taken over by the underlying buffer.
+ */
+void linvector_view_set(linvector_view* view, size_t index, realnum value);
+
+/**
+ * Copies the elements of a view into a new linvector.
+ *
+ * @param view The view.
+ * @return The newly created linvector.
+ */
+linvector linvector_view_to_vector(linvector_view* view);
+
+/**
+ * Calculates the dot product of two views of the same size.
+ *
+ * Views of LINVECTOR_PARALLEL_THRESHOLD elements or more are summed in
+ * fixed-size chunks whose partial sums are added pairwise. With OpenMP the
+ * chunks are split between threads, and the result is the same for any
+ * number of threads.
+ *
+ * @param a The first view.
+ * @param b The second view.
+ * @return The dot product.
+ */
+realnum linvector_view_dot(linvector_view* a, linvector_view* b);
+
+/**
+ * Computes y = alpha * x + y in place on the elements `y` points to.
+ *
+ * @param y The view to update.
+ * @param alpha The scalar multiplying `x`.
+ * @param x The view to add, of the same size as `y`.
+ */
+void linvector_view_axpy(linvector_view* y, realnum alpha, linvector_view* x);
+
+/**
+ * Multiplies the elements `a` points to by a scalar in place.
+ *
+ * @param a The view to update.
+ * @param scalar The scalar.
+ */
+void linvector_view_scale(linvector_view* a, realnum scalar);
@@ -39,6 +39,13 @@ int main(int argc, char *argv[]) {
     linvector_print(&vec7, 3);
     printf("\n");
 
+    linvector rows[2] = { linvector_new(3, 1.0, 2.0, 3.0), linvector_new(3, 4.0, 5.0, 6.0) };
+    linmatrix mat = linmatrix_from_rows(rows, 2);
+    linmatrix mat_t = linmatrix_transpose(&mat);
+    linmatrix mat2 = linmatrix_mul(&mat, &mat_t);
+    printf("mat * mat^T:\n");
+    linmatrix_print(&mat2, 3);
+
     
     linvector_free(&vec);
     linvector_free(&vec2);
@@ -47,6 +54,11 @@ int main(int argc, char *argv[]) {
     linvector_free(&vec5);
     linvector_free(&vec6);
     linvector_free(&vec7);
+    linvector_free(&rows[0]);
+    linvector_free(&rows[1]);
+    linmatrix_free(&mat);
+    linmatrix_free(&mat_t);
+    linmatrix_free(&mat2);
 
 
 
@@ -0,0 +1,62 @@
+#include"./test.h"
+#include"../lib/memory/arena.h"
+#include"../lib/vector/vector.h"
+#include<stdalign.h>
+#include<string.h>
+
+static bool aligned(void* ptr) {
+    return (uintptr_t)ptr % alignof(max_align_t) == 0;
+}
+
+/* Allocations are aligned, the last one grows in place, and a reset hands out the same memory again. */
+static void test_alloc(void) {
+    linarena arena = linarena_new(256);
+    char* first = linarena_alloc(&arena, 3);
+    char* second = linarena_alloc(&arena, 40);
+    CHECK(aligned(first) && aligned(second) && second >= first + 3);
+    memset(second, 'x', 40);
+
+    char* grown = linarena_realloc(&arena, second, 40, 100);
+    CHECK(grown == second);
+    char* moved = linarena_realloc(&arena, first, 3, 8);
+    CHECK(moved != first && aligned(moved));
+    for (size_t i = 0; i < 40; i++) {
+        CHECK(grown[i] == 'x');
+    }
+
+    // Larger than a block, so it gets a block of its own.
+    char* big = linarena_alloc(&arena, 1000);
+    CHECK(aligned(big));
+    memset(big, 0, 1000);
+
+    linarena_reset(&arena);
+    CHECK(linarena_alloc(&arena, 3) == first);
+    linarena_free(&arena);
+}
+
+/* Vectors drawn from an arena grow and clone like heap ones and are released by the reset. */
+static void test_vector(void) {
+    linarena arena = linarena_new(0);
+    for (int round = 0; round < 3; round++) {
+        linvector vec = linvector_with_capacity_in(&arena, 1);
+        for (size_t i = 0; i < 100; i++) {
+            linvector_push(&vec, realnum_from_frac(test_int(i), 3));
+        }
+        linvector clone = linvector_clone_in(&arena, &vec);
+        CHECK(vec.arena == &arena && clone.arena == &arena && clone.size == 100);
+        for (size_t i = 0; i < 100; i++) {
+            CHECK_FRAC(&clone.data[i], test_int(i), 3);
+        }
+        linvector_free(&vec);
+        linvector_free(&clone);
+        linarena_reset(&arena);
+    }
+    linarena_free(&arena);
+}
+
+int main(void) {
+    test_alloc();
+    test_vector();
+    printf("arena_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include"./test.h"
+#include"../lib/matrix/batch.h"
+#include"../lib/matrix/lu.h"
+#include<math.h>
+
+/* Not a multiple of LINMATRIX_BATCH_LANES, so the last group is padded. */
+#define COUNT 11
+#define N 6
+
+#if REALNUM_APROX_PRECISION == 32
+#define TOL 1e-3
+#else
+#define TOL 1e-9
+#endif
+
+/* Small integers from a linear congruential generator, see factorization_test. */
+static linmatrix test_matrix(size_t rows, size_t cols, uint64_t seed) {
+    linmatrix mat = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) {
+        seed = seed * 6364136223846793005u + 1442695040888963407u;
+        linmatrix_set(&mat, i / cols, i % cols, realnum_from_frac((int64_t)(seed >> 33) % 11 - 5, 1));
+    }
+    return mat;
+}
+
+static linmatrix_batch test_batch(size_t rows, size_t cols, uint64_t seed) {
+    linmatrix_batch batch = linmatrix_batch_new(COUNT, rows, cols);
+    for (size_t m = 0; m < COUNT; m++) {
+        linmatrix mat = test_matrix(rows, cols, seed + m);
+        linmatrix_batch_set_matrix(&batch, m, &mat);
+        linmatrix_free(&mat);
+    }
+    return batch;
+}
+
+static void check_close(linmatrix* a, linmatrix* b, double tol) {
+    CHECK(a->rows == b->rows && a->cols == b->cols);
+    for (size_t i = 0; i < a->rows * a->cols; i++) {
+        CHECK_NEAR(&a->data[i], test_value(&b->data[i]), tol);
+    }
+}
+
+/* Each matrix reads back as it was set and multiplies like a single matrix. */
+static void test_mul(void) {
+    linmatrix_batch a = test_batch(N, 4, 1);
+    linmatrix_batch b = test_batch(4, 3, 100);
+    realnum half = realnum_from_frac(1, 2);
+    linmatrix_batch_set(&a, COUNT - 1, 2, 3, &half);
+    realnum back = linmatrix_batch_get(&a, COUNT - 1, 2, 3);
+    CHECK(test_value(&back) == 0.5);
+
+    linmatrix_batch c = linmatrix_batch_mul(&a, &b);
+    CHECK(c.count == COUNT && c.rows == N && c.cols == 3);
+    for (size_t m = 0; m < COUNT; m++) {
+        linmatrix am = linmatrix_batch_get_matrix(&a, m);
+        linmatrix bm = linmatrix_batch_get_matrix(&b, m);
+        linmatrix cm = linmatrix_batch_get_matrix(&c, m);
+        linmatrix expected = linmatrix_mul(&am, &bm);
+        check_close(&cm, &expected, TOL);
+        linmatrix_free(&am);
+        linmatrix_free(&bm);
+        linmatrix_free(&cm);
+        linmatrix_free(&expected);
+    }
+    linmatrix_batch_free(&a);
+    linmatrix_batch_free(&b);
+    linmatrix_batch_free(&c);
+}
+
+/* Determinants match the single LU and solves leave a small residual. */
+static void test_lu(void) {
+    linmatrix_batch a = test_batch(N, N, 7);
+    linmatrix_batch b = test_batch(N, 2, 50);
+    linvector det = linmatrix_batch_determinant(&a);
+    CHECK(det.size == COUNT);
+    for (size_t m = 0; m < COUNT; m++) {
+        linmatrix am = linmatrix_batch_get_matrix(&a, m);
+        realnum expected = linmatrix_determinant(&am);
+        double scale = fabs(test_value(&expected)) + 1;
+        CHECK_NEAR(&det.data[m], test_value(&expected), TOL * scale);
+        linmatrix_free(&am);
+        realnum_free(&expected);
+    }
+
+    linmatrix_batch x = linmatrix_batch_solve(&a, &b);
+    linmatrix_batch ax = linmatrix_batch_mul(&a, &x);
+    for (size_t m = 0; m < COUNT; m++) {
+        linmatrix axm = linmatrix_batch_get_matrix(&ax, m);
+        linmatrix bm = linmatrix_batch_get_matrix(&b, m);
+        check_close(&axm, &bm, 1e3 * TOL);
+        linmatrix_free(&axm);
+        linmatrix_free(&bm);
+    }
+
+    // A matrix with two equal rows is reported singular, the others are not.
+    linmatrix twin = test_matrix(N, N, 3);
+    for (size_t j = 0; j < N; j++) {
+        linmatrix_set(&twin, 4, j, realnum_clone(&twin.data[1 * N + j]));
+    }
+    linmatrix_batch_set_matrix(&a, 5, &twin);
+    linmatrix_batch_lu lu = linmatrix_batch_lu_new(&a);
+    linvector twin_det = linmatrix_batch_lu_determinant(&lu);
+    for (size_t m = 0; m < COUNT; m++) {
+        CHECK(lu.singular[m] == (m == 5));
+    }
+    CHECK_NEAR(&twin_det.data[5], 0, TOL);
+
+    linmatrix_free(&twin);
+    linmatrix_batch_lu_free(&lu);
+    linvector_free(&det);
+    linvector_free(&twin_det);
+    linmatrix_batch_free(&a);
+    linmatrix_batch_free(&b);
+    linmatrix_batch_free(&x);
+    linmatrix_batch_free(&ax);
+}
+
+int main(void) {
+    test_mul();
+    test_lu();
+    printf("batch_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include"./test.h"
+#include<string.h>
+
+static void check_text(linbigint* a, const char* expected) {
+    char buf[256];
+    size_t length = linbigint_format(a, buf, sizeof(buf));
+    CHECK(length == strlen(expected) && strcmp(buf, expected) == 0);
+}
+
+/* (a * b + r) / b gives back a with the remainder r, across several limbs. */
+static void test_divmod(void) {
+    linbigint a = linbigint_from_i128(-((__int128)INT64_MAX * 1000003 + 17));
+    linbigint b = linbigint_from_i128((__int128)INT64_MAX * 7 + 5);
+    linbigint r = linbigint_from_i128(-12345);
+    linbigint ab = linbigint_mul(&a, &b);
+    linbigint n = linbigint_add(&ab, &r);
+    linbigint q;
+    linbigint rem;
+    linbigint_divmod(&n, &b, &q, &rem);
+    CHECK(linbigint_cmp(&q, &a) == 0);
+    CHECK(linbigint_cmp(&rem, &r) == 0);
+    linbigint back = linbigint_sub(&n, &r);
+    CHECK(linbigint_cmp(&back, &ab) == 0);
+    linbigint_free(&a);
+    linbigint_free(&b);
+    linbigint_free(&r);
+    linbigint_free(&ab);
+    linbigint_free(&n);
+    linbigint_free(&q);
+    linbigint_free(&rem);
+    linbigint_free(&back);
+}
+
+static void test_gcd_and_format(void) {
+    // 2^100 and 6^50 share 2^50.
+    linbigint two = linbigint_from_i128(2);
+    linbigint six = linbigint_from_i128(6);
+    linbigint a = linbigint_from_i128(1);
+    linbigint b = linbigint_from_i128(1);
+    for (int i = 0; i < 100; i++) {
+        linbigint t = linbigint_mul(&a, &two);
+        linbigint_free(&a);
+        a = t;
+    }
+    for (int i = 0; i < 50; i++) {
+        linbigint t = linbigint_mul(&b, &six);
+        linbigint_free(&b);
+        b = t;
+    }
+    check_text(&a, "1267650600228229401496703205376");
+    linbigint g = linbigint_gcd(&a, &b);
+    check_text(&g, "1125899906842624");
+
+    linbigint zero = linbigint_new();
+    check_text(&zero, "0");
+    CHECK(linbigint_is_zero(&zero));
+
+    // Truncated text is cut at the capacity but reports its full length.
+    char small[8];
+    CHECK(linbigint_format(&a, small, sizeof(small)) == 31 && strcmp(small, "1267650") == 0);
+
+    linbigint_free(&two);
+    linbigint_free(&six);
+    linbigint_free(&a);
+    linbigint_free(&b);
+    linbigint_free(&g);
+}
+
+/* to_i64 accepts exactly [-INT64_MAX, INT64_MAX]. */
+static void test_to_i64(void) {
+    int64_t out;
+    linbigint max = linbigint_from_i128(-(__int128)INT64_MAX);
+    CHECK(linbigint_to_i64(&max, &out) && out == -INT64_MAX);
+    linbigint min = linbigint_from_i128(INT64_MIN);
+    CHECK(!linbigint_to_i64(&min, &out));
+    linbigint over = linbigint_from_i128((__int128)INT64_MAX + 1);
+    CHECK(!linbigint_to_i64(&over, &out));
+    linbigint_free(&max);
+    linbigint_free(&min);
+    linbigint_free(&over);
+}
+
+int main(void) {
+    test_divmod();
+    test_gcd_and_format();
+    test_to_i64();
+    printf("bigint_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include"./test.h"
+#include"../lib/device/device.h"
+
+static linmatrix test_matrix(size_t rows, size_t cols, size_t seed) {
+    linmatrix mat = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) {
+        linmatrix_set(&mat, i / cols, i % cols, realnum_from_frac(test_int(seed + i), 1));
+    }
+    return mat;
+}
+
+static linvector test_vector(size_t size, size_t seed) {
+    linvector vec = linvector_with_capacity(size);
+    for (size_t i = 0; i < size; i++) {
+        linvector_push(&vec, realnum_from_frac(test_int(seed + i), 2));
+    }
+    return vec;
+}
+
+/* The host backend gives the products of the host kernels. */
+static void test_kernels(void) {
+    lindevice* host = lindevice_host();
+    linmatrix a = test_matrix(19, 23, 1);
+    linmatrix b = test_matrix(23, 17, 2);
+    linmatrix expected = linmatrix_mul(&a, &b);
+
+    lindevice_matrix da = lindevice_matrix_upload(host, &a);
+    lindevice_matrix db = lindevice_matrix_upload(host, &b);
+    lindevice_matrix dc = lindevice_matrix_new(host, 19, 17);
+    lindevice_gemm(&da, &db, &dc);
+    linmatrix c = lindevice_matrix_download(&dc);
+    for (size_t i = 0; i < 19 * 17; i++) {
+        CHECK_NEAR(&c.data[i], test_value(&expected.data[i]), 1e-9);
+    }
+    linmatrix on = linmatrix_mul_on(host, &a, &b);
+    for (size_t i = 0; i < 19 * 17; i++) {
+        CHECK_NEAR(&on.data[i], test_value(&expected.data[i]), 1e-9);
+    }
+
+    linsparse sparse = linsparse_from_dense(&a, LINSPARSE_CSR);
+    linvector x = test_vector(23, 3);
+    linvector y_expected = linsparse_mul_vector(&sparse, &x);
+    lindevice_sparse ds = lindevice_sparse_upload(host, &sparse);
+    lindevice_vector dx = lindevice_vector_upload(host, &x);
+    lindevice_vector dy = lindevice_vector_new(host, 19);
+    lindevice_spmv(&ds, &dx, &dy);
+    linvector y = lindevice_vector_download(&dy);
+    CHECK(y.size == 19);
+    for (size_t i = 0; i < 19; i++) {
+        CHECK_NEAR(&y.data[i], test_value(&y_expected.data[i]), 1e-9);
+    }
+
+    realnum dot = lindevice_dot(&dy, &dy);
+    realnum dot_expected = linvector_dot(&y_expected, &y_expected);
+    CHECK_NEAR(&dot, test_value(&dot_expected), 1e-6);
+
+    lindevice_matrix_free(&da);
+    lindevice_matrix_free(&db);
+    lindevice_matrix_free(&dc);
+    lindevice_sparse_free(&ds);
+    lindevice_vector_free(&dx);
+    lindevice_vector_free(&dy);
+    linsparse_free(&sparse);
+    linmatrix_free(&a);
+    linmatrix_free(&b);
+    linmatrix_free(&c);
+    linmatrix_free(&on);
+    linmatrix_free(&expected);
+    linvector_free(&x);
+    linvector_free(&y);
+    linvector_free(&y_expected);
+    realnum_free(&dot_expected);
+}
+
+/* Work queued on a stream runs in order, and the dot product replaces what the result held. */
+static void test_stream(void) {
+    lindevice* host = lindevice_host();
+    linmatrix a = test_matrix(8, 8, 4);
+    linmatrix c = linmatrix_new(8, 8);
+    lindevice_matrix da = lindevice_matrix_new(host, 8, 8);
+    lindevice_matrix dc = lindevice_matrix_new(host, 8, 8);
+    linvector v = test_vector(8, 5);
+    lindevice_vector dv = lindevice_vector_upload(host, &v);
+    realnum big = realnum_from_frac(INT64_MAX, 1);
+    realnum result = realnum_add(&big, &big);
+    CHECK(result.kind == REALNUM_BIGFRAC);
+
+    linstream* stream = linstream_new(host);
+    linstream_matrix_upload(stream, &a, &da);
+    linstream_gemm(stream, &da, &da, &dc);
+    uint64_t download = linstream_matrix_download(stream, &dc, &c);
+    uint64_t dot = linstream_dot(stream, &dv, &dv, &result);
+    linstream_wait(stream, download);
+    CHECK(linstream_done(stream, download));
+    linstream_sync(stream);
+    CHECK(linstream_done(stream, dot));
+
+    linmatrix expected = linmatrix_mul(&a, &a);
+    for (size_t i = 0; i < 64; i++) {
+        CHECK_NEAR(&c.data[i], test_value(&expected.data[i]), 1e-9);
+    }
+    realnum dot_expected = linvector_dot(&v, &v);
+    CHECK(result.kind == REALNUM_APROX);
+    CHECK_NEAR(&result, test_value(&dot_expected), 1e-9);
+
+    linstream_free(stream);
+    lindevice_matrix_free(&da);
+    lindevice_matrix_free(&dc);
+    lindevice_vector_free(&dv);
+    linmatrix_free(&a);
+    linmatrix_free(&c);
+    linmatrix_free(&expected);
+    linvector_free(&v);
+    realnum_free(&dot_expected);
+}
+
+int main(void) {
+    test_kernels();
+    test_stream();
+    printf("device_test: ok\n");
+    return 0;
+}
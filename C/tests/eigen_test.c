@@ -0,0 +1,152 @@
+#include"./test.h"
+#include"../lib/matrix/eigen.h"
+#include<math.h>
+
+#define N 40
+
+/* Relative tolerance of the checks, which are computed in double. */
+#if REALNUM_APROX_PRECISION == 32
+#define TOL 1e-3
+#else
+#define TOL 1e-7
+#endif
+
+/* Small integers from a linear congruential generator, see factorization_test. */
+static linmatrix test_matrix(size_t rows, size_t cols, uint64_t seed) {
+    linmatrix mat = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) {
+        seed = seed * 6364136223846793005u + 1442695040888963407u;
+        linmatrix_set(&mat, i / cols, i % cols, realnum_from_frac((int64_t)(seed >> 33) % 11 - 5, 1));
+    }
+    return mat;
+}
+
+static linmatrix test_symmetric(size_t n) {
+    linmatrix a = test_matrix(n, n, 3);
+    linmatrix at = linmatrix_transpose(&a);
+    linmatrix s = linmatrix_mul(&at, &a);
+    linmatrix_free(&a);
+    linmatrix_free(&at);
+    return s;
+}
+
+static double element(linmatrix* mat, size_t row, size_t col) {
+    return test_value(&mat->data[row * mat->cols + col]);
+}
+
+/* |A * v - lambda * v| for column i of `vectors`. */
+static double residual(linmatrix* a, linmatrix* vectors, size_t i, double lambda) {
+    double sum = 0;
+    for (size_t r = 0; r < a->rows; r++) {
+        double av = 0;
+        for (size_t c = 0; c < a->cols; c++) {
+            av += element(a, r, c) * element(vectors, c, i);
+        }
+        double d = av - lambda * element(vectors, r, i);
+        sum += d * d;
+    }
+    return sqrt(sum);
+}
+
+/* Every pair of the full decomposition satisfies A * v = lambda * v, and the values add up to the trace. */
+static void test_symmetric_eigen(void) {
+    linmatrix a = test_symmetric(N);
+    linmatrix_eigen eigen = linmatrix_eigen_symmetric(&a, true);
+    CHECK(eigen.converged && eigen.values.size == N);
+    CHECK(eigen.vectors.rows == N && eigen.vectors.cols == N);
+    double trace = 0;
+    double sum = 0;
+    double largest = test_value(&eigen.values.data[0]);
+    for (size_t i = 0; i < N; i++) {
+        double lambda = test_value(&eigen.values.data[i]);
+        CHECK(i == 0 || lambda <= test_value(&eigen.values.data[i - 1]));
+        CHECK(residual(&a, &eigen.vectors, i, lambda) <= TOL * largest);
+        trace += element(&a, i, i);
+        sum += lambda;
+    }
+    CHECK(fabs(trace - sum) <= TOL * trace);
+
+    linmatrix_eigen values = linmatrix_eigen_symmetric(&a, false);
+    CHECK(values.vectors.rows * values.vectors.cols == 0);
+    for (size_t i = 0; i < N; i++) {
+        CHECK_NEAR(&values.values.data[i], test_value(&eigen.values.data[i]), TOL * largest);
+    }
+
+    // Lanczos finds the same largest pairs from products alone.
+    linoperator op = linoperator_dense(&a);
+    linmatrix_eigen top = linoperator_eigen_top(&op, 4);
+    CHECK(top.converged && top.values.size == 4);
+    for (size_t i = 0; i < 4; i++) {
+        double lambda = test_value(&top.values.data[i]);
+        CHECK(fabs(lambda - test_value(&eigen.values.data[i])) <= TOL * largest);
+        CHECK(residual(&a, &top.vectors, i, lambda) <= TOL * largest);
+    }
+
+    linoperator_free(&op);
+    linmatrix_eigen_free(&eigen);
+    linmatrix_eigen_free(&values);
+    linmatrix_eigen_free(&top);
+    linmatrix_free(&a);
+}
+
+/* The second difference matrix has the eigenvalues 2 - 2 cos(k pi / (n + 1)). */
+static void test_sparse_lanczos(void) {
+    size_t n = 30;
+    linsparse_coo coo = linsparse_coo_new(n, n);
+    for (size_t i = 0; i < n; i++) {
+        linsparse_coo_push(&coo, i, i, realnum_from_frac(2, 1));
+        if (i + 1 < n) {
+            linsparse_coo_push(&coo, i, i + 1, realnum_from_frac(-1, 1));
+            linsparse_coo_push(&coo, i + 1, i, realnum_from_frac(-1, 1));
+        }
+    }
+    linsparse a = linsparse_from_coo(&coo, LINSPARSE_CSR);
+    linoperator op = linoperator_sparse(&a);
+    linmatrix_eigen top = linoperator_eigen_top(&op, 3);
+    CHECK(top.values.size == 3);
+    for (size_t i = 0; i < 3; i++) {
+        double expected = 2 - 2 * cos((double)(n - i) * acos(-1.0) / (double)(n + 1));
+        CHECK_NEAR(&top.values.data[i], expected, TOL);
+    }
+    linoperator_free(&op);
+    linmatrix_eigen_free(&top);
+    linsparse_free(&a);
+    linsparse_coo_free(&coo);
+}
+
+/* A * v = s * u for every triplet, on both sides of a rectangular matrix. */
+static void test_svd(void) {
+    for (int side = 0; side < 2; side++) {
+        linmatrix a = side == 0 ? test_matrix(30, 12, 11) : test_matrix(12, 30, 11);
+        linmatrix_svd svd = linmatrix_svd_new(&a, 3);
+        linoperator op = linoperator_dense(&a);
+        linmatrix_svd top = linoperator_svd_top(&op, 3);
+        CHECK(svd.s.size == 3 && top.s.size == 3);
+        CHECK(svd.u.rows == a.rows && svd.v.rows == a.cols);
+        double largest = test_value(&svd.s.data[0]);
+        for (size_t i = 0; i < 3; i++) {
+            double s = test_value(&svd.s.data[i]);
+            CHECK(i == 0 || s <= test_value(&svd.s.data[i - 1]));
+            CHECK_NEAR(&top.s.data[i], s, TOL * largest);
+            for (size_t r = 0; r < a.rows; r++) {
+                double av = 0;
+                for (size_t c = 0; c < a.cols; c++) {
+                    av += element(&a, r, c) * element(&svd.v, c, i);
+                }
+                CHECK(fabs(av - s * element(&svd.u, r, i)) <= TOL * largest);
+            }
+        }
+        linoperator_free(&op);
+        linmatrix_svd_free(&svd);
+        linmatrix_svd_free(&top);
+        linmatrix_free(&a);
+    }
+}
+
+int main(void) {
+    test_symmetric_eigen();
+    test_sparse_lanczos();
+    test_svd();
+    printf("eigen_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include"./test.h"
+#include"../lib/matrix/matrix.h"
+#include"../lib/matrix/qr.h"
+#include"../lib/matrix/cholesky.h"
+
+/* Larger than a panel, so the blocked trailing updates run more than once. */
+#define N 75
+
+/*
+ * Small integers from a linear congruential generator. test_int repeats every
+ * 11 elements, which would make these matrices rank deficient.
+ */
+static linmatrix test_matrix(size_t rows, size_t cols, uint64_t seed) {
+    linmatrix mat = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) {
+        seed = seed * 6364136223846793005u + 1442695040888963407u;
+        linmatrix_set(&mat, i / cols, i % cols, realnum_from_frac((int64_t)(seed >> 33) % 11 - 5, 1));
+    }
+    return mat;
+}
+
+/* A^T * A + n * I, exact and symmetric positive definite. */
+static linmatrix test_spd(size_t n) {
+    linmatrix a = test_matrix(n, n, 5);
+    linmatrix at = linmatrix_transpose(&a);
+    linmatrix spd = linmatrix_mul(&at, &a);
+    for (size_t i = 0; i < n; i++) {
+        realnum shift = realnum_from_frac((int64_t)n, 1);
+        realnum sum = realnum_add(&spd.data[i * n + i], &shift);
+        linmatrix_set(&spd, i, i, sum);
+    }
+    linmatrix_free(&a);
+    linmatrix_free(&at);
+    return spd;
+}
+
+static void check_close(linmatrix* a, linmatrix* b, double tol) {
+    CHECK(a->rows == b->rows && a->cols == b->cols);
+    for (size_t i = 0; i < a->rows * a->cols; i++) {
+        CHECK_NEAR(&a->data[i], test_value(&b->data[i]), tol);
+    }
+}
+
+/* Q * R gives back A, Q has orthonormal columns and R is upper triangular. */
+static void test_qr(void) {
+    linmatrix a = test_matrix(N + 10, N, 1);
+    linmatrix_qr qr = linmatrix_qr_new(&a);
+    linmatrix q = linmatrix_qr_q(&qr);
+    linmatrix r = linmatrix_qr_r(&qr);
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < i; j++) {
+            CHECK(test_value(&r.data[i * N + j]) == 0);
+        }
+    }
+    linmatrix qr_product = linmatrix_mul(&q, &r);
+    check_close(&qr_product, &a, 1e-4);
+    linmatrix qt = linmatrix_transpose(&q);
+    linmatrix qtq = linmatrix_mul(&qt, &q);
+    linmatrix id = linmatrix_identity(N);
+    check_close(&qtq, &id, 1e-4);
+
+    // A consistent system is solved exactly by least squares.
+    linvector x = linvector_with_capacity(N);
+    for (size_t i = 0; i < N; i++) {
+        linvector_push(&x, realnum_from_frac(test_int(i + 3), 1));
+    }
+    linvector b = linmatrix_mul_vector(&a, &x);
+    linvector y = linmatrix_qr_solve(&qr, &b);
+    for (size_t i = 0; i < N; i++) {
+        CHECK_NEAR(&y.data[i], test_value(&x.data[i]), 1e-4);
+    }
+
+    linvector_free(&x);
+    linvector_free(&b);
+    linvector_free(&y);
+    linmatrix_free(&a);
+    linmatrix_free(&q);
+    linmatrix_free(&r);
+    linmatrix_free(&qr_product);
+    linmatrix_free(&qt);
+    linmatrix_free(&qtq);
+    linmatrix_free(&id);
+    linmatrix_qr_free(&qr);
+}
+
+/* L * L^T gives back A, and solves leave a small residual. */
+static void test_cholesky(void) {
+    linmatrix a = test_spd(N);
+    linmatrix_cholesky chol = linmatrix_cholesky_new(&a);
+    CHECK(chol.definite);
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            CHECK_FRAC(&chol.l.data[i * N + j], 0, 1);
+        }
+    }
+    linmatrix lt = linmatrix_transpose(&chol.l);
+    linmatrix llt = linmatrix_mul(&chol.l, &lt);
+    check_close(&llt, &a, 1e-3);
+
+    linmatrix b = test_matrix(N, 3, 9);
+    linmatrix x = linmatrix_cholesky_solve_matrix(&chol, &b);
+    linmatrix ax = linmatrix_mul(&a, &x);
+    check_close(&ax, &b, 1e-4);
+
+    // A matrix with a negative pivot is reported, not factored.
+    linmatrix_set(&a, N - 1, N - 1, realnum_from_frac(-1, 1));
+    linmatrix_cholesky bad = linmatrix_cholesky_new(&a);
+    CHECK(!bad.definite);
+
+    linmatrix_free(&a);
+    linmatrix_free(&lt);
+    linmatrix_free(&llt);
+    linmatrix_free(&b);
+    linmatrix_free(&x);
+    linmatrix_free(&ax);
+    linmatrix_cholesky_free(&chol);
+    linmatrix_cholesky_free(&bad);
+}
+
+int main(void) {
+    test_qr();
+    test_cholesky();
+    printf("factorization_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include"./test.h"
+#include"../lib/vector/hvector.h"
+
+#define N 29
+
+/* The tolerance of values that went through REALNUM_APROX, which may be a float. */
+#if REALNUM_APROX_PRECISION == 32
+#define TOL 1e-5
+#else
+#define TOL 1e-12
+#endif
+
+static linvector test_vector(size_t size, size_t seed) {
+    linvector vec = linvector_with_capacity(size);
+    for (size_t i = 0; i < size; i++) {
+        linvector_push(&vec, realnum_from_frac(test_int(seed + i), (int64_t)(i % 5) + 1));
+    }
+    return vec;
+}
+
+/* Exact vectors go through the homogeneous storage and back unchanged. */
+static void test_round_trip(void) {
+    linvector vec = test_vector(N, 1);
+    linhvector hvec = linhvector_from_linvector(&vec);
+    CHECK(hvec.kind == REALNUM_FRAC && hvec.size == N);
+    linvector back = linhvector_to_linvector(&hvec);
+    for (size_t i = 0; i < N; i++) {
+        CHECK_FRAC(&back.data[i], test_int(1 + i), (int64_t)(i % 5) + 1);
+    }
+
+    linhvector f32 = linhvector_from_linvector_with_precision(&vec, REALNUM_FLOAT);
+    CHECK(f32.kind == REALNUM_APROX && f32.precision == REALNUM_FLOAT);
+    for (size_t i = 0; i < N; i++) {
+        realnum x = linhvector_get(&f32, i);
+        CHECK_NEAR(&x, test_value(&vec.data[i]), 1e-6);
+    }
+
+    linvector_free(&vec);
+    linvector_free(&back);
+    linhvector_free(&hvec);
+    linhvector_free(&f32);
+}
+
+/* Exact operations agree with linvector, and mixed operands take the wider kind. */
+static void test_operations(void) {
+    linvector a = test_vector(N, 2);
+    linvector b = test_vector(N, 9);
+    linhvector ha = linhvector_from_linvector(&a);
+    linhvector hb = linhvector_from_linvector(&b);
+
+    linhvector sum = linhvector_add(&ha, &hb);
+    linhvector diff = linhvector_sub(&ha, &hb);
+    CHECK(sum.kind == REALNUM_FRAC && diff.kind == REALNUM_FRAC);
+    for (size_t i = 0; i < N; i++) {
+        realnum s = linhvector_get(&sum, i);
+        realnum d = linhvector_get(&diff, i);
+        realnum es = realnum_add(&a.data[i], &b.data[i]);
+        realnum ed = realnum_sub(&a.data[i], &b.data[i]);
+        CHECK_FRAC(&s, es.value.frac.num, es.value.frac.den);
+        CHECK_FRAC(&d, ed.value.frac.num, ed.value.frac.den);
+    }
+    realnum dot = linhvector_dot(&ha, &hb);
+    realnum expected = linvector_dot(&a, &b);
+    CHECK(dot.kind == REALNUM_FRAC);
+    CHECK_NEAR(&dot, test_value(&expected), TOL);
+
+    linhvector f32 = linhvector_to_precision(&ha, REALNUM_FLOAT);
+    linhvector f64 = linhvector_to_precision(&hb, REALNUM_DOUBLE);
+    linhvector mixed = linhvector_add(&f32, &f64);
+    CHECK(mixed.kind == REALNUM_APROX && mixed.precision == REALNUM_DOUBLE);
+    linhvector promoted = linhvector_add(&ha, &f64);
+    CHECK(promoted.kind == REALNUM_APROX && promoted.precision == REALNUM_DOUBLE);
+    for (size_t i = 0; i < N; i++) {
+        realnum m = linhvector_get(&mixed, i);
+        realnum p = linhvector_get(&promoted, i);
+        double e = test_value(&a.data[i]) + test_value(&b.data[i]);
+        CHECK_NEAR(&m, e, 1e-6);
+        CHECK_NEAR(&p, e, TOL);
+    }
+    realnum norm = linhvector_norm(&f64);
+    realnum expected_norm = linvector_norm(&b);
+    CHECK_NEAR(&norm, test_value(&expected_norm), TOL);
+
+    linvector_free(&a);
+    linvector_free(&b);
+    linhvector_free(&ha);
+    linhvector_free(&hb);
+    linhvector_free(&sum);
+    linhvector_free(&diff);
+    linhvector_free(&f32);
+    linhvector_free(&f64);
+    linhvector_free(&mixed);
+    linhvector_free(&promoted);
+    realnum_free(&expected);
+    realnum_free(&expected_norm);
+}
+
+/* Exact results that overflow int64 are redone on approximations, and an approximated value promotes its vector. */
+static void test_promotion(void) {
+    linhvector a = linhvector_with_capacity(REALNUM_FRAC, 2);
+    linhvector_push(&a, realnum_from_frac(INT64_MAX, 1));
+    linhvector_push(&a, realnum_from_frac(1, 3));
+    linhvector sum = linhvector_add(&a, &a);
+    CHECK(sum.kind == REALNUM_APROX);
+    realnum big = linhvector_get(&sum, 0);
+    CHECK_NEAR(&big, 2 * (double)INT64_MAX, 1e4);
+
+    linhvector_set(&a, 1, realnum_from_aprox(0.5));
+    CHECK(a.kind == REALNUM_APROX);
+    realnum half = linhvector_get(&a, 1);
+    CHECK(test_value(&half) == 0.5);
+
+    linhvector_free(&a);
+    linhvector_free(&sum);
+}
+
+/* Each precision rounds to its own type, and widening then narrowing back loses nothing. */
+static void test_precision(void) {
+    linhvector frac = linhvector_with_capacity(REALNUM_FRAC, 2);
+    linhvector_push(&frac, realnum_from_frac(1, 3));
+    linhvector_push(&frac, realnum_from_frac(-2, 7));
+    linhvector f32 = linhvector_to_precision(&frac, REALNUM_FLOAT);
+    linhvector f64 = linhvector_to_precision(&frac, REALNUM_DOUBLE);
+    linhvector f80 = linhvector_to_precision(&frac, REALNUM_LONG_DOUBLE);
+    linhvector f128 = linhvector_to_precision(&frac, REALNUM_QUAD);
+    CHECK(f32.data.f32[0] == 1.0f / 3 && f32.data.f32[1] == -2.0f / 7);
+    CHECK(f64.data.f64[0] == 1.0 / 3 && f64.data.f64[1] == -2.0 / 7);
+    CHECK(f80.data.f80[0] == 1.0L / 3 && f80.data.f80[1] == -2.0L / 7);
+    CHECK(f128.data.f128[0] == (__float128)1 / 3 && f128.data.f128[1] == (__float128)-2 / 7);
+
+    linhvector wide = linhvector_to_precision(&f32, REALNUM_QUAD);
+    linhvector narrow = linhvector_to_precision(&wide, REALNUM_FLOAT);
+    CHECK(narrow.data.f32[0] == f32.data.f32[0] && narrow.data.f32[1] == f32.data.f32[1]);
+
+    // A FRAC vector is approximated at the precision realnum was built with.
+    linhvector aprox = linhvector_as_aprox(&frac);
+    CHECK(aprox.precision == REALNUM_DEFAULT_PRECISION);
+    realnum third = linhvector_get(&aprox, 0);
+    realnum_aprox one = 1;
+    CHECK(third.kind == REALNUM_APROX && third.value.aprox == one / 3);
+
+    linhvector_free(&frac);
+    linhvector_free(&f32);
+    linhvector_free(&f64);
+    linhvector_free(&f80);
+    linhvector_free(&f128);
+    linhvector_free(&wide);
+    linhvector_free(&narrow);
+    linhvector_free(&aprox);
+}
+
+int main(void) {
+    test_round_trip();
+    test_operations();
+    test_promotion();
+    test_precision();
+    printf("hvector_test: ok\n");
+    return 0;
+}
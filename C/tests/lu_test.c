@@ -0,0 +1,80 @@
+#include"./test.h"
+#include"../lib/matrix/matrix.h"
+#include"../lib/matrix/lu.h"
+
+static linmatrix test_matrix(size_t n, int64_t* values) {
+    linmatrix mat = linmatrix_new(n, n);
+    for (size_t i = 0; i < n * n; i++) {
+        linmatrix_set(&mat, i / n, i % n, realnum_from_frac(values[i], 1));
+    }
+    return mat;
+}
+
+/* Exact elements give the exact determinant, with the sign of the permutation. */
+static void test_determinant(void) {
+    // The first pivot is taken from the last row, an odd permutation.
+    int64_t values[] = {
+        1, 2, 3,
+        0, 1, 4,
+        5, 6, 0
+    };
+    linmatrix a = test_matrix(3, values);
+    realnum det = linmatrix_determinant(&a);
+    CHECK_FRAC(&det, 1, 1);
+
+    int64_t singular[] = {
+        1, 2, 3,
+        2, 4, 6,
+        1, 0, 1
+    };
+    linmatrix s = test_matrix(3, singular);
+    linmatrix_lu lu = linmatrix_lu_new(&s);
+    CHECK(lu.singular);
+    realnum zero = linmatrix_lu_determinant(&lu);
+    CHECK_FRAC(&zero, 0, 1);
+    linmatrix_lu_free(&lu);
+    linmatrix_free(&a);
+    linmatrix_free(&s);
+}
+
+/* A^-1 * A is exactly the identity, and a solve reproduces its right-hand side. */
+static void test_inverse_and_solve(void) {
+    int64_t values[] = {
+        2, -1, 0, 3,
+        4, 1, -2, 0,
+        0, 5, 1, 1,
+        -3, 0, 2, 2
+    };
+    linmatrix a = test_matrix(4, values);
+    linmatrix_lu lu = linmatrix_lu_new(&a);
+    CHECK(!lu.singular);
+    linmatrix inv = linmatrix_lu_inverse(&lu);
+    linmatrix id = linmatrix_mul(&inv, &a);
+    for (size_t i = 0; i < 16; i++) {
+        CHECK_FRAC(&id.data[i], i / 4 == i % 4 ? 1 : 0, 1);
+    }
+
+    linvector b = linvector_with_capacity(4);
+    for (size_t i = 0; i < 4; i++) {
+        linvector_push(&b, realnum_from_frac((int64_t)i + 1, 1));
+    }
+    linvector x = linmatrix_lu_solve(&lu, &b);
+    linvector ax = linmatrix_mul_vector(&a, &x);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK_FRAC(&ax.data[i], (int64_t)i + 1, 1);
+    }
+    linmatrix_free(&inv);
+    linmatrix_free(&id);
+    linvector_free(&b);
+    linvector_free(&x);
+    linvector_free(&ax);
+    linmatrix_lu_free(&lu);
+    linmatrix_free(&a);
+}
+
+int main(void) {
+    test_determinant();
+    test_inverse_and_solve();
+    printf("lu_test: ok\n");
+    return 0;
+}
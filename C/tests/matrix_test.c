@@ -0,0 +1,125 @@
+#include"./test.h"
+#include"../lib/matrix/matrix.h"
+#include"../lib/matrix/lu.h"
+
+static linmatrix test_matrix(size_t rows, size_t cols, size_t seed) {
+    linmatrix mat = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) {
+        linmatrix_set(&mat, i / cols, i % cols, realnum_from_frac(test_int(seed + i), 1));
+    }
+    return mat;
+}
+
+/* The product through the textbook triple loop, as exact int64s. */
+static void test_product(void) {
+    // Larger than a block in every dimension, and not a multiple of any.
+    size_t m = 70, k = 300, n = 45;
+    linmatrix a = test_matrix(m, k, 0);
+    linmatrix b = test_matrix(k, n, 7);
+    linmatrix c = linmatrix_mul(&a, &b);
+    CHECK(c.rows == m && c.cols == n);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            int64_t sum = 0;
+            for (size_t p = 0; p < k; p++) {
+                sum += a.data[i * k + p].value.frac.num * b.data[p * n + j].value.frac.num;
+            }
+            CHECK_FRAC(&c.data[i * n + j], sum, 1);
+        }
+    }
+    linmatrix id = linmatrix_identity(m);
+    linmatrix same = linmatrix_mul(&id, &a);
+    for (size_t i = 0; i < m * k; i++) {
+        CHECK_FRAC(&same.data[i], a.data[i].value.frac.num, 1);
+    }
+    linmatrix_free(&a);
+    linmatrix_free(&b);
+    linmatrix_free(&c);
+    linmatrix_free(&id);
+    linmatrix_free(&same);
+}
+
+static void test_transpose(void) {
+    linmatrix a = test_matrix(37, 53, 3);
+    linmatrix t = linmatrix_transpose(&a);
+    linmatrix u = linmatrix_clone(&a);
+    linmatrix_transpose_in_place(&u);
+    CHECK(t.rows == 53 && t.cols == 37 && u.rows == 53 && u.cols == 37);
+    for (size_t i = 0; i < 37; i++) {
+        for (size_t j = 0; j < 53; j++) {
+            CHECK_FRAC(&t.data[j * 37 + i], a.data[i * 53 + j].value.frac.num, 1);
+            CHECK_FRAC(&u.data[j * 37 + i], a.data[i * 53 + j].value.frac.num, 1);
+        }
+    }
+    linmatrix_free(&a);
+    linmatrix_free(&t);
+    linmatrix_free(&u);
+}
+
+/* C -= A * B on sub-blocks leaves the rest of C untouched. */
+static void test_view_mul_sub(void) {
+    linmatrix a = test_matrix(6, 4, 1);
+    linmatrix b = test_matrix(4, 5, 2);
+    linmatrix c = test_matrix(8, 8, 3);
+    linmatrix before = linmatrix_clone(&c);
+    linmatrix_view av = linmatrix_view_of(&a);
+    linmatrix_view bv = linmatrix_view_of(&b);
+    linmatrix_view cv = linmatrix_view_of(&c);
+    linmatrix_view block = linmatrix_view_block(&cv, 1, 2, 6, 5);
+    linmatrix_view_mul_sub(&block, &av, &bv);
+    for (size_t i = 0; i < 8; i++) {
+        for (size_t j = 0; j < 8; j++) {
+            int64_t expected = before.data[i * 8 + j].value.frac.num;
+            if (i >= 1 && i < 7 && j >= 2 && j < 7) {
+                for (size_t p = 0; p < 4; p++) {
+                    expected -= a.data[(i - 1) * 4 + p].value.frac.num * b.data[p * 5 + j - 2].value.frac.num;
+                }
+            }
+            CHECK_FRAC(&c.data[i * 8 + j], expected, 1);
+        }
+    }
+    linmatrix_free(&a);
+    linmatrix_free(&b);
+    linmatrix_free(&c);
+    linmatrix_free(&before);
+}
+
+/* A borrowed matrix writes through to the caller's elements and frees neither them nor their buffer. */
+static void test_borrow(void) {
+    realnum data[4] = {
+        realnum_from_frac(2, 1), realnum_from_frac(1, 1),
+        realnum_from_frac(4, 1), realnum_from_frac(5, 1)
+    };
+    linmatrix a = linmatrix_borrow(data, 2, 2);
+    CHECK(a.borrowed && a.data == data);
+    linmatrix_set(&a, 0, 1, realnum_from_frac(3, 1));
+    CHECK_FRAC(&data[1], 3, 1);
+    linmatrix_free(&a);
+    CHECK_FRAC(&data[0], 2, 1);
+
+    // An in-place factorization keeps working on the caller's buffer.
+    linmatrix b = linmatrix_borrow(data, 2, 2);
+    linmatrix_lu lu = linmatrix_lu_in_place(&b);
+    CHECK(lu.lu.data == data);
+    realnum det = linmatrix_lu_determinant(&lu);
+    CHECK_FRAC(&det, -2, 1);
+    linmatrix_lu_free(&lu);
+    CHECK(data[0].kind == REALNUM_FRAC);
+
+    realnum* owned = malloc(2 * sizeof(realnum));
+    owned[0] = realnum_from_frac(1, 2);
+    owned[1] = realnum_from_frac(INT64_MAX, 1);
+    owned[1] = realnum_add(&owned[1], &owned[1]);
+    linmatrix c = linmatrix_with_data(owned, 1, 2);
+    CHECK(!c.borrowed);
+    linmatrix_free(&c);
+}
+
+int main(void) {
+    test_product();
+    test_transpose();
+    test_view_mul_sub();
+    test_borrow();
+    printf("matrix_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include"./test.h"
+#include<string.h>
+
+/* Sums and products that outgrow int64 terms are exact, and come back when they fit. */
+static void test_frac_overflow(void) {
+    realnum big = realnum_from_frac(INT64_MAX, 1);
+    realnum sum = realnum_add(&big, &big);
+    CHECK(sum.kind == REALNUM_BIGFRAC);
+    realnum back = realnum_sub(&sum, &big);
+    CHECK_FRAC(&back, INT64_MAX, 1);
+
+    realnum third = realnum_from_frac(1, 3);
+    realnum a = realnum_from_frac(INT64_MAX / 3 * 3, 7);
+    realnum product = realnum_mul(&a, &third);
+    CHECK_FRAC(&product, INT64_MAX / 3, 7);
+    realnum_free(&sum);
+}
+
+/* INT64_MIN has no int64 negation, so these go through the 128-bit path. */
+static void test_int64_min(void) {
+    realnum min = realnum_from_frac(INT64_MIN, 1);
+    realnum neg = realnum_neg(&min);
+    CHECK(neg.kind == REALNUM_BIGFRAC);
+    realnum again = realnum_neg(&neg);
+    CHECK(again.kind != REALNUM_APROX);
+    realnum diff = realnum_sub(&again, &min);
+    CHECK_FRAC(&diff, 0, 1);
+
+    realnum abs = realnum_abs(&min);
+    CHECK(abs.kind == REALNUM_BIGFRAC);
+
+    realnum over = realnum_from_frac(2, INT64_MIN);
+    realnum simp = realnum_fracsimp(&over);
+    CHECK(simp.kind == REALNUM_FRAC && simp.value.frac.num == -1 && simp.value.frac.den == INT64_C(1) << 62);
+
+    realnum unit = realnum_from_frac(1, INT64_MIN);
+    realnum unit_simp = realnum_fracsimp(&unit);
+    CHECK(unit_simp.kind == REALNUM_BIGFRAC);
+    realnum product = realnum_mul(&unit_simp, &min);
+    CHECK_FRAC(&product, 1, 1);
+
+    realnum same = realnum_from_frac(INT64_MIN, INT64_MIN);
+    realnum one = realnum_fracsimp(&same);
+    CHECK(one.kind == REALNUM_FRAC && one.value.frac.num == 1 && one.value.frac.den == 1);
+
+    realnum_free(&neg);
+    realnum_free(&again);
+    realnum_free(&abs);
+    realnum_free(&unit_simp);
+}
+
+static void test_format(realnum* x, const char* num, const char* den) {
+    char buf[128];
+    CHECK(x->kind == REALNUM_BIGFRAC);
+    linbigint_format(&x->value.bigfrac->num, buf, sizeof(buf));
+    CHECK(strcmp(buf, num) == 0);
+    linbigint_format(&x->value.bigfrac->den, buf, sizeof(buf));
+    CHECK(strcmp(buf, den) == 0);
+}
+
+/* Exact powers, and their inverses and negations, stay reduced and exact. */
+static void test_bigfrac(void) {
+    realnum base = realnum_from_frac(3, 2);
+    realnum e = realnum_from_frac(100, 1);
+    realnum x = realnum_pow(&base, &e);
+    test_format(&x, "515377520732011331036461129765621272702107522001", "1267650600228229401496703205376");
+
+    realnum neg = realnum_neg(&x);
+    test_format(&neg, "-515377520732011331036461129765621272702107522001", "1267650600228229401496703205376");
+    realnum inv = realnum_inv(&neg);
+    test_format(&inv, "-1267650600228229401496703205376", "515377520732011331036461129765621272702107522001");
+    realnum one = realnum_mul(&inv, &neg);
+    CHECK_FRAC(&one, 1, 1);
+
+    realnum minus = realnum_from_frac(-100, 1);
+    realnum y = realnum_pow(&base, &minus);
+    realnum product = realnum_mul(&x, &y);
+    CHECK_FRAC(&product, 1, 1);
+    CHECK_NEAR(&x, 406561177535215237.0, 1e12);
+
+    realnum_free(&x);
+    realnum_free(&neg);
+    realnum_free(&inv);
+    realnum_free(&y);
+}
+
+/* Powers too large to be exact are approximated instead of computed for ever. */
+static void test_pow_cap(void) {
+    realnum base = realnum_from_frac(3, 2);
+    realnum e = realnum_from_frac(1000000, 1);
+    realnum x = realnum_pow(&base, &e);
+    CHECK(x.kind == REALNUM_APROX);
+
+    realnum one = realnum_from_frac(1, 1);
+    realnum y = realnum_pow(&one, &e);
+    CHECK_FRAC(&y, 1, 1);
+    realnum two = realnum_from_frac(-2, 1);
+    realnum small = realnum_from_frac(-3, 1);
+    realnum z = realnum_pow(&two, &small);
+    CHECK_FRAC(&z, -1, 8);
+}
+
+int main(void) {
+    test_frac_overflow();
+    test_int64_min();
+    test_bigfrac();
+    test_pow_cap();
+    printf("realnum_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include"./test.h"
+#include"../lib/matrix/rref.h"
+
+#define ROWS 12
+#define COLS 9
+#define RANK 4
+
+/* [I; G] for a rows x rank G of small integers, which has full column rank. */
+static linmatrix test_basis(size_t rows, size_t rank, size_t seed) {
+    linmatrix mat = linmatrix_new(rows, rank);
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < rank; j++) {
+            int64_t value = i < rank ? i == j : test_int(seed + i * rank + j);
+            linmatrix_set(&mat, i, j, realnum_from_frac(value, 1));
+        }
+    }
+    return mat;
+}
+
+/* B * C^T with both of full column rank, so the product has rank RANK. */
+static linmatrix test_matrix(void) {
+    linmatrix b = test_basis(ROWS, RANK, 1);
+    linmatrix c = test_basis(COLS, RANK, 7);
+    linmatrix ct = linmatrix_transpose(&c);
+    linmatrix a = linmatrix_mul(&b, &ct);
+    linmatrix_free(&b);
+    linmatrix_free(&c);
+    linmatrix_free(&ct);
+    return a;
+}
+
+/* The reduced form has leading ones in its pivot columns and zero rows below the rank. */
+static void test_rref(void) {
+    linmatrix a = test_matrix();
+    linmatrix_rref rref = linmatrix_rref_new(&a);
+    CHECK(rref.rank == RANK);
+    for (size_t k = 0; k < RANK; k++) {
+        CHECK(k == 0 || rref.pivots[k - 1] < rref.pivots[k]);
+        for (size_t i = 0; i < ROWS; i++) {
+            CHECK_FRAC(&rref.rref.data[i * COLS + rref.pivots[k]], i == k, 1);
+        }
+    }
+    for (size_t i = RANK * COLS; i < ROWS * COLS; i++) {
+        CHECK_FRAC(&rref.rref.data[i], 0, 1);
+    }
+    CHECK(linmatrix_rank(&a) == RANK);
+
+    linmatrix column = linmatrix_column_space(&a);
+    CHECK(column.rows == ROWS && column.cols == RANK && linmatrix_rank(&column) == RANK);
+
+    linmatrix_free(&a);
+    linmatrix_free(&column);
+    linmatrix_rref_free(&rref);
+}
+
+/* A * N is zero, exactly for exact elements and nearly for approximated ones. */
+static void test_null_space(void) {
+    linmatrix a = test_matrix();
+    linmatrix n = linmatrix_null_space(&a);
+    CHECK(n.rows == COLS && n.cols == COLS - RANK && linmatrix_rank(&n) == COLS - RANK);
+    linmatrix an = linmatrix_mul(&a, &n);
+    for (size_t i = 0; i < ROWS * (COLS - RANK); i++) {
+        CHECK_FRAC(&an.data[i], 0, 1);
+    }
+    linmatrix_free(&n);
+    linmatrix_free(&an);
+
+    for (size_t i = 0; i < ROWS * COLS; i++) {
+        a.data[i] = realnum_as_aprox(&a.data[i]);
+        a.data[i].value.aprox /= 3;
+    }
+    CHECK(linmatrix_rank(&a) == RANK);
+    n = linmatrix_null_space(&a);
+    CHECK(n.cols == COLS - RANK);
+    an = linmatrix_mul(&a, &n);
+    for (size_t i = 0; i < ROWS * (COLS - RANK); i++) {
+        CHECK_NEAR(&an.data[i], 0, 1e-4);
+    }
+    linmatrix_free(&a);
+    linmatrix_free(&n);
+    linmatrix_free(&an);
+}
+
+/* The coefficients found for a target in the span give the target back. */
+static void test_combination(void) {
+    linvector vecs[3];
+    for (size_t k = 0; k < 3; k++) {
+        vecs[k] = linvector_with_capacity(5);
+        for (size_t i = 0; i < 5; i++) {
+            linvector_push(&vecs[k], realnum_from_frac(k == 2 ? test_int(i) + 2 * test_int(i + 5) : test_int(i + 5 * k), 1));
+        }
+    }
+    CHECK(linvector_independent(vecs, 2));
+    CHECK(!linvector_independent(vecs, 3));
+
+    linvector target = linvector_with_capacity(5);
+    for (size_t i = 0; i < 5; i++) {
+        linvector_push(&target, realnum_from_frac(3 * test_int(i) - test_int(i + 5), 2));
+    }
+    linvector c;
+    CHECK(linvector_combination(vecs, 3, &target, &c));
+    CHECK(c.size == 3);
+    for (size_t i = 0; i < 5; i++) {
+        realnum sum = realnum_new();
+        for (size_t k = 0; k < 3; k++) {
+            realnum term = realnum_mul(&c.data[k], &vecs[k].data[i]);
+            realnum next = realnum_add(&sum, &term);
+            sum = next;
+        }
+        realnum diff = realnum_sub(&sum, &target.data[i]);
+        CHECK_FRAC(&diff, 0, 1);
+    }
+
+    target.data[0] = realnum_from_frac(1000, 1);
+    linvector unused;
+    CHECK(!linvector_combination(vecs, 3, &target, &unused));
+
+    for (size_t k = 0; k < 3; k++) {
+        linvector_free(&vecs[k]);
+    }
+    linvector_free(&target);
+    linvector_free(&c);
+}
+
+int main(void) {
+    test_rref();
+    test_null_space();
+    test_combination();
+    printf("rref_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include"./test.h"
+#include"../lib/vector/simd.h"
+#include<math.h>
+
+/* Covers empty arrays, partial registers and every unrolled tail of every instruction set. */
+#define MAX 70
+
+static double a64[MAX], b64[MAX], r64[MAX];
+static float a32[MAX], b32[MAX], r32[MAX];
+
+static void fill(void) {
+    for (size_t i = 0; i < MAX; i++) {
+        a64[i] = test_int(i) + 1.0 / (double)(i + 1);
+        b64[i] = test_int(i + 3) - 0.25 * (double)i;
+        a32[i] = (float)a64[i];
+        b32[i] = (float)b64[i];
+    }
+}
+
+/* Every kernel of the active instruction set agrees with a plain loop. */
+static void check_kernels(void) {
+    for (size_t n = 0; n <= MAX; n++) {
+        double dot64 = 0;
+        float dot32 = 0;
+        double scale = 0;
+        for (size_t i = 0; i < n; i++) {
+            dot64 += a64[i] * b64[i];
+            dot32 += a32[i] * b32[i];
+            scale += fabs(a64[i] * b64[i]);
+        }
+        CHECK(fabs(linsimd_dot_f64(n, a64, b64) - dot64) <= 1e-13 * scale);
+        CHECK(fabs(linsimd_dot_f32(n, a32, b32) - dot32) <= 1e-5f * (float)scale);
+
+        linsimd_add_f64(n, a64, b64, r64);
+        linsimd_add_f32(n, a32, b32, r32);
+        for (size_t i = 0; i < n; i++) {
+            CHECK(r64[i] == a64[i] + b64[i] && r32[i] == a32[i] + b32[i]);
+        }
+        linsimd_sub_f64(n, a64, b64, r64);
+        linsimd_sub_f32(n, a32, b32, r32);
+        for (size_t i = 0; i < n; i++) {
+            CHECK(r64[i] == a64[i] - b64[i] && r32[i] == a32[i] - b32[i]);
+        }
+        linsimd_scale_f64(n, a64, -1.5, r64);
+        linsimd_scale_f32(n, a32, -1.5f, r32);
+        for (size_t i = 0; i < n; i++) {
+            CHECK(r64[i] == a64[i] * -1.5 && r32[i] == a32[i] * -1.5f);
+        }
+        linsimd_div_f64(n, a64, 3, r64);
+        linsimd_div_f32(n, a32, 3, r32);
+        for (size_t i = 0; i < n; i++) {
+            CHECK(fabs(r64[i] - a64[i] / 3) <= 1e-15 * fabs(a64[i]));
+            CHECK(fabsf(r32[i] - a32[i] / 3) <= 1e-6f * fabsf(a32[i]));
+        }
+    }
+}
+
+/* The 3D kernels round exactly like the scalar code. */
+static void check_kernels3(double expected[3][MAX]) {
+    const double* a[3] = { a64, b64, a64 + 1 };
+    const double* b[3] = { b64, a64 + 2, b64 + 1 };
+    double x[MAX], y[MAX], z[MAX];
+    double* r[3] = { x, y, z };
+    size_t n = MAX - 2;
+    linsimd_cross3_f64(n, a, b, r);
+    for (size_t i = 0; i < n; i++) {
+        CHECK(x[i] == expected[0][i] && y[i] == expected[1][i] && z[i] == expected[2][i]);
+    }
+    double dots[MAX];
+    linsimd_dot3_f64(n, a, b, dots);
+    linsimd_normalize3_f64(n, (const double* const*)r, r);
+    for (size_t i = 0; i < n; i++) {
+        CHECK(dots[i] == a64[i] * b64[i] + b64[i] * a64[i + 2] + a64[i + 1] * b64[i + 1]);
+        double norm = sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        CHECK(norm == 0 || fabs(norm - 1) <= 1e-15);
+    }
+}
+
+int main(void) {
+    fill();
+    linsimd_isa detected = linsimd_detect();
+    CHECK(linsimd_active() == detected);
+
+    // The scalar cross products are the reference of the vectorized ones.
+    double expected[3][MAX];
+    for (size_t i = 0; i < MAX - 2; i++) {
+        double ax = a64[i], ay = b64[i], az = a64[i + 1];
+        double bx = b64[i], by = a64[i + 2], bz = b64[i + 1];
+        expected[0][i] = ay * bz - az * by;
+        expected[1][i] = az * bx - ax * bz;
+        expected[2][i] = ax * by - ay * bx;
+    }
+
+    const linsimd_isa isas[] = { LINSIMD_SCALAR, LINSIMD_NEON, LINSIMD_AVX2, LINSIMD_AVX512 };
+    for (size_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+        linsimd_isa isa = linsimd_force(isas[k]);
+        CHECK(isa == isas[k] || isa == detected);
+        CHECK(linsimd_active() == isa);
+        check_kernels();
+        check_kernels3(expected);
+    }
+    linsimd_force(detected);
+    printf("simd_test: ok\n");
+    return 0;
+}
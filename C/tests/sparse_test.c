@@ -0,0 +1,120 @@
+#include"./test.h"
+#include"../lib/sparse/sparse.h"
+
+/* A matrix with about one element in three stored. */
+static linmatrix test_matrix(size_t rows, size_t cols, size_t seed) {
+    linmatrix mat = linmatrix_new(rows, cols);
+    for (size_t i = 0; i < rows * cols; i++) {
+        int64_t value = (i * 7 + seed) % 3 == 0 ? test_int(seed + i) : 0;
+        linmatrix_set(&mat, i / cols, i % cols, realnum_from_frac(value, (int64_t)(i % 4) + 1));
+    }
+    return mat;
+}
+
+static void check_same(realnum* a, realnum* b) {
+    realnum diff = realnum_sub(a, b);
+    CHECK_FRAC(&diff, 0, 1);
+}
+
+static void check_same_matrix(linmatrix* a, linmatrix* b) {
+    CHECK(a->rows == b->rows && a->cols == b->cols);
+    for (size_t i = 0; i < a->rows * a->cols; i++) {
+        check_same(&a->data[i], &b->data[i]);
+    }
+}
+
+/* Both layouts keep sorted indices and give back the dense matrix they came from. */
+static void test_round_trip(void) {
+    linmatrix dense = test_matrix(13, 17, 1);
+    linsparse csr = linsparse_from_dense(&dense, LINSPARSE_CSR);
+    linsparse csc = linsparse_convert(&csr, LINSPARSE_CSC);
+    CHECK(csr.nnz == csc.nnz && csr.offsets[13] == csr.nnz && csc.offsets[17] == csc.nnz);
+    for (size_t i = 0; i < 13; i++) {
+        for (size_t k = csr.offsets[i] + 1; k < csr.offsets[i + 1]; k++) {
+            CHECK(csr.indices[k - 1] < csr.indices[k]);
+        }
+    }
+    for (size_t i = 0; i < 13; i++) {
+        for (size_t j = 0; j < 17; j++) {
+            realnum a = linsparse_get(&csr, i, j);
+            realnum b = linsparse_get(&csc, i, j);
+            check_same(&a, &dense.data[i * 17 + j]);
+            check_same(&b, &dense.data[i * 17 + j]);
+        }
+    }
+    linmatrix from_csr = linsparse_to_dense(&csr);
+    linmatrix from_csc = linsparse_to_dense(&csc);
+    check_same_matrix(&from_csr, &dense);
+    check_same_matrix(&from_csc, &dense);
+
+    linmatrix_free(&dense);
+    linmatrix_free(&from_csr);
+    linmatrix_free(&from_csc);
+    linsparse_free(&csr);
+    linsparse_free(&csc);
+}
+
+/* Duplicate triplets are summed and the ones that cancel are dropped. */
+static void test_coo(void) {
+    linsparse_coo coo = linsparse_coo_new(3, 4);
+    linsparse_coo_push(&coo, 2, 3, realnum_from_frac(1, 2));
+    linsparse_coo_push(&coo, 0, 1, realnum_from_frac(3, 1));
+    linsparse_coo_push(&coo, 2, 3, realnum_from_frac(1, 3));
+    linsparse_coo_push(&coo, 1, 0, realnum_from_frac(2, 1));
+    linsparse_coo_push(&coo, 1, 0, realnum_from_frac(-2, 1));
+    for (int f = LINSPARSE_CSR; f <= LINSPARSE_CSC; f++) {
+        linsparse mat = linsparse_from_coo(&coo, (linsparse_format)f);
+        CHECK(mat.nnz == 2);
+        realnum a = linsparse_get(&mat, 2, 3);
+        realnum b = linsparse_get(&mat, 0, 1);
+        realnum c = linsparse_get(&mat, 1, 0);
+        CHECK_FRAC(&a, 5, 6);
+        CHECK_FRAC(&b, 3, 1);
+        CHECK_FRAC(&c, 0, 1);
+        linsparse_free(&mat);
+    }
+    linsparse_coo_free(&coo);
+}
+
+/* Products in either layout match the dense products exactly. */
+static void test_products(void) {
+    linmatrix a = test_matrix(31, 23, 2);
+    linmatrix b = linmatrix_new(23, 5);
+    for (size_t i = 0; i < 23 * 5; i++) {
+        linmatrix_set(&b, i / 5, i % 5, realnum_from_frac(test_int(i + 4), 3));
+    }
+    linvector x = linvector_with_capacity(23);
+    for (size_t i = 0; i < 23; i++) {
+        linvector_push(&x, realnum_from_frac(test_int(i + 9), 2));
+    }
+    linmatrix expected = linmatrix_mul(&a, &b);
+    linvector expected_y = linmatrix_mul_vector(&a, &x);
+
+    for (int f = LINSPARSE_CSR; f <= LINSPARSE_CSC; f++) {
+        linsparse sa = linsparse_from_dense(&a, (linsparse_format)f);
+        linvector y = linsparse_mul_vector(&sa, &x);
+        CHECK(y.size == 31);
+        for (size_t i = 0; i < 31; i++) {
+            check_same(&y.data[i], &expected_y.data[i]);
+        }
+        linmatrix c = linsparse_mul_dense(&sa, &b);
+        check_same_matrix(&c, &expected);
+        linvector_free(&y);
+        linmatrix_free(&c);
+        linsparse_free(&sa);
+    }
+
+    linmatrix_free(&a);
+    linmatrix_free(&b);
+    linmatrix_free(&expected);
+    linvector_free(&x);
+    linvector_free(&expected_y);
+}
+
+int main(void) {
+    test_round_trip();
+    test_coo();
+    test_products();
+    printf("sparse_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include"./test.h"
+#include"../lib/stats/stats.h"
+
+static void test_clock(void) {
+    uint64_t last = linstats_now();
+    for (int i = 0; i < 1000; i++) {
+        uint64_t now = linstats_now();
+        CHECK(now >= last);
+        last = now;
+    }
+}
+
+/* Every exact result that leaves int64 terms is counted once, whatever its path. */
+static void test_frac_overflow(void) {
+    linstats_reset();
+    realnum big = realnum_from_frac(INT64_MAX, 1);
+    realnum sum = realnum_add(&big, &big);
+    realnum more = realnum_add(&sum, &big);
+    realnum product = realnum_mul(&more, &big);
+    linstats stats = linstats_snapshot();
+#if LINALG_STATS
+    CHECK(stats.counts[LINSTATS_FRAC_OVERFLOW] == 3);
+#else
+    CHECK(stats.counts[LINSTATS_FRAC_OVERFLOW] == 0);
+#endif
+    realnum_free(&sum);
+    realnum_free(&more);
+    realnum_free(&product);
+}
+
+int main(void) {
+    test_clock();
+    test_frac_overflow();
+    printf("stats_test: ok\n");
+    return 0;
+}
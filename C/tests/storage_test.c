@@ -0,0 +1,140 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include"./test.h"
+#include"../lib/storage/storage.h"
+#include<string.h>
+#if !defined(_WIN32)
+#include<sys/wait.h>
+#include<unistd.h>
+#endif
+
+#define PATH "storage_test.bin"
+
+static bool same_element(realnum* a, realnum* b) {
+    if (a->kind == REALNUM_FRAC) {
+        return b->kind == REALNUM_FRAC && a->value.frac.num == b->value.frac.num && a->value.frac.den == b->value.frac.den;
+    }
+    return b->kind == REALNUM_APROX && a->value.aprox == b->value.aprox;
+}
+
+/* Exact and approximated elements read back as they were. */
+static void test_vector(void) {
+    realnum_aprox one = 1;
+    linvector vec = linvector_with_capacity(4);
+    linvector_push(&vec, realnum_from_frac(-3, 7));
+    linvector_push(&vec, realnum_from_aprox(one / 3));
+    linvector_push(&vec, realnum_from_aprox(-one / 1024));
+    linvector_push(&vec, realnum_from_frac(INT64_MIN, 1));
+    linstorage_save_vector(&vec, PATH);
+
+    linvector back = linstorage_load_vector(PATH);
+    CHECK(back.size == 4);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK(same_element(&vec.data[i], &back.data[i]));
+    }
+
+    linstorage_map map = linstorage_map_open(PATH);
+    CHECK(linstorage_map_check(&map, 0, 4));
+    CHECK(!linstorage_map_check(&map, 2, 3));
+    linvector_view view = linstorage_map_vector(&map);
+    CHECK(view.size == 4);
+    CHECK(same_element(&back.data[0], &view.data[0]) && same_element(&back.data[3], &view.data[3]));
+    linstorage_map_close(&map);
+
+    linvector_free(&vec);
+    linvector_free(&back);
+}
+
+static void test_matrix(void) {
+    linmatrix mat = linmatrix_new(7, 5);
+    for (size_t i = 0; i < 35; i++) {
+        realnum value = i % 2 ? realnum_from_frac(test_int(i), (int64_t)i) : realnum_from_aprox((realnum_aprox)test_int(i) / 8);
+        linmatrix_set(&mat, i / 5, i % 5, value);
+    }
+    linstorage_save_matrix(&mat, PATH);
+    linmatrix back = linstorage_load_matrix(PATH);
+    CHECK(back.rows == 7 && back.cols == 5);
+    for (size_t i = 0; i < 35; i++) {
+        CHECK(same_element(&mat.data[i], &back.data[i]));
+    }
+
+    linstorage_map map = linstorage_map_open(PATH);
+    linmatrix_view view = linstorage_map_matrix(&map);
+    CHECK(view.rows == 7 && view.cols == 5);
+    for (size_t i = 0; i < 7; i++) {
+        for (size_t j = 0; j < 5; j++) {
+            CHECK(same_element(&mat.data[i * 5 + j], &view.data[i * view.row_stride + j * view.col_stride]));
+        }
+    }
+    linstorage_map_close(&map);
+    linmatrix_free(&mat);
+    linmatrix_free(&back);
+}
+
+/* A fraction over zero written into the file is reported by the check of its range only. */
+static void test_invalid(void) {
+    linmatrix mat = linmatrix_identity(4);
+    linstorage_save_matrix(&mat, PATH);
+    FILE* file = fopen(PATH, "r+b");
+    CHECK(file != NULL);
+    realnum bad = realnum_from_frac(1, 0);
+    CHECK(fseek(file, LINSTORAGE_ALIGNMENT + 9 * sizeof(realnum), SEEK_SET) == 0);
+    CHECK(fwrite(&bad, sizeof(realnum), 1, file) == 1);
+    fclose(file);
+
+    linstorage_map map = linstorage_map_open(PATH);
+    CHECK(linstorage_map_check(&map, 0, 9));
+    CHECK(!linstorage_map_check(&map, 0, 16));
+    CHECK(linstorage_map_check(&map, 10, 6));
+    linstorage_map_close(&map);
+    linmatrix_free(&mat);
+}
+
+#if !defined(_WIN32)
+/* Saves `vec` in a child process and returns whether it exited with an error. */
+static bool save_fails(linvector* vec) {
+    fflush(NULL);
+    pid_t pid = fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        fclose(stderr);
+        linstorage_save_vector(vec, PATH);
+        _exit(0);
+    }
+    int status;
+    CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status));
+    return WEXITSTATUS(status) != 0;
+}
+
+/* Elements that would not load back unchanged are refused, and the file is left alone. */
+static void test_refused(void) {
+    linvector vec = linvector_with_capacity(2);
+    linvector_push(&vec, realnum_from_frac(5, 2));
+    linstorage_save_vector(&vec, PATH);
+
+    realnum big = realnum_from_frac(INT64_MAX, 1);
+    linvector_push(&vec, realnum_add(&big, &big));
+    CHECK(save_fails(&vec));
+    realnum_free(&vec.data[1]);
+    vec.data[1] = realnum_from_frac(1, 0);
+    CHECK(save_fails(&vec));
+
+    linvector back = linstorage_load_vector(PATH);
+    CHECK(back.size == 1 && same_element(&back.data[0], &vec.data[0]));
+    linvector_free(&vec);
+    linvector_free(&back);
+}
+#endif
+
+int main(void) {
+    test_vector();
+    test_matrix();
+    test_invalid();
+#if !defined(_WIN32)
+    test_refused();
+#endif
+    remove(PATH);
+    printf("storage_test: ok\n");
+    return 0;
+}
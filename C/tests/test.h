@@ -0,0 +1,40 @@
+#pragma once
+#include<stdio.h>
+#include<stdlib.h>
+#include"../lib/numeric/realnum.h"
+
+/*
+ * Checks shared by the tests. A test is a program that returns 0 when every
+ * check holds and stops at the first one that does not, printing its location.
+ */
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    } \
+} while (0)
+
+/*
+ * Checks that a realnum is an exact fraction equal to num / den. Small terms
+ * are reduced lazily, so the terms themselves are compared crosswise.
+ */
+#define CHECK_FRAC(x, n, d) CHECK((x)->kind == REALNUM_FRAC && \
+    (__int128)(x)->value.frac.num * (d) == (__int128)(n) * (x)->value.frac.den)
+
+/* Checks that a realnum of any kind is within tol of the double expected. */
+#define CHECK_NEAR(x, expected, tol) CHECK(test_distance(x, expected) <= (tol))
+
+static inline double test_value(realnum* x) {
+    return (double)realnum_as_aprox(x).value.aprox;
+}
+
+static inline double test_distance(realnum* x, double expected) {
+    double d = test_value(x) - expected;
+    return d < 0 ? -d : d;
+}
+
+/* Deterministic small integers in [-5, 5]. */
+static inline int64_t test_int(size_t i) {
+    return (int64_t)((i * 2654435761u) % 11) - 5;
+}
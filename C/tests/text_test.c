@@ -0,0 +1,114 @@
+#include"./test.h"
+#include"../lib/text/text.h"
+#include<string.h>
+
+static bool same_realnum(realnum* a, realnum* b) {
+    if (a->kind != b->kind) {
+        return false;
+    }
+    switch (a->kind) {
+        case REALNUM_FRAC:
+            return a->value.frac.num == b->value.frac.num && a->value.frac.den == b->value.frac.den;
+        case REALNUM_BIGFRAC:
+            return linbigint_cmp(&a->value.bigfrac->num, &b->value.bigfrac->num) == 0 &&
+                linbigint_cmp(&a->value.bigfrac->den, &b->value.bigfrac->den) == 0;
+        default:
+            return a->value.aprox == b->value.aprox;
+    }
+}
+
+/* Every kind of element reads back as the value it was written from. */
+static void test_round_trip(void) {
+    realnum a = realnum_from_frac(INT64_MAX / 3, 1);
+    realnum b = realnum_from_frac(INT64_MAX / 7, 3);
+    realnum c = realnum_from_frac(INT64_MAX, 1);
+    realnum third = realnum_from_frac(1, 3);
+    realnum tenth = realnum_from_aprox(1);
+    realnum ten = realnum_from_aprox(10);
+    realnum_aprox one = 1;
+
+    linvector vec = linvector_with_capacity(8);
+    linvector_push(&vec, realnum_mul(&a, &b));
+    linvector_push(&vec, realnum_add(&c, &c));
+    linvector_push(&vec, realnum_div(&third, &c));
+    linvector_push(&vec, realnum_from_frac(INT64_MIN, 1));
+    linvector_push(&vec, realnum_from_frac(-7, 2));
+    linvector_push(&vec, realnum_div(&tenth, &ten));
+    linvector_push(&vec, realnum_from_aprox(-one / 3));
+    linvector_push(&vec, realnum_from_aprox(1e30));
+    CHECK(vec.data[0].kind == REALNUM_BIGFRAC && vec.data[1].kind == REALNUM_BIGFRAC && vec.data[2].kind == REALNUM_BIGFRAC);
+
+    for (char sep = ' '; sep != 0; sep = sep == ' ' ? ',' : 0) {
+        size_t length = lintext_format_vector(&vec, sep, NULL, 0);
+        char* text = malloc(length + 1);
+        CHECK(lintext_format_vector(&vec, sep, text, length + 1) == length);
+        linvector back = lintext_parse_vector(text, length);
+        CHECK(back.size == vec.size);
+        for (size_t i = 0; i < vec.size; i++) {
+            CHECK(same_realnum(&back.data[i], &vec.data[i]));
+        }
+        linvector_free(&back);
+        free(text);
+    }
+
+    // A numerator beyond int64 over a small denominator, which used to stop the parser.
+    char expected[] = "4050980558582600754198739797494177402/3";
+    char buf[64];
+    CHECK(lintext_format_realnum(&vec.data[0], buf, sizeof(buf)) == strlen(expected) && strcmp(buf, expected) == 0);
+    linvector_free(&vec);
+}
+
+/* Terms beyond int64 that reduce back into it are demoted as they are read. */
+static void test_parse(void) {
+    const char text[] = "[1, -2/4; 18446744073709551616/36893488147419103232]\n\n3.5 ; 1e2 ; -0\n";
+    linmatrix mat = lintext_parse_matrix(text, sizeof(text) - 1);
+    CHECK(mat.rows == 2 && mat.cols == 3);
+    CHECK_FRAC(&mat.data[0], 1, 1);
+    CHECK_FRAC(&mat.data[1], -1, 2);
+    CHECK(mat.data[2].kind == REALNUM_FRAC && mat.data[2].value.frac.num == 1 && mat.data[2].value.frac.den == 2);
+    CHECK(mat.data[3].kind == REALNUM_APROX && test_value(&mat.data[3]) == 3.5);
+    CHECK(mat.data[4].kind == REALNUM_APROX && test_value(&mat.data[4]) == 100);
+    CHECK_FRAC(&mat.data[5], 0, 1);
+
+    size_t length = lintext_format_matrix(&mat, ',', NULL, 0);
+    char* out = malloc(length + 1);
+    lintext_format_matrix(&mat, ',', out, length + 1);
+    CHECK(strcmp(out, "1,-2/4,1/2\n3.5,100.0,0\n") == 0);
+    free(out);
+    linmatrix_free(&mat);
+}
+
+/* A token longer than a chunk goes to the stream around it, and the chunk keeps working. */
+static void test_long_token(void) {
+    size_t digits = LINTEXT_CHUNK + 4464;
+    char* text = malloc(digits + 8);
+    memset(text, '7', digits);
+    memcpy(text + digits, "/3 1/2", 7);
+    linvector vec = lintext_parse_vector(text, digits + 6);
+    CHECK(vec.size == 2 && vec.data[0].kind == REALNUM_BIGFRAC);
+    CHECK_FRAC(&vec.data[1], 1, 2);
+
+    FILE* file = tmpfile();
+    CHECK(file != NULL);
+    lintext_write_vector(&vec, ' ', file);
+    rewind(file);
+    linvector back = lintext_read_vector(file);
+    fclose(file);
+    CHECK(back.size == 2);
+    CHECK(same_realnum(&back.data[0], &vec.data[0]) && same_realnum(&back.data[1], &vec.data[1]));
+
+    // Only the length is asked for, there is no buffer to write to.
+    CHECK(lintext_format_vector(&vec, ' ', NULL, 0) == digits + 7);
+
+    linvector_free(&vec);
+    linvector_free(&back);
+    free(text);
+}
+
+int main(void) {
+    test_round_trip();
+    test_parse();
+    test_long_token();
+    printf("text_test: ok\n");
+    return 0;
+}
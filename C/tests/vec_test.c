@@ -0,0 +1,72 @@
+#include"./test.h"
+#include"../lib/vector/vec.h"
+#include<math.h>
+
+/* Not a multiple of any SIMD width, so the kernels also run their tails. */
+#define N 37
+
+static linvec3 test_vec3(size_t i) {
+    return (linvec3){ test_int(i) + 0.25, test_int(i + 1) * 0.5, test_int(i + 2) - 0.125 };
+}
+
+static bool near_vec3(linvec3 a, linvec3 b) {
+    return fabs(a.x - b.x) <= 1e-12 && fabs(a.y - b.y) <= 1e-12 && fabs(a.z - b.z) <= 1e-12;
+}
+
+static void test_single(void) {
+    linvec3 a = { 1, 2, 3 };
+    linvec3 b = { -2, 0.5, 4 };
+    linvec3 c = linvec3_cross(a, b);
+    CHECK(linvec3_dot(c, a) == 0 && linvec3_dot(c, b) == 0);
+    CHECK(near_vec3(linvec3_sub(linvec3_add(a, b), b), a));
+    CHECK(fabs(linvec3_norm(linvec3_normalize(b)) - 1) <= 1e-15);
+    CHECK(linvec2_cross((linvec2){ 1, 0 }, (linvec2){ 0, 1 }) == 1);
+    CHECK(linvec4_dot((linvec4){ 1, 2, 3, 4 }, linvec4_scale((linvec4){ 1, 1, 1, 1 }, 2)) == 20);
+
+    linvector vec = linvec3_to_linvector(a);
+    CHECK(vec.size == 3);
+    CHECK(near_vec3(linvec3_from_linvector(&vec), a));
+    linvector_free(&vec);
+}
+
+/* The batch kernels agree with the single vector operations, also in place. */
+static void test_batch(void) {
+    linvec3_batch a = linvec3_batch_with_capacity(4);
+    linvec3_batch b = linvec3_batch_zero(N);
+    for (size_t i = 0; i < N; i++) {
+        linvec3_batch_push(&a, test_vec3(i));
+        linvec3_batch_set(&b, i, test_vec3(i + 5));
+    }
+    linvec3_batch_set(&a, 3, (linvec3){ 0, 0, 0 });
+    CHECK(a.size == N && b.size == N);
+
+    double dots[N];
+    linvec3_batch dst = linvec3_batch_with_capacity(0);
+    linvec3_batch_cross(&dst, &a, &b);
+    linvec3_batch_dot(dots, &a, &b);
+    CHECK(dst.size == N);
+    for (size_t i = 0; i < N; i++) {
+        linvec3 x = linvec3_batch_get(&a, i);
+        linvec3 y = linvec3_batch_get(&b, i);
+        CHECK(near_vec3(linvec3_batch_get(&dst, i), linvec3_cross(x, y)));
+        CHECK(fabs(dots[i] - linvec3_dot(x, y)) <= 1e-12);
+    }
+
+    linvec3_batch_normalize(&a, &a);
+    for (size_t i = 0; i < N; i++) {
+        linvec3 x = linvec3_batch_get(&a, i);
+        CHECK(i == 3 ? linvec3_norm(x) == 0 : fabs(linvec3_norm(x) - 1) <= 1e-12);
+        CHECK(i == 3 || near_vec3(x, linvec3_normalize(test_vec3(i))));
+    }
+
+    linvec3_batch_free(&a);
+    linvec3_batch_free(&b);
+    linvec3_batch_free(&dst);
+}
+
+int main(void) {
+    test_single();
+    test_batch();
+    printf("vec_test: ok\n");
+    return 0;
+}
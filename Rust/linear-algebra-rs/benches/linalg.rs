@@ -0,0 +1,216 @@
+//! Benchmarks of the crate's kernels.
+//!
+//! Every benchmark repeats its operation until at least `BENCH_SECONDS` (0.2
+//! by default) have passed and prints one CSV row to stdout, in the same
+//! columns as the C `make bench`:
+//!
+//! ```text
+//! name,size,ns_per_op,gflops,bytes_per_elem
+//! ```
+//!
+//! `gflops` counts the arithmetic of the textbook algorithm, 0 for operations
+//! without arithmetic. `bytes_per_elem` is the storage the operation has to
+//! read and write, divided by the number of elements it works on. The first
+//! free argument filters the benchmarks by name.
+
+use linear_algebra_rs::batch::MatrixBatch;
+use linear_algebra_rs::eigen::{lanczos, LanczosOptions};
+use linear_algebra_rs::krylov::{Ilu0, Jacobi, KrylovSolver, Preconditioner, SolverOptions};
+use linear_algebra_rs::linnum::LinNum;
+use linear_algebra_rs::matrix::LinMatrix;
+use linear_algebra_rs::sparse::{CooMatrix, SparseFormat};
+use std::hint::black_box;
+use std::mem::size_of;
+use std::time::{Duration, Instant};
+
+struct Bench {
+    min_time: Duration,
+    filter: Option<String>,
+}
+
+impl Bench {
+    fn from_env() -> Bench {
+        let seconds = std::env::var("BENCH_SECONDS").ok().and_then(|s| s.parse().ok()).unwrap_or(0.2);
+        // `cargo bench` passes `--bench` along, the filter is the first free argument.
+        let filter = std::env::args().skip(1).find(|arg| !arg.starts_with("--"));
+        println!("name,size,ns_per_op,gflops,bytes_per_elem");
+        Bench { min_time: Duration::from_secs_f64(seconds), filter }
+    }
+
+    fn run<R>(&self, name: &str, size: usize, flops: f64, bytes: f64, elems: f64, mut op: impl FnMut() -> R) {
+        if self.filter.as_ref().is_some_and(|filter| !name.contains(filter.as_str())) {
+            return;
+        }
+        black_box(op());
+        let mut reps = 0u64;
+        let start = Instant::now();
+        while start.elapsed() < self.min_time || reps == 0 {
+            black_box(op());
+            reps += 1;
+        }
+        let ns = start.elapsed().as_secs_f64() * 1e9 / reps as f64;
+        println!("{name},{size},{ns:.1},{:.4},{:.1}", flops / ns, bytes / elems);
+    }
+}
+
+/// Deterministic values in [-1, 1).
+fn value(i: usize) -> f64 {
+    (i.wrapping_mul(2654435761) % 2048) as f64 / 1024.0 - 1.0
+}
+
+/// A diagonally dominant `n` x `n` matrix.
+fn matrix(n: usize, seed: usize) -> LinMatrix {
+    let mut m = LinMatrix::new(n, n);
+    for i in 0..n {
+        for j in 0..n {
+            let diagonal = if i == j { n as f64 } else { 0.0 };
+            m.set(i, j, LinNum::new_real(value(seed + i * n + j) + diagonal));
+        }
+    }
+    m
+}
+
+/// The 5-point Laplacian of a `side` x `side` grid.
+fn laplacian(side: usize) -> CooMatrix {
+    let n = side * side;
+    let mut coo = CooMatrix::new(n, n);
+    for i in 0..side {
+        for j in 0..side {
+            let r = i * side + j;
+            coo.push(r, r, LinNum::new_real(4.0)).unwrap();
+            if j + 1 < side {
+                coo.push(r, r + 1, LinNum::new_real(-1.0)).unwrap();
+                coo.push(r + 1, r, LinNum::new_real(-1.0)).unwrap();
+            }
+            if i + 1 < side {
+                coo.push(r, r + side, LinNum::new_real(-1.0)).unwrap();
+                coo.push(r + side, r, LinNum::new_real(-1.0)).unwrap();
+            }
+        }
+    }
+    coo
+}
+
+fn bench_scalars(bench: &Bench) {
+    const BATCH: usize = 1024;
+    let elem = size_of::<LinNum>() as f64;
+    let rationals: Vec<(LinNum, LinNum)> = (0..BATCH)
+        .map(|i| (LinNum::new_rational((i % 97) as i128 + 1, (i % 89) as i128 + 2), LinNum::new_rational((i % 83) as i128 + 1, (i % 79) as i128 + 3)))
+        .collect();
+    let reals: Vec<(LinNum, LinNum)> = (0..BATCH).map(|i| (LinNum::new_real(value(i) + 2.0), LinNum::new_real(value(i + 1) + 2.0))).collect();
+    for (kind, pairs) in [("rational", &rationals), ("real", &reals)] {
+        let n = BATCH as f64;
+        let ops: [(&str, fn(LinNum, LinNum) -> LinNum); 3] = [("add", |a, b| a + b), ("mul", |a, b| a * b), ("div", |a, b| a / b)];
+        for (op_name, op) in ops {
+            bench.run(&format!("linnum_{op_name}_{kind}"), BATCH, n, 3.0 * n * elem, n, || {
+                pairs.iter().map(|&(a, b)| op(black_box(a), b)).fold(LinNum::new_real(0.0), |_, r| black_box(r))
+            });
+        }
+    }
+}
+
+fn bench_vectors(bench: &Bench, size: usize) {
+    // Vectors are taken from matrix rows, the crate has no public vector
+    // constructor yet.
+    let mut source = LinMatrix::new(2, size);
+    for j in 0..size {
+        source.set(0, j, LinNum::new_real(value(j)));
+        source.set(1, j, LinNum::new_real(value(j + 7)));
+    }
+    let a = source.row(0).to_vector();
+    let b = source.row(1).to_vector();
+    let n = size as f64;
+    let elem = size_of::<LinNum>() as f64;
+    bench.run("linvector_dot", size, 2.0 * n, 2.0 * n * elem, n, || a.dot_product(&b));
+    bench.run("linvector_add", size, n, 3.0 * n * elem, n, || &a + &b);
+    bench.run("linvector_normalize", size, 3.0 * n, 3.0 * n * elem, n, || &a / a.norm());
+}
+
+fn bench_matrices(bench: &Bench, size: usize) {
+    let a = matrix(size, 0);
+    let b = matrix(size, 7);
+    let n = size as f64;
+    let elem = size_of::<LinNum>() as f64;
+    let lu_flops = 2.0 / 3.0 * n * n * n;
+    bench.run("linmatrix_mul", size, 2.0 * n * n * n, 3.0 * n * n * elem, n * n, || &a * &b);
+    bench.run("linmatrix_transpose", size, 0.0, 2.0 * n * n * elem, n * n, || a.transpose());
+    let mut c = a.clone();
+    bench.run("linmatrix_transpose_in_place", size, 0.0, 2.0 * n * n * elem, n * n, || c.transpose_in_place());
+    bench.run("linmatrix_lu", size, lu_flops, 2.0 * n * n * elem, n * n, || a.lu().unwrap());
+    bench.run("linmatrix_determinant", size, lu_flops, 2.0 * n * n * elem, n * n, || a.determinant().unwrap());
+    bench.run("linmatrix_qr", size, 4.0 / 3.0 * n * n * n, 2.0 * n * n * elem, n * n, || a.qr());
+    // The lower triangle of `a` mirrored is diagonally dominant, so positive definite.
+    bench.run("linmatrix_cholesky", size, n * n * n / 3.0, 2.0 * n * n * elem, n * n, || a.cholesky().unwrap());
+    let gram = (&a.transpose() * &a).unwrap();
+    bench.run("linmatrix_symmetric_eigen", size, 9.0 * n * n * n, 2.0 * n * n * elem, n * n, || gram.symmetric_eigen().unwrap());
+    // The Lanczos iteration count depends on the spectrum, its flop rate is not reported.
+    bench.run("eigen_lanczos", size, 0.0, 2.0 * n * n * elem, n * n, || lanczos(&gram, 8, LanczosOptions::default()).unwrap());
+}
+
+/// The number of matrices per batch.
+const BATCH_COUNT: usize = 4096;
+
+fn bench_batches(bench: &Bench, size: usize) {
+    let a: Vec<LinMatrix> = (0..BATCH_COUNT).map(|m| matrix(size, m * size * size)).collect();
+    let b: Vec<LinMatrix> = (0..BATCH_COUNT).map(|m| matrix(size, m * size * size + 7)).collect();
+    let batch_a = MatrixBatch::from_matrices(&a).unwrap();
+    let batch_b = MatrixBatch::from_matrices(&b).unwrap();
+    let n = size as f64;
+    let count = BATCH_COUNT as f64;
+    let elem = size_of::<f64>() as f64;
+    let lu_flops = count * 2.0 / 3.0 * n * n * n;
+    let elems = count * n * n;
+    bench.run("matrix_batch_mul", size, count * 2.0 * n * n * n, 3.0 * elems * elem, elems, || batch_a.mul(&batch_b).unwrap());
+    bench.run("matrix_batch_lu", size, lu_flops, 2.0 * elems * elem, elems, || batch_a.lu().unwrap());
+    bench.run("matrix_batch_solve", size, count * 8.0 / 3.0 * n * n * n, 4.0 * elems * elem, elems, || batch_a.solve(&batch_b).unwrap());
+    bench.run("matrix_batch_determinants", size, lu_flops, 2.0 * elems * elem, elems, || batch_a.determinants().unwrap());
+    // The same determinants one `LinMatrix` at a time, for comparison.
+    let linnum = size_of::<LinNum>() as f64;
+    bench.run("matrix_batch_determinants_each", size, lu_flops, 2.0 * elems * linnum, elems, || {
+        a.iter().map(|m| m.determinant().unwrap()).collect::<Vec<_>>()
+    });
+}
+
+fn bench_sparse(bench: &Bench, side: usize) {
+    let a = laplacian(side).to_sparse(SparseFormat::Csr);
+    let n = side * side;
+    let nnz = a.nnz() as f64;
+    let b: Vec<f64> = (0..n).map(value).collect();
+    let ilu = Ilu0::new(&a).unwrap();
+    let jacobi = Jacobi::from_sparse(&a).unwrap();
+    let mut solver = KrylovSolver::new(SolverOptions { tolerance: 1e-8, ..SolverOptions::default() });
+    let mut x = vec![0.0; n];
+    // One CSR entry is a value and a column index.
+    let entry = (size_of::<LinNum>() + size_of::<usize>()) as f64;
+    bench.run("sparse_ilu0", n, 2.0 * nnz, 2.0 * nnz * entry, nnz, || Ilu0::new(&a).unwrap());
+    // A CG iteration is a product, a preconditioner application, two dot
+    // products and three updates.
+    let mut cg = |name: &str, m: &dyn Preconditioner, apply_flops: f64| {
+        x.fill(0.0);
+        let iterations = solver.cg(&a, m, &b, &mut x).unwrap().iterations as f64;
+        let flops = iterations * (2.0 * nnz + apply_flops + 10.0 * n as f64);
+        bench.run(name, n, flops, iterations * nnz * entry, nnz, || {
+            x.fill(0.0);
+            solver.cg(&a, m, &b, &mut x).unwrap()
+        });
+    };
+    cg("krylov_cg_jacobi", &jacobi, n as f64);
+    cg("krylov_cg_ilu0", &ilu, 2.0 * nnz);
+}
+
+fn main() {
+    let bench = Bench::from_env();
+    bench_scalars(&bench);
+    for size in [16, 1024, 65536, 1048576] {
+        bench_vectors(&bench, size);
+    }
+    for size in [16, 64, 256] {
+        bench_matrices(&bench, size);
+    }
+    for size in [4, 8, 16, 32] {
+        bench_batches(&bench, size);
+    }
+    for side in [32, 128] {
+        bench_sparse(&bench, side);
+    }
+}
@@ -0,0 +1,463 @@
+//! Batches of many small matrices of the same shape.
+//!
+//! Factoring millions of 4 x 4 to 32 x 32 matrices one [`LinMatrix`] at a
+//! time spends most of its time on allocation and loop overhead. A
+//! [`MatrixBatch`] stores all of them in one buffer, interleaved
+//! [`LANES`] at a time, so every operation runs its innermost loop across
+//! the matrices of a group, which the compiler vectorizes, and splits the
+//! groups between threads. Everything runs on `f64`.
+
+use crate::gemm;
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::sparse;
+use crate::stats::{self, Kernel};
+
+/// The number of matrices interleaved element by element in one group, a
+/// multiple of the `f64` SIMD width.
+pub const LANES: usize = 8;
+
+/// `count` matrices of `rows` x `cols` in one contiguous buffer.
+///
+/// The matrices are stored in groups of [`LANES`], each group holding element
+/// `(i, j)` of all its matrices next to each other: element `(i, j)` of matrix
+/// `m` is at `((m / LANES) * rows * cols + i * cols + j) * LANES + m % LANES`.
+/// The last group is padded with zero matrices.
+#[derive(Debug, PartialEq, Clone)]
+pub struct MatrixBatch {
+    count: usize,
+    rows: usize,
+    cols: usize,
+    data: Vec<f64>,
+}
+
+/// The PLU factorizations of every matrix of a square batch, computed by
+/// [`MatrixBatch::lu`].
+#[derive(Debug, PartialEq, Clone)]
+pub struct BatchLu {
+    lu: MatrixBatch,
+    pivots: Vec<usize>,
+    singular: Vec<bool>,
+}
+
+fn groups(count: usize) -> usize {
+    (count + LANES - 1) / LANES
+}
+
+/// Factors the [`LANES`] matrices of one group of an `n` x `n` batch in
+/// place. The pivot rows differ between lanes, so only the row swaps are done
+/// lane by lane; the elimination runs across all lanes at once, with a zero
+/// multiplier for the lanes whose column has no non-zero pivot.
+fn factor_group(a: &mut [f64], pivots: &mut [usize], singular: &mut [bool], n: usize) {
+    singular.fill(false);
+    for k in 0..n {
+        let mut best = [0.0; LANES];
+        let mut pivot = [k; LANES];
+        for i in k..n {
+            for (l, &value) in a[(i * n + k) * LANES..][..LANES].iter().enumerate() {
+                if value.abs() > best[l] {
+                    best[l] = value.abs();
+                    pivot[l] = i;
+                }
+            }
+        }
+        for l in 0..LANES {
+            pivots[k * LANES + l] = pivot[l];
+            if pivot[l] != k {
+                for j in 0..n {
+                    a.swap((k * n + j) * LANES + l, (pivot[l] * n + j) * LANES + l);
+                }
+            }
+        }
+        let mut inverse = [0.0; LANES];
+        for (l, &value) in a[(k * n + k) * LANES..][..LANES].iter().enumerate() {
+            singular[l] |= value == 0.0;
+            inverse[l] = if value == 0.0 { 0.0 } else { 1.0 / value };
+        }
+        let (top, bottom) = a.split_at_mut((k + 1) * n * LANES);
+        let top = &top[k * n * LANES..];
+        for row in bottom.chunks_exact_mut(n * LANES) {
+            let (head, tail) = row.split_at_mut((k + 1) * LANES);
+            let factor = &mut head[k * LANES..];
+            for (f, inv) in factor.iter_mut().zip(&inverse) {
+                *f *= inv;
+            }
+            for (x, y) in tail.chunks_exact_mut(LANES).zip(top[(k + 1) * LANES..].chunks_exact(LANES)) {
+                for l in 0..LANES {
+                    x[l] -= factor[l] * y[l];
+                }
+            }
+        }
+    }
+}
+
+/// Subtracts `factor` times row `k` from row `i` of the block `x` of `width`
+/// columns, lane by lane.
+fn eliminate(x: &mut [f64], factor: &[f64], i: usize, k: usize, width: usize) {
+    let (src, dst) = if k < i {
+        let (top, bottom) = x.split_at_mut(i * width * LANES);
+        (&top[k * width * LANES..(k + 1) * width * LANES], &mut bottom[..width * LANES])
+    } else {
+        let (top, bottom) = x.split_at_mut(k * width * LANES);
+        (&bottom[..width * LANES], &mut top[i * width * LANES..(i + 1) * width * LANES])
+    };
+    for (d, s) in dst.chunks_exact_mut(LANES).zip(src.chunks_exact(LANES)) {
+        for l in 0..LANES {
+            d[l] -= factor[l] * s[l];
+        }
+    }
+}
+
+/// Applies the row swaps of one group to its block `x` of right-hand sides
+/// and runs forward substitution with `L` and back substitution with `U`.
+fn substitute_group(a: &[f64], pivots: &[usize], x: &mut [f64], n: usize, width: usize) {
+    for k in 0..n {
+        for l in 0..LANES {
+            let p = pivots[k * LANES + l];
+            if p != k {
+                for j in 0..width {
+                    x.swap((k * width + j) * LANES + l, (p * width + j) * LANES + l);
+                }
+            }
+        }
+    }
+    for i in 1..n {
+        for k in 0..i {
+            eliminate(x, &a[(i * n + k) * LANES..][..LANES], i, k, width);
+        }
+    }
+    for i in (0..n).rev() {
+        for k in i + 1..n {
+            eliminate(x, &a[(i * n + k) * LANES..][..LANES], i, k, width);
+        }
+        // The padding lanes hold zero matrices, whose solutions are left zero.
+        let mut inverse = [0.0; LANES];
+        for (inv, &value) in inverse.iter_mut().zip(&a[(i * n + i) * LANES..][..LANES]) {
+            *inv = if value == 0.0 { 0.0 } else { 1.0 / value };
+        }
+        for row in x[i * width * LANES..(i + 1) * width * LANES].chunks_exact_mut(LANES) {
+            for (value, inv) in row.iter_mut().zip(&inverse) {
+                *value *= inv;
+            }
+        }
+    }
+}
+
+impl MatrixBatch {
+    /// Creates a batch of `count` zero matrices of `rows` x `cols`.
+    pub fn new(count: usize, rows: usize, cols: usize) -> MatrixBatch {
+        MatrixBatch { count, rows, cols, data: vec![0.0; groups(count) * rows * cols * LANES] }
+    }
+
+    /// Creates a batch holding a copy of every given matrix.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(batch)` with the batch, empty for no matrices.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrices differ in shape.
+    pub fn from_matrices(matrices: &[LinMatrix]) -> Result<MatrixBatch, MatrixError> {
+        let (rows, cols) = matrices.first().map_or((0, 0), |a| a.dim());
+        let mut batch = MatrixBatch::new(matrices.len(), rows, cols);
+        for (m, a) in matrices.iter().enumerate() {
+            batch.set_matrix(m, a)?;
+        }
+        Ok(batch)
+    }
+
+    /// Returns the number of matrices in the batch.
+    pub fn len(&self) -> usize {
+        self.count
+    }
+
+    /// Returns whether the batch holds no matrices.
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// Returns the number of rows and columns of every matrix.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    fn index(&self, m: usize, row: usize, col: usize) -> usize {
+        assert!(m < self.count && row < self.rows && col < self.cols, "batch index out of bounds");
+        ((m / LANES) * self.rows * self.cols + row * self.cols + col) * LANES + m % LANES
+    }
+
+    /// Returns element `(row, col)` of matrix `m`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if an index is out of bounds.
+    pub fn get(&self, m: usize, row: usize, col: usize) -> f64 {
+        self.data[self.index(m, row, col)]
+    }
+
+    /// Sets element `(row, col)` of matrix `m`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if an index is out of bounds.
+    pub fn set(&mut self, m: usize, row: usize, col: usize, value: f64) {
+        let index = self.index(m, row, col);
+        self.data[index] = value;
+    }
+
+    /// Returns a copy of matrix `m`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `m` is out of bounds.
+    pub fn matrix(&self, m: usize) -> LinMatrix {
+        let mut a = LinMatrix::new(self.rows, self.cols);
+        for i in 0..self.rows {
+            for j in 0..self.cols {
+                a.data[i * self.cols + j] = LinNum::new_real(self.get(m, i, j));
+            }
+        }
+        a
+    }
+
+    /// Overwrites matrix `m` with a copy of `a`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` once copied.
+    /// - `Err(MatrixError::DimensionMismatch)` if `a` does not have the shape of the batch.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `m` is out of bounds.
+    pub fn set_matrix(&mut self, m: usize, a: &LinMatrix) -> Result<(), MatrixError> {
+        if a.dim() != self.dim() {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        for i in 0..self.rows {
+            for j in 0..self.cols {
+                self.set(m, i, j, f64::from(a.data[i * self.cols + j]));
+            }
+        }
+        Ok(())
+    }
+
+    /// Multiplies every matrix of the batch by the matrix at the same index of `other`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(product)` with the batch of products.
+    /// - `Err(MatrixError::DimensionMismatch)` if the batches differ in length
+    ///   or the columns of `self` do not match the rows of `other`.
+    pub fn mul(&self, other: &MatrixBatch) -> Result<MatrixBatch, MatrixError> {
+        if self.count != other.count || self.cols != other.rows {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let _timer = stats::time(Kernel::MatrixBatch);
+        let (m, k, n) = (self.rows, self.cols, other.cols);
+        let mut c = MatrixBatch::new(self.count, m, n);
+        if c.data.is_empty() || k == 0 {
+            return Ok(c);
+        }
+        let threads = sparse::threads_for(groups(self.count) * m * k * n * LANES);
+        let mut work: Vec<_> = c
+            .data
+            .chunks_exact_mut(m * n * LANES)
+            .zip(self.data.chunks_exact(m * k * LANES))
+            .zip(other.data.chunks_exact(k * n * LANES))
+            .collect();
+        gemm::for_each_row_block(&mut work, 1, threads, |_, block| {
+            for ((c, a), b) in block.iter_mut() {
+                for (c_row, a_row) in c.chunks_exact_mut(n * LANES).zip(a.chunks_exact(k * LANES)) {
+                    for (x, b_row) in a_row.chunks_exact(LANES).zip(b.chunks_exact(n * LANES)) {
+                        for (z, y) in c_row.chunks_exact_mut(LANES).zip(b_row.chunks_exact(LANES)) {
+                            for l in 0..LANES {
+                                z[l] += x[l] * y[l];
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        Ok(c)
+    }
+
+    /// Computes the PLU factorization of every matrix of a square batch.
+    ///
+    /// Each column of each matrix is pivoted on its entry of largest magnitude
+    /// at or below the diagonal; a column without a non-zero pivot marks its
+    /// matrix as singular and is skipped.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(lu)` with the factorizations.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrices are not square.
+    pub fn lu(&self) -> Result<BatchLu, MatrixError> {
+        if self.rows != self.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let _timer = stats::time(Kernel::MatrixBatch);
+        let n = self.rows;
+        let groups = groups(self.count);
+        let mut lu = self.clone();
+        let mut pivots = vec![0; groups * n * LANES];
+        let mut singular = vec![false; groups * LANES];
+        if n > 0 {
+            let threads = sparse::threads_for(groups * n * n * n * LANES);
+            let mut work: Vec<_> = lu
+                .data
+                .chunks_exact_mut(n * n * LANES)
+                .zip(pivots.chunks_exact_mut(n * LANES))
+                .zip(singular.chunks_exact_mut(LANES))
+                .collect();
+            gemm::for_each_row_block(&mut work, 1, threads, |_, block| {
+                for ((a, pivots), singular) in block.iter_mut() {
+                    factor_group(a, pivots, singular, n);
+                }
+            });
+        }
+        singular.truncate(self.count);
+        Ok(BatchLu { lu, pivots, singular })
+    }
+
+    /// Calculates the determinant of every matrix of a square batch through
+    /// its LU factorization.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(determinants)` with one determinant per matrix.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrices are not square.
+    pub fn determinants(&self) -> Result<Vec<f64>, MatrixError> {
+        Ok(self.lu()?.determinants())
+    }
+
+    /// Solves `A_m * X_m = B_m` for every matrix `A_m` of the batch through
+    /// their LU factorizations, see [`BatchLu::solve`].
+    pub fn solve(&self, b: &MatrixBatch) -> Result<MatrixBatch, MatrixError> {
+        self.lu()?.solve(b)
+    }
+}
+
+impl BatchLu {
+    /// Returns whether matrix `m` had a column without a non-zero pivot.
+    pub fn is_singular(&self, m: usize) -> bool {
+        self.singular[m]
+    }
+
+    /// Calculates the determinant of every factored matrix.
+    pub fn determinants(&self) -> Vec<f64> {
+        let n = self.lu.rows;
+        (0..self.lu.count)
+            .map(|m| {
+                let a = &self.lu.data[(m / LANES) * n * n * LANES + m % LANES..];
+                let pivots = &self.pivots[(m / LANES) * n * LANES + m % LANES..];
+                (0..n)
+                    .map(|k| {
+                        let diagonal = a[(k * n + k) * LANES];
+                        if pivots[k * LANES] == k { diagonal } else { -diagonal }
+                    })
+                    .product()
+            })
+            .collect()
+    }
+
+    /// Solves `A_m * X_m = B_m` for every factored matrix `A_m` and the matrix
+    /// `B_m` at the same index of `b`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(x)` with the batch of solutions.
+    /// - `Err(MatrixError::DimensionMismatch)` if `b` differs in length or does
+    ///   not have one row per row of the factored matrices.
+    /// - `Err(MatrixError::Singular)` if a factored matrix is singular.
+    pub fn solve(&self, b: &MatrixBatch) -> Result<MatrixBatch, MatrixError> {
+        let n = self.lu.rows;
+        if b.count != self.lu.count || b.rows != n {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        if self.singular.contains(&true) {
+            return Err(MatrixError::Singular);
+        }
+        let _timer = stats::time(Kernel::MatrixBatch);
+        let width = b.cols;
+        let mut x = b.clone();
+        if x.data.is_empty() {
+            return Ok(x);
+        }
+        let threads = sparse::threads_for(groups(b.count) * n * n * width * LANES);
+        let mut work: Vec<_> = x
+            .data
+            .chunks_exact_mut(n * width * LANES)
+            .zip(self.lu.data.chunks_exact(n * n * LANES))
+            .zip(self.pivots.chunks_exact(n * LANES))
+            .collect();
+        gemm::for_each_row_block(&mut work, 1, threads, |_, block| {
+            for ((x, a), pivots) in block.iter_mut() {
+                substitute_group(a, pivots, x, n, width);
+            }
+        });
+        Ok(x)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn matrices(count: usize, n: usize) -> Vec<LinMatrix> {
+        (0..count)
+            .map(|m| {
+                let data = (0..n * n)
+                    .map(|i| {
+                        let diagonal = if i % (n + 1) == 0 { n as f64 } else { 0.0 };
+                        LinNum::new_real(((i * i * 31 + i * 17 + m * 13) % 97) as f64 / 10.0 - 4.8 + diagonal)
+                    })
+                    .collect();
+                LinMatrix::from_vec(n, n, data).unwrap()
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_matches_single_matrix_operations() {
+        // Counts on both sides of a group boundary, so padding lanes are exercised.
+        for &(count, n) in &[(1, 1), (7, 3), (8, 4), (21, 9)] {
+            let a = matrices(count, n);
+            let b: Vec<LinMatrix> = matrices(count + 3, n).split_off(3);
+            let batch_a = MatrixBatch::from_matrices(&a).unwrap();
+            let batch_b = MatrixBatch::from_matrices(&b).unwrap();
+            assert_eq!(batch_a.len(), count);
+            assert_eq!(batch_a.matrix(count - 1), a[count - 1]);
+
+            let product = batch_a.mul(&batch_b).unwrap();
+            let determinants = batch_a.determinants().unwrap();
+            let solved = batch_a.solve(&batch_b).unwrap();
+            for m in 0..count {
+                let expected = (&a[m] * &b[m]).unwrap();
+                for (x, y) in product.matrix(m).data.iter().zip(&expected.data) {
+                    assert!((f64::from(*x) - f64::from(*y)).abs() < 1e-9);
+                }
+                let det = f64::from(a[m].determinant().unwrap());
+                assert!((determinants[m] - det).abs() < 1e-9 * det.abs().max(1.0));
+                let residual = (&a[m] * &solved.matrix(m)).unwrap();
+                for (x, y) in residual.data.iter().zip(&b[m].data) {
+                    assert!((f64::from(*x) - f64::from(*y)).abs() < 1e-8);
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn test_singular_and_mismatched() {
+        let mut batch = MatrixBatch::from_matrices(&[matrix![[1.0, 2.0], [2.0, 4.0]], matrix![[0.0, 1.0], [1.0, 0.0]]]).unwrap();
+        let lu = batch.lu().unwrap();
+        assert!(lu.is_singular(0));
+        assert!(!lu.is_singular(1));
+        assert_eq!(lu.determinants(), vec![0.0, -1.0]);
+        assert_eq!(lu.solve(&MatrixBatch::new(2, 2, 1)), Err(MatrixError::Singular));
+        assert_eq!(lu.solve(&MatrixBatch::new(3, 2, 1)), Err(MatrixError::DimensionMismatch));
+        assert_eq!(MatrixBatch::new(2, 2, 3).lu(), Err(MatrixError::DimensionMismatch));
+        assert_eq!(batch.set_matrix(0, &LinMatrix::new(3, 3)), Err(MatrixError::DimensionMismatch));
+        assert_eq!(MatrixBatch::from_matrices(&[LinMatrix::new(2, 2), LinMatrix::new(3, 3)]), Err(MatrixError::DimensionMismatch));
+        batch.set(0, 1, 1, 5.0);
+        assert_eq!(batch.determinants().unwrap(), vec![1.0, -1.0]);
+    }
+}
@@ -0,0 +1,539 @@
+//! Device backends for the throughput-bound kernels: dense products, sparse
+//! matrix-vector products and dot products.
+//!
+//! A [`Device`] owns buffers of `f64` in its own memory and runs the kernels
+//! on them. [`DeviceMatrix`], [`DeviceVector`] and [`DeviceSparse`] keep data
+//! resident on a device between calls, so an iteration pays for transfers only
+//! at its ends, and a [`Stream`] queues work on a thread of its own, returning
+//! a [`Pending`] result, so the host keeps working while the device does.
+//! [`LinMatrix::mul_on`] picks between the device and the host by size.
+//!
+//! The crate ships the [`Host`] backend, which runs the kernels on the host and
+//! is the fallback of every other; a GPU backend implements [`Device`] with its
+//! own buffers and launches.
+
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::Arc;
+use std::thread::{self, JoinHandle};
+
+use crate::gemm;
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::sparse::{self, SparseFormat, SparseMatrix};
+
+/// The default number of multiply-adds under which [`LinMatrix::mul_on`]
+/// keeps a product on the host: below it the transfers cost more than the
+/// device saves.
+pub const MIN_WORK: usize = 1 << 21;
+
+/// An execution backend.
+///
+/// Every kernel overwrites its output buffer, whose length matches the
+/// operation; the handles check the shapes before calling them.
+pub trait Device: Send + Sync + 'static {
+    /// A buffer of `f64` in device memory.
+    type Buffer: Send + Sync;
+    /// A buffer of indices in device memory, for sparse structure.
+    type Indices: Send + Sync;
+
+    /// Returns the name of the backend.
+    fn name(&self) -> &str;
+
+    /// Returns the number of multiply-adds under which a product should stay on the host.
+    fn min_work(&self) -> usize {
+        MIN_WORK
+    }
+
+    /// Allocates a zeroed buffer of `len` elements.
+    fn alloc(&self, len: usize) -> Self::Buffer;
+
+    /// Copies host data into a new buffer.
+    fn upload(&self, data: &[f64]) -> Self::Buffer;
+
+    /// Copies host indices into a new buffer.
+    fn upload_indices(&self, data: &[usize]) -> Self::Indices;
+
+    /// Copies a buffer back into host memory of the same length.
+    fn download(&self, buffer: &Self::Buffer, out: &mut [f64]);
+
+    /// Overwrites the row-major m x n buffer `c` with the product of the
+    /// row-major m x k buffer `a` and k x n buffer `b`.
+    fn gemm(&self, m: usize, k: usize, n: usize, a: &Self::Buffer, b: &Self::Buffer, c: &mut Self::Buffer);
+
+    /// Overwrites `y` with the product of the CSR matrix of `rows` rows and `x`.
+    fn spmv(&self, rows: usize, offsets: &Self::Indices, indices: &Self::Indices, values: &Self::Buffer, x: &Self::Buffer, y: &mut Self::Buffer);
+
+    /// Returns the dot product of two buffers of `n` elements.
+    fn dot(&self, n: usize, x: &Self::Buffer, y: &Self::Buffer) -> f64;
+}
+
+/// The built-in backend, whose buffers are host memory and whose kernels are
+/// the crate's own, split between threads for large sizes.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct Host;
+
+impl Device for Host {
+    type Buffer = Vec<f64>;
+    type Indices = Vec<usize>;
+
+    fn name(&self) -> &str {
+        "host"
+    }
+
+    fn min_work(&self) -> usize {
+        0
+    }
+
+    fn alloc(&self, len: usize) -> Vec<f64> {
+        vec![0.0; len]
+    }
+
+    fn upload(&self, data: &[f64]) -> Vec<f64> {
+        data.to_vec()
+    }
+
+    fn upload_indices(&self, data: &[usize]) -> Vec<usize> {
+        data.to_vec()
+    }
+
+    fn download(&self, buffer: &Vec<f64>, out: &mut [f64]) {
+        out.copy_from_slice(buffer);
+    }
+
+    fn gemm(&self, m: usize, k: usize, n: usize, a: &Vec<f64>, b: &Vec<f64>, c: &mut Vec<f64>) {
+        *c = gemm::multiply_f64(a, k, 1, b, n, 1, m, k, n);
+    }
+
+    fn spmv(&self, _rows: usize, offsets: &Vec<usize>, indices: &Vec<usize>, values: &Vec<f64>, x: &Vec<f64>, y: &mut Vec<f64>) {
+        let threads = sparse::threads_for(values.len());
+        gemm::for_each_row_block(y, 1, threads, |first, block| {
+            for (i, value) in block.iter_mut().enumerate() {
+                let row = first + i;
+                *value = (offsets[row]..offsets[row + 1]).map(|p| values[p] * x[indices[p]]).sum();
+            }
+        });
+    }
+
+    fn dot(&self, _n: usize, x: &Vec<f64>, y: &Vec<f64>) -> f64 {
+        x.iter().zip(y).map(|(a, b)| a * b).sum()
+    }
+}
+
+fn check_device<D: Device>(a: &Arc<D>, b: &Arc<D>) {
+    assert!(Arc::ptr_eq(a, b), "the operands must be on the same device");
+}
+
+/// A dense matrix resident in the memory of a device.
+pub struct DeviceMatrix<D: Device> {
+    device: Arc<D>,
+    rows: usize,
+    cols: usize,
+    buffer: D::Buffer,
+}
+
+impl<D: Device> DeviceMatrix<D> {
+    /// Allocates a zero `rows` x `cols` matrix on a device.
+    pub fn new(device: &Arc<D>, rows: usize, cols: usize) -> DeviceMatrix<D> {
+        DeviceMatrix { device: Arc::clone(device), rows, cols, buffer: device.alloc(rows * cols) }
+    }
+
+    /// Copies a matrix to a device.
+    pub fn upload(device: &Arc<D>, matrix: &LinMatrix) -> DeviceMatrix<D> {
+        let data: Vec<f64> = matrix.data.iter().map(|&x| f64::from(x)).collect();
+        DeviceMatrix { device: Arc::clone(device), rows: matrix.rows, cols: matrix.cols, buffer: device.upload(&data) }
+    }
+
+    /// Returns the number of rows and columns.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    /// Returns the device the matrix lives on.
+    pub fn device(&self) -> &Arc<D> {
+        &self.device
+    }
+
+    /// Copies the matrix back to the host.
+    pub fn download(&self) -> LinMatrix {
+        let mut data = vec![0.0; self.rows * self.cols];
+        self.device.download(&self.buffer, &mut data);
+        LinMatrix { rows: self.rows, cols: self.cols, data: data.into_iter().map(LinNum::new_real).collect() }
+    }
+
+    /// Overwrites `out` with `self * other` on the device.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` once multiplied.
+    /// - `Err(MatrixError::DimensionMismatch)` if the shapes do not match.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the matrices are on different devices.
+    pub fn mul_into(&self, other: &DeviceMatrix<D>, out: &mut DeviceMatrix<D>) -> Result<(), MatrixError> {
+        check_device(&self.device, &other.device);
+        check_device(&self.device, &out.device);
+        if self.cols != other.rows || out.dim() != (self.rows, other.cols) {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.device.gemm(self.rows, self.cols, other.cols, &self.buffer, &other.buffer, &mut out.buffer);
+        Ok(())
+    }
+
+    /// Multiplies two matrices on their device, see [`DeviceMatrix::mul_into`].
+    pub fn mul(&self, other: &DeviceMatrix<D>) -> Result<DeviceMatrix<D>, MatrixError> {
+        let mut out = DeviceMatrix::new(&self.device, self.rows, other.cols);
+        self.mul_into(other, &mut out)?;
+        Ok(out)
+    }
+}
+
+/// A vector resident in the memory of a device.
+pub struct DeviceVector<D: Device> {
+    device: Arc<D>,
+    len: usize,
+    buffer: D::Buffer,
+}
+
+impl<D: Device> DeviceVector<D> {
+    /// Allocates a zero vector of `len` elements on a device.
+    pub fn new(device: &Arc<D>, len: usize) -> DeviceVector<D> {
+        DeviceVector { device: Arc::clone(device), len, buffer: device.alloc(len) }
+    }
+
+    /// Copies a vector to a device.
+    pub fn upload(device: &Arc<D>, data: &[f64]) -> DeviceVector<D> {
+        DeviceVector { device: Arc::clone(device), len: data.len(), buffer: device.upload(data) }
+    }
+
+    /// Returns the number of elements.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns whether the vector has no elements.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Copies the vector back to the host.
+    pub fn download(&self) -> Vec<f64> {
+        let mut data = vec![0.0; self.len];
+        self.device.download(&self.buffer, &mut data);
+        data
+    }
+
+    /// Calculates the dot product of two vectors on their device.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(dot)` with the dot product.
+    /// - `Err(MatrixError::DimensionMismatch)` if the lengths differ.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the vectors are on different devices.
+    pub fn dot(&self, other: &DeviceVector<D>) -> Result<f64, MatrixError> {
+        check_device(&self.device, &other.device);
+        if self.len != other.len {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        Ok(self.device.dot(self.len, &self.buffer, &other.buffer))
+    }
+}
+
+/// A CSR matrix resident in the memory of a device.
+pub struct DeviceSparse<D: Device> {
+    device: Arc<D>,
+    rows: usize,
+    cols: usize,
+    offsets: D::Indices,
+    indices: D::Indices,
+    values: D::Buffer,
+}
+
+impl<D: Device> DeviceSparse<D> {
+    /// Copies a sparse matrix of either format to a device, converting it to CSR.
+    pub fn upload(device: &Arc<D>, matrix: &SparseMatrix) -> DeviceSparse<D> {
+        let converted;
+        let csr = if matrix.format == SparseFormat::Csr {
+            matrix
+        } else {
+            converted = matrix.to_format(SparseFormat::Csr);
+            &converted
+        };
+        let values: Vec<f64> = csr.values.iter().map(|&x| f64::from(x)).collect();
+        DeviceSparse {
+            device: Arc::clone(device),
+            rows: csr.rows,
+            cols: csr.cols,
+            offsets: device.upload_indices(&csr.offsets),
+            indices: device.upload_indices(&csr.indices),
+            values: device.upload(&values),
+        }
+    }
+
+    /// Returns the number of rows and columns.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    /// Overwrites `y` with `self * x` on the device.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` once multiplied.
+    /// - `Err(MatrixError::DimensionMismatch)` if the lengths do not match.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the operands are on different devices.
+    pub fn mul_vector_into(&self, x: &DeviceVector<D>, y: &mut DeviceVector<D>) -> Result<(), MatrixError> {
+        check_device(&self.device, &x.device);
+        check_device(&self.device, &y.device);
+        if x.len != self.cols || y.len != self.rows {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.device.spmv(self.rows, &self.offsets, &self.indices, &self.values, &x.buffer, &mut y.buffer);
+        Ok(())
+    }
+
+    /// Multiplies the matrix by a vector on their device, see [`DeviceSparse::mul_vector_into`].
+    pub fn mul_vector(&self, x: &DeviceVector<D>) -> Result<DeviceVector<D>, MatrixError> {
+        let mut y = DeviceVector::new(&self.device, self.rows);
+        self.mul_vector_into(x, &mut y)?;
+        Ok(y)
+    }
+}
+
+impl LinMatrix {
+    /// Copies the matrix to a device, see [`DeviceMatrix::upload`].
+    pub fn to_device<D: Device>(&self, device: &Arc<D>) -> DeviceMatrix<D> {
+        DeviceMatrix::upload(device, self)
+    }
+
+    /// Multiplies two matrices on `device`, or on the host when the product
+    /// has fewer multiply-adds than [`Device::min_work`]. On the host this is
+    /// the regular product, exact for exact operands.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(product)` with the product.
+    /// - `Err(MatrixError::DimensionMismatch)` if the shapes do not match.
+    pub fn mul_on<D: Device>(&self, other: &LinMatrix, device: &Arc<D>) -> Result<LinMatrix, MatrixError> {
+        if self.cols != other.rows || self.rows * self.cols * other.cols < device.min_work() {
+            return self * other;
+        }
+        Ok(self.to_device(device).mul(&other.to_device(device))?.download())
+    }
+}
+
+/// The result of a submission to a [`Stream`], available once the stream
+/// has run it.
+pub struct Pending<T> {
+    receiver: Receiver<T>,
+    value: Option<T>,
+}
+
+impl<T> Pending<T> {
+    /// Returns whether the result is available, without blocking.
+    pub fn is_ready(&mut self) -> bool {
+        if self.value.is_none() {
+            self.value = self.receiver.try_recv().ok();
+        }
+        self.value.is_some()
+    }
+
+    /// Blocks until the result is available and returns it.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the submission panicked.
+    pub fn wait(self) -> T {
+        match self.value {
+            Some(value) => value,
+            None => self.receiver.recv().expect("the stream submission panicked"),
+        }
+    }
+}
+
+type Job = Box<dyn FnOnce() + Send>;
+
+/// An in-order queue of device work run by a thread of its own.
+///
+/// Submissions take their operands by value or behind an [`Arc`], so they
+/// outlive the call, and run one after the other in submission order.
+/// Dropping the stream waits for the pending work.
+pub struct Stream<D: Device> {
+    device: Arc<D>,
+    sender: Option<Sender<Job>>,
+    worker: Option<JoinHandle<()>>,
+}
+
+impl<D: Device> Stream<D> {
+    /// Creates a stream for a device and starts its thread.
+    pub fn new(device: &Arc<D>) -> Stream<D> {
+        let (sender, receiver) = mpsc::channel::<Job>();
+        let worker = thread::spawn(move || {
+            for job in receiver {
+                job();
+            }
+        });
+        Stream { device: Arc::clone(device), sender: Some(sender), worker: Some(worker) }
+    }
+
+    /// Queues a call of `f` with the device of the stream.
+    pub fn submit<T, F>(&self, f: F) -> Pending<T>
+    where
+        T: Send + 'static,
+        F: FnOnce(&Arc<D>) -> T + Send + 'static,
+    {
+        let (sender, receiver) = mpsc::channel();
+        let device = Arc::clone(&self.device);
+        let job: Job = Box::new(move || {
+            // The receiver may have been dropped without waiting.
+            let _ = sender.send(f(&device));
+        });
+        self.sender.as_ref().expect("stream is running").send(job).expect("the stream thread stopped");
+        Pending { receiver, value: None }
+    }
+
+    /// Queues the upload of a host matrix.
+    pub fn upload(&self, matrix: LinMatrix) -> Pending<DeviceMatrix<D>> {
+        self.submit(move |device| DeviceMatrix::upload(device, &matrix))
+    }
+
+    /// Queues the download of a device matrix.
+    pub fn download(&self, matrix: Arc<DeviceMatrix<D>>) -> Pending<LinMatrix> {
+        self.submit(move |_| matrix.download())
+    }
+
+    /// Queues a product of device matrices, see [`DeviceMatrix::mul`].
+    pub fn mul(&self, a: Arc<DeviceMatrix<D>>, b: Arc<DeviceMatrix<D>>) -> Pending<Result<DeviceMatrix<D>, MatrixError>> {
+        self.submit(move |_| a.mul(&b))
+    }
+
+    /// Queues a sparse matrix-vector product, see [`DeviceSparse::mul_vector`].
+    pub fn mul_vector(&self, a: Arc<DeviceSparse<D>>, x: Arc<DeviceVector<D>>) -> Pending<Result<DeviceVector<D>, MatrixError>> {
+        self.submit(move |_| a.mul_vector(&x))
+    }
+
+    /// Queues a dot product, see [`DeviceVector::dot`].
+    pub fn dot(&self, x: Arc<DeviceVector<D>>, y: Arc<DeviceVector<D>>) -> Pending<Result<f64, MatrixError>> {
+        self.submit(move |_| x.dot(&y))
+    }
+}
+
+impl<D: Device> Drop for Stream<D> {
+    fn drop(&mut self) {
+        // Closing the channel ends the worker loop once the queue is drained.
+        self.sender.take();
+        if let Some(worker) = self.worker.take() {
+            let _ = worker.join();
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    /// A backend that runs on the host and counts its products, standing in for a GPU.
+    struct Counting {
+        products: AtomicUsize,
+    }
+
+    impl Device for Counting {
+        type Buffer = Vec<f64>;
+        type Indices = Vec<usize>;
+
+        fn name(&self) -> &str {
+            "counting"
+        }
+
+        fn min_work(&self) -> usize {
+            1000
+        }
+
+        fn alloc(&self, len: usize) -> Vec<f64> {
+            Host.alloc(len)
+        }
+
+        fn upload(&self, data: &[f64]) -> Vec<f64> {
+            Host.upload(data)
+        }
+
+        fn upload_indices(&self, data: &[usize]) -> Vec<usize> {
+            Host.upload_indices(data)
+        }
+
+        fn download(&self, buffer: &Vec<f64>, out: &mut [f64]) {
+            Host.download(buffer, out)
+        }
+
+        fn gemm(&self, m: usize, k: usize, n: usize, a: &Vec<f64>, b: &Vec<f64>, c: &mut Vec<f64>) {
+            self.products.fetch_add(1, Ordering::Relaxed);
+            Host.gemm(m, k, n, a, b, c)
+        }
+
+        fn spmv(&self, rows: usize, offsets: &Vec<usize>, indices: &Vec<usize>, values: &Vec<f64>, x: &Vec<f64>, y: &mut Vec<f64>) {
+            Host.spmv(rows, offsets, indices, values, x, y)
+        }
+
+        fn dot(&self, n: usize, x: &Vec<f64>, y: &Vec<f64>) -> f64 {
+            Host.dot(n, x, y)
+        }
+    }
+
+    fn matrix(rows: usize, cols: usize, seed: usize) -> LinMatrix {
+        let data = (0..rows * cols).map(|i| LinNum::new_real(((i * 7 + seed) % 11) as f64 - 5.0)).collect();
+        LinMatrix::from_vec(rows, cols, data).unwrap()
+    }
+
+    #[test]
+    fn test_resident_kernels_and_fallback() {
+        let device = Arc::new(Counting { products: AtomicUsize::new(0) });
+        let a = matrix(20, 30, 1);
+        let b = matrix(30, 10, 2);
+        let expected = (&a * &b).unwrap();
+        assert_eq!(a.to_device(&device).mul(&b.to_device(&device)).unwrap().download(), expected);
+        assert_eq!(a.mul_on(&b, &device).unwrap(), expected);
+        assert_eq!(device.products.load(Ordering::Relaxed), 2);
+        // 2 x 2 x 2 multiply-adds stay on the host.
+        let small = matrix(2, 2, 3);
+        assert_eq!(small.mul_on(&small, &device).unwrap(), (&small * &small).unwrap());
+        assert_eq!(device.products.load(Ordering::Relaxed), 2);
+        assert!(a.to_device(&device).mul(&a.to_device(&device)).is_err());
+
+        let sparse = SparseMatrix::from_dense(&a, SparseFormat::Csc);
+        let x: Vec<f64> = (0..30).map(|i| i as f64 - 10.0).collect();
+        let y = DeviceSparse::upload(&device, &sparse).mul_vector(&DeviceVector::upload(&device, &x)).unwrap().download();
+        for (i, value) in y.iter().enumerate() {
+            let row: f64 = (0..30).map(|j| f64::from(a.get(i, j)) * x[j]).sum();
+            assert_eq!(*value, row);
+        }
+        let dx = DeviceVector::upload(&device, &x);
+        assert_eq!(dx.dot(&dx).unwrap(), x.iter().map(|v| v * v).sum::<f64>());
+    }
+
+    #[test]
+    fn test_stream_runs_in_order() {
+        let device = Arc::new(Host);
+        let stream = Stream::new(&device);
+        let a = matrix(40, 40, 4);
+        let b = matrix(40, 40, 5);
+        let expected = (&(&a * &b).unwrap() * &a).unwrap();
+        let da = Arc::new(stream.upload(a).wait());
+        let db = Arc::new(stream.upload(b).wait());
+        let ab = Arc::new(stream.mul(Arc::clone(&da), db).wait().unwrap());
+        let mut pending = stream.mul(ab, da);
+        while !pending.is_ready() {
+            thread::yield_now();
+        }
+        let product = Arc::new(pending.wait().unwrap());
+        assert_eq!(stream.download(product).wait(), expected);
+        let x = Arc::new(DeviceVector::upload(&device, &[1.0, 2.0, 3.0]));
+        assert_eq!(stream.dot(Arc::clone(&x), x).wait(), Ok(14.0));
+    }
+}
@@ -0,0 +1,636 @@
+//! Eigenvalues of symmetric matrices and truncated singular value decompositions.
+//!
+//! [`LinMatrix::symmetric_eigen`] computes the whole spectrum of a dense
+//! matrix by Householder tridiagonalization and the implicit QR iteration.
+//! When only a few of the largest eigenpairs are wanted, [`lanczos`] finds them
+//! from products with any [`LinearOperator`], dense or sparse, at a small
+//! fraction of the cost. [`LinMatrix::svd`] and [`lanczos_svd`] do the same for
+//! singular values. Everything runs on `f64`.
+
+use crate::gemm;
+use crate::krylov::{LinearOperator, TransposeOperator};
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::sparse;
+use crate::stats::{self, Kernel};
+
+/// The implicit QR iteration gives up after this many steps per eigenvalue.
+/// A Wilkinson shift converges in two or three.
+const MAX_STEPS: usize = 30;
+
+/// Eigenvalues of a symmetric matrix and their unit eigenvectors.
+///
+/// The eigenvalues are sorted from largest to smallest and column `i` of
+/// [`vectors`](SymmetricEigen::vectors) belongs to eigenvalue `i`.
+#[derive(Debug, PartialEq, Clone)]
+pub struct SymmetricEigen {
+    values: Vec<f64>,
+    vectors: Vec<f64>,
+    rows: usize,
+    converged: bool,
+}
+
+impl SymmetricEigen {
+    /// Returns the eigenvalues, largest first.
+    pub fn values(&self) -> &[f64] {
+        &self.values
+    }
+
+    /// Returns the eigenvectors as the columns of a matrix.
+    pub fn vectors(&self) -> LinMatrix {
+        LinMatrix { rows: self.rows, cols: self.values.len(), data: self.vectors.iter().map(|&x| LinNum::new_real(x)).collect() }
+    }
+
+    /// Returns the eigenvector of eigenvalue `i`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `i` is out of range.
+    pub fn vector(&self, i: usize) -> Vec<f64> {
+        assert!(i < self.values.len(), "no eigenvector {}", i);
+        let k = self.values.len();
+        (0..self.rows).map(|r| self.vectors[r * k + i]).collect()
+    }
+
+    /// Returns `true` if every returned pair reached its tolerance.
+    pub fn converged(&self) -> bool {
+        self.converged
+    }
+}
+
+/// The `k` largest singular values of a matrix and their singular vectors,
+/// `A ≈ U * diag(s) * V^T`, sorted from largest to smallest.
+#[derive(Debug, PartialEq, Clone)]
+pub struct TruncatedSvd {
+    u: Vec<f64>,
+    s: Vec<f64>,
+    v: Vec<f64>,
+    rows: usize,
+    cols: usize,
+    converged: bool,
+}
+
+impl TruncatedSvd {
+    /// Returns the `rows` x `k` matrix of left singular vectors.
+    pub fn u(&self) -> LinMatrix {
+        LinMatrix { rows: self.rows, cols: self.s.len(), data: self.u.iter().map(|&x| LinNum::new_real(x)).collect() }
+    }
+
+    /// Returns the singular values, largest first.
+    pub fn singular_values(&self) -> &[f64] {
+        &self.s
+    }
+
+    /// Returns the `cols` x `k` matrix of right singular vectors.
+    pub fn v(&self) -> LinMatrix {
+        LinMatrix { rows: self.cols, cols: self.s.len(), data: self.v.iter().map(|&x| LinNum::new_real(x)).collect() }
+    }
+
+    /// Returns `true` if every returned triplet reached its tolerance.
+    pub fn converged(&self) -> bool {
+        self.converged
+    }
+}
+
+/// Stopping criteria of [`lanczos`] and [`lanczos_svd`].
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct LanczosOptions {
+    /// The iteration stops once the residual `|A x - theta x|` of each wanted
+    /// Ritz pair is below this fraction of the largest Ritz value.
+    pub tolerance: f64,
+    /// The number of steps between two convergence checks, each of which
+    /// solves the tridiagonal eigenproblem built so far.
+    pub check: usize,
+}
+
+impl Default for LanczosOptions {
+    fn default() -> LanczosOptions {
+        LanczosOptions { tolerance: 1e-10, check: 8 }
+    }
+}
+
+/// Diagonalizes the symmetric tridiagonal matrix with diagonal `d` and
+/// off-diagonal `e`, both overwritten, by implicit QR steps with Wilkinson
+/// shifts. The rotations of every step are applied to the columns of the
+/// row-major matrix `z` of `d.len()` columns, a block of rows per worker.
+/// Returns whether every eigenvalue converged.
+fn tridiagonal(d: &mut [f64], e: &mut [f64], z: &mut [f64]) -> bool {
+    let n = d.len();
+    let mut c = vec![0.0; n];
+    let mut s = vec![0.0; n];
+    let mut steps = 0;
+    let mut hi = n.saturating_sub(1);
+    while hi > 0 {
+        for i in 0..hi {
+            if e[i].abs() <= f64::EPSILON * (d[i].abs() + d[i + 1].abs()) {
+                e[i] = 0.0;
+            }
+        }
+        while hi > 0 && e[hi - 1] == 0.0 {
+            hi -= 1;
+        }
+        if hi == 0 {
+            break;
+        }
+        if steps >= MAX_STEPS * n {
+            return false;
+        }
+        steps += 1;
+        let mut lo = hi - 1;
+        while lo > 0 && e[lo - 1] != 0.0 {
+            lo -= 1;
+        }
+        // The eigenvalue of the trailing 2 x 2 block closer to d[hi].
+        let delta = (d[hi - 1] - d[hi]) / 2.0;
+        let off = e[hi - 1];
+        let root = delta.hypot(off);
+        let mu = d[hi] - off * off / (delta + if delta < 0.0 { -root } else { root });
+        // Chase the bulge of the shifted first rotation down the block.
+        let mut x = d[lo] - mu;
+        let mut y = e[lo];
+        for k in lo..hi {
+            let r = x.hypot(y);
+            let (ck, sk) = if r == 0.0 { (1.0, 0.0) } else { (x / r, y / r) };
+            if k > lo {
+                e[k - 1] = r;
+            }
+            let (dk, dk1, ek) = (d[k], d[k + 1], e[k]);
+            d[k] = ck * ck * dk + 2.0 * ck * sk * ek + sk * sk * dk1;
+            d[k + 1] = sk * sk * dk - 2.0 * ck * sk * ek + ck * ck * dk1;
+            e[k] = ck * sk * (dk1 - dk) + (ck * ck - sk * sk) * ek;
+            if k + 1 < hi {
+                x = e[k];
+                y = sk * e[k + 1];
+                e[k + 1] *= ck;
+            }
+            c[k] = ck;
+            s[k] = sk;
+        }
+        let (c, s) = (&c, &s);
+        gemm::for_each_row_block(z, n, sparse::threads_for(z.len() / n.max(1) * (hi - lo)), |_, block| {
+            for row in block.chunks_exact_mut(n) {
+                for k in lo..hi {
+                    let (a, b) = (row[k], row[k + 1]);
+                    row[k] = c[k] * a + s[k] * b;
+                    row[k + 1] = c[k] * b - s[k] * a;
+                }
+            }
+        });
+    }
+    true
+}
+
+/// Reduces the symmetric row-major `a` to tridiagonal form `Q^T A Q`, returning
+/// its diagonal, its off-diagonal and `Q`.
+fn tridiagonalize(mut a: Vec<f64>, n: usize) -> (Vec<f64>, Vec<f64>, Vec<f64>) {
+    let mut e = vec![0.0; n.saturating_sub(1)];
+    // The reflections as their first index, v with its unit leading element and tau.
+    let mut reflections: Vec<(usize, Vec<f64>, f64)> = Vec::new();
+    let mut p = vec![0.0; n];
+    for k in 0..n.saturating_sub(1) {
+        let alpha = a[(k + 1) * n + k];
+        let tail: f64 = (k + 2..n).map(|i| a[i * n + k] * a[i * n + k]).sum();
+        if tail == 0.0 {
+            e[k] = alpha;
+            continue;
+        }
+        let norm = (alpha * alpha + tail).sqrt();
+        let beta = if alpha >= 0.0 { -norm } else { norm };
+        let tau = (beta - alpha) / beta;
+        let scale = 1.0 / (alpha - beta);
+        e[k] = beta;
+        // v over the indices k + 1 onwards.
+        let v: Vec<f64> = (k + 1..n).map(|i| if i == k + 1 { 1.0 } else { a[i * n + k] * scale }).collect();
+        let threads = sparse::threads_for((n - k) * (n - k));
+        // p = tau * A22 * v, then w = p - (tau / 2) * (p^T v) * v.
+        let trailing = &a[(k + 1) * n..];
+        gemm::for_each_row_block(&mut p[k + 1..], 1, threads, |row, block| {
+            for (i, value) in block.iter_mut().enumerate() {
+                let a_row = &trailing[(row + i) * n + k + 1..(row + i + 1) * n];
+                *value = tau * a_row.iter().zip(&v).map(|(&a, &v)| a * v).sum::<f64>();
+            }
+        });
+        let pv: f64 = p[k + 1..].iter().zip(&v).map(|(&p, &v)| p * v).sum();
+        for (p, &v) in p[k + 1..].iter_mut().zip(&v) {
+            *p -= tau / 2.0 * pv * v;
+        }
+        // A22 -= v * w^T + w * v^T.
+        let w = &p[k + 1..];
+        gemm::for_each_row_block(&mut a[(k + 1) * n..], n, threads, |row, block| {
+            for (i, a_row) in block.chunks_exact_mut(n).enumerate() {
+                let (vi, wi) = (v[row + i], w[row + i]);
+                for ((a, &vj), &wj) in a_row[k + 1..].iter_mut().zip(&v).zip(w) {
+                    *a -= vi * wj + wi * vj;
+                }
+            }
+        });
+        reflections.push((k + 1, v, tau));
+    }
+    let d = (0..n).map(|i| a[i * n + i]).collect();
+    // Q = H_0 * H_1 * ..., every row of Q picking up H_k from the right on its own.
+    let mut q = vec![0.0; n * n];
+    for i in 0..n {
+        q[i * n + i] = 1.0;
+    }
+    for (start, v, tau) in &reflections {
+        let start = *start;
+        gemm::for_each_row_block(&mut q, n, sparse::threads_for(n * (n - start)), |_, block| {
+            for row in block.chunks_exact_mut(n) {
+                let dot: f64 = row[start..].iter().zip(v).map(|(&r, &v)| r * v).sum::<f64>() * tau;
+                for (r, &v) in row[start..].iter_mut().zip(v) {
+                    *r -= dot * v;
+                }
+            }
+        });
+    }
+    (d, e, q)
+}
+
+/// Returns the indices of `d` ordered by decreasing value.
+fn descending(d: &[f64]) -> Vec<usize> {
+    let mut order: Vec<usize> = (0..d.len()).collect();
+    order.sort_by(|&a, &b| d[b].total_cmp(&d[a]));
+    order
+}
+
+/// Picks the columns `order` of the row-major `z` of `n` columns.
+fn columns(z: &[f64], n: usize, order: &[usize]) -> Vec<f64> {
+    z.chunks_exact(n.max(1)).flat_map(|row| order.iter().map(move |&c| row[c])).collect()
+}
+
+impl LinMatrix {
+    /// Computes every eigenvalue and eigenvector of a symmetric matrix, see
+    /// [`SymmetricEigen`]. Only the lower triangle is read.
+    ///
+    /// The matrix is reduced to tridiagonal form by Householder reflections
+    /// and diagonalized by the implicit QR iteration with Wilkinson shifts, in
+    /// O(n³) overall. [`lanczos`] is far cheaper when only the largest few
+    /// eigenpairs are needed.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(eigen)` with the eigenpairs, largest first.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrix is not square.
+    pub fn symmetric_eigen(&self) -> Result<SymmetricEigen, MatrixError> {
+        if self.rows != self.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let _timer = stats::time(Kernel::MatrixEigen);
+        let n = self.rows;
+        let mut a = vec![0.0; n * n];
+        for i in 0..n {
+            for j in 0..=i {
+                let value = f64::from(self.data[i * n + j]);
+                a[i * n + j] = value;
+                a[j * n + i] = value;
+            }
+        }
+        let (mut d, mut e, mut q) = tridiagonalize(a, n);
+        let converged = tridiagonal(&mut d, &mut e, &mut q);
+        let order = descending(&d);
+        let vectors = columns(&q, n, &order);
+        Ok(SymmetricEigen { values: order.iter().map(|&i| d[i]).collect(), vectors, rows: n, converged })
+    }
+
+    /// Computes the `k` largest singular values of the matrix and their
+    /// singular vectors, see [`TruncatedSvd`].
+    ///
+    /// The singular values are the square roots of the eigenvalues of the
+    /// Gram matrix of the smaller side, `A^T A` or `A A^T`, formed with the
+    /// blocked product. Squaring halves the relative accuracy of singular
+    /// values much smaller than the largest.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(svd)` with the triplets, largest first.
+    /// - `Err(MatrixError::DimensionMismatch)` if `k` is larger than the smaller dimension.
+    pub fn svd(&self, k: usize) -> Result<TruncatedSvd, MatrixError> {
+        let wide = self.rows < self.cols;
+        if k > self.rows.min(self.cols) {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let a: Vec<f64> = self.data.iter().map(|&x| f64::from(x)).collect();
+        let (m, n) = (self.rows, self.cols);
+        let gram = if wide {
+            gemm::multiply_f64(&a, n, 1, &a, 1, n, m, n, m)
+        } else {
+            gemm::multiply_f64(&a, 1, n, &a, n, 1, n, m, n)
+        };
+        let side = m.min(n);
+        let full = LinMatrix { rows: side, cols: side, data: gram.into_iter().map(LinNum::new_real).collect() }.symmetric_eigen()?;
+        let order: Vec<usize> = (0..k).collect();
+        let eigen = SymmetricEigen {
+            values: full.values[..k].to_vec(),
+            vectors: columns(&full.vectors, side, &order),
+            rows: side,
+            converged: full.converged,
+        };
+        Ok(complete(self, eigen, wide))
+    }
+}
+
+/// Completes the singular triplets from the eigenpairs of the Gram matrix of
+/// the smaller side: the singular values are the square roots of the
+/// eigenvalues and every vector of the other side is the product with `A`, or
+/// `A^T`, divided by its singular value.
+fn complete<A: TransposeOperator + ?Sized>(a: &A, eigen: SymmetricEigen, wide: bool) -> TruncatedSvd {
+    let (rows, cols) = a.dim();
+    let k = eigen.values.len();
+    let large = if wide { cols } else { rows };
+    let s: Vec<f64> = eigen.values.iter().map(|&lambda| lambda.max(0.0).sqrt()).collect();
+    let mut other = vec![0.0; large * k];
+    let mut y = vec![0.0; large];
+    for c in 0..k {
+        let x = eigen.vector(c);
+        if wide {
+            a.apply_transpose(&x, &mut y);
+        } else {
+            a.apply(&x, &mut y);
+        }
+        for (i, &value) in y.iter().enumerate() {
+            other[i * k + c] = if s[c] > 0.0 { value / s[c] } else { 0.0 };
+        }
+    }
+    let (u, v) = if wide { (eigen.vectors, other) } else { (other, eigen.vectors) };
+    TruncatedSvd { u, s, v, rows, cols, converged: eigen.converged }
+}
+
+/// Deterministic values in [-1, 1) for the start vectors.
+fn start(i: usize) -> f64 {
+    (i.wrapping_mul(2654435761) % 2048) as f64 / 1024.0 - 1.0
+}
+
+fn norm(x: &[f64]) -> f64 {
+    x.iter().map(|&x| x * x).sum::<f64>().sqrt()
+}
+
+/// Removes from `w` its components along every vector of `basis`, twice so
+/// that what is left is orthogonal to working precision.
+fn orthogonalize(basis: &[Vec<f64>], w: &mut [f64]) {
+    for _ in 0..2 {
+        let h: Vec<f64> = basis.iter().map(|q| q.iter().zip(w.iter()).map(|(&q, &w)| q * w).sum()).collect();
+        for (q, &h) in basis.iter().zip(&h) {
+            for (w, &q) in w.iter_mut().zip(q) {
+                *w -= h * q;
+            }
+        }
+    }
+}
+
+/// Diagonalizes the Lanczos matrix with diagonal `alpha` and off-diagonal
+/// `beta`, returning its eigenvalues and the last `rows` rows of the matrix of
+/// its eigenvectors.
+fn ritz(alpha: &[f64], beta: &[f64], rows: usize) -> (Vec<f64>, Vec<f64>, bool) {
+    let m = alpha.len();
+    let mut d = alpha.to_vec();
+    let mut e = beta[..m - 1].to_vec();
+    let mut s = vec![0.0; rows * m];
+    for r in 0..rows {
+        s[r * m + m - rows + r] = 1.0;
+    }
+    let converged = tridiagonal(&mut d, &mut e, &mut s);
+    (d, s, converged)
+}
+
+/// The `k` largest eigenpairs of the symmetric `n` x `n` map `apply`, by
+/// Lanczos with full reorthogonalization.
+fn run_lanczos(n: usize, k: usize, options: LanczosOptions, mut apply: impl FnMut(&[f64], &mut [f64])) -> SymmetricEigen {
+    if k == 0 {
+        return SymmetricEigen { values: Vec::new(), vectors: Vec::new(), rows: n, converged: true };
+    }
+    let check = options.check.max(1);
+    let mut q0: Vec<f64> = (0..n).map(start).collect();
+    let scale0 = norm(&q0);
+    q0.iter_mut().for_each(|x| *x /= scale0);
+    let mut basis = vec![q0];
+    let mut alpha = Vec::new();
+    let mut beta = Vec::new();
+    let mut w = vec![0.0; n];
+    // A running estimate of |A|, the scale of breakdowns.
+    let mut scale: f64 = 0.0;
+    let mut seed = 0;
+    let converged = loop {
+        let j = alpha.len();
+        apply(&basis[j], &mut w);
+        alpha.push(basis[j].iter().zip(&w).map(|(&q, &w)| q * w).sum::<f64>());
+        // Orthogonalizing against the whole basis also removes alpha and beta.
+        orthogonalize(&basis, &mut w);
+        let b = norm(&w);
+        beta.push(b);
+        let m = j + 1;
+        scale = scale.max(alpha[j].abs() + b + if j > 0 { beta[j - 1] } else { 0.0 });
+        let breakdown = b <= f64::EPSILON * scale;
+        if m >= k && (m == n || breakdown || (m - k) % check == 0) {
+            // Only the last row of the eigenvectors of T is needed for the residuals.
+            let (d, s, complete) = ritz(&alpha, &beta, 1);
+            let order = descending(&d);
+            let top = d[order[0]].abs().max(d[order[m - 1]].abs());
+            // The residual of Ritz pair i is beta_j times the last element of its vector.
+            let converged = complete && order[..k].iter().all(|&i| (b * s[i]).abs() <= options.tolerance * top);
+            if converged || m == n {
+                break converged;
+            }
+        }
+        let next = if breakdown {
+            // The basis spans an invariant subspace, continue from a fresh direction.
+            beta[j] = 0.0;
+            loop {
+                seed += n;
+                let mut next: Vec<f64> = (0..n).map(|i| start(seed + i)).collect();
+                orthogonalize(&basis, &mut next);
+                let length = norm(&next);
+                if length > f64::EPSILON {
+                    next.iter_mut().for_each(|x| *x /= length);
+                    break next;
+                }
+            }
+        } else {
+            w.iter().map(|&w| w / b).collect()
+        };
+        basis.push(next);
+    };
+
+    // The Ritz vectors, Q^T * S over the wanted columns of S.
+    let m = alpha.len();
+    let (d, s, complete) = ritz(&alpha, &beta, m);
+    let order = descending(&d);
+    let mut vectors = vec![0.0; n * k];
+    for (j, q) in basis.iter().take(m).enumerate() {
+        let s_row = &s[j * m..(j + 1) * m];
+        for (i, &q) in q.iter().enumerate() {
+            for (c, &index) in order[..k].iter().enumerate() {
+                vectors[i * k + c] += q * s_row[index];
+            }
+        }
+    }
+    SymmetricEigen { values: order[..k].iter().map(|&i| d[i]).collect(), vectors, rows: n, converged: converged && complete }
+}
+
+/// Computes the `k` largest eigenvalues of a symmetric operator and their
+/// eigenvectors.
+///
+/// Runs the Lanczos iteration with full reorthogonalization from a fixed
+/// start vector, checking the Ritz pairs every `options.check` steps and
+/// stopping as soon as the `k` largest reach `options.tolerance`. Only
+/// products with `a` are needed, and for well separated eigenvalues the
+/// Krylov space stays a small multiple of `k`, so this is far cheaper than
+/// [`LinMatrix::symmetric_eigen`] when `k` is small.
+///
+/// # Returns
+///
+/// - `Ok(eigen)` with the eigenpairs, largest first.
+/// - `Err(MatrixError::DimensionMismatch)` if `a` is not square or `k` is larger than it.
+pub fn lanczos<A: LinearOperator + ?Sized>(a: &A, k: usize, options: LanczosOptions) -> Result<SymmetricEigen, MatrixError> {
+    let (rows, cols) = a.dim();
+    if rows != cols || k > rows {
+        return Err(MatrixError::DimensionMismatch);
+    }
+    let _timer = stats::time(Kernel::Lanczos);
+    Ok(run_lanczos(rows, k, options, |x, y| a.apply(x, y)))
+}
+
+/// Computes the `k` largest singular values of an operator and their singular vectors.
+///
+/// Runs [`lanczos`] on `x -> A^T (A x)`, or `A (A^T x)` when `a` has fewer
+/// rows than columns, so only products are needed.
+///
+/// # Returns
+///
+/// - `Ok(svd)` with the triplets, largest first.
+/// - `Err(MatrixError::DimensionMismatch)` if `k` is larger than the smaller dimension.
+pub fn lanczos_svd<A: TransposeOperator + ?Sized>(a: &A, k: usize, options: LanczosOptions) -> Result<TruncatedSvd, MatrixError> {
+    let (rows, cols) = a.dim();
+    let wide = rows < cols;
+    if k > rows.min(cols) {
+        return Err(MatrixError::DimensionMismatch);
+    }
+    let _timer = stats::time(Kernel::Lanczos);
+    let mut tmp = vec![0.0; rows.max(cols)];
+    let eigen = run_lanczos(rows.min(cols), k, options, |x, y| {
+        if wide {
+            a.apply_transpose(x, &mut tmp[..cols]);
+            a.apply(&tmp[..cols], y);
+        } else {
+            a.apply(x, &mut tmp[..rows]);
+            a.apply_transpose(&tmp[..rows], y);
+        }
+    });
+    Ok(complete(a, eigen, wide))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::sparse::{CooMatrix, SparseFormat, SparseMatrix};
+
+    fn symmetric(n: usize) -> LinMatrix {
+        let mut a = LinMatrix::new(n, n);
+        for i in 0..n {
+            for j in 0..=i {
+                let value = LinNum::new_real(start(i * n + j + 3));
+                a.data[i * n + j] = value;
+                a.data[j * n + i] = value;
+            }
+        }
+        a
+    }
+
+    /// The largest entry of `|A V - V diag(values)|`.
+    fn residual<A: LinearOperator>(a: &A, eigen: &SymmetricEigen) -> f64 {
+        let n = a.dim().0;
+        let mut y = vec![0.0; n];
+        let mut worst: f64 = 0.0;
+        for (c, &lambda) in eigen.values().iter().enumerate() {
+            let x = eigen.vector(c);
+            a.apply(&x, &mut y);
+            worst = y.iter().zip(&x).fold(worst, |worst, (&y, &x)| worst.max((y - lambda * x).abs()));
+        }
+        worst
+    }
+
+    #[test]
+    fn test_symmetric_eigen() {
+        for &n in &[1, 2, 24, 70] {
+            let a = symmetric(n);
+            let eigen = a.symmetric_eigen().unwrap();
+            assert!(eigen.converged());
+            assert!(eigen.values().windows(2).all(|w| w[0] >= w[1]));
+            assert!(residual(&a, &eigen) < 1e-12);
+            let v = eigen.vectors();
+            let vtv = (&v.transpose() * &v).unwrap();
+            for i in 0..n {
+                for j in 0..n {
+                    let expected = if i == j { 1.0 } else { 0.0 };
+                    assert!((f64::from(vtv.get(i, j)) - expected).abs() < 1e-12);
+                }
+            }
+        }
+        assert_eq!(LinMatrix::new(2, 3).symmetric_eigen(), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_lanczos_matches_dense() {
+        let a = symmetric(60);
+        let dense = a.symmetric_eigen().unwrap();
+        let top = lanczos(&a, 5, LanczosOptions::default()).unwrap();
+        assert!(top.converged());
+        for (x, y) in top.values().iter().zip(dense.values()) {
+            assert!((x - y).abs() < 1e-8);
+        }
+        assert!(residual(&a, &top) < 1e-8);
+        assert_eq!(lanczos(&a, 61, LanczosOptions::default()), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_lanczos_sparse() {
+        // A path Laplacian with three large, well separated diagonal entries.
+        let n = 2000;
+        let mut coo = CooMatrix::new(n, n);
+        for i in 0..n {
+            let diagonal = match i {
+                0 => 12.0,
+                500 => 11.0,
+                1000 => 10.0,
+                _ => 2.0,
+            };
+            coo.push(i, i, LinNum::new_real(diagonal)).unwrap();
+            if i > 0 {
+                coo.push(i, i - 1, LinNum::new_real(-1.0)).unwrap();
+                coo.push(i - 1, i, LinNum::new_real(-1.0)).unwrap();
+            }
+        }
+        for format in [SparseFormat::Csr, SparseFormat::Csc] {
+            let a = coo.to_sparse(format);
+            let top = lanczos(&a, 3, LanczosOptions::default()).unwrap();
+            assert!(top.converged());
+            assert!((top.values()[0] - 12.1).abs() < 1e-9);
+            assert!(residual(&a, &top) < 1e-8);
+        }
+    }
+
+    #[test]
+    fn test_svd() {
+        for &(m, n) in &[(40, 25), (25, 40)] {
+            let data = (0..m * n).map(|i| LinNum::new_real(((i * 7919) % 13) as f64 - 6.0)).collect();
+            let a = LinMatrix::from_vec(m, n, data).unwrap();
+            let dense = a.svd(4).unwrap();
+            let top = lanczos_svd(&SparseMatrix::from_dense(&a, SparseFormat::Csr), 4, LanczosOptions::default()).unwrap();
+            assert!(dense.converged() && top.converged());
+            for (x, y) in dense.singular_values().iter().zip(top.singular_values()) {
+                assert!((x - y).abs() < 1e-8 * dense.singular_values()[0]);
+            }
+            for svd in [&dense, &top] {
+                // A v = s u for every triplet.
+                let av = (&a * &svd.v()).unwrap();
+                let u = svd.u();
+                for i in 0..m {
+                    for c in 0..4 {
+                        let expected = svd.singular_values()[c] * f64::from(u.get(i, c));
+                        assert!((f64::from(av.get(i, c)) - expected).abs() < 1e-8);
+                    }
+                }
+            }
+        }
+        assert_eq!(LinMatrix::new(3, 2).svd(3), Err(MatrixError::DimensionMismatch));
+    }
+}
@@ -0,0 +1,335 @@
+//! Deferred evaluation of elementwise vector and matrix expressions.
+//!
+//! Operators on [`Lazy`] only build a tree of borrowed operands, so an
+//! expression like `(a.lazy() * s + &b - &c).eval_vector()` is computed in one
+//! fused pass over its operands when it is evaluated, without a temporary per
+//! operator. Every node is a distinct type, so the whole tree is monomorphized
+//! into a single loop.
+//!
+//! Evaluation uses plain `LinNum` arithmetic, so rational operands stay exact.
+//! Operand shapes are only compared when the expression is evaluated.
+
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::sum::Summation;
+use crate::vector::LinVector;
+use std::ops::{Add, Mul, Sub};
+
+/// An elementwise expression over row-major operands.
+pub trait LinExpr {
+    /// Returns the shape `(rows, cols)` of the result, vectors being a single
+    /// column, or `None` if the operands do not have matching shapes.
+    fn shape(&self) -> Option<(usize, usize)>;
+
+    /// Returns the element at the given row-major index.
+    fn at(&self, index: usize) -> LinNum;
+}
+
+/// Anything that can be used as an operand of a [`Lazy`] expression.
+pub trait IntoExpr {
+    type Expr: LinExpr;
+
+    fn into_expr(self) -> Self::Expr;
+}
+
+/// An unevaluated expression, see the [module documentation](self).
+#[derive(Debug, Clone, Copy)]
+pub struct Lazy<E>(E);
+
+/// The elementwise sum of two expressions.
+#[derive(Debug, Clone, Copy)]
+pub struct Sum<A, B>(A, B);
+
+/// The elementwise difference of two expressions.
+#[derive(Debug, Clone, Copy)]
+pub struct Diff<A, B>(A, B);
+
+/// An expression multiplied by a scalar.
+#[derive(Debug, Clone, Copy)]
+pub struct Scaled<A>(A, LinNum);
+
+/// Returns the shape shared by both operands, if any.
+fn joint_shape(a: &impl LinExpr, b: &impl LinExpr) -> Option<(usize, usize)> {
+    match (a.shape(), b.shape()) {
+        (Some(x), Some(y)) if x == y => Some(x),
+        _ => None,
+    }
+}
+
+impl LinExpr for &LinVector {
+    fn shape(&self) -> Option<(usize, usize)> {
+        Some((self.dim(), 1))
+    }
+
+    fn at(&self, index: usize) -> LinNum {
+        self.numbers[index]
+    }
+}
+
+impl LinExpr for &LinMatrix {
+    fn shape(&self) -> Option<(usize, usize)> {
+        Some(self.dim())
+    }
+
+    fn at(&self, index: usize) -> LinNum {
+        self.data[index]
+    }
+}
+
+impl<A: LinExpr, B: LinExpr> LinExpr for Sum<A, B> {
+    fn shape(&self) -> Option<(usize, usize)> {
+        joint_shape(&self.0, &self.1)
+    }
+
+    #[inline(always)]
+    fn at(&self, index: usize) -> LinNum {
+        self.0.at(index) + self.1.at(index)
+    }
+}
+
+impl<A: LinExpr, B: LinExpr> LinExpr for Diff<A, B> {
+    fn shape(&self) -> Option<(usize, usize)> {
+        joint_shape(&self.0, &self.1)
+    }
+
+    #[inline(always)]
+    fn at(&self, index: usize) -> LinNum {
+        self.0.at(index) - self.1.at(index)
+    }
+}
+
+impl<A: LinExpr> LinExpr for Scaled<A> {
+    fn shape(&self) -> Option<(usize, usize)> {
+        self.0.shape()
+    }
+
+    #[inline(always)]
+    fn at(&self, index: usize) -> LinNum {
+        self.0.at(index) * self.1
+    }
+}
+
+impl<E: LinExpr> LinExpr for Lazy<E> {
+    fn shape(&self) -> Option<(usize, usize)> {
+        self.0.shape()
+    }
+
+    #[inline(always)]
+    fn at(&self, index: usize) -> LinNum {
+        self.0.at(index)
+    }
+}
+
+impl<E: LinExpr> IntoExpr for Lazy<E> {
+    type Expr = E;
+
+    fn into_expr(self) -> E {
+        self.0
+    }
+}
+
+impl<'a> IntoExpr for &'a LinVector {
+    type Expr = &'a LinVector;
+
+    fn into_expr(self) -> &'a LinVector {
+        self
+    }
+}
+
+impl<'a> IntoExpr for &'a LinMatrix {
+    type Expr = &'a LinMatrix;
+
+    fn into_expr(self) -> &'a LinMatrix {
+        self
+    }
+}
+
+impl<E: LinExpr, R: IntoExpr> Add<R> for Lazy<E> {
+    type Output = Lazy<Sum<E, R::Expr>>;
+
+    fn add(self, other: R) -> Self::Output {
+        Lazy(Sum(self.0, other.into_expr()))
+    }
+}
+
+impl<E: LinExpr, R: IntoExpr> Sub<R> for Lazy<E> {
+    type Output = Lazy<Diff<E, R::Expr>>;
+
+    fn sub(self, other: R) -> Self::Output {
+        Lazy(Diff(self.0, other.into_expr()))
+    }
+}
+
+impl<E: LinExpr> Mul<LinNum> for Lazy<E> {
+    type Output = Lazy<Scaled<E>>;
+
+    fn mul(self, other: LinNum) -> Self::Output {
+        Lazy(Scaled(self.0, other))
+    }
+}
+
+impl<E: LinExpr> Mul<Lazy<E>> for LinNum {
+    type Output = Lazy<Scaled<E>>;
+
+    fn mul(self, other: Lazy<E>) -> Self::Output {
+        Lazy(Scaled(other.0, self))
+    }
+}
+
+impl<E: LinExpr> Lazy<E> {
+    /// Evaluates the expression into a new vector.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(vector)` with the result.
+    /// - `Err(MatrixError::DimensionMismatch)` if the operands do not have matching
+    ///   shapes or the result is not a single column.
+    pub fn eval_vector(self) -> Result<LinVector, MatrixError> {
+        let mut result = LinVector { numbers: Vec::new() };
+        result.assign(self)?;
+        Ok(result)
+    }
+
+    /// Evaluates the expression into a new matrix.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(matrix)` with the result.
+    /// - `Err(MatrixError::DimensionMismatch)` if the operands do not have matching shapes.
+    pub fn eval_matrix(self) -> Result<LinMatrix, MatrixError> {
+        let mut result = LinMatrix { rows: 0, cols: 0, data: Vec::new() };
+        result.assign(self)?;
+        Ok(result)
+    }
+
+    /// Computes the dot product of the expression with another operand in one
+    /// pass, without evaluating either side.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(dot)` with the sum of the elementwise products, see [`Summation`].
+    /// - `Err(MatrixError::DimensionMismatch)` if the operands do not have matching shapes.
+    pub fn dot_product<R: IntoExpr>(self, other: R) -> Result<LinNum, MatrixError> {
+        let other = other.into_expr();
+        let (rows, cols) = joint_shape(&self, &other).ok_or(MatrixError::DimensionMismatch)?;
+        Ok(Summation::default().sum((0..rows * cols).map(|i| self.at(i) * other.at(i))))
+    }
+}
+
+/// Overwrites `out` with the elements of `expr`, reusing its allocation.
+fn write_into<E: LinExpr>(out: &mut Vec<LinNum>, expr: &E, len: usize) {
+    out.clear();
+    out.extend((0..len).map(|i| expr.at(i)));
+}
+
+impl LinVector {
+    /// Starts a lazy expression over this vector, see [`Lazy`].
+    pub fn lazy(&self) -> Lazy<&LinVector> {
+        Lazy(self)
+    }
+
+    /// Evaluates an expression into this vector, reusing its storage.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the vector now holds the result.
+    /// - `Err(MatrixError::DimensionMismatch)` if the operands do not have matching
+    ///   shapes or the result is not a single column. The vector is left untouched.
+    pub fn assign<E: LinExpr>(&mut self, expr: Lazy<E>) -> Result<(), MatrixError> {
+        match expr.shape() {
+            Some((rows, 1)) => {
+                write_into(&mut self.numbers, &expr, rows);
+                Ok(())
+            }
+            _ => Err(MatrixError::DimensionMismatch),
+        }
+    }
+}
+
+impl LinMatrix {
+    /// Starts a lazy expression over this matrix, see [`Lazy`].
+    pub fn lazy(&self) -> Lazy<&LinMatrix> {
+        Lazy(self)
+    }
+
+    /// Evaluates an expression into this matrix, reusing its storage.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the matrix now holds the result.
+    /// - `Err(MatrixError::DimensionMismatch)` if the operands do not have matching
+    ///   shapes. The matrix is left untouched.
+    pub fn assign<E: LinExpr>(&mut self, expr: Lazy<E>) -> Result<(), MatrixError> {
+        let (rows, cols) = expr.shape().ok_or(MatrixError::DimensionMismatch)?;
+        write_into(&mut self.data, &expr, rows * cols);
+        self.rows = rows;
+        self.cols = cols;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{lnum, matrix};
+
+    #[test]
+    fn test_vector_chain() {
+        let a = linvector![1, 2, 3];
+        let b = linvector![4, 5, 6];
+        let c = linvector![1, 1, 1];
+        let lazy = (a.lazy() * lnum!(2.0) + &b - &c).eval_vector().unwrap();
+        let eager = ((a.clone() * lnum!(2.0)) + b.clone()) - c.clone();
+        assert_eq!(lazy, eager);
+        assert_eq!((lnum!(3.0) * b.lazy() - a.lazy()).eval_vector(), Ok(linvector![11, 13, 15]));
+    }
+
+    #[test]
+    fn test_matrix_chain() {
+        let a = matrix!([1.0, 2.0], [3.0, 4.0]);
+        let b = matrix!([0.5, 0.5], [0.5, 0.5]);
+        let expected = ((a.clone() * lnum!(2.0) + b.clone()).unwrap() - a.clone()).unwrap();
+        assert_eq!((a.lazy() * lnum!(2.0) + &b - &a).eval_matrix(), Ok(expected));
+    }
+
+    #[test]
+    fn test_assign_reuses_storage() {
+        let a = linvector![1, 2, 3];
+        let b = linvector![3, 2, 1];
+        let mut out = linvector![0, 0, 0];
+        let ptr = out.numbers.as_ptr();
+        out.assign(a.lazy() + &b).unwrap();
+        assert_eq!(out, linvector![4, 4, 4]);
+        assert_eq!(out.numbers.as_ptr(), ptr);
+    }
+
+    #[test]
+    fn test_dot_product() {
+        let a = linvector![1, 2, 3];
+        let b = linvector![4, 5, 6];
+        assert_eq!((a.lazy() + &b).dot_product(&a), Ok(lnum!(46.0)));
+        assert_eq!(a.lazy().dot_product(&b), Ok(a.dot_product(&b)));
+    }
+
+    #[test]
+    fn test_rational_stays_exact() {
+        let mut a = LinMatrix::new(1, 2);
+        a.set(0, 0, LinNum::new_rational(1, 3));
+        a.set(0, 1, LinNum::new_rational(2, 3));
+        let result = (a.lazy() * LinNum::new_rational(3, 1) - &a).eval_matrix().unwrap();
+        assert_eq!(result.get(0, 0), LinNum::new_rational(2, 3));
+        assert_eq!(result.get(0, 1), LinNum::new_rational(4, 3));
+    }
+
+    #[test]
+    fn test_dimension_mismatch() {
+        let a = linvector![1, 2, 3];
+        let b = linvector![1, 2];
+        let m = matrix!([1.0, 2.0], [3.0, 4.0]);
+        let mut out = linvector![7];
+        assert_eq!(out.assign(a.lazy() + &b), Err(MatrixError::DimensionMismatch));
+        assert_eq!(out, linvector![7]);
+        assert_eq!(m.lazy().eval_vector(), Err(MatrixError::DimensionMismatch));
+        assert_eq!(a.lazy().dot_product(&m), Err(MatrixError::DimensionMismatch));
+    }
+}
@@ -0,0 +1,449 @@
+//! Vectors and matrices whose dimensions are part of their type.
+//!
+//! [`SVector`] and [`SMatrix`] store their elements inline in arrays, so they
+//! never allocate, and every loop runs to a constant bound the compiler can
+//! unroll. Operations between mismatched shapes do not compile, so none of
+//! them return a `Result`. The dynamic [`LinVector`] and [`LinMatrix`] convert
+//! to and from them.
+
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::vector::LinVector;
+use std::array;
+use std::ops::{Add, AddAssign, Index, IndexMut, Mul, MulAssign, Neg, Sub, SubAssign};
+
+/// A vector of `N` elements stored inline.
+#[derive(Debug, PartialEq, Clone, Copy)]
+pub struct SVector<const N: usize> {
+    data: [LinNum; N],
+}
+
+/// An `R` x `C` matrix stored inline, row by row.
+#[derive(Debug, PartialEq, Clone, Copy)]
+pub struct SMatrix<const R: usize, const C: usize> {
+    data: [[LinNum; C]; R],
+}
+
+fn zero() -> LinNum {
+    LinNum::new_real(0.0)
+}
+
+impl<const N: usize> SVector<N> {
+    /// Creates a vector from its elements.
+    pub fn new(data: [LinNum; N]) -> SVector<N> {
+        SVector { data }
+    }
+
+    /// Creates a vector with all elements set to zero.
+    pub fn zero() -> SVector<N> {
+        SVector { data: [zero(); N] }
+    }
+
+    /// Returns the dimension of the vector.
+    pub const fn dim(&self) -> usize {
+        N
+    }
+
+    /// Returns the elements of the vector.
+    pub fn as_array(&self) -> &[LinNum; N] {
+        &self.data
+    }
+
+    /// Computes the dot product of this vector with another vector.
+    pub fn dot_product(&self, other: &SVector<N>) -> LinNum {
+        let mut result = zero();
+        for i in 0..N {
+            result += self.data[i] * other.data[i];
+        }
+        result
+    }
+}
+
+impl SVector<3> {
+    /// Computes the cross product of this vector with another vector.
+    pub fn cross_product(&self, other: &SVector<3>) -> SVector<3> {
+        let [a0, a1, a2] = self.data;
+        let [b0, b1, b2] = other.data;
+        SVector::new([a1 * b2 - a2 * b1, a2 * b0 - a0 * b2, a0 * b1 - a1 * b0])
+    }
+}
+
+impl<const R: usize, const C: usize> SMatrix<R, C> {
+    /// Creates a matrix from its rows.
+    pub fn new(data: [[LinNum; C]; R]) -> SMatrix<R, C> {
+        SMatrix { data }
+    }
+
+    /// Creates a matrix with all elements set to zero.
+    pub fn zero() -> SMatrix<R, C> {
+        SMatrix { data: [[zero(); C]; R] }
+    }
+
+    /// Returns the dimensions of the matrix as a tuple `(rows, cols)`.
+    pub const fn dim(&self) -> (usize, usize) {
+        (R, C)
+    }
+
+    /// Returns the rows of the matrix.
+    pub fn as_array(&self) -> &[[LinNum; C]; R] {
+        &self.data
+    }
+
+    /// Returns the transpose of the matrix.
+    pub fn transpose(&self) -> SMatrix<C, R> {
+        SMatrix { data: array::from_fn(|j| array::from_fn(|i| self.data[i][j])) }
+    }
+}
+
+impl<const N: usize> SMatrix<N, N> {
+    /// Creates the `N` x `N` identity matrix.
+    pub fn identity() -> SMatrix<N, N> {
+        let mut result = SMatrix::zero();
+        for i in 0..N {
+            result.data[i][i] = LinNum::new_real(1.0);
+        }
+        result
+    }
+
+    /// Calculates the determinant of the matrix, see [`LinMatrix::determinant`].
+    ///
+    /// Larger matrices are eliminated with partial pivoting like
+    /// [`LuDecomposition::new`](crate::lu::LuDecomposition::new), in a copy of
+    /// the array rather than on the heap.
+    pub fn determinant(&self) -> LinNum {
+        match N {
+            1 => self.data[0][0],
+            2 => self.data[0][0] * self.data[1][1] - self.data[0][1] * self.data[1][0],
+            _ => {
+                let mut a = self.data;
+                let mut odd = false;
+                for k in 0..N {
+                    let mut pivot_row = k;
+                    let mut pivot_abs = f64::from(a[k][k]).abs();
+                    for i in k + 1..N {
+                        let abs = f64::from(a[i][k]).abs();
+                        if abs > pivot_abs {
+                            pivot_row = i;
+                            pivot_abs = abs;
+                        }
+                    }
+                    if pivot_abs == 0.0 {
+                        continue;
+                    }
+                    if pivot_row != k {
+                        a.swap(k, pivot_row);
+                        odd = !odd;
+                    }
+                    let pivot = a[k][k];
+                    for i in k + 1..N {
+                        let factor = a[i][k] / pivot;
+                        if f64::from(factor) == 0.0 {
+                            continue;
+                        }
+                        for j in k + 1..N {
+                            a[i][j] -= factor * a[k][j];
+                        }
+                    }
+                }
+                let mut det = LinNum::new_rational(if odd { -1 } else { 1 }, 1);
+                for k in 0..N {
+                    det *= a[k][k];
+                }
+                det
+            }
+        }
+    }
+}
+
+impl<const N: usize> Index<usize> for SVector<N> {
+    type Output = LinNum;
+
+    fn index(&self, index: usize) -> &LinNum {
+        &self.data[index]
+    }
+}
+
+impl<const N: usize> IndexMut<usize> for SVector<N> {
+    fn index_mut(&mut self, index: usize) -> &mut LinNum {
+        &mut self.data[index]
+    }
+}
+
+impl<const R: usize, const C: usize> Index<(usize, usize)> for SMatrix<R, C> {
+    type Output = LinNum;
+
+    fn index(&self, (row, col): (usize, usize)) -> &LinNum {
+        &self.data[row][col]
+    }
+}
+
+impl<const R: usize, const C: usize> IndexMut<(usize, usize)> for SMatrix<R, C> {
+    fn index_mut(&mut self, (row, col): (usize, usize)) -> &mut LinNum {
+        &mut self.data[row][col]
+    }
+}
+
+impl<const N: usize> Add for SVector<N> {
+    type Output = SVector<N>;
+
+    fn add(mut self, other: SVector<N>) -> SVector<N> {
+        self += other;
+        self
+    }
+}
+
+impl<const N: usize> AddAssign for SVector<N> {
+    fn add_assign(&mut self, other: SVector<N>) {
+        for i in 0..N {
+            self.data[i] += other.data[i];
+        }
+    }
+}
+
+impl<const N: usize> Sub for SVector<N> {
+    type Output = SVector<N>;
+
+    fn sub(mut self, other: SVector<N>) -> SVector<N> {
+        self -= other;
+        self
+    }
+}
+
+impl<const N: usize> SubAssign for SVector<N> {
+    fn sub_assign(&mut self, other: SVector<N>) {
+        for i in 0..N {
+            self.data[i] -= other.data[i];
+        }
+    }
+}
+
+impl<const N: usize> Mul<LinNum> for SVector<N> {
+    type Output = SVector<N>;
+
+    fn mul(mut self, other: LinNum) -> SVector<N> {
+        self *= other;
+        self
+    }
+}
+
+impl<const N: usize> MulAssign<LinNum> for SVector<N> {
+    fn mul_assign(&mut self, other: LinNum) {
+        for x in self.data.iter_mut() {
+            *x *= other;
+        }
+    }
+}
+
+impl<const N: usize> Neg for SVector<N> {
+    type Output = SVector<N>;
+
+    fn neg(self) -> SVector<N> {
+        self * LinNum::new_real(-1.0)
+    }
+}
+
+impl<const R: usize, const C: usize> Add for SMatrix<R, C> {
+    type Output = SMatrix<R, C>;
+
+    fn add(mut self, other: SMatrix<R, C>) -> SMatrix<R, C> {
+        self += other;
+        self
+    }
+}
+
+impl<const R: usize, const C: usize> AddAssign for SMatrix<R, C> {
+    fn add_assign(&mut self, other: SMatrix<R, C>) {
+        for i in 0..R {
+            for j in 0..C {
+                self.data[i][j] += other.data[i][j];
+            }
+        }
+    }
+}
+
+impl<const R: usize, const C: usize> Sub for SMatrix<R, C> {
+    type Output = SMatrix<R, C>;
+
+    fn sub(mut self, other: SMatrix<R, C>) -> SMatrix<R, C> {
+        self -= other;
+        self
+    }
+}
+
+impl<const R: usize, const C: usize> SubAssign for SMatrix<R, C> {
+    fn sub_assign(&mut self, other: SMatrix<R, C>) {
+        for i in 0..R {
+            for j in 0..C {
+                self.data[i][j] -= other.data[i][j];
+            }
+        }
+    }
+}
+
+impl<const R: usize, const C: usize> Mul<LinNum> for SMatrix<R, C> {
+    type Output = SMatrix<R, C>;
+
+    fn mul(mut self, other: LinNum) -> SMatrix<R, C> {
+        self *= other;
+        self
+    }
+}
+
+impl<const R: usize, const C: usize> MulAssign<LinNum> for SMatrix<R, C> {
+    fn mul_assign(&mut self, other: LinNum) {
+        for row in self.data.iter_mut() {
+            for x in row.iter_mut() {
+                *x *= other;
+            }
+        }
+    }
+}
+
+impl<const R: usize, const C: usize, const K: usize> Mul<SMatrix<C, K>> for SMatrix<R, C> {
+    type Output = SMatrix<R, K>;
+
+    fn mul(self, other: SMatrix<C, K>) -> SMatrix<R, K> {
+        let mut result = SMatrix::zero();
+        for i in 0..R {
+            for k in 0..C {
+                let a = self.data[i][k];
+                for j in 0..K {
+                    result.data[i][j] += a * other.data[k][j];
+                }
+            }
+        }
+        result
+    }
+}
+
+impl<const R: usize, const C: usize> Mul<SVector<C>> for SMatrix<R, C> {
+    type Output = SVector<R>;
+
+    fn mul(self, other: SVector<C>) -> SVector<R> {
+        SVector { data: array::from_fn(|i| SVector::new(self.data[i]).dot_product(&other)) }
+    }
+}
+
+impl<const N: usize> From<SVector<N>> for LinVector {
+    fn from(vector: SVector<N>) -> LinVector {
+        LinVector { numbers: vector.data.to_vec() }
+    }
+}
+
+impl<const N: usize> TryFrom<&LinVector> for SVector<N> {
+    type Error = MatrixError;
+
+    fn try_from(vector: &LinVector) -> Result<SVector<N>, MatrixError> {
+        let data = vector.numbers.as_slice().try_into().map_err(|_| MatrixError::DimensionMismatch)?;
+        Ok(SVector { data })
+    }
+}
+
+impl LinMatrix {
+    /// Copies a fixed-size matrix into a dynamic one.
+    ///
+    /// This is the `From<SMatrix<R, C>>` conversion, spelled out because the
+    /// inherent [`LinMatrix::from`] shadows `From::from`.
+    pub fn from_fixed<const R: usize, const C: usize>(matrix: SMatrix<R, C>) -> LinMatrix {
+        LinMatrix { rows: R, cols: C, data: matrix.data.iter().flatten().copied().collect() }
+    }
+}
+
+impl<const R: usize, const C: usize> From<SMatrix<R, C>> for LinMatrix {
+    fn from(matrix: SMatrix<R, C>) -> LinMatrix {
+        LinMatrix::from_fixed(matrix)
+    }
+}
+
+impl<const R: usize, const C: usize> TryFrom<&LinMatrix> for SMatrix<R, C> {
+    type Error = MatrixError;
+
+    fn try_from(matrix: &LinMatrix) -> Result<SMatrix<R, C>, MatrixError> {
+        if matrix.dim() != (R, C) {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        Ok(SMatrix { data: array::from_fn(|i| array::from_fn(|j| matrix.data[i * C + j])) })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{lnum, matrix};
+
+    fn svec<const N: usize>(values: [f64; N]) -> SVector<N> {
+        SVector::new(values.map(LinNum::new_real))
+    }
+
+    #[test]
+    fn test_vector_ops() {
+        let a = svec([1.0, 2.0, 3.0]);
+        let b = svec([4.0, 5.0, 6.0]);
+        assert_eq!(a + b, svec([5.0, 7.0, 9.0]));
+        assert_eq!(b - a, svec([3.0, 3.0, 3.0]));
+        assert_eq!(a * lnum!(2.0), svec([2.0, 4.0, 6.0]));
+        assert_eq!(-a, svec([-1.0, -2.0, -3.0]));
+        assert_eq!(a.dot_product(&b), lnum!(32.0));
+        assert_eq!(a.cross_product(&b), svec([-3.0, 6.0, -3.0]));
+        assert_eq!(a.dim(), 3);
+    }
+
+    #[test]
+    fn test_matrix_mul() {
+        let a = SMatrix::new([[1.0, 2.0, 3.0], [4.0, 5.0, 6.0]].map(|row| row.map(LinNum::new_real)));
+        let b = a.transpose();
+        let product: SMatrix<2, 2> = a * b;
+        let expected = (LinMatrix::from_fixed(a) * LinMatrix::from_fixed(b)).unwrap();
+        assert_eq!(LinMatrix::from_fixed(product), expected);
+        assert_eq!(a * svec([1.0, 0.0, -1.0]), svec([-2.0, -2.0]));
+        assert_eq!(SMatrix::<3, 3>::identity() * b, b);
+    }
+
+    #[test]
+    fn test_transform_pipeline() {
+        // Translate by (1, 2, 3) in homogeneous coordinates, then scale by 2.
+        let mut translate = SMatrix::<4, 4>::identity();
+        translate[(0, 3)] = lnum!(1.0);
+        translate[(1, 3)] = lnum!(2.0);
+        translate[(2, 3)] = lnum!(3.0);
+        let mut scale = SMatrix::<4, 4>::identity() * lnum!(2.0);
+        scale[(3, 3)] = lnum!(1.0);
+        let point = svec([1.0, 1.0, 1.0, 1.0]);
+        assert_eq!((scale * translate) * point, svec([4.0, 6.0, 8.0, 1.0]));
+        assert_eq!((scale * translate).determinant(), lnum!(8.0));
+    }
+
+    #[test]
+    fn test_determinant_elimination() {
+        // Needs row swaps, and the exact result matches the dynamic LU.
+        let exact = SMatrix::new([[0, 2, 1], [3, -1, 4], [1, 5, 9]].map(|row| row.map(|x| LinNum::new_rational(x, 1))));
+        assert_eq!(exact.determinant(), LinMatrix::from_fixed(exact).determinant().unwrap());
+        assert_eq!(exact.determinant(), LinNum::new_rational(-30, 1));
+
+        let mut real = SMatrix::<5, 5>::identity() * lnum!(3.0);
+        real[(0, 4)] = lnum!(-1.5);
+        real[(3, 1)] = lnum!(2.0);
+        real[(4, 0)] = lnum!(7.0);
+        assert_eq!(real.determinant(), LinMatrix::from_fixed(real).determinant().unwrap());
+
+        let mut singular = exact;
+        singular[(2, 0)] = LinNum::new_rational(3, 1);
+        singular[(2, 1)] = LinNum::new_rational(-1, 1);
+        singular[(2, 2)] = LinNum::new_rational(4, 1);
+        assert_eq!(f64::from(singular.determinant()), 0.0);
+    }
+
+    #[test]
+    fn test_conversions() {
+        let dynamic = matrix!([1.0, 2.0], [3.0, 4.0]);
+        let fixed = SMatrix::<2, 2>::try_from(&dynamic).unwrap();
+        assert_eq!(fixed.determinant(), dynamic.determinant().unwrap());
+        assert_eq!(LinMatrix::from_fixed(fixed), dynamic);
+        assert_eq!(SMatrix::<2, 3>::try_from(&dynamic), Err(MatrixError::DimensionMismatch));
+
+        let vector = linvector![1, 2, 3];
+        let fixed = SVector::<3>::try_from(&vector).unwrap();
+        assert_eq!(LinVector::from(fixed), vector);
+        assert_eq!(SVector::<2>::try_from(&vector), Err(MatrixError::DimensionMismatch));
+    }
+}
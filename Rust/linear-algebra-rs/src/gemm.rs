@@ -0,0 +1,278 @@
+//! Blocked, multithreaded matrix multiplication behind `Mul<LinMatrix> for LinMatrix`.
+//!
+//! `C` is split into blocks of `MC` rows that worker threads claim one at a
+//! time from a shared queue, so a thread that finishes early picks up the
+//! remaining blocks instead of idling. Matrices made only of real numbers are
+//! multiplied as plain `f64` with packed panels and a register-blocked
+//! micro-kernel; anything else goes through `LinNum` arithmetic against a
+//! transposed copy of `B`, so both operands are read contiguously.
+//!
+//! Operands are strided [`MatrixView`]s, so transposes and sub-blocks are
+//! consumed by the packing routines directly instead of being copied first.
+
+use crate::linnum::LinNum;
+use crate::matrix::LinMatrix;
+use crate::stats::{self, Counter, Kernel};
+use crate::view::MatrixView;
+use std::sync::Mutex;
+use std::thread;
+
+/// Rows of `C` per scheduled block.
+const MC: usize = 64;
+/// Depth of a packed block along the shared dimension.
+const KC: usize = 256;
+/// Rows of the micro-kernel tile.
+const MR: usize = 4;
+/// Columns of the micro-kernel tile.
+const NR: usize = 8;
+/// Products with fewer multiply-adds than this stay on the calling thread.
+pub(crate) const PARALLEL_THRESHOLD: usize = 1 << 18;
+
+/// Multiplies `a` by `b`, which must already have matching inner dimensions.
+pub(crate) fn multiply(a: &LinMatrix, b: &LinMatrix) -> LinMatrix {
+    multiply_views(a.view(), b.view())
+}
+
+/// Multiplies two views, which must already have matching inner dimensions.
+pub(crate) fn multiply_views(a: MatrixView, b: MatrixView) -> LinMatrix {
+    let _timer = stats::time(Kernel::MatrixMul);
+    stats::record(Counter::MatrixAlloc, a.rows * b.cols * std::mem::size_of::<LinNum>());
+    let work = a.rows * a.cols * b.cols;
+    let threads = if work < PARALLEL_THRESHOLD {
+        1
+    } else {
+        thread::available_parallelism().map_or(1, |n| n.get())
+    };
+    multiply_with_threads(a, b, threads)
+}
+
+fn multiply_with_threads(a: MatrixView, b: MatrixView, threads: usize) -> LinMatrix {
+    let (m, k, n) = (a.rows, a.cols, b.cols);
+    if let (Some((a64, ars, acs)), Some((b64, brs, bcs))) = (a.to_f64(), b.to_f64()) {
+        let packed = pack_b(&b64, brs, bcs, k, n);
+        let mut c = vec![0.0; m * n];
+        for_each_row_block(&mut c, n, threads, |row, block| {
+            multiply_block_f64(&a64, ars, acs, &packed, row, block, k, n);
+        });
+        return LinMatrix { rows: m, cols: n, data: c.into_iter().map(LinNum::new_real).collect() };
+    }
+
+    // Rows of A against rows of B^T, both contiguous.
+    let a_rows = a.row_major();
+    let bt = b.t().row_major();
+    let mut c = vec![LinNum::new_real(0.0); m * n];
+    for_each_row_block(&mut c, n, threads, |row, block| {
+        for (i, c_row) in block.chunks_exact_mut(n).enumerate() {
+            let a_row = &a_rows[(row + i) * k..(row + i + 1) * k];
+            for (value, b_col) in c_row.iter_mut().zip(bt.chunks_exact(k)) {
+                for (&x, &y) in a_row.iter().zip(b_col) {
+                    *value += x * y;
+                }
+            }
+        }
+    });
+    LinMatrix { rows: m, cols: n, data: c }
+}
+
+/// Multiplies the m x k matrix `a` by the k x n matrix `b`, plain `f64`s with
+/// element `(i, p)` of `a` at `i * ars + p * acs` and likewise for `b`, into a
+/// new row-major m x n buffer. This is the kernel of the blocked factorizations.
+#[allow(clippy::too_many_arguments)]
+pub(crate) fn multiply_f64(a: &[f64], ars: usize, acs: usize, b: &[f64], brs: usize, bcs: usize, m: usize, k: usize, n: usize) -> Vec<f64> {
+    let _timer = stats::time(Kernel::MatrixMul);
+    let mut c = vec![0.0; m * n];
+    if m == 0 || n == 0 || k == 0 {
+        return c;
+    }
+    let threads = if m * k * n < PARALLEL_THRESHOLD {
+        1
+    } else {
+        thread::available_parallelism().map_or(1, |n| n.get())
+    };
+    let packed = pack_b(b, brs, bcs, k, n);
+    for_each_row_block(&mut c, n, threads, |row, block| {
+        multiply_block_f64(a, ars, acs, &packed, row, block, k, n);
+    });
+    c
+}
+
+/// Hands out blocks of `MC` rows of `c` to up to `threads` workers, calling
+/// `f(first_row, block)` once per block.
+pub(crate) fn for_each_row_block<T, F>(c: &mut [T], row_len: usize, threads: usize, f: F)
+where
+    T: Send,
+    F: Fn(usize, &mut [T]) + Sync,
+{
+    if row_len == 0 || c.is_empty() {
+        return;
+    }
+    let block_len = MC * row_len;
+    let blocks = (c.len() + block_len - 1) / block_len;
+    let threads = threads.clamp(1, blocks);
+    if threads == 1 {
+        for (index, block) in c.chunks_mut(block_len).enumerate() {
+            f(index * MC, block);
+        }
+        return;
+    }
+    let queue = Mutex::new(c.chunks_mut(block_len).enumerate());
+    thread::scope(|scope| {
+        for _ in 0..threads {
+            scope.spawn(|| loop {
+                let next = queue.lock().unwrap().next();
+                match next {
+                    Some((index, block)) => f(index * MC, block),
+                    None => break,
+                }
+            });
+        }
+    });
+}
+
+/// Packs the k x n matrix `b`, with element `(p, j)` at `p * rs + j * cs`, into
+/// column panels of `NR`, one run of `KC` rows at a time, zero padding the last
+/// panel. The panel for rows starting at `pc` and columns starting at `jr`
+/// begins at `pc * panels * NR + jr * kc`.
+fn pack_b(b: &[f64], rs: usize, cs: usize, k: usize, n: usize) -> Vec<f64> {
+    let panels = (n + NR - 1) / NR;
+    let mut packed = vec![0.0; k * panels * NR];
+    let mut offset = 0;
+    for pc in (0..k).step_by(KC) {
+        let kc = KC.min(k - pc);
+        for jr in (0..n).step_by(NR) {
+            let nr = NR.min(n - jr);
+            for p in 0..kc {
+                let panel = &mut packed[offset + p * NR..offset + p * NR + nr];
+                for (j, value) in panel.iter_mut().enumerate() {
+                    *value = b[(pc + p) * rs + (jr + j) * cs];
+                }
+            }
+            offset += kc * NR;
+        }
+    }
+    packed
+}
+
+/// Computes the rows of `C` starting at `row` into `c`, a block of whole rows.
+/// Element `(i, p)` of `A` is `a[i * rs + p * cs]`.
+#[allow(clippy::too_many_arguments)]
+fn multiply_block_f64(a: &[f64], rs: usize, cs: usize, packed: &[f64], row: usize, c: &mut [f64], k: usize, n: usize) {
+    let mc = c.len() / n;
+    let panels = (n + NR - 1) / NR;
+    let mut pack_a = vec![0.0; MC * KC];
+    for pc in (0..k).step_by(KC) {
+        let kc = KC.min(k - pc);
+        // Pack the block of A into panels of MR rows, MR values per column.
+        for ir in (0..mc).step_by(MR) {
+            let mr = MR.min(mc - ir);
+            let panel = &mut pack_a[ir * kc..(ir + MR) * kc];
+            for p in 0..kc {
+                for i in 0..MR {
+                    panel[p * MR + i] = if i < mr { a[(row + ir + i) * rs + (pc + p) * cs] } else { 0.0 };
+                }
+            }
+        }
+        for jr in (0..n).step_by(NR) {
+            let nr = NR.min(n - jr);
+            let pb = &packed[pc * panels * NR + (jr / NR) * kc * NR..][..kc * NR];
+            for ir in (0..mc).step_by(MR) {
+                let mr = MR.min(mc - ir);
+                micro_kernel(kc, &pack_a[ir * kc..(ir + MR) * kc], pb, &mut c[ir * n + jr..], n, mr, nr);
+            }
+        }
+    }
+}
+
+/// Accumulates the `mr` x `nr` tile `c += pa * pb` in registers.
+fn micro_kernel(kc: usize, pa: &[f64], pb: &[f64], c: &mut [f64], ldc: usize, mr: usize, nr: usize) {
+    let mut acc = [[0.0; NR]; MR];
+    for (a, b) in pa.chunks_exact(MR).zip(pb.chunks_exact(NR)).take(kc) {
+        for i in 0..MR {
+            for j in 0..NR {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+    for i in 0..mr {
+        for j in 0..nr {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn naive(a: &LinMatrix, b: &LinMatrix) -> LinMatrix {
+        let mut c = LinMatrix::new(a.rows, b.cols);
+        for i in 0..a.rows {
+            for j in 0..b.cols {
+                let mut sum = LinNum::new_real(0.0);
+                for k in 0..a.cols {
+                    sum += a.get(i, k) * b.get(k, j);
+                }
+                c.set(i, j, sum);
+            }
+        }
+        c
+    }
+
+    fn filled(rows: usize, cols: usize, seed: usize, rational: bool) -> LinMatrix {
+        let mut matrix = LinMatrix::new(rows, cols);
+        for i in 0..rows {
+            for j in 0..cols {
+                let v = ((i * 31 + j * 17 + seed) % 23) as i128 - 11;
+                let value = if rational { LinNum::new_rational(v, 3) } else { LinNum::new_real(v as f64 / 4.0) };
+                matrix.set(i, j, value);
+            }
+        }
+        matrix
+    }
+
+    #[test]
+    fn test_f64_matches_naive() {
+        for &(m, k, n) in &[(1, 1, 1), (5, 3, 7), (67, 300, 13), (130, 9, 70)] {
+            let a = filled(m, k, 1, false);
+            let b = filled(k, n, 2, false);
+            for threads in [1, 3] {
+                assert_eq!(multiply_with_threads(a.view(), b.view(), threads), naive(&a, &b));
+            }
+        }
+    }
+
+    #[test]
+    fn test_mixed_matches_naive() {
+        let a = filled(70, 12, 3, true);
+        let b = filled(12, 9, 4, false);
+        for threads in [1, 4] {
+            assert_eq!(multiply_with_threads(a.view(), b.view(), threads), naive(&a, &b));
+        }
+    }
+
+    #[test]
+    fn test_transposed_views() {
+        for rational in [false, true] {
+            let a = filled(13, 70, 5, rational);
+            let b = filled(13, 9, 6, false);
+            let expected = naive(&a.transpose(), &b);
+            assert_eq!(multiply_views(a.view().t(), b.view()), expected);
+            let expected = naive(&b.transpose(), &a);
+            assert_eq!(multiply_views(b.view().t(), a.view()), expected);
+            let c = filled(70, 9, 7, rational);
+            assert_eq!(multiply_views(b.view(), c.view().t()), naive(&b, &c.transpose()));
+            let d = filled(9, 13, 8, rational);
+            assert_eq!(multiply_views(a.view().t(), d.view().t()), naive(&a.transpose(), &d.transpose()));
+        }
+    }
+
+    #[test]
+    fn test_empty() {
+        let a = LinMatrix::new(0, 3);
+        let b = LinMatrix::new(3, 4);
+        assert_eq!(multiply(&a, &b).dim(), (0, 4));
+        let a = LinMatrix::new(2, 0);
+        let b = LinMatrix::new(0, 2);
+        assert_eq!(multiply(&a, &b), LinMatrix::new(2, 2));
+    }
+}
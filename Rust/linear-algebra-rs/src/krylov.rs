@@ -0,0 +1,771 @@
+//! Iterative Krylov solvers for `A x = b`.
+//!
+//! The solvers only need products `A v`, so `A` is any [`LinearOperator`]: a
+//! dense [`LinMatrix`], a [`SparseMatrix`] or a user callback wrapped in a
+//! [`FnOperator`]. Convergence is accelerated by a [`Preconditioner`], either
+//! [`Jacobi`] or an incomplete factorization [`Ilu0`]. The iterations run on
+//! `f64` and a [`KrylovSolver`] keeps its work vectors between solves, so
+//! repeated solves of the same size do not allocate.
+
+use crate::gemm;
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::sparse::{self, SparseFormat, SparseMatrix};
+use crate::stats::{self, Kernel};
+
+/// A linear map that can be applied to `f64` vectors.
+pub trait LinearOperator {
+    /// Returns the dimensions of the operator as a tuple `(rows, cols)`.
+    fn dim(&self) -> (usize, usize);
+
+    /// Overwrites `y`, with one element per row, with the product `A x`.
+    fn apply(&self, x: &[f64], y: &mut [f64]);
+}
+
+/// A [`LinearOperator`] that can also be applied transposed, as the singular
+/// value solvers need.
+pub trait TransposeOperator: LinearOperator {
+    /// Overwrites `y`, with one element per column, with the product `A^T x`.
+    fn apply_transpose(&self, x: &[f64], y: &mut [f64]);
+}
+
+/// An approximation of `A^{-1}` that is cheap to apply.
+pub trait Preconditioner {
+    /// Overwrites `z` with the preconditioned residual `M^{-1} r`.
+    fn apply(&self, r: &[f64], z: &mut [f64]);
+}
+
+impl LinearOperator for LinMatrix {
+    fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    fn apply(&self, x: &[f64], y: &mut [f64]) {
+        let cols = self.cols;
+        gemm::for_each_row_block(y, 1, sparse::threads_for(self.rows * cols), |row, block| {
+            for (i, value) in block.iter_mut().enumerate() {
+                let a_row = &self.data[(row + i) * cols..(row + i + 1) * cols];
+                *value = a_row.iter().zip(x).map(|(&a, &x)| f64::from(a) * x).sum();
+            }
+        });
+    }
+}
+
+impl TransposeOperator for LinMatrix {
+    fn apply_transpose(&self, x: &[f64], y: &mut [f64]) {
+        let cols = self.cols;
+        // Each block of outputs streams the rows of the matrix through it.
+        gemm::for_each_row_block(y, 1, sparse::threads_for(self.rows * cols), |col, block| {
+            block.fill(0.0);
+            for (i, &x) in x.iter().enumerate() {
+                let a_row = &self.data[i * cols + col..i * cols + col + block.len()];
+                for (y, &a) in block.iter_mut().zip(a_row) {
+                    *y += f64::from(a) * x;
+                }
+            }
+        });
+    }
+}
+
+impl LinearOperator for SparseMatrix {
+    fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    fn apply(&self, x: &[f64], y: &mut [f64]) {
+        match self.format {
+            SparseFormat::Csr => {
+                gemm::for_each_row_block(y, 1, sparse::threads_for(self.nnz()), |row, block| {
+                    for (i, value) in block.iter_mut().enumerate() {
+                        let range = self.offsets[row + i]..self.offsets[row + i + 1];
+                        *value = range.map(|p| f64::from(self.values[p]) * x[self.indices[p]]).sum();
+                    }
+                });
+            }
+            SparseFormat::Csc => {
+                y.fill(0.0);
+                for (j, &x) in x.iter().enumerate() {
+                    for p in self.offsets[j]..self.offsets[j + 1] {
+                        y[self.indices[p]] += f64::from(self.values[p]) * x;
+                    }
+                }
+            }
+        }
+    }
+}
+
+impl TransposeOperator for SparseMatrix {
+    fn apply_transpose(&self, x: &[f64], y: &mut [f64]) {
+        match self.format {
+            SparseFormat::Csr => {
+                y.fill(0.0);
+                for (i, &x) in x.iter().enumerate() {
+                    for p in self.offsets[i]..self.offsets[i + 1] {
+                        y[self.indices[p]] += f64::from(self.values[p]) * x;
+                    }
+                }
+            }
+            SparseFormat::Csc => {
+                gemm::for_each_row_block(y, 1, sparse::threads_for(self.nnz()), |col, block| {
+                    for (j, value) in block.iter_mut().enumerate() {
+                        let range = self.offsets[col + j]..self.offsets[col + j + 1];
+                        *value = range.map(|p| f64::from(self.values[p]) * x[self.indices[p]]).sum();
+                    }
+                });
+            }
+        }
+    }
+}
+
+/// A [`LinearOperator`] defined by a callback computing `y = A x`.
+pub struct FnOperator<F> {
+    rows: usize,
+    cols: usize,
+    f: F,
+}
+
+impl<F: Fn(&[f64], &mut [f64])> FnOperator<F> {
+    /// Wraps `f`, which overwrites its second argument (`rows` elements) with
+    /// the product of the operator and its first argument (`cols` elements).
+    pub fn new(rows: usize, cols: usize, f: F) -> FnOperator<F> {
+        FnOperator { rows, cols, f }
+    }
+}
+
+impl<F: Fn(&[f64], &mut [f64])> LinearOperator for FnOperator<F> {
+    fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    fn apply(&self, x: &[f64], y: &mut [f64]) {
+        (self.f)(x, y)
+    }
+}
+
+/// The preconditioner that does nothing, `M = I`.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct Identity;
+
+impl Preconditioner for Identity {
+    fn apply(&self, r: &[f64], z: &mut [f64]) {
+        z.copy_from_slice(r);
+    }
+}
+
+/// Scales the residual by the inverse of the diagonal of `A`.
+#[derive(Debug, Clone, PartialEq)]
+pub struct Jacobi {
+    inverse_diagonal: Vec<f64>,
+}
+
+impl Jacobi {
+    /// Creates the preconditioner for a matrix with the given diagonal.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(jacobi)` if no element of the diagonal is 0.
+    /// - `Err(MatrixError::Singular)` otherwise.
+    pub fn new(diagonal: &[f64]) -> Result<Jacobi, MatrixError> {
+        if diagonal.iter().any(|&d| d == 0.0) {
+            return Err(MatrixError::Singular);
+        }
+        Ok(Jacobi { inverse_diagonal: diagonal.iter().map(|&d| 1.0 / d).collect() })
+    }
+
+    /// Creates the preconditioner for a square dense matrix, see [`Jacobi::new`].
+    pub fn from_dense(matrix: &LinMatrix) -> Result<Jacobi, MatrixError> {
+        if matrix.rows != matrix.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let diagonal: Vec<f64> = (0..matrix.rows).map(|i| f64::from(matrix.get(i, i))).collect();
+        Jacobi::new(&diagonal)
+    }
+
+    /// Creates the preconditioner for a square sparse matrix, see [`Jacobi::new`].
+    pub fn from_sparse(matrix: &SparseMatrix) -> Result<Jacobi, MatrixError> {
+        if matrix.rows != matrix.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let diagonal: Vec<f64> = (0..matrix.rows).map(|i| f64::from(matrix.get(i, i))).collect();
+        Jacobi::new(&diagonal)
+    }
+}
+
+impl Preconditioner for Jacobi {
+    fn apply(&self, r: &[f64], z: &mut [f64]) {
+        for ((z, &r), &d) in z.iter_mut().zip(r).zip(&self.inverse_diagonal) {
+            *z = r * d;
+        }
+    }
+}
+
+/// The incomplete LU factorization with no fill-in of a sparse matrix.
+///
+/// `L` (unit lower triangular) and `U` are computed on the sparsity pattern of
+/// `A` only and stored together in CSR form, so applying the preconditioner
+/// costs one forward and one backward substitution over `nnz(A)` elements.
+#[derive(Debug, Clone, PartialEq)]
+pub struct Ilu0 {
+    offsets: Vec<usize>,
+    indices: Vec<usize>,
+    values: Vec<f64>,
+    diagonal: Vec<usize>,
+}
+
+impl Ilu0 {
+    /// Factors a square sparse matrix.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(ilu)` with the factorization.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrix is not square.
+    /// - `Err(MatrixError::Singular)` if a diagonal element is missing or
+    ///   becomes 0 during the factorization.
+    pub fn new(matrix: &SparseMatrix) -> Result<Ilu0, MatrixError> {
+        if matrix.rows != matrix.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let csr;
+        let matrix = if matrix.format == SparseFormat::Csr {
+            matrix
+        } else {
+            csr = matrix.to_format(SparseFormat::Csr);
+            &csr
+        };
+        let n = matrix.rows;
+        let (offsets, indices) = (matrix.offsets.clone(), matrix.indices.clone());
+        let mut values: Vec<f64> = matrix.values.iter().map(|&v| f64::from(v)).collect();
+        let mut diagonal = Vec::with_capacity(n);
+        // Position of each column of the current row, usize::MAX when absent.
+        let mut position = vec![usize::MAX; n];
+        for i in 0..n {
+            let row = offsets[i]..offsets[i + 1];
+            for p in row.clone() {
+                position[indices[p]] = p;
+            }
+            for p in row.clone() {
+                let k = indices[p];
+                if k >= i {
+                    break;
+                }
+                values[p] /= values[diagonal[k]];
+                let factor = values[p];
+                for q in diagonal[k] + 1..offsets[k + 1] {
+                    let target = position[indices[q]];
+                    if target != usize::MAX {
+                        values[target] -= factor * values[q];
+                    }
+                }
+            }
+            for p in row.clone() {
+                position[indices[p]] = usize::MAX;
+            }
+            match row.clone().find(|&p| indices[p] == i) {
+                Some(p) if values[p] != 0.0 => diagonal.push(p),
+                _ => return Err(MatrixError::Singular),
+            }
+        }
+        Ok(Ilu0 { offsets, indices, values, diagonal })
+    }
+
+    /// Factors the non-zero pattern of a square dense matrix, see [`Ilu0::new`].
+    pub fn from_dense(matrix: &LinMatrix) -> Result<Ilu0, MatrixError> {
+        Ilu0::new(&SparseMatrix::from_dense(matrix, SparseFormat::Csr))
+    }
+}
+
+impl Preconditioner for Ilu0 {
+    fn apply(&self, r: &[f64], z: &mut [f64]) {
+        let n = self.diagonal.len();
+        // Forward substitution with the unit lower triangle.
+        for i in 0..n {
+            let mut sum = r[i];
+            for p in self.offsets[i]..self.diagonal[i] {
+                sum -= self.values[p] * z[self.indices[p]];
+            }
+            z[i] = sum;
+        }
+        // Backward substitution with the upper triangle.
+        for i in (0..n).rev() {
+            let mut sum = z[i];
+            for p in self.diagonal[i] + 1..self.offsets[i + 1] {
+                sum -= self.values[p] * z[self.indices[p]];
+            }
+            z[i] = sum / self.values[self.diagonal[i]];
+        }
+    }
+}
+
+/// Stopping criteria of a [`KrylovSolver`].
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SolverOptions {
+    /// The solve stops once `||b - A x|| <= tolerance * ||b||`.
+    pub tolerance: f64,
+    /// The maximum number of iterations, each costing one product with `A`.
+    pub max_iterations: usize,
+    /// The number of GMRES iterations between restarts.
+    pub restart: usize,
+}
+
+impl Default for SolverOptions {
+    fn default() -> SolverOptions {
+        SolverOptions { tolerance: 1e-10, max_iterations: 1000, restart: 30 }
+    }
+}
+
+/// The outcome of a solve.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SolveInfo {
+    /// The number of iterations performed.
+    pub iterations: usize,
+    /// The final residual norm relative to `||b||`, as tracked by the method.
+    pub residual: f64,
+    /// `true` if the residual reached the tolerance. Otherwise the iteration
+    /// limit was hit or the method broke down, and `x` holds the last iterate.
+    pub converged: bool,
+}
+
+/// Conjugate gradient, BiCGSTAB and restarted GMRES, with the work vectors
+/// they need kept across calls.
+#[derive(Debug, Clone, Default)]
+pub struct KrylovSolver {
+    /// The stopping criteria of the next solves.
+    pub options: SolverOptions,
+    work: Vec<Vec<f64>>,
+    /// The GMRES Hessenberg matrix, Givens rotations and right-hand side.
+    hessenberg: Vec<f64>,
+}
+
+fn dot(a: &[f64], b: &[f64]) -> f64 {
+    a.iter().zip(b).map(|(&a, &b)| a * b).sum()
+}
+
+fn norm(a: &[f64]) -> f64 {
+    dot(a, a).sqrt()
+}
+
+/// `y += alpha * x`.
+fn axpy(y: &mut [f64], alpha: f64, x: &[f64]) {
+    for (y, &x) in y.iter_mut().zip(x) {
+        *y += alpha * x;
+    }
+}
+
+/// Overwrites `r` with `b - A x`.
+fn residual<A: LinearOperator + ?Sized>(a: &A, b: &[f64], x: &[f64], r: &mut [f64]) {
+    a.apply(x, r);
+    for (r, &b) in r.iter_mut().zip(b) {
+        *r = b - *r;
+    }
+}
+
+impl KrylovSolver {
+    /// Creates a solver with the given stopping criteria.
+    pub fn new(options: SolverOptions) -> KrylovSolver {
+        KrylovSolver { options, work: Vec::new(), hessenberg: Vec::new() }
+    }
+
+    /// Returns `count` work vectors of length `n`, reusing earlier allocations.
+    fn vectors(&mut self, count: usize, n: usize) -> &mut [Vec<f64>] {
+        if self.work.len() < count {
+            self.work.resize_with(count, Vec::new);
+        }
+        for v in &mut self.work[..count] {
+            v.resize(n, 0.0);
+        }
+        &mut self.work[..count]
+    }
+
+    /// Checks that `a` is square and matches `b` and `x`, returning `||b||`,
+    /// or `None` after setting `x` to the solution 0 if `b` is 0.
+    fn check<A: LinearOperator + ?Sized>(a: &A, b: &[f64], x: &mut [f64]) -> Result<Option<f64>, MatrixError> {
+        let (rows, cols) = a.dim();
+        if rows != cols || b.len() != rows || x.len() != cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let b_norm = norm(b);
+        if b_norm == 0.0 {
+            x.fill(0.0);
+            return Ok(None);
+        }
+        Ok(Some(b_norm))
+    }
+
+    /// Solves `A x = b` for a symmetric positive definite `A` with the
+    /// preconditioned conjugate gradient method, starting from `x`.
+    ///
+    /// `m` must be symmetric positive definite as well, which [`Jacobi`] is
+    /// for such an `A`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(info)` with `x` holding the last iterate. CG stops early if it
+    ///   detects that `A` is not positive definite.
+    /// - `Err(MatrixError::DimensionMismatch)` if `A` is not square or `b` and
+    ///   `x` do not match it.
+    pub fn cg<A, M>(&mut self, a: &A, m: &M, b: &[f64], x: &mut [f64]) -> Result<SolveInfo, MatrixError>
+    where
+        A: LinearOperator + ?Sized,
+        M: Preconditioner + ?Sized,
+    {
+        let _timer = stats::time(Kernel::KrylovSolve);
+        let Some(scale) = KrylovSolver::check(a, b, x)? else {
+            return Ok(SolveInfo { iterations: 0, residual: 0.0, converged: true });
+        };
+        let options = self.options;
+        let [r, z, p, q] = self.vectors(4, b.len()) else { unreachable!() };
+        residual(a, b, x, r);
+        let mut info = SolveInfo { iterations: 0, residual: norm(r) / scale, converged: false };
+        if info.residual <= options.tolerance {
+            info.converged = true;
+            return Ok(info);
+        }
+        m.apply(r, z);
+        p.copy_from_slice(z);
+        let mut rz = dot(r, z);
+        while info.iterations < options.max_iterations {
+            a.apply(p, q);
+            let pq = dot(p, q);
+            if pq <= 0.0 || !pq.is_finite() {
+                break;
+            }
+            let alpha = rz / pq;
+            axpy(x, alpha, p);
+            axpy(r, -alpha, q);
+            info.iterations += 1;
+            info.residual = norm(r) / scale;
+            if info.residual <= options.tolerance {
+                info.converged = true;
+                break;
+            }
+            m.apply(r, z);
+            let rz_next = dot(r, z);
+            let beta = rz_next / rz;
+            rz = rz_next;
+            for (p, &z) in p.iter_mut().zip(z.iter()) {
+                *p = z + beta * *p;
+            }
+        }
+        Ok(info)
+    }
+
+    /// Solves `A x = b` for a general square `A` with the right-preconditioned
+    /// BiCGSTAB method, starting from `x`. Every iteration costs two products
+    /// with `A` and is counted once.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(info)` with `x` holding the last iterate. BiCGSTAB stops early
+    ///   if its recurrences break down.
+    /// - `Err(MatrixError::DimensionMismatch)` if `A` is not square or `b` and
+    ///   `x` do not match it.
+    pub fn bicgstab<A, M>(&mut self, a: &A, m: &M, b: &[f64], x: &mut [f64]) -> Result<SolveInfo, MatrixError>
+    where
+        A: LinearOperator + ?Sized,
+        M: Preconditioner + ?Sized,
+    {
+        let _timer = stats::time(Kernel::KrylovSolve);
+        let Some(scale) = KrylovSolver::check(a, b, x)? else {
+            return Ok(SolveInfo { iterations: 0, residual: 0.0, converged: true });
+        };
+        let options = self.options;
+        let [r, r_hat, p, v, p_hat, s, s_hat, t] = self.vectors(8, b.len()) else { unreachable!() };
+        residual(a, b, x, r);
+        let mut info = SolveInfo { iterations: 0, residual: norm(r) / scale, converged: false };
+        if info.residual <= options.tolerance {
+            info.converged = true;
+            return Ok(info);
+        }
+        r_hat.copy_from_slice(r);
+        p.fill(0.0);
+        v.fill(0.0);
+        let (mut rho, mut alpha, mut omega) = (1.0, 1.0, 1.0);
+        while info.iterations < options.max_iterations {
+            let rho_next = dot(r_hat, r);
+            if rho_next == 0.0 || omega == 0.0 || !rho_next.is_finite() {
+                break;
+            }
+            let beta = (rho_next / rho) * (alpha / omega);
+            rho = rho_next;
+            for ((p, &r), &v) in p.iter_mut().zip(r.iter()).zip(v.iter()) {
+                *p = r + beta * (*p - omega * v);
+            }
+            m.apply(p, p_hat);
+            a.apply(p_hat, v);
+            alpha = rho / dot(r_hat, v);
+            s.copy_from_slice(r);
+            axpy(s, -alpha, v);
+            info.iterations += 1;
+            let s_norm = norm(s) / scale;
+            if s_norm <= options.tolerance {
+                axpy(x, alpha, p_hat);
+                info.residual = s_norm;
+                info.converged = true;
+                break;
+            }
+            m.apply(s, s_hat);
+            a.apply(s_hat, t);
+            let tt = dot(t, t);
+            omega = if tt > 0.0 { dot(t, s) / tt } else { 0.0 };
+            axpy(x, alpha, p_hat);
+            axpy(x, omega, s_hat);
+            r.copy_from_slice(s);
+            axpy(r, -omega, t);
+            info.residual = norm(r) / scale;
+            if info.residual <= options.tolerance {
+                info.converged = true;
+                break;
+            }
+        }
+        Ok(info)
+    }
+
+    /// Solves `A x = b` for a general square `A` with right-preconditioned
+    /// GMRES, restarted every `options.restart` iterations, starting from `x`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(info)` with `x` holding the last iterate.
+    /// - `Err(MatrixError::DimensionMismatch)` if `A` is not square or `b` and
+    ///   `x` do not match it.
+    pub fn gmres<A, M>(&mut self, a: &A, m: &M, b: &[f64], x: &mut [f64]) -> Result<SolveInfo, MatrixError>
+    where
+        A: LinearOperator + ?Sized,
+        M: Preconditioner + ?Sized,
+    {
+        let _timer = stats::time(Kernel::KrylovSolve);
+        let Some(scale) = KrylovSolver::check(a, b, x)? else {
+            return Ok(SolveInfo { iterations: 0, residual: 0.0, converged: true });
+        };
+        let options = self.options;
+        let restart = options.restart.max(1);
+        let n = b.len();
+        // Basis vectors V_0..V_restart, then two scratch vectors.
+        self.vectors(restart + 3, n);
+        let (basis, scratch) = self.work[..restart + 3].split_at_mut(restart + 1);
+        let [w, z] = scratch else { unreachable!() };
+        // Hessenberg matrix stored by columns, Givens rotations and the
+        // rotated right-hand side, all in one reused buffer.
+        self.hessenberg.resize((restart + 1) * restart + 3 * restart + 1, 0.0);
+        let (h, rest) = self.hessenberg.split_at_mut((restart + 1) * restart);
+        let (cs, rest) = rest.split_at_mut(restart);
+        let (sn, g) = rest.split_at_mut(restart);
+        let mut info = SolveInfo { iterations: 0, residual: 0.0, converged: false };
+        loop {
+            residual(a, b, x, &mut basis[0]);
+            let beta = norm(&basis[0]);
+            info.residual = beta / scale;
+            if info.residual <= options.tolerance {
+                info.converged = true;
+                return Ok(info);
+            }
+            if info.iterations >= options.max_iterations {
+                return Ok(info);
+            }
+            basis[0].iter_mut().for_each(|v| *v /= beta);
+            g.fill(0.0);
+            g[0] = beta;
+            let mut k = 0;
+            while k < restart && info.iterations < options.max_iterations {
+                m.apply(&basis[k], z);
+                a.apply(z, w);
+                let column = &mut h[k * (restart + 1)..(k + 1) * (restart + 1)];
+                for (i, v) in basis[..=k].iter().enumerate() {
+                    column[i] = dot(w, v);
+                    axpy(w, -column[i], v);
+                }
+                column[k + 1] = norm(w);
+                for i in 0..k {
+                    let (hi, hj) = (column[i], column[i + 1]);
+                    column[i] = cs[i] * hi + sn[i] * hj;
+                    column[i + 1] = -sn[i] * hi + cs[i] * hj;
+                }
+                let r = column[k].hypot(column[k + 1]);
+                let lucky = column[k + 1] == 0.0;
+                if !lucky {
+                    basis[k + 1].iter_mut().zip(w.iter()).for_each(|(v, &w)| *v = w / column[k + 1]);
+                }
+                (cs[k], sn[k]) = if r == 0.0 { (1.0, 0.0) } else { (column[k] / r, column[k + 1] / r) };
+                column[k] = r;
+                column[k + 1] = 0.0;
+                g[k + 1] = -sn[k] * g[k];
+                g[k] *= cs[k];
+                k += 1;
+                info.iterations += 1;
+                info.residual = g[k].abs() / scale;
+                if info.residual <= options.tolerance || lucky {
+                    break;
+                }
+            }
+            // Solve the k x k triangular system H y = g in place of g.
+            for i in (0..k).rev() {
+                let mut sum = g[i];
+                for j in i + 1..k {
+                    sum -= h[j * (restart + 1) + i] * g[j];
+                }
+                g[i] = sum / h[i * (restart + 1) + i];
+            }
+            w.fill(0.0);
+            for (v, &y) in basis[..k].iter().zip(g.iter()) {
+                axpy(w, y, v);
+            }
+            m.apply(w, z);
+            axpy(x, 1.0, z);
+        }
+    }
+}
+
+impl LinMatrix {
+    /// Solves `self * x = b` for a symmetric positive definite matrix with
+    /// Jacobi-preconditioned conjugate gradients and the default options.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(x)` once the residual reaches the default tolerance.
+    /// - `Err(MatrixError::DimensionMismatch)` if the shapes do not match.
+    /// - `Err(MatrixError::Singular)` if the diagonal holds a 0 or the
+    ///   iteration does not converge.
+    pub fn solve_cg(&self, b: &[LinNum]) -> Result<Vec<LinNum>, MatrixError> {
+        let jacobi = Jacobi::from_dense(self)?;
+        let b: Vec<f64> = b.iter().map(|&v| f64::from(v)).collect();
+        let mut x = vec![0.0; self.cols];
+        let info = KrylovSolver::default().cg(self, &jacobi, &b, &mut x)?;
+        if !info.converged {
+            return Err(MatrixError::Singular);
+        }
+        Ok(x.into_iter().map(LinNum::new_real).collect())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::sparse::CooMatrix;
+
+    /// The 5-point Laplacian on an `n` x `n` grid, symmetric positive definite.
+    fn laplacian(n: usize, format: SparseFormat) -> SparseMatrix {
+        let mut coo = CooMatrix::new(n * n, n * n);
+        for i in 0..n {
+            for j in 0..n {
+                let row = i * n + j;
+                coo.push(row, row, lnum!(4.0)).unwrap();
+                for (di, dj) in [(0, 1), (1, 0)] {
+                    let (ni, nj) = (i + di, j + dj);
+                    if ni < n && nj < n {
+                        coo.push(row, ni * n + nj, lnum!(-1.0)).unwrap();
+                        coo.push(ni * n + nj, row, lnum!(-1.0)).unwrap();
+                    }
+                }
+            }
+        }
+        coo.to_sparse(format)
+    }
+
+    /// A diagonally dominant, non-symmetric tridiagonal matrix.
+    fn convection(n: usize) -> SparseMatrix {
+        let mut coo = CooMatrix::new(n, n);
+        for i in 0..n {
+            coo.push(i, i, lnum!(3.0)).unwrap();
+            if i > 0 {
+                coo.push(i, i - 1, lnum!(-1.5)).unwrap();
+            }
+            if i + 1 < n {
+                coo.push(i, i + 1, lnum!(-0.5)).unwrap();
+            }
+        }
+        coo.to_sparse(SparseFormat::Csr)
+    }
+
+    fn relative_residual<A: LinearOperator>(a: &A, b: &[f64], x: &[f64]) -> f64 {
+        let mut r = vec![0.0; b.len()];
+        residual(a, b, x, &mut r);
+        norm(&r) / norm(b)
+    }
+
+    fn rhs(n: usize) -> Vec<f64> {
+        (0..n).map(|i| ((i * 7) % 11) as f64 - 5.0).collect()
+    }
+
+    #[test]
+    fn test_cg_preconditioners() {
+        let a = laplacian(12, SparseFormat::Csr);
+        let b = rhs(144);
+        let mut solver = KrylovSolver::default();
+        let mut iterations = Vec::new();
+        let preconditioners: [&dyn Preconditioner; 3] =
+            [&Identity, &Jacobi::from_sparse(&a).unwrap(), &Ilu0::new(&a).unwrap()];
+        for m in preconditioners {
+            let mut x = vec![0.0; 144];
+            let info = solver.cg(&a, m, &b, &mut x).unwrap();
+            assert!(info.converged);
+            assert!(relative_residual(&a, &b, &x) < 1e-9);
+            iterations.push(info.iterations);
+        }
+        // ILU(0) is not symmetric in general, but for this matrix it still helps.
+        assert!(iterations[2] < iterations[0]);
+    }
+
+    #[test]
+    fn test_nonsymmetric_solvers() {
+        let a = convection(200);
+        let b = rhs(200);
+        let mut solver = KrylovSolver::new(SolverOptions { restart: 10, ..SolverOptions::default() });
+        for method in [KrylovSolver::bicgstab::<SparseMatrix, Jacobi>, KrylovSolver::gmres::<SparseMatrix, Jacobi>] {
+            let mut x = vec![0.0; 200];
+            let info = method(&mut solver, &a, &Jacobi::from_sparse(&a).unwrap(), &b, &mut x).unwrap();
+            assert!(info.converged, "{:?}", info);
+            assert!(relative_residual(&a, &b, &x) < 1e-9);
+        }
+    }
+
+    #[test]
+    fn test_ilu0_of_tridiagonal_is_exact() {
+        // A tridiagonal matrix has no fill-in, so ILU(0) is its LU factorization.
+        let a = convection(50);
+        let b = rhs(50);
+        let mut x = vec![0.0; 50];
+        let info = KrylovSolver::default().gmres(&a, &Ilu0::new(&a).unwrap(), &b, &mut x).unwrap();
+        assert!(info.converged);
+        assert_eq!(info.iterations, 1);
+    }
+
+    #[test]
+    fn test_operators_agree() {
+        let sparse = laplacian(5, SparseFormat::Csc);
+        let dense = sparse.to_dense();
+        let callback = FnOperator::new(25, 25, |x: &[f64], y: &mut [f64]| sparse.apply(x, y));
+        let b = rhs(25);
+        let mut solver = KrylovSolver::default();
+        let mut solutions = Vec::new();
+        let operators: [&dyn LinearOperator; 3] = [&sparse, &dense, &callback];
+        for a in operators {
+            let mut x = vec![0.0; 25];
+            assert!(solver.cg(a, &Identity, &b, &mut x).unwrap().converged);
+            solutions.push(x);
+        }
+        for x in &solutions[1..] {
+            assert!(x.iter().zip(&solutions[0]).all(|(a, b)| (a - b).abs() < 1e-8));
+        }
+        let x = dense.solve_cg(&b.iter().map(|&v| lnum!(v)).collect::<Vec<_>>()).unwrap();
+        assert!(x.iter().zip(&solutions[0]).all(|(&a, b)| (f64::from(a) - b).abs() < 1e-8));
+    }
+
+    #[test]
+    fn test_limits_and_errors() {
+        let a = laplacian(10, SparseFormat::Csr);
+        let b = rhs(100);
+        let mut solver = KrylovSolver::new(SolverOptions { max_iterations: 3, ..SolverOptions::default() });
+        let mut x = vec![0.0; 100];
+        let info = solver.cg(&a, &Identity, &b, &mut x).unwrap();
+        assert_eq!((info.iterations, info.converged), (3, false));
+        let info = solver.gmres(&a, &Identity, &b, &mut x).unwrap();
+        assert_eq!((info.iterations, info.converged), (3, false));
+        assert_eq!(solver.cg(&a, &Identity, &b[..99], &mut x), Err(MatrixError::DimensionMismatch));
+        let mut x = vec![1.0; 100];
+        let info = solver.bicgstab(&a, &Identity, &[0.0; 100], &mut x).unwrap();
+        assert!(info.converged && x.iter().all(|&v| v.abs() < 1e-9));
+        assert_eq!(Jacobi::new(&[1.0, 0.0]), Err(MatrixError::Singular));
+        let no_diagonal = SparseMatrix::from_dense(&matrix!([0.0, 1.0], [1.0, 0.0]), SparseFormat::Csr);
+        assert_eq!(Ilu0::new(&no_diagonal), Err(MatrixError::Singular));
+    }
+}
@@ -1,7 +1,25 @@
 #[macro_use]
 pub mod linnum;
+#[macro_use]
 mod vector;
 #[macro_use]
 pub mod matrix;
+pub mod lu;
+pub mod rref;
+pub mod qr;
+pub mod cholesky;
+pub mod eigen;
+pub mod batch;
+pub mod device;
+mod gemm;
+pub mod expr;
+pub mod sparse;
+pub mod fixed;
+pub mod view;
+pub mod sum;
+pub mod krylov;
+pub mod stats;
+pub mod storage;
+pub mod text;
 
 
@@ -2,6 +2,7 @@ use std::ops::{Add, AddAssign, Div, DivAssign, Mul, MulAssign, Sub, SubAssign};
 use num_integer::gcd;
 
 use crate::matrix::LinMatrix;
+use crate::stats::{self, Counter};
 
 /// Creates a new `LinNum` instance with a rational number.
 #[macro_export]
@@ -13,12 +14,16 @@ macro_rules! lnum {
 // pub(crate) use lnum;
 
 
+// The layout is fixed, a `u64` tag (0 for rational, 1 for real) followed by
+// the fields of the variant, so `storage` can use stored elements in place.
 #[derive(Debug, PartialEq, Clone, Copy, PartialOrd)]
+#[repr(u64)]
 enum LinNumWrapper {
     Rational(i128, i128),
     Real(f64),
 }
 #[derive(Debug, PartialEq, Clone, Copy, PartialOrd)]
+#[repr(C)]
 /// Represents a linear number, which can be either a rational number or a real number.
 pub struct LinNum {
     value: LinNumWrapper,
@@ -36,7 +41,9 @@ impl LinNum {
     ///
     /// A new `LinNum` instance with the specified rational number.
     pub fn new_rational(numerator: i128, denominator: i128) -> LinNum {
+        // The divisor carries the sign of the denominator, which is kept positive.
         let gcd = gcd(numerator, denominator);
+        let gcd = if denominator < 0 { -gcd } else { gcd };
         let simplified_numerator = numerator / gcd;
         let simplified_denominator = denominator / gcd;
         LinNum {
@@ -59,6 +66,14 @@ impl LinNum {
         }
     }
 
+    /// Returns the numerator and denominator of a rational number, `None` for a real number.
+    pub(crate) fn rational_parts(&self) -> Option<(i128, i128)> {
+        match self.value {
+            LinNumWrapper::Rational(num, den) => Some((num, den)),
+            LinNumWrapper::Real(_) => None,
+        }
+    }
+
     /// Checks if the `LinNum` instance represents a rational number.
     ///
     /// # Returns
@@ -166,9 +181,11 @@ impl Add for LinNum {
                 LinNum::new_rational(numerator, denominator)
             }
             (LinNumWrapper::Real(val1), LinNumWrapper::Rational(num2, den2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real(val1 + (num2 as f64 / den2 as f64))
             }
             (LinNumWrapper::Rational(num1, den1), LinNumWrapper::Real(val2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real((num1 as f64 / den1 as f64) + val2)
             }
             (LinNumWrapper::Real(val1), LinNumWrapper::Real(val2)) => LinNum::new_real(val1 + val2),
@@ -185,6 +202,14 @@ impl Mul<LinMatrix> for LinNum {
     }
 }
 
+impl Mul<&LinMatrix> for LinNum {
+    type Output = LinMatrix;
+
+    fn mul(self, other: &LinMatrix) -> LinMatrix {
+        other * self
+    }
+}
+
 impl Sub for LinNum {
     type Output = LinNum;
 
@@ -196,9 +221,11 @@ impl Sub for LinNum {
                 LinNum::new_rational(numerator, denominator)
             }
             (LinNumWrapper::Real(val1), LinNumWrapper::Rational(num2, den2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real(val1 - (num2 as f64 / den2 as f64))
             }
             (LinNumWrapper::Rational(num1, den1), LinNumWrapper::Real(val2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real((num1 as f64 / den1 as f64) - val2)
             }
             (LinNumWrapper::Real(val1), LinNumWrapper::Real(val2)) => LinNum::new_real(val1 - val2),
@@ -218,9 +245,11 @@ impl Mul for LinNum {
             }
             (LinNumWrapper::Real(val1), LinNumWrapper::Real(val2)) => LinNum::new_real(val1 * val2),
             (LinNumWrapper::Real(val1), LinNumWrapper::Rational(num2, den2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real(val1 * (num2 as f64 / den2 as f64))
             }
             (LinNumWrapper::Rational(num1, den1), LinNumWrapper::Real(val2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real((num1 as f64 / den1 as f64) * val2)
             }
         }
@@ -239,9 +268,11 @@ impl Div for LinNum {
             }
             (LinNumWrapper::Real(val1), LinNumWrapper::Real(val2)) => LinNum::new_real(val1 / val2),
             (LinNumWrapper::Real(val1), LinNumWrapper::Rational(num2, den2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real(val1 / (num2 as f64 / den2 as f64))
             }
             (LinNumWrapper::Rational(num1, den1), LinNumWrapper::Real(val2)) => {
+                stats::record(Counter::RealPromotion, 0);
                 LinNum::new_real((num1 as f64 / den1 as f64) / val2)
             }
         }
@@ -0,0 +1,328 @@
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::stats::{self, Kernel};
+
+/// The PLU factorization `P * A = L * U` of a square matrix.
+///
+/// `L` and `U` share one matrix: `U` is stored on and above the diagonal and
+/// the multipliers of `L` below it, with its unit diagonal left implicit. The
+/// permutation is kept as the list of original rows, in their new order.
+///
+/// The factorization is computed once in O(n³) and can then be reused for any
+/// number of determinants, solves and inverses.
+#[derive(Debug, PartialEq, Clone)]
+pub struct LuDecomposition {
+    lu: LinMatrix,
+    perm: Vec<usize>,
+    odd: bool,
+    singular: bool,
+}
+
+impl LuDecomposition {
+    /// Factors a square matrix in place, taking over its storage.
+    ///
+    /// Each column is pivoted on the entry of largest magnitude at or below the
+    /// diagonal. A column without a non-zero pivot marks the matrix as singular
+    /// and is skipped, so the factorization always completes.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(lu)` with the factorization.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrix is not square.
+    pub fn new(mut matrix: LinMatrix) -> Result<LuDecomposition, MatrixError> {
+        if matrix.rows != matrix.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let _timer = stats::time(Kernel::MatrixLu);
+        let n = matrix.rows;
+        let mut perm: Vec<usize> = (0..n).collect();
+        let mut odd = false;
+        let mut singular = false;
+        let data = &mut matrix.data;
+
+        for k in 0..n {
+            let mut pivot_row = k;
+            let mut pivot_abs = f64::from(data[k * n + k]).abs();
+            for i in k + 1..n {
+                let abs = f64::from(data[i * n + k]).abs();
+                if abs > pivot_abs {
+                    pivot_row = i;
+                    pivot_abs = abs;
+                }
+            }
+            if pivot_abs == 0.0 {
+                singular = true;
+                continue;
+            }
+            if pivot_row != k {
+                let (top, bottom) = data.split_at_mut(pivot_row * n);
+                top[k * n..(k + 1) * n].swap_with_slice(&mut bottom[..n]);
+                perm.swap(k, pivot_row);
+                odd = !odd;
+            }
+
+            let (top, bottom) = data.split_at_mut((k + 1) * n);
+            let pivot_slice = &top[k * n..];
+            let pivot = pivot_slice[k];
+            for row in bottom.chunks_exact_mut(n) {
+                let factor = row[k] / pivot;
+                row[k] = factor;
+                if f64::from(factor) == 0.0 {
+                    continue;
+                }
+                for j in k + 1..n {
+                    row[j] -= factor * pivot_slice[j];
+                }
+            }
+        }
+
+        Ok(LuDecomposition { lu: matrix, perm, odd, singular })
+    }
+
+    /// Returns the dimension of the factored matrix.
+    pub fn dim(&self) -> usize {
+        self.lu.rows
+    }
+
+    /// Checks whether the factored matrix is singular.
+    pub fn is_singular(&self) -> bool {
+        self.singular
+    }
+
+    /// Calculates the determinant of the factored matrix.
+    ///
+    /// # Returns
+    ///
+    /// The product of the pivots, negated for an odd permutation.
+    pub fn determinant(&self) -> LinNum {
+        let n = self.dim();
+        let mut det = LinNum::new_rational(if self.odd { -1 } else { 1 }, 1);
+        for i in 0..n {
+            det *= self.lu.data[i * n + i];
+        }
+        det
+    }
+
+    /// Solves `A * x = b` for `x`.
+    ///
+    /// # Arguments
+    ///
+    /// * `b` - The right-hand side.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(x)` with the solution.
+    /// - `Err(MatrixError::DimensionMismatch)` if `b` does not have one entry per row.
+    /// - `Err(MatrixError::Singular)` if the matrix is singular.
+    pub fn solve(&self, b: &[LinNum]) -> Result<Vec<LinNum>, MatrixError> {
+        if b.len() != self.dim() {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let mut x = self.permute(b, 1);
+        self.substitute(&mut x, 1)?;
+        Ok(x)
+    }
+
+    /// Solves `A * X = B` for every column of `B` at once.
+    ///
+    /// # Arguments
+    ///
+    /// * `b` - The right-hand sides, one per column.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(x)` with the solutions, one per column.
+    /// - `Err(MatrixError::DimensionMismatch)` if `b` does not have one row per row of the matrix.
+    /// - `Err(MatrixError::Singular)` if the matrix is singular.
+    pub fn solve_matrix(&self, b: &LinMatrix) -> Result<LinMatrix, MatrixError> {
+        if b.rows != self.dim() {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let data = self.permute(&b.data, b.cols);
+        let mut x = LinMatrix { rows: b.rows, cols: b.cols, data };
+        self.substitute(&mut x.data, b.cols)?;
+        Ok(x)
+    }
+
+    /// Calculates the inverse of the factored matrix.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(inverse)` with the inverse.
+    /// - `Err(MatrixError::Singular)` if the matrix is singular.
+    pub fn inverse(&self) -> Result<LinMatrix, MatrixError> {
+        let n = self.dim();
+        let mut identity = LinMatrix {
+            rows: n,
+            cols: n,
+            data: vec![LinNum::new_rational(0, 1); n * n],
+        };
+        for i in 0..n {
+            identity.data[i * n + i] = LinNum::new_rational(1, 1);
+        }
+        self.solve_matrix(&identity)
+    }
+
+    /// Reorders the rows of a row-major block of the given width by the permutation.
+    fn permute(&self, b: &[LinNum], width: usize) -> Vec<LinNum> {
+        let mut x = Vec::with_capacity(b.len());
+        for &row in &self.perm {
+            x.extend_from_slice(&b[row * width..(row + 1) * width]);
+        }
+        x
+    }
+
+    /// Runs forward substitution with `L` and back substitution with `U` over a
+    /// permuted row-major block, working a whole row of right-hand sides at a time.
+    fn substitute(&self, x: &mut [LinNum], width: usize) -> Result<(), MatrixError> {
+        if self.singular {
+            return Err(MatrixError::Singular);
+        }
+        let n = self.dim();
+        let lu = &self.lu.data;
+        for i in 1..n {
+            let (solved, rest) = x.split_at_mut(i * width);
+            let row = &mut rest[..width];
+            for k in 0..i {
+                let factor = lu[i * n + k];
+                for (value, &known) in row.iter_mut().zip(&solved[k * width..(k + 1) * width]) {
+                    *value -= factor * known;
+                }
+            }
+        }
+        for i in (0..n).rev() {
+            let (head, solved) = x.split_at_mut((i + 1) * width);
+            let row = &mut head[i * width..];
+            for k in i + 1..n {
+                let factor = lu[i * n + k];
+                for (value, &known) in row.iter_mut().zip(&solved[(k - i - 1) * width..(k - i) * width]) {
+                    *value -= factor * known;
+                }
+            }
+            let pivot = lu[i * n + i];
+            for value in row.iter_mut() {
+                *value /= pivot;
+            }
+        }
+        Ok(())
+    }
+}
+
+impl LinMatrix {
+    /// Computes the PLU factorization of the matrix, see [`LuDecomposition`].
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(lu)` with the factorization.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrix is not square.
+    pub fn lu(&self) -> Result<LuDecomposition, MatrixError> {
+        LuDecomposition::new(self.clone())
+    }
+
+    /// Computes the PLU factorization of the matrix, reusing its storage.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(lu)` with the factorization.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrix is not square.
+    pub fn into_lu(self) -> Result<LuDecomposition, MatrixError> {
+        LuDecomposition::new(self)
+    }
+
+    /// Calculates the inverse of the matrix.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(inverse)` with the inverse.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrix is not square.
+    /// - `Err(MatrixError::Singular)` if the matrix is singular.
+    pub fn inverse(&self) -> Result<LinMatrix, MatrixError> {
+        self.lu()?.inverse()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{lnum, matrix};
+
+    fn assert_close(a: &LinMatrix, b: &LinMatrix) {
+        assert_eq!(a.dim(), b.dim());
+        for (x, y) in a.data.iter().zip(&b.data) {
+            assert!((f64::from(*x) - f64::from(*y)).abs() < 1e-9, "{} != {}", a, b);
+        }
+    }
+
+    #[test]
+    fn test_determinant() {
+        let matrix = matrix!([2.0, -3.0, 1.0], [2.0, 0.0, -1.0], [1.0, 4.0, 5.0]);
+        let det = f64::from(matrix.determinant().unwrap());
+        assert!((det - 49.0).abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_determinant_pivot_sign() {
+        let matrix = matrix!([0.0, 1.0, 0.0], [1.0, 0.0, 0.0], [0.0, 0.0, 1.0]);
+        assert_eq!(matrix.determinant(), Ok(lnum!(-1.0)));
+    }
+
+    #[test]
+    fn test_determinant_rational() {
+        let mut matrix = LinMatrix::new(3, 3);
+        for i in 0..3 {
+            for j in 0..3 {
+                matrix.set(i, j, LinNum::new_rational(1, (i + j + 1) as i128));
+            }
+        }
+        assert_eq!(matrix.determinant(), Ok(LinNum::new_rational(1, 2160)));
+    }
+
+    #[test]
+    fn test_determinant_large() {
+        let n = 14;
+        let mut matrix = LinMatrix::new(n, n);
+        for i in 0..n {
+            for j in 0..n {
+                matrix.set(i, j, lnum!(if i == j { 2.0 } else if i.abs_diff(j) == 1 { -1.0 } else { 0.0 }));
+            }
+        }
+        let det = f64::from(matrix.determinant().unwrap());
+        assert!((det - (n as f64 + 1.0)).abs() < 1e-9);
+    }
+
+    #[test]
+    fn test_singular() {
+        let matrix = matrix!([1.0, 2.0, 3.0], [4.0, 5.0, 6.0], [2.0, 4.0, 6.0]);
+        let lu = matrix.lu().unwrap();
+        assert!(lu.is_singular());
+        assert_eq!(f64::from(lu.determinant()), 0.0);
+        assert_eq!(lu.solve(&[lnum!(1.0), lnum!(1.0), lnum!(1.0)]), Err(MatrixError::Singular));
+        assert_eq!(matrix.inverse(), Err(MatrixError::Singular));
+    }
+
+    #[test]
+    fn test_not_square() {
+        let matrix = matrix!([1.0, 2.0, 3.0], [4.0, 5.0, 6.0]);
+        assert_eq!(matrix.lu(), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_solve() {
+        let matrix = matrix!([2.0, 1.0, -1.0], [-3.0, -1.0, 2.0], [-2.0, 1.0, 2.0]);
+        let lu = matrix.into_lu().unwrap();
+        let x = lu.solve(&[lnum!(8.0), lnum!(-11.0), lnum!(-3.0)]).unwrap();
+        let expected = [2.0, 3.0, -1.0];
+        for (value, expected) in x.iter().zip(expected) {
+            assert!((f64::from(*value) - expected).abs() < 1e-9);
+        }
+        assert_eq!(lu.solve(&[lnum!(1.0)]), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_inverse() {
+        let matrix = matrix!([4.0, 7.0, 2.0], [3.0, 6.0, 1.0], [2.0, 5.0, 3.0]);
+        let inverse = matrix.inverse().unwrap();
+        let product = (matrix * inverse).unwrap();
+        assert_close(&product, &matrix!([1.0, 0.0, 0.0], [0.0, 1.0, 0.0], [0.0, 0.0, 1.0]));
+    }
+}
@@ -1,4 +1,7 @@
+use crate::gemm;
 use crate::linnum::LinNum;
+use crate::stats::{self, Counter, Kernel};
+use crate::view::MatrixView;
 use std::ops::{Add, AddAssign, Div, DivAssign, Index, IndexMut, Mul, MulAssign, Sub, SubAssign};
 
 #[macro_export]
@@ -13,14 +16,35 @@ macro_rules! matrix {
 #[derive(Debug, PartialEq, Clone)]
 pub enum MatrixError {
     DimensionMismatch,
+    Singular,
+    NotPositiveDefinite,
+}
+
+/// Side of the square tiles the transposes work on. 16 elements of up to 48
+/// bytes keep a tile of the source and one of the destination in L1.
+const TRANSPOSE_TILE: usize = 16;
+
+/// Returns the row-major transpose of the `rows` x `cols` row-major `data`.
+pub(crate) fn transpose_data(data: &[LinNum], rows: usize, cols: usize) -> Vec<LinNum> {
+    let mut result = vec![LinNum::new_real(0.0); rows * cols];
+    for ib in (0..rows).step_by(TRANSPOSE_TILE) {
+        for jb in (0..cols).step_by(TRANSPOSE_TILE) {
+            for i in ib..(ib + TRANSPOSE_TILE).min(rows) {
+                for j in jb..(jb + TRANSPOSE_TILE).min(cols) {
+                    result[j * rows + i] = data[i * cols + j];
+                }
+            }
+        }
+    }
+    result
 }
 
 #[derive(Debug, PartialEq, Clone)]
 /// Represents a linear algebra Matrix.
 pub struct LinMatrix {
-    rows: usize,
-    cols: usize,
-    data: Vec<LinNum>,
+    pub(crate) rows: usize,
+    pub(crate) cols: usize,
+    pub(crate) data: Vec<LinNum>,
 }
 
 impl LinMatrix {
@@ -35,6 +59,7 @@ impl LinMatrix {
     ///
     /// A new `LinMatrix` with the specified dimensions, initialized with zeros.
     pub fn new(rows: usize, cols: usize) -> LinMatrix {
+        stats::record(Counter::MatrixAlloc, rows * cols * std::mem::size_of::<LinNum>());
         LinMatrix {
             rows,
             cols,
@@ -58,13 +83,41 @@ impl LinMatrix {
     pub fn from(data: &[&[LinNum]]) -> LinMatrix {
         let rows = data.len();
         let cols = data[0].len();
-        let mut matrix = LinMatrix::new(rows, cols);
-        for (i, row) in data.iter().enumerate() {
-            for (j, &value) in row.iter().enumerate() {
-                matrix.set(i, j, value);
-            }
+        stats::record(Counter::MatrixAlloc, rows * cols * std::mem::size_of::<LinNum>());
+        let mut elements = Vec::with_capacity(rows * cols);
+        for row in data {
+            assert_eq!(row.len(), cols, "all rows must have the same length");
+            elements.extend_from_slice(row);
         }
-        matrix
+        LinMatrix { rows, cols, data: elements }
+    }
+
+    /// Creates a `LinMatrix` that takes over a `Vec` of row-major elements, without copying them.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(matrix)` with the matrix.
+    /// - `Err(MatrixError::DimensionMismatch)` if `data` does not hold `rows * cols` elements.
+    pub fn from_vec(rows: usize, cols: usize, data: Vec<LinNum>) -> Result<LinMatrix, MatrixError> {
+        if data.len() != rows * cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        Ok(LinMatrix { rows, cols, data })
+    }
+
+    /// Returns the elements of the matrix in row-major order.
+    pub fn as_slice(&self) -> &[LinNum] {
+        &self.data
+    }
+
+    /// Returns the elements of the matrix in row-major order, mutably.
+    pub fn as_mut_slice(&mut self) -> &mut [LinNum] {
+        &mut self.data
+    }
+
+    /// Returns the elements of the matrix in row-major order, without copying them.
+    pub fn into_vec(self) -> Vec<LinNum> {
+        self.data
     }
 
     /// Returns the dimensions of the matrix as a tuple `(rows, cols)`.
@@ -99,21 +152,55 @@ impl LinMatrix {
 
     /// Returns the transpose of the matrix.
     ///
+    /// The copy is made one tile at a time, so both the reads and the writes
+    /// stay within a few cache lines. Products with the transpose do not need
+    /// it, see [`LinMatrix::t`].
+    ///
     /// # Returns
     ///
     /// The transpose of the matrix.
     pub fn transpose(&self) -> LinMatrix {
-        let mut result = LinMatrix::new(self.cols, self.rows);
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                result.set(j, i, self.get(i, j));
+        let _timer = stats::time(Kernel::MatrixTranspose);
+        stats::record(Counter::MatrixAlloc, self.data.len() * std::mem::size_of::<LinNum>());
+        LinMatrix { rows: self.cols, cols: self.rows, data: transpose_data(&self.data, self.rows, self.cols) }
+    }
+
+    /// Transposes the matrix in place.
+    ///
+    /// Square matrices swap their elements across the diagonal tile by tile
+    /// without allocating; other shapes are transposed into a new buffer that
+    /// replaces the old one.
+    pub fn transpose_in_place(&mut self) {
+        let n = self.rows;
+        if n != self.cols {
+            *self = self.transpose();
+            return;
+        }
+        let _timer = stats::time(Kernel::MatrixTranspose);
+        for ib in (0..n).step_by(TRANSPOSE_TILE) {
+            for jb in (ib..n).step_by(TRANSPOSE_TILE) {
+                for i in ib..(ib + TRANSPOSE_TILE).min(n) {
+                    let start = if ib == jb { i + 1 } else { jb };
+                    for j in start..(jb + TRANSPOSE_TILE).min(n) {
+                        self.data.swap(i * n + j, j * n + i);
+                    }
+                }
             }
         }
-        result
+    }
+
+    /// Returns a view of the transpose of the matrix, without copying it.
+    ///
+    /// Multiplying a view reads the original elements with swapped strides, so
+    /// `a.t() * &a` never builds `a`'s transpose.
+    pub fn t(&self) -> MatrixView<'_> {
+        self.view().t()
     }
 
     /// Calculates the determinant of the matrix.
     ///
+    /// Matrices larger than 2x2 go through an LU factorization, see [`LinMatrix::lu`].
+    ///
     /// # Returns
     ///
     /// - `Ok(det)` if the matrix is square and the determinant can be calculated.
@@ -122,31 +209,11 @@ impl LinMatrix {
         if self.rows != self.cols {
             return Err(MatrixError::DimensionMismatch);
         }
-        if self.rows == 1 {
-            return Ok(self.get(0, 0));
-        }
-
-        let mut det = LinNum::new_real(0.0);
-        
-        if self.rows == 2 {
-            return Ok(self[(0, 0)] * self[(1, 1)] - self[(0, 1)] * self[(1, 0)]);
-        }
-        
-        for i in 0..self.cols {
-            let mut sub_matrix = LinMatrix::new(self.rows - 1, self.cols - 1); // 1 dim less
-            for j in 1..self.rows {
-                for k in 0..self.cols {
-                    if k < i {
-                        sub_matrix.set(j - 1, k, self.get(j, k));
-                    } else if k > i {
-                        sub_matrix.set(j - 1, k - 1, self.get(j, k));
-                    }
-                }
-            }
-            let sign = if i % 2 == 0 { 1.0 } else { -1.0 };
-            det += self.get(0, i) * sub_matrix.determinant()? * lnum!(sign);
+        match self.rows {
+            1 => Ok(self.get(0, 0)),
+            2 => Ok(self[(0, 0)] * self[(1, 1)] - self[(0, 1)] * self[(1, 0)]),
+            _ => Ok(self.lu()?.determinant()),
         }
-        Ok(det)
     }
 }
 
@@ -164,84 +231,147 @@ impl IndexMut<(usize, usize)> for LinMatrix {
     }
 }
 
+impl LinMatrix {
+    /// Adds `alpha * x` to the matrix in a single pass, without a temporary.
+    ///
+    /// # Arguments
+    ///
+    /// * `alpha` - The scale of `x`.
+    /// * `x` - The matrix to add.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` once the matrix is updated.
+    /// - `Err(MatrixError::DimensionMismatch)` if the matrices have different dimensions.
+    pub fn axpy(&mut self, alpha: LinNum, x: &LinMatrix) -> Result<(), MatrixError> {
+        if self.rows != x.rows || self.cols != x.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.zip_assign(x, |y, x| y + alpha * x);
+        Ok(())
+    }
+
+    /// Replaces every element with `op(element, other)` over the flat buffers.
+    fn zip_assign(&mut self, other: &LinMatrix, op: impl Fn(LinNum, LinNum) -> LinNum) {
+        for (x, &y) in self.data.iter_mut().zip(&other.data) {
+            *x = op(*x, y);
+        }
+    }
+
+    /// Builds a matrix from `op(element, other)` over the flat buffers.
+    fn zip_with(&self, other: &LinMatrix, op: impl Fn(LinNum, LinNum) -> LinNum) -> LinMatrix {
+        LinMatrix {
+            rows: self.rows,
+            cols: self.cols,
+            data: self.data.iter().zip(&other.data).map(|(&x, &y)| op(x, y)).collect(),
+        }
+    }
+
+    /// Builds a matrix from `op(element)` over the flat buffer.
+    fn map(&self, op: impl Fn(LinNum) -> LinNum) -> LinMatrix {
+        LinMatrix {
+            rows: self.rows,
+            cols: self.cols,
+            data: self.data.iter().map(|&x| op(x)).collect(),
+        }
+    }
+}
+
 impl Add for LinMatrix {
     type Output = Result<LinMatrix, MatrixError>;
-    fn add(self, other: LinMatrix) -> Result<LinMatrix, MatrixError> {
+    /// Adds in place into the buffer of `self`, which is reused for the result.
+    fn add(mut self, other: LinMatrix) -> Result<LinMatrix, MatrixError> {
         if self.rows != other.rows || self.cols != other.cols {
             return Err(MatrixError::DimensionMismatch);
         }
-        let mut result = LinMatrix::new(self.rows, self.cols);
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                result.set(i, j, self.get(i, j) + other.get(i, j));
-            }
+        self.zip_assign(&other, |x, y| x + y);
+        Ok(self)
+    }
+}
+
+impl Add<&LinMatrix> for &LinMatrix {
+    type Output = Result<LinMatrix, MatrixError>;
+    fn add(self, other: &LinMatrix) -> Result<LinMatrix, MatrixError> {
+        if self.rows != other.rows || self.cols != other.cols {
+            return Err(MatrixError::DimensionMismatch);
         }
-        Ok(result)
+        Ok(self.zip_with(other, |x, y| x + y))
     }
 }
 
 impl AddAssign for LinMatrix {
     fn add_assign(&mut self, other: LinMatrix) {
+        *self += &other;
+    }
+}
+
+impl AddAssign<&LinMatrix> for LinMatrix {
+    fn add_assign(&mut self, other: &LinMatrix) {
         if other.rows != self.rows || other.cols != self.cols {
             panic!("Dimension mismatch"); //TODO: handle error
         }
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                self.set(i, j, self.get(i, j) + other.get(i, j));
-            }
-        }
+        self.zip_assign(other, |x, y| x + y);
     }
 }
 
 impl Sub for LinMatrix {
     type Output = Result<LinMatrix, MatrixError>;
-    fn sub(self, other: LinMatrix) -> Result<LinMatrix, MatrixError> {
+    /// Subtracts in place into the buffer of `self`, which is reused for the result.
+    fn sub(mut self, other: LinMatrix) -> Result<LinMatrix, MatrixError> {
         if self.rows != other.rows || self.cols != other.cols {
             return Err(MatrixError::DimensionMismatch);
         }
-        let mut result = LinMatrix::new(self.rows, self.cols);
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                result.set(i, j, self.get(i, j) - other.get(i, j));
-            }
+        self.zip_assign(&other, |x, y| x - y);
+        Ok(self)
+    }
+}
+
+impl Sub<&LinMatrix> for &LinMatrix {
+    type Output = Result<LinMatrix, MatrixError>;
+    fn sub(self, other: &LinMatrix) -> Result<LinMatrix, MatrixError> {
+        if self.rows != other.rows || self.cols != other.cols {
+            return Err(MatrixError::DimensionMismatch);
         }
-        Ok(result)
+        Ok(self.zip_with(other, |x, y| x - y))
     }
 }
 
 impl SubAssign for LinMatrix {
     fn sub_assign(&mut self, other: LinMatrix) {
+        *self -= &other;
+    }
+}
+
+impl SubAssign<&LinMatrix> for LinMatrix {
+    fn sub_assign(&mut self, other: &LinMatrix) {
         if other.rows != self.rows || other.cols != self.cols {
             panic!("Dimension mismatch"); //TODO: handle error
         }
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                self.set(i, j, self.get(i, j) - other.get(i, j));
-            }
-        }
+        self.zip_assign(other, |x, y| x - y);
     }
 }
 
 impl Mul<LinNum> for LinMatrix {
     type Output = LinMatrix;
 
+    fn mul(mut self, other: LinNum) -> LinMatrix {
+        self *= other;
+        self
+    }
+}
+
+impl Mul<LinNum> for &LinMatrix {
+    type Output = LinMatrix;
+
     fn mul(self, other: LinNum) -> LinMatrix {
-        let mut result = LinMatrix::new(self.rows, self.cols);
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                result.set(i, j, self.get(i, j) * other);
-            }
-        }
-        result
+        self.map(|x| x * other)
     }
 }
 
 impl MulAssign<LinNum> for LinMatrix {
     fn mul_assign(&mut self, other: LinNum) {
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                self.set(i, j, self.get(i, j) * other);
-            }
+        for x in self.data.iter_mut() {
+            *x *= other;
         }
     }
 }
@@ -249,23 +379,24 @@ impl MulAssign<LinNum> for LinMatrix {
 impl Div<LinNum> for LinMatrix {
     type Output = LinMatrix;
 
+    fn div(mut self, other: LinNum) -> LinMatrix {
+        self /= other;
+        self
+    }
+}
+
+impl Div<LinNum> for &LinMatrix {
+    type Output = LinMatrix;
+
     fn div(self, other: LinNum) -> LinMatrix {
-        let mut result = LinMatrix::new(self.rows, self.cols);
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                result.set(i, j, self.get(i, j) / other);
-            }
-        }
-        result
+        self.map(|x| x / other)
     }
 }
 
 impl DivAssign<LinNum> for LinMatrix {
     fn div_assign(&mut self, other: LinNum) {
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                self.set(i, j, self.get(i, j) / other);
-            }
+        for x in self.data.iter_mut() {
+            *x /= other;
         }
     }
 }
@@ -273,33 +404,35 @@ impl DivAssign<LinNum> for LinMatrix {
 impl Mul<LinMatrix> for LinMatrix {
     type Output = Result<LinMatrix, MatrixError>;
     fn mul(self, other: LinMatrix) -> Result<LinMatrix, MatrixError> {
+        &self * &other
+    }
+}
+
+impl Mul<&LinMatrix> for &LinMatrix {
+    type Output = Result<LinMatrix, MatrixError>;
+    /// Multiplies two matrices with the blocked, multithreaded kernel of `gemm`.
+    fn mul(self, other: &LinMatrix) -> Result<LinMatrix, MatrixError> {
         if self.cols != other.rows {
             return Err(MatrixError::DimensionMismatch);
         }
-        let mut result = LinMatrix::new(self.rows, other.cols);
-        for i in 0..self.rows {
-            for j in 0..other.cols {
-                let mut sum = LinNum::new_real(0.0);
-                for k in 0..self.cols {
-                    sum += self.get(i, k) * other.get(k, j);
-                }
-                result.set(i, j, sum);
-            }
-        }
-        Ok(result)
+        Ok(gemm::multiply(self, other))
     }
 }
 
 impl std::fmt::Display for LinMatrix {
     fn fmt(&self, f: &mut std::fmt::Formatter) -> std::fmt::Result {
-        for i in 0..self.rows {
-            write!(f, "[ ")?;
-            for j in 0..self.cols {
-                write!(f, "{} ", self.get(i, j))?;
+        // Built in one buffer and handed over at once, as the formatter may be
+        // unbuffered.
+        use std::fmt::Write as _;
+        let mut text = String::with_capacity(self.data.len() * 8 + self.rows * 4);
+        for row in self.data.chunks(self.cols.max(1)).take(self.rows) {
+            text.push_str("[ ");
+            for num in row {
+                write!(text, "{} ", num)?;
             }
-            writeln!(f, "]")?;
+            text.push_str("]\n");
         }
-        Ok(())
+        f.write_str(&text)
     }
 }
 
@@ -356,6 +489,18 @@ mod tests {
         assert_eq!(result, matrix!([19.0, 22.0], [43.0, 50.0]));
     }
 
+    #[test]
+    fn test_from_vec_adopts_buffer() {
+        let data = vec![lnum!(1.0), lnum!(2.0), lnum!(3.0), lnum!(4.0)];
+        let pointer = data.as_ptr();
+        let matrix = LinMatrix::from_vec(2, 2, data).unwrap();
+        assert_eq!(matrix, matrix!([1.0, 2.0], [3.0, 4.0]));
+        assert_eq!(matrix.as_slice().as_ptr(), pointer);
+        let data = matrix.into_vec();
+        assert_eq!(data.as_ptr(), pointer);
+        assert_eq!(LinMatrix::from_vec(3, 2, vec![lnum!(1.0)]), Err(MatrixError::DimensionMismatch));
+    }
+
     #[test]
     fn test_mul_matrix_error() {
         let matrix1 = matrix!([1.0, 2.0], [3.0, 4.0]);
@@ -364,6 +509,77 @@ mod tests {
         assert_eq!(result, Err(MatrixError::DimensionMismatch));
     }
 
+    #[test]
+    fn test_ref_ops() {
+        let matrix1 = matrix!([1.0, 2.0], [3.0, 4.0]);
+        let matrix2 = matrix!([5.0, 6.0], [7.0, 8.0]);
+        assert_eq!(&matrix1 + &matrix2, Ok(matrix!([6.0, 8.0], [10.0, 12.0])));
+        assert_eq!(&matrix1 - &matrix2, Ok(matrix!([-4.0, -4.0], [-4.0, -4.0])));
+        assert_eq!(&matrix1 * lnum!(2.0), matrix!([2.0, 4.0], [6.0, 8.0]));
+        assert_eq!(&matrix1 / lnum!(2.0), matrix!([0.5, 1.0], [1.5, 2.0]));
+        assert_eq!(&matrix1 * &matrix2, Ok(matrix!([19.0, 22.0], [43.0, 50.0])));
+        assert_eq!(&matrix1 + &matrix!([1.0, 2.0]), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_assign_ops() {
+        let mut matrix = matrix!([1.0, 2.0], [3.0, 4.0]);
+        let other = matrix!([5.0, 6.0], [7.0, 8.0]);
+        matrix += &other;
+        assert_eq!(matrix, matrix!([6.0, 8.0], [10.0, 12.0]));
+        matrix -= &other;
+        matrix *= lnum!(3.0);
+        matrix /= lnum!(2.0);
+        assert_eq!(matrix, matrix!([1.5, 3.0], [4.5, 6.0]));
+        matrix.axpy(lnum!(-0.5), &other).unwrap();
+        assert_eq!(matrix, matrix!([-1.0, 0.0], [1.0, 2.0]));
+        assert_eq!(matrix.axpy(lnum!(1.0), &matrix!([1.0, 2.0])), Err(MatrixError::DimensionMismatch));
+    }
+
+    fn numbered(rows: usize, cols: usize) -> LinMatrix {
+        let mut matrix = LinMatrix::new(rows, cols);
+        for i in 0..rows * cols {
+            matrix.data[i] = lnum!(i as f64);
+        }
+        matrix
+    }
+
+    #[test]
+    fn test_transpose_tiled() {
+        let matrix = numbered(37, 21);
+        let transpose = matrix.transpose();
+        assert_eq!(transpose.dim(), (21, 37));
+        for i in 0..37 {
+            for j in 0..21 {
+                assert_eq!(transpose.get(j, i), matrix.get(i, j));
+                assert_eq!(matrix.t().get(j, i), matrix.get(i, j));
+            }
+        }
+        assert_eq!(transpose.transpose(), matrix);
+    }
+
+    #[test]
+    fn test_transpose_in_place() {
+        for (rows, cols) in [(37, 37), (1, 1), (5, 3)] {
+            let matrix = numbered(rows, cols);
+            let mut copy = matrix.clone();
+            copy.transpose_in_place();
+            assert_eq!(copy, matrix.transpose());
+        }
+    }
+
+    #[test]
+    fn test_transposed_view_mul() {
+        let a = numbered(6, 4);
+        let b = numbered(6, 3);
+        assert_eq!(a.t() * &b, &a.transpose() * &b);
+        assert_eq!(&b.transpose() * a.t(), &b.transpose() * &a.transpose());
+        assert_eq!(b.t() * a.t(), &b.transpose() * &a.transpose());
+        assert_eq!(a.t() * &a, &a.transpose() * &a);
+        assert_eq!(a.t() * a.t(), Err(MatrixError::DimensionMismatch));
+        assert_eq!(a.t().to_matrix(), a.transpose());
+    }
+
     #[test]
     fn test_index() {
         let matrix = matrix!([1.0, 2.0], [3.0, 4.0]);
@@ -0,0 +1,292 @@
+use crate::gemm;
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::stats::{self, Kernel};
+
+/// Columns factored per panel. Each panel is reduced with Householder
+/// reflections in place and then applied to the columns right of it at once,
+/// as three products through the blocked GEMM.
+const NB: usize = 32;
+
+/// The Householder QR factorization `A = Q * R` of an m x n matrix.
+///
+/// `Q` is the product `H_0 * H_1 * ...` of `min(m, n)` reflections
+/// `H_k = I - tau_k * v_k * v_k^T`. `R` is stored on and above the diagonal
+/// and each `v_k` below it, with its leading 1 left implicit. The
+/// factorization works on real numbers.
+///
+/// The factorization is computed once in O(m * n²) and can then be reused for
+/// any number of least-squares solves.
+#[derive(Debug, PartialEq, Clone)]
+pub struct QrDecomposition {
+    qr: Vec<f64>,
+    rows: usize,
+    cols: usize,
+    tau: Vec<f64>,
+}
+
+/// Computes the reflection `H_j` that zeroes column `j` below the diagonal,
+/// stores `v_j` in its place and applies `H_j` to the columns right of `j` up
+/// to `end`, the end of the panel. Returns `tau_j`.
+fn reflect(a: &mut [f64], m: usize, n: usize, j: usize, end: usize) -> f64 {
+    let alpha = a[j * n + j];
+    let tail: f64 = (j + 1..m).map(|i| a[i * n + j] * a[i * n + j]).sum();
+    if tail == 0.0 {
+        // The column is already reduced, H_j is the identity.
+        return 0.0;
+    }
+    let norm = (alpha * alpha + tail).sqrt();
+    let beta = if alpha >= 0.0 { -norm } else { norm };
+    let tau = (beta - alpha) / beta;
+    let scale = 1.0 / (alpha - beta);
+    for i in j + 1..m {
+        a[i * n + j] *= scale;
+    }
+    a[j * n + j] = beta;
+    for c in j + 1..end {
+        let w = tau * (a[j * n + c] + (j + 1..m).map(|i| a[i * n + j] * a[i * n + c]).sum::<f64>());
+        a[j * n + c] -= w;
+        for i in j + 1..m {
+            a[i * n + c] -= w * a[i * n + j];
+        }
+    }
+    tau
+}
+
+/// Applies the reflections of the `nb`-column panel starting at column `k` to
+/// the columns right of it, as `A2 -= V * (T^T * (V^T * A2))`, where
+/// `I - V * T * V^T` is the product of the reflections.
+fn update(a: &mut [f64], m: usize, n: usize, k: usize, nb: usize, tau: &[f64]) {
+    let rows = m - k;
+    let cols = n - k - nb;
+    // V with its unit diagonal and the zeros above it spelled out.
+    let mut v = vec![0.0; rows * nb];
+    for i in 0..rows {
+        for c in 0..nb.min(i + 1) {
+            v[i * nb + c] = if i == c { 1.0 } else { a[(k + i) * n + k + c] };
+        }
+    }
+    // T is upper triangular, column i is -tau_i * T * (V^T * v_i) over the columns before i.
+    let mut t = vec![0.0; nb * nb];
+    for i in 0..nb {
+        let z: Vec<f64> = (0..i).map(|c| (i..rows).map(|r| v[r * nb + c] * v[r * nb + i]).sum()).collect();
+        for r in 0..i {
+            t[r * nb + i] = -tau[i] * (r..i).map(|c| t[r * nb + c] * z[c]).sum::<f64>();
+        }
+        t[i * nb + i] = tau[i];
+    }
+    let a2 = k * n + k + nb;
+    let w = gemm::multiply_f64(&v, 1, nb, &a[a2..], n, 1, nb, rows, cols);
+    let tw = gemm::multiply_f64(&t, 1, nb, &w, cols, 1, nb, nb, cols);
+    let product = gemm::multiply_f64(&v, nb, 1, &tw, cols, 1, rows, nb, cols);
+    for (i, row) in product.chunks_exact(cols).enumerate() {
+        for (value, p) in a[a2 + i * n..a2 + i * n + cols].iter_mut().zip(row) {
+            *value -= p;
+        }
+    }
+}
+
+impl QrDecomposition {
+    /// Factors a matrix of any shape.
+    ///
+    /// The columns are reduced in panels whose reflections are accumulated in
+    /// the compact WY form `I - V * T * V^T`, so the rest of the matrix is
+    /// updated by matrix products.
+    pub fn new(matrix: &LinMatrix) -> QrDecomposition {
+        let _timer = stats::time(Kernel::MatrixQr);
+        let (m, n) = (matrix.rows, matrix.cols);
+        let mut qr: Vec<f64> = matrix.data.iter().map(|&x| f64::from(x)).collect();
+        let p = m.min(n);
+        let mut tau = vec![0.0; p];
+        for k in (0..p).step_by(NB) {
+            let end = (k + NB).min(p);
+            for j in k..end {
+                tau[j] = reflect(&mut qr, m, n, j, end);
+            }
+            if end < n {
+                update(&mut qr, m, n, k, end - k, &tau[k..end]);
+            }
+        }
+        QrDecomposition { qr, rows: m, cols: n, tau }
+    }
+
+    /// Returns the dimensions of the factored matrix as a tuple `(rows, cols)`.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    /// Applies `H_j` to the row-major block `x` of `width` columns.
+    fn apply(&self, j: usize, x: &mut [f64], width: usize) {
+        let tau = self.tau[j];
+        if tau == 0.0 {
+            return;
+        }
+        let n = self.cols;
+        let mut w = x[j * width..(j + 1) * width].to_vec();
+        for i in j + 1..self.rows {
+            let v = self.qr[i * n + j];
+            for (w, &x) in w.iter_mut().zip(&x[i * width..(i + 1) * width]) {
+                *w += v * x;
+            }
+        }
+        for (x, w) in x[j * width..(j + 1) * width].iter_mut().zip(w.iter_mut()) {
+            *w *= tau;
+            *x -= *w;
+        }
+        for i in j + 1..self.rows {
+            let v = self.qr[i * n + j];
+            for (x, &w) in x[i * width..(i + 1) * width].iter_mut().zip(&w) {
+                *x -= w * v;
+            }
+        }
+    }
+
+    /// Forms the first `min(m, n)` columns of `Q`.
+    ///
+    /// They are an orthonormal basis of the column space of a matrix of full
+    /// column rank, so this is also how a set of vectors is orthonormalized.
+    pub fn q(&self) -> LinMatrix {
+        let p = self.tau.len();
+        let mut x = vec![0.0; self.rows * p];
+        for i in 0..p {
+            x[i * p + i] = 1.0;
+        }
+        // Q * I = H_0 * (H_1 * ... (H_{p-1} * I)).
+        for j in (0..p).rev() {
+            self.apply(j, &mut x, p);
+        }
+        LinMatrix { rows: self.rows, cols: p, data: x.into_iter().map(LinNum::new_real).collect() }
+    }
+
+    /// Returns the `min(m, n)` x n upper triangular factor.
+    pub fn r(&self) -> LinMatrix {
+        let (p, n) = (self.tau.len(), self.cols);
+        let mut r = LinMatrix::new(p, n);
+        for i in 0..p {
+            for c in i..n {
+                r.data[i * n + c] = LinNum::new_real(self.qr[i * n + c]);
+            }
+        }
+        r
+    }
+
+    /// Replaces the row-major block `x` of `width` columns by the
+    /// least-squares solutions, left in its first `cols` rows.
+    fn substitute(&self, x: &mut [f64], width: usize) -> Result<(), MatrixError> {
+        let n = self.cols;
+        if self.rows < n {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        if (0..n).any(|i| self.qr[i * n + i] == 0.0) {
+            return Err(MatrixError::Singular);
+        }
+        for j in 0..n {
+            self.apply(j, x, width);
+        }
+        for i in (0..n).rev() {
+            for k in i + 1..n {
+                let r = self.qr[i * n + k];
+                let (top, bottom) = x.split_at_mut(k * width);
+                for (value, &xk) in top[i * width..(i + 1) * width].iter_mut().zip(&bottom[..width]) {
+                    *value -= r * xk;
+                }
+            }
+            let d = self.qr[i * n + i];
+            for value in &mut x[i * width..(i + 1) * width] {
+                *value /= d;
+            }
+        }
+        Ok(())
+    }
+
+    /// Solves the least-squares problem of minimizing `|A * x - b|`, which is
+    /// `A * x = b` for a square `A`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(x)` with the solution.
+    /// - `Err(MatrixError::DimensionMismatch)` if `b` does not have one element per row, or `A` has fewer rows than columns.
+    /// - `Err(MatrixError::Singular)` if `A` does not have full column rank.
+    pub fn solve(&self, b: &[LinNum]) -> Result<Vec<LinNum>, MatrixError> {
+        if b.len() != self.rows {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let mut x: Vec<f64> = b.iter().map(|&value| f64::from(value)).collect();
+        self.substitute(&mut x, 1)?;
+        Ok(x[..self.cols].iter().map(|&value| LinNum::new_real(value)).collect())
+    }
+
+    /// Solves the least-squares problem of every column of `b` at once.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(x)` with the solutions, one per column.
+    /// - `Err(MatrixError::DimensionMismatch)` if `b` does not have one row per row of `A`, or `A` has fewer rows than columns.
+    /// - `Err(MatrixError::Singular)` if `A` does not have full column rank.
+    pub fn solve_matrix(&self, b: &LinMatrix) -> Result<LinMatrix, MatrixError> {
+        if b.rows != self.rows {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let mut x: Vec<f64> = b.data.iter().map(|&value| f64::from(value)).collect();
+        self.substitute(&mut x, b.cols)?;
+        x.truncate(self.cols * b.cols);
+        Ok(LinMatrix { rows: self.cols, cols: b.cols, data: x.into_iter().map(LinNum::new_real).collect() })
+    }
+}
+
+impl LinMatrix {
+    /// Computes the Householder QR factorization of the matrix, see [`QrDecomposition`].
+    pub fn qr(&self) -> QrDecomposition {
+        QrDecomposition::new(self)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn filled(rows: usize, cols: usize, seed: usize) -> LinMatrix {
+        let data = (0..rows * cols).map(|i| LinNum::new_real((((i * i * 31 + i * 17 + seed) % 97) as f64 - 48.0) / 24.0)).collect();
+        LinMatrix::from_vec(rows, cols, data).unwrap()
+    }
+
+    fn assert_close(a: &LinMatrix, b: &LinMatrix) {
+        assert_eq!(a.dim(), b.dim());
+        for (x, y) in a.data.iter().zip(&b.data) {
+            assert!((f64::from(*x) - f64::from(*y)).abs() < 1e-9, "{} != {}", x, y);
+        }
+    }
+
+    #[test]
+    fn test_reconstructs_and_orthonormal() {
+        // Wider than a panel so the blocked update runs.
+        for &(m, n) in &[(5, 3), (3, 5), (80, 70)] {
+            let a = filled(m, n, m);
+            let qr = a.qr();
+            let q = qr.q();
+            assert_close(&(&q * &qr.r()).unwrap(), &a);
+            let p = m.min(n);
+            let mut identity = LinMatrix::new(p, p);
+            for i in 0..p {
+                identity.data[i * p + i] = LinNum::new_real(1.0);
+            }
+            assert_close(&(&q.transpose() * &q).unwrap(), &identity);
+        }
+    }
+
+    #[test]
+    fn test_least_squares() {
+        let a = filled(90, 40, 3);
+        let x: Vec<LinNum> = (0..40).map(|i| LinNum::new_real(i as f64)).collect();
+        let b = LinMatrix::from_vec(40, 1, x.clone()).unwrap();
+        let rhs = (&a * &b).unwrap();
+        let solved = a.qr().solve(&rhs.data).unwrap();
+        for (s, e) in solved.iter().zip(&x) {
+            assert!((f64::from(*s) - f64::from(*e)).abs() < 1e-9);
+        }
+        let solved = a.qr().solve_matrix(&rhs).unwrap();
+        assert_close(&solved, &b);
+        assert_eq!(a.qr().solve(&x), Err(MatrixError::DimensionMismatch));
+        assert_eq!(LinMatrix::new(3, 2).qr().solve(&rhs.data[..3]), Err(MatrixError::Singular));
+    }
+}
@@ -0,0 +1,267 @@
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::vector::LinVector;
+
+/// The relative magnitude under which a real entry counts as zero during
+/// elimination, scaled by the largest magnitude in the matrix and by its
+/// larger dimension. Rational entries are only zero when they are.
+pub const TOLERANCE: f64 = 1e-12;
+
+/// The reduced row echelon form of a matrix.
+///
+/// Row `k` has its leading 1 in column `pivots()[k]` for every `k` below the
+/// rank, and every row from the rank on is zero. The pivot columns of the
+/// original matrix are a basis of its column space and the non-pivot columns
+/// give a basis of its null space.
+#[derive(Debug, PartialEq, Clone)]
+pub struct RowEchelon {
+    rref: LinMatrix,
+    pivots: Vec<usize>,
+}
+
+fn is_zero(num: LinNum, tolerance: f64) -> bool {
+    if num.is_rational() {
+        f64::from(num) == 0.0
+    } else {
+        f64::from(num).abs() <= tolerance
+    }
+}
+
+impl RowEchelon {
+    /// Reduces a matrix in place by Gauss-Jordan elimination, taking over its storage.
+    ///
+    /// Each column is pivoted on the entry of largest magnitude among the rows
+    /// not pivoted yet, and eliminated from every other row, in
+    /// O(rows * cols * rank). Rational entries are eliminated exactly; real
+    /// ones under [`TOLERANCE`] are taken as zero.
+    pub fn new(mut matrix: LinMatrix) -> RowEchelon {
+        let (m, n) = (matrix.rows, matrix.cols);
+        let scale = matrix.data.iter().fold(0.0f64, |scale, &num| scale.max(f64::from(num).abs()));
+        let tolerance = TOLERANCE * scale * m.max(n) as f64;
+        let zero = LinNum::new_rational(0, 1);
+        let data = &mut matrix.data;
+        let mut pivots = Vec::with_capacity(m.min(n));
+
+        for c in 0..n {
+            let r = pivots.len();
+            if r == m {
+                break;
+            }
+            let mut pivot_row = r;
+            let mut pivot_abs = f64::from(data[r * n + c]).abs();
+            for i in r + 1..m {
+                let abs = f64::from(data[i * n + c]).abs();
+                if abs > pivot_abs {
+                    pivot_row = i;
+                    pivot_abs = abs;
+                }
+            }
+            if is_zero(data[pivot_row * n + c], tolerance) {
+                // Round-off left in a column without a pivot is cleared so the rows below the rank end up zero.
+                for i in r..m {
+                    data[i * n + c] = zero;
+                }
+                continue;
+            }
+            if pivot_row != r {
+                let (top, bottom) = data.split_at_mut(pivot_row * n);
+                top[r * n..(r + 1) * n].swap_with_slice(&mut bottom[..n]);
+            }
+
+            let pivot = data[r * n + c];
+            for value in &mut data[r * n + c + 1..(r + 1) * n] {
+                *value /= pivot;
+            }
+            data[r * n + c] = LinNum::new_rational(1, 1);
+            let pivot_row: Vec<LinNum> = data[r * n..(r + 1) * n].to_vec();
+            for (i, row) in data.chunks_exact_mut(n).enumerate() {
+                if i == r {
+                    continue;
+                }
+                let factor = row[c];
+                if !is_zero(factor, tolerance) {
+                    for j in c + 1..n {
+                        row[j] -= factor * pivot_row[j];
+                    }
+                }
+                row[c] = zero;
+            }
+            pivots.push(c);
+        }
+
+        RowEchelon { rref: matrix, pivots }
+    }
+
+    /// Returns the reduced matrix.
+    pub fn matrix(&self) -> &LinMatrix {
+        &self.rref
+    }
+
+    /// Returns the column of the leading 1 of every non-zero row.
+    pub fn pivots(&self) -> &[usize] {
+        &self.pivots
+    }
+
+    /// Returns the rank of the matrix.
+    pub fn rank(&self) -> usize {
+        self.pivots.len()
+    }
+
+    /// Calculates a basis of the null space.
+    ///
+    /// # Returns
+    ///
+    /// A `cols` x `cols - rank` matrix whose columns are a basis of the solutions of `A * x = 0`.
+    pub fn null_space(&self) -> LinMatrix {
+        let n = self.rref.cols;
+        let nullity = n - self.rank();
+        let mut basis = LinMatrix::new(n, nullity);
+        basis.data.fill(LinNum::new_rational(0, 1));
+        let free = (0..n).filter(|j| self.pivots.binary_search(j).is_err());
+        for (q, j) in free.enumerate() {
+            // The solution with free variable j set to 1 and the other free variables to 0.
+            basis.data[j * nullity + q] = LinNum::new_rational(1, 1);
+            for (p, &pivot) in self.pivots.iter().enumerate() {
+                basis.data[pivot * nullity + q] = LinNum::new_rational(0, 1) - self.rref.data[p * n + j];
+            }
+        }
+        basis
+    }
+}
+
+impl LinMatrix {
+    /// Computes the reduced row echelon form of the matrix, see [`RowEchelon`].
+    pub fn rref(&self) -> RowEchelon {
+        RowEchelon::new(self.clone())
+    }
+
+    /// Computes the reduced row echelon form of the matrix, reusing its storage.
+    pub fn into_rref(self) -> RowEchelon {
+        RowEchelon::new(self)
+    }
+
+    /// Calculates the rank of the matrix.
+    pub fn rank(&self) -> usize {
+        self.rref().rank()
+    }
+
+    /// Calculates a basis of the null space of the matrix, see [`RowEchelon::null_space`].
+    pub fn null_space(&self) -> LinMatrix {
+        self.rref().null_space()
+    }
+
+    /// Calculates a basis of the column space of the matrix.
+    ///
+    /// # Returns
+    ///
+    /// A `rows` x `rank` matrix holding copies of the pivot columns of the matrix.
+    pub fn column_space(&self) -> LinMatrix {
+        let rref = self.rref();
+        let rank = rref.rank();
+        let mut data = Vec::with_capacity(self.rows * rank);
+        for row in self.data.chunks_exact(self.cols.max(1)).take(self.rows) {
+            data.extend(rref.pivots.iter().map(|&pivot| row[pivot]));
+        }
+        LinMatrix { rows: self.rows, cols: rank, data }
+    }
+}
+
+impl LinVector {
+    /// Checks whether vectors are linearly independent with a single elimination.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(independent)` with whether no vector is a linear combination of the others.
+    /// - `Err(MatrixError::DimensionMismatch)` if the vectors differ in size.
+    pub fn are_independent(vectors: &[LinVector]) -> Result<bool, MatrixError> {
+        let size = vectors.first().map_or(0, LinVector::dim);
+        if vectors.iter().any(|vector| vector.dim() != size) {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        if vectors.len() > size {
+            return Ok(vectors.is_empty());
+        }
+        // One vector per row, so the rank counts the independent vectors.
+        let data = vectors.iter().flat_map(|vector| vector.numbers.iter().copied()).collect();
+        let rows = LinMatrix { rows: vectors.len(), cols: size, data };
+        Ok(rows.into_rref().rank() == vectors.len())
+    }
+
+    /// Finds coefficients `c` such that the sum of `c[i] * vectors[i]` is the vector.
+    ///
+    /// When the vectors are dependent the coefficients of the vectors that are
+    /// not needed are zero.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(Some(coefficients))` if the vector is in the span of `vectors`.
+    /// - `Ok(None)` if it is not.
+    /// - `Err(MatrixError::DimensionMismatch)` if a vector differs in size from this one.
+    pub fn combination_of(&self, vectors: &[LinVector]) -> Result<Option<LinVector>, MatrixError> {
+        let size = self.dim();
+        if vectors.iter().any(|vector| vector.dim() != size) {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        // The augmented matrix [v_0 ... v_{n-1} | self], one vector per column.
+        let n = vectors.len();
+        let mut data = Vec::with_capacity(size * (n + 1));
+        for i in 0..size {
+            data.extend(vectors.iter().map(|vector| vector.numbers[i]));
+            data.push(self.numbers[i]);
+        }
+        let rref = LinMatrix { rows: size, cols: n + 1, data }.into_rref();
+        if rref.pivots.last() == Some(&n) {
+            return Ok(None);
+        }
+        let mut coefficients = vec![LinNum::new_rational(0, 1); n];
+        for (p, &pivot) in rref.pivots.iter().enumerate() {
+            coefficients[pivot] = rref.rref.data[p * (n + 1) + n];
+        }
+        Ok(Some(LinVector::from_vec(coefficients)))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn thirds(rows: usize, cols: usize, values: &[i128]) -> LinMatrix {
+        let data = values.iter().map(|&value| LinNum::new_rational(value, 3)).collect();
+        LinMatrix::from_vec(rows, cols, data).unwrap()
+    }
+
+    #[test]
+    fn test_rref_exact() {
+        let matrix = thirds(3, 4, &[1, 2, 3, 4, 2, 4, 6, 8, 1, 0, 1, 0]);
+        let rref = matrix.rref();
+        assert_eq!(rref.pivots(), &[0, 1]);
+        assert_eq!(rref.matrix().get(1, 3), LinNum::new_rational(2, 1));
+        let null_space = rref.null_space();
+        assert_eq!(null_space.dim(), (4, 2));
+        let product = (&matrix * &null_space).unwrap();
+        assert!(product.data.iter().all(|&num| f64::from(num) == 0.0));
+        assert_eq!(matrix.column_space().dim(), (3, 2));
+    }
+
+    #[test]
+    fn test_rank_with_round_off() {
+        let matrix = matrix!([0.1, 0.2, 0.3], [0.4, 0.5, 0.6], [0.7, 0.8, 0.9]);
+        assert_eq!(matrix.rank(), 2);
+        assert_eq!(LinMatrix::new(3, 2).rank(), 0);
+        assert_eq!(matrix.null_space().dim(), (3, 1));
+    }
+
+    #[test]
+    fn test_independence_and_combinations() {
+        let u = LinVector::from_vec(vec![LinNum::new_rational(1, 1), LinNum::new_rational(0, 1), LinNum::new_rational(1, 1)]);
+        let v = LinVector::from_vec(vec![LinNum::new_rational(0, 1), LinNum::new_rational(1, 1), LinNum::new_rational(1, 1)]);
+        let w = &u + &v;
+        assert_eq!(LinVector::are_independent(&[u.clone(), v.clone()]), Ok(true));
+        assert_eq!(LinVector::are_independent(&[u.clone(), v.clone(), w.clone()]), Ok(false));
+        let target = LinVector::from_vec(vec![LinNum::new_rational(2, 1), LinNum::new_rational(3, 1), LinNum::new_rational(5, 1)]);
+        let coefficients = target.combination_of(&[u.clone(), v.clone(), w]).unwrap().unwrap();
+        assert_eq!(coefficients.as_slice()[..2], [LinNum::new_rational(2, 1), LinNum::new_rational(3, 1)]);
+        let outside = LinVector::from_vec(vec![LinNum::new_rational(1, 1); 3]);
+        assert_eq!(outside.combination_of(&[u, v]), Ok(None));
+    }
+}
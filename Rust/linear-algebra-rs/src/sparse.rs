@@ -0,0 +1,406 @@
+//! Compressed sparse matrices and their products with dense operands.
+//!
+//! Matrices are assembled from `(row, col, value)` triplets in a [`CooMatrix`]
+//! and compressed into a [`SparseMatrix`], which only stores the non-zero
+//! elements. Products of CSR matrices split their rows between threads with the
+//! same row-block scheduler as the dense multiplication.
+
+use crate::gemm;
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::stats::{self, Kernel};
+use crate::vector::LinVector;
+
+/// The compressed layouts a [`SparseMatrix`] can be stored in.
+#[derive(Debug, PartialEq, Eq, Clone, Copy)]
+pub enum SparseFormat {
+    /// Compressed rows: fast row access, products parallelize over rows.
+    Csr,
+    /// Compressed columns: fast column access.
+    Csc,
+}
+
+/// A sparse matrix under construction, as a list of `(row, col, value)` triplets.
+///
+/// Triplets can be pushed in any order and the same position may appear more
+/// than once, in which case the values are summed when the matrix is compressed.
+#[derive(Debug, PartialEq, Clone)]
+pub struct CooMatrix {
+    rows: usize,
+    cols: usize,
+    entries: Vec<(usize, usize, LinNum)>,
+}
+
+/// A compressed sparse matrix.
+///
+/// For [`SparseFormat::Csr`] the elements of row `i` are
+/// `values[offsets[i]..offsets[i + 1]]` and `indices` holds their columns; for
+/// [`SparseFormat::Csc`] the roles of rows and columns are swapped. The indices
+/// of every row (or column) are sorted and unique.
+#[derive(Debug, PartialEq, Clone)]
+pub struct SparseMatrix {
+    pub(crate) format: SparseFormat,
+    pub(crate) rows: usize,
+    pub(crate) cols: usize,
+    pub(crate) offsets: Vec<usize>,
+    pub(crate) indices: Vec<usize>,
+    pub(crate) values: Vec<LinNum>,
+}
+
+fn is_zero(value: LinNum) -> bool {
+    f64::from(value) == 0.0
+}
+
+/// Returns the number of threads a product with `work` multiply-adds should use.
+pub(crate) fn threads_for(work: usize) -> usize {
+    if work < gemm::PARALLEL_THRESHOLD {
+        1
+    } else {
+        std::thread::available_parallelism().map_or(1, |n| n.get())
+    }
+}
+
+impl CooMatrix {
+    /// Creates an empty triplet builder for a `rows` x `cols` matrix.
+    pub fn new(rows: usize, cols: usize) -> CooMatrix {
+        CooMatrix { rows, cols, entries: Vec::new() }
+    }
+
+    /// Appends a triplet, whose value is added to any earlier value at the same position.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the triplet was stored.
+    /// - `Err(MatrixError::DimensionMismatch)` if the position is outside the matrix.
+    pub fn push(&mut self, row: usize, col: usize, value: LinNum) -> Result<(), MatrixError> {
+        if row >= self.rows || col >= self.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.entries.push((row, col, value));
+        Ok(())
+    }
+
+    /// Returns the number of triplets pushed so far.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// Checks whether no triplet was pushed yet.
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Compresses the triplets, summing duplicates and dropping zeros.
+    pub fn to_sparse(&self, format: SparseFormat) -> SparseMatrix {
+        let major_len = match format {
+            SparseFormat::Csr => self.rows,
+            SparseFormat::Csc => self.cols,
+        };
+        let mut entries: Vec<(usize, usize, LinNum)> = self
+            .entries
+            .iter()
+            .map(|&(row, col, value)| match format {
+                SparseFormat::Csr => (row, col, value),
+                SparseFormat::Csc => (col, row, value),
+            })
+            .collect();
+        entries.sort_by_key(|&(major, minor, _)| (major, minor));
+
+        let mut matrix = SparseMatrix::empty(format, self.rows, self.cols, major_len);
+        let mut runs = entries.chunk_by(|a, b| a.0 == b.0 && a.1 == b.1).peekable();
+        for major in 0..major_len {
+            while let Some(run) = runs.next_if(|run| run[0].0 == major) {
+                let sum = run[1..].iter().fold(run[0].2, |sum, &(_, _, value)| sum + value);
+                if !is_zero(sum) {
+                    matrix.indices.push(run[0].1);
+                    matrix.values.push(sum);
+                }
+            }
+            matrix.offsets.push(matrix.values.len());
+        }
+        matrix
+    }
+}
+
+impl SparseMatrix {
+    /// Creates a matrix without elements whose offsets still have to be filled.
+    fn empty(format: SparseFormat, rows: usize, cols: usize, major_len: usize) -> SparseMatrix {
+        let mut offsets = Vec::with_capacity(major_len + 1);
+        offsets.push(0);
+        SparseMatrix { format, rows, cols, offsets, indices: Vec::new(), values: Vec::new() }
+    }
+
+    fn major_len(&self) -> usize {
+        self.offsets.len() - 1
+    }
+
+    /// Creates a sparse matrix from the non-zero elements of a dense one.
+    pub fn from_dense(matrix: &LinMatrix, format: SparseFormat) -> SparseMatrix {
+        let (major_len, minor_len) = match format {
+            SparseFormat::Csr => (matrix.rows, matrix.cols),
+            SparseFormat::Csc => (matrix.cols, matrix.rows),
+        };
+        let mut result = SparseMatrix::empty(format, matrix.rows, matrix.cols, major_len);
+        for i in 0..major_len {
+            for j in 0..minor_len {
+                let value = match format {
+                    SparseFormat::Csr => matrix.data[i * matrix.cols + j],
+                    SparseFormat::Csc => matrix.data[j * matrix.cols + i],
+                };
+                if !is_zero(value) {
+                    result.indices.push(j);
+                    result.values.push(value);
+                }
+            }
+            result.offsets.push(result.values.len());
+        }
+        result
+    }
+
+    /// Creates a dense copy of the matrix.
+    pub fn to_dense(&self) -> LinMatrix {
+        let mut result = LinMatrix::new(self.rows, self.cols);
+        for i in 0..self.major_len() {
+            for p in self.offsets[i]..self.offsets[i + 1] {
+                let (row, col) = match self.format {
+                    SparseFormat::Csr => (i, self.indices[p]),
+                    SparseFormat::Csc => (self.indices[p], i),
+                };
+                result.data[row * self.cols + col] = self.values[p];
+            }
+        }
+        result
+    }
+
+    /// Creates a copy of the matrix in the given layout.
+    pub fn to_format(&self, format: SparseFormat) -> SparseMatrix {
+        if format == self.format {
+            return self.clone();
+        }
+        // Counting transpose: walking the source in major order leaves every
+        // new row (column) sorted.
+        let minor_len = match self.format {
+            SparseFormat::Csr => self.cols,
+            SparseFormat::Csc => self.rows,
+        };
+        let mut offsets = vec![0; minor_len + 1];
+        for &j in &self.indices {
+            offsets[j + 1] += 1;
+        }
+        for j in 0..minor_len {
+            offsets[j + 1] += offsets[j];
+        }
+        let mut cursor = offsets.clone();
+        let mut indices = vec![0; self.nnz()];
+        let mut values = vec![LinNum::new_real(0.0); self.nnz()];
+        for i in 0..self.major_len() {
+            for p in self.offsets[i]..self.offsets[i + 1] {
+                let dst = &mut cursor[self.indices[p]];
+                indices[*dst] = i;
+                values[*dst] = self.values[p];
+                *dst += 1;
+            }
+        }
+        SparseMatrix { format, rows: self.rows, cols: self.cols, offsets, indices, values }
+    }
+
+    /// Returns the dimensions of the matrix as a tuple `(rows, cols)`.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    /// Returns the number of stored elements.
+    pub fn nnz(&self) -> usize {
+        self.values.len()
+    }
+
+    /// Returns the layout of the matrix.
+    pub fn format(&self) -> SparseFormat {
+        self.format
+    }
+
+    /// Returns the value at the specified row and column, 0 if it is not stored.
+    ///
+    /// # Panics
+    ///
+    /// This function panics if the position is outside the matrix.
+    pub fn get(&self, row: usize, col: usize) -> LinNum {
+        assert!(row < self.rows && col < self.cols, "index out of bounds");
+        let (major, minor) = match self.format {
+            SparseFormat::Csr => (row, col),
+            SparseFormat::Csc => (col, row),
+        };
+        let range = self.offsets[major]..self.offsets[major + 1];
+        match self.indices[range.clone()].binary_search(&minor) {
+            Ok(p) => self.values[range.start + p],
+            Err(_) => LinNum::new_real(0.0),
+        }
+    }
+
+    /// Multiplies the matrix by a dense vector.
+    ///
+    /// CSR matrices compute one row at a time and split the rows between threads
+    /// once the product is large enough; CSC matrices scatter column by column.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(vector)` with one element per row.
+    /// - `Err(MatrixError::DimensionMismatch)` if the vector does not have one element per column.
+    pub fn mul_vector(&self, vector: &LinVector) -> Result<LinVector, MatrixError> {
+        let _timer = stats::time(Kernel::SparseMul);
+        self.mul_vector_with_threads(vector, threads_for(self.nnz()))
+    }
+
+    fn mul_vector_with_threads(&self, vector: &LinVector, threads: usize) -> Result<LinVector, MatrixError> {
+        if vector.dim() != self.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let x = &vector.numbers;
+        let mut y = vec![LinNum::new_real(0.0); self.rows];
+        match self.format {
+            SparseFormat::Csr => {
+                gemm::for_each_row_block(&mut y, 1, threads, |row, block| {
+                    for (i, value) in block.iter_mut().enumerate() {
+                        for p in self.offsets[row + i]..self.offsets[row + i + 1] {
+                            *value += self.values[p] * x[self.indices[p]];
+                        }
+                    }
+                });
+            }
+            SparseFormat::Csc => {
+                for j in 0..self.cols {
+                    for p in self.offsets[j]..self.offsets[j + 1] {
+                        y[self.indices[p]] += self.values[p] * x[j];
+                    }
+                }
+            }
+        }
+        Ok(LinVector { numbers: y })
+    }
+
+    /// Multiplies the matrix by a dense matrix, parallelized over the rows of
+    /// the result like [`SparseMatrix::mul_vector`].
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(matrix)` with the dense product.
+    /// - `Err(MatrixError::DimensionMismatch)` if `b` does not have one row per column.
+    pub fn mul_dense(&self, b: &LinMatrix) -> Result<LinMatrix, MatrixError> {
+        let _timer = stats::time(Kernel::SparseMul);
+        self.mul_dense_with_threads(b, threads_for(self.nnz() * b.cols))
+    }
+
+    fn mul_dense_with_threads(&self, b: &LinMatrix, threads: usize) -> Result<LinMatrix, MatrixError> {
+        if b.rows != self.cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let n = b.cols;
+        let mut c = LinMatrix::new(self.rows, n);
+        match self.format {
+            SparseFormat::Csr => {
+                // Row i of C is the combination of the rows of B picked by row i of A.
+                gemm::for_each_row_block(&mut c.data, n, threads, |row, block| {
+                    for (i, c_row) in block.chunks_exact_mut(n).enumerate() {
+                        for p in self.offsets[row + i]..self.offsets[row + i + 1] {
+                            let b_row = &b.data[self.indices[p] * n..(self.indices[p] + 1) * n];
+                            for (value, &x) in c_row.iter_mut().zip(b_row) {
+                                *value += self.values[p] * x;
+                            }
+                        }
+                    }
+                });
+            }
+            SparseFormat::Csc => {
+                for k in 0..self.cols {
+                    let b_row = &b.data[k * n..(k + 1) * n];
+                    for p in self.offsets[k]..self.offsets[k + 1] {
+                        let c_row = &mut c.data[self.indices[p] * n..(self.indices[p] + 1) * n];
+                        for (value, &x) in c_row.iter_mut().zip(b_row) {
+                            *value += self.values[p] * x;
+                        }
+                    }
+                }
+            }
+        }
+        Ok(c)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn laplacian(n: usize) -> CooMatrix {
+        let mut coo = CooMatrix::new(n, n);
+        for i in 0..n {
+            coo.push(i, i, LinNum::new_rational(2, 1)).unwrap();
+            if i > 0 {
+                coo.push(i, i - 1, LinNum::new_rational(-1, 1)).unwrap();
+            }
+            if i + 1 < n {
+                coo.push(i, i + 1, LinNum::new_rational(-1, 1)).unwrap();
+            }
+        }
+        coo
+    }
+
+    #[test]
+    fn test_coo_duplicates_and_zeros() {
+        let mut coo = CooMatrix::new(2, 3);
+        coo.push(1, 2, LinNum::new_rational(1, 2)).unwrap();
+        coo.push(0, 1, LinNum::new_real(3.0)).unwrap();
+        coo.push(1, 2, LinNum::new_rational(1, 3)).unwrap();
+        coo.push(0, 0, LinNum::new_real(1.0)).unwrap();
+        coo.push(0, 0, LinNum::new_real(-1.0)).unwrap();
+        assert_eq!(coo.push(2, 0, LinNum::new_real(1.0)), Err(MatrixError::DimensionMismatch));
+        for format in [SparseFormat::Csr, SparseFormat::Csc] {
+            let sparse = coo.to_sparse(format);
+            assert_eq!(sparse.nnz(), 2);
+            assert_eq!(sparse.get(1, 2), LinNum::new_rational(5, 6));
+            assert_eq!(sparse.get(0, 1), LinNum::new_real(3.0));
+            assert_eq!(sparse.get(0, 0), LinNum::new_real(0.0));
+        }
+    }
+
+    #[test]
+    fn test_dense_round_trip() {
+        let coo = laplacian(7);
+        let csr = coo.to_sparse(SparseFormat::Csr);
+        let csc = coo.to_sparse(SparseFormat::Csc);
+        let dense = csr.to_dense();
+        assert_eq!(csc.to_dense(), dense);
+        assert_eq!(SparseMatrix::from_dense(&dense, SparseFormat::Csr), csr);
+        assert_eq!(SparseMatrix::from_dense(&dense, SparseFormat::Csc), csc);
+        assert_eq!(csr.to_format(SparseFormat::Csc), csc);
+        assert_eq!(csc.to_format(SparseFormat::Csr), csr);
+    }
+
+    #[test]
+    fn test_mul_vector() {
+        let n = 1000;
+        let csr = laplacian(n).to_sparse(SparseFormat::Csr);
+        let x = LinVector { numbers: (0..n).map(|i| LinNum::new_rational((i * i) as i128, 1)).collect() };
+        let y = csr.mul_vector(&x).unwrap();
+        assert_eq!(y, csr.mul_vector_with_threads(&x, 4).unwrap());
+        assert_eq!(y, csr.to_format(SparseFormat::Csc).mul_vector(&x).unwrap());
+        // The second difference of i^2 is -2 inside the grid.
+        assert_eq!(f64::from(y.numbers[500]), -2.0);
+        assert_eq!(csr.mul_vector(&LinVector { numbers: vec![] }), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_mul_dense() {
+        let coo = laplacian(90);
+        let csr = coo.to_sparse(SparseFormat::Csr);
+        let mut b = LinMatrix::new(90, 5);
+        for i in 0..90 {
+            for j in 0..5 {
+                b.set(i, j, LinNum::new_real(((i * 7 + j * 3) % 11) as f64));
+            }
+        }
+        let expected = (&csr.to_dense() * &b).unwrap();
+        assert_eq!(csr.mul_dense(&b), Ok(expected.clone()));
+        assert_eq!(csr.mul_dense_with_threads(&b, 3), Ok(expected.clone()));
+        assert_eq!(coo.to_sparse(SparseFormat::Csc).mul_dense(&b), Ok(expected));
+    }
+}
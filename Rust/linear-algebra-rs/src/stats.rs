@@ -0,0 +1,227 @@
+//! Opt-in instrumentation of the hot paths.
+//!
+//! The hooks are compiled in with the `stats` cargo feature. Without it they
+//! are empty inline functions, so a regular build pays nothing, and the
+//! reading functions report zeros. The counters and kernels mirror those of
+//! the C library's `stats.h`.
+//!
+//! Counters are relaxed atomics, so they stay exact when the kernels run on
+//! several threads.
+
+use std::time::Duration;
+
+/// The events that are counted, each with the bytes it allocated.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Counter {
+    /// A rational operand was converted to a real because the other one was real.
+    RealPromotion,
+    /// The storage of a new matrix was allocated.
+    MatrixAlloc,
+}
+
+/// The kernels whose calls are timed.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Kernel {
+    /// [`LinVector::dot_product`](crate::vector::LinVector::dot_product) and everything built on it.
+    VectorDot,
+    /// Dense matrix products.
+    MatrixMul,
+    /// [`LinMatrix::transpose`](crate::matrix::LinMatrix::transpose) and its in-place variant.
+    MatrixTranspose,
+    /// LU factorizations.
+    MatrixLu,
+    /// Householder QR factorizations.
+    MatrixQr,
+    /// Cholesky factorizations.
+    MatrixCholesky,
+    /// Dense symmetric eigendecompositions.
+    MatrixEigen,
+    /// Sparse matrix-vector and matrix-matrix products.
+    SparseMul,
+    /// Krylov solves, from the first iteration to the last.
+    KrylovSolve,
+    /// Lanczos eigenvalue and singular value iterations.
+    Lanczos,
+    /// Products, factorizations and solves of [`MatrixBatch`](crate::batch::MatrixBatch).
+    MatrixBatch,
+}
+
+const COUNTERS: usize = 2;
+const KERNELS: usize = 11;
+
+/// A function called after every timed kernel call with its duration.
+pub type Trace = fn(Kernel, Duration);
+
+/// A snapshot of everything recorded since the last [`reset`].
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct Stats {
+    counts: [u64; COUNTERS],
+    bytes: [u64; COUNTERS],
+    calls: [u64; KERNELS],
+    nanoseconds: [u64; KERNELS],
+}
+
+impl Stats {
+    /// Returns the number of events recorded for a counter.
+    pub fn count(&self, counter: Counter) -> u64 {
+        self.counts[counter as usize]
+    }
+
+    /// Returns the bytes allocated by the events of a counter.
+    pub fn bytes(&self, counter: Counter) -> u64 {
+        self.bytes[counter as usize]
+    }
+
+    /// Returns the number of calls of a kernel.
+    pub fn calls(&self, kernel: Kernel) -> u64 {
+        self.calls[kernel as usize]
+    }
+
+    /// Returns the total duration of the calls of a kernel.
+    pub fn time(&self, kernel: Kernel) -> Duration {
+        Duration::from_nanos(self.nanoseconds[kernel as usize])
+    }
+}
+
+#[cfg(feature = "stats")]
+mod imp {
+    use super::{Counter, Kernel, Stats, Trace, COUNTERS, KERNELS};
+    use std::sync::atomic::{AtomicU64, Ordering::Relaxed};
+    use std::sync::RwLock;
+    use std::time::Instant;
+
+    #[allow(clippy::declare_interior_mutable_const)]
+    const ZERO: AtomicU64 = AtomicU64::new(0);
+    static COUNTS: [AtomicU64; COUNTERS] = [ZERO; COUNTERS];
+    static BYTES: [AtomicU64; COUNTERS] = [ZERO; COUNTERS];
+    static CALLS: [AtomicU64; KERNELS] = [ZERO; KERNELS];
+    static NANOSECONDS: [AtomicU64; KERNELS] = [ZERO; KERNELS];
+    static TRACE: RwLock<Option<Trace>> = RwLock::new(None);
+
+    pub fn snapshot() -> Stats {
+        let load = |values: &[AtomicU64]| -> Vec<u64> { values.iter().map(|v| v.load(Relaxed)).collect() };
+        Stats {
+            counts: load(&COUNTS).try_into().unwrap(),
+            bytes: load(&BYTES).try_into().unwrap(),
+            calls: load(&CALLS).try_into().unwrap(),
+            nanoseconds: load(&NANOSECONDS).try_into().unwrap(),
+        }
+    }
+
+    pub fn reset() {
+        for value in COUNTS.iter().chain(&BYTES).chain(&CALLS).chain(&NANOSECONDS) {
+            value.store(0, Relaxed);
+        }
+    }
+
+    pub fn set_trace(trace: Option<Trace>) {
+        *TRACE.write().unwrap_or_else(|e| e.into_inner()) = trace;
+    }
+
+    #[inline]
+    pub fn record(counter: Counter, bytes: usize) {
+        COUNTS[counter as usize].fetch_add(1, Relaxed);
+        if bytes != 0 {
+            BYTES[counter as usize].fetch_add(bytes as u64, Relaxed);
+        }
+    }
+
+    pub struct Timer {
+        kernel: Kernel,
+        start: Instant,
+    }
+
+    #[inline]
+    pub fn time(kernel: Kernel) -> Timer {
+        Timer { kernel, start: Instant::now() }
+    }
+
+    impl Drop for Timer {
+        fn drop(&mut self) {
+            let elapsed = self.start.elapsed();
+            CALLS[self.kernel as usize].fetch_add(1, Relaxed);
+            NANOSECONDS[self.kernel as usize].fetch_add(elapsed.as_nanos() as u64, Relaxed);
+            if let Some(trace) = *TRACE.read().unwrap_or_else(|e| e.into_inner()) {
+                trace(self.kernel, elapsed);
+            }
+        }
+    }
+}
+
+#[cfg(not(feature = "stats"))]
+mod imp {
+    use super::{Counter, Kernel, Stats, Trace};
+
+    pub fn snapshot() -> Stats {
+        Stats::default()
+    }
+
+    pub fn reset() {}
+
+    pub fn set_trace(_trace: Option<Trace>) {}
+
+    #[inline(always)]
+    pub fn record(_counter: Counter, _bytes: usize) {}
+
+    pub struct Timer;
+
+    #[inline(always)]
+    pub fn time(_kernel: Kernel) -> Timer {
+        Timer
+    }
+}
+
+/// Takes a snapshot of the statistics, all zeros without the `stats` feature.
+pub fn snapshot() -> Stats {
+    imp::snapshot()
+}
+
+/// Sets every statistic back to zero.
+pub fn reset() {
+    imp::reset()
+}
+
+/// Installs the function called after every timed kernel call, `None` to remove it.
+pub fn set_trace(trace: Option<Trace>) {
+    imp::set_trace(trace)
+}
+
+/// Records an event of `counter` that allocated `bytes`.
+#[inline(always)]
+pub(crate) fn record(counter: Counter, bytes: usize) {
+    imp::record(counter, bytes)
+}
+
+/// Times a kernel call until the returned guard is dropped.
+#[inline(always)]
+pub(crate) fn time(kernel: Kernel) -> imp::Timer {
+    imp::time(kernel)
+}
+
+#[cfg(all(test, feature = "stats"))]
+mod tests {
+    use super::*;
+    use crate::linnum::LinNum;
+    use crate::matrix::LinMatrix;
+
+    // The statistics are global, so everything is checked in one test to keep
+    // the other tests of this module from interfering.
+    #[test]
+    fn test_records_counters_and_kernels() {
+        static TRACED: std::sync::atomic::AtomicU64 = std::sync::atomic::AtomicU64::new(0);
+        set_trace(Some(|_, _| {
+            TRACED.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+        }));
+        let before = snapshot();
+        let a = LinMatrix::new(4, 4);
+        let _ = (&a * &a).unwrap();
+        let _ = LinNum::new_rational(1, 2) + LinNum::new_real(0.5);
+        let after = snapshot();
+        set_trace(None);
+        assert!(after.count(Counter::MatrixAlloc) >= before.count(Counter::MatrixAlloc) + 2);
+        assert!(after.bytes(Counter::MatrixAlloc) >= before.bytes(Counter::MatrixAlloc) + 2 * 16 * std::mem::size_of::<LinNum>() as u64);
+        assert!(after.count(Counter::RealPromotion) > before.count(Counter::RealPromotion));
+        assert!(after.calls(Kernel::MatrixMul) > before.calls(Kernel::MatrixMul));
+        assert!(TRACED.load(std::sync::atomic::Ordering::Relaxed) >= 1);
+    }
+}
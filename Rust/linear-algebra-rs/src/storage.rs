@@ -0,0 +1,458 @@
+//! Binary storage of vectors and matrices, with zero-copy loading.
+//!
+//! A file is a 64-byte header followed by the elements in row-major order in
+//! the in-memory layout of [`LinNum`], so [`MappedFile`] can map a file and
+//! hand out views of its elements without reading or converting them. The
+//! header is the one of the C library's `storage.h`, with the element layout
+//! recorded as a `LinNum`; files are only read back by builds with the same
+//! byte order and element layout.
+
+use crate::linnum::LinNum;
+use crate::matrix::LinMatrix;
+use crate::vector::LinVector;
+use crate::view::{MatrixView, VectorView};
+use std::fs::File;
+use std::io::{self, BufWriter, Read, Write};
+use std::mem::{align_of, size_of, MaybeUninit};
+use std::path::Path;
+
+const MAGIC: [u8; 8] = *b"LINALGB\0";
+const VERSION: u16 = 1;
+const BYTE_ORDER: u32 = 0x0102_0304;
+const HEADER_SIZE: usize = 64;
+const SHAPE_VECTOR: u16 = 1;
+const SHAPE_MATRIX: u16 = 2;
+const ELEMENT_LINNUM: u16 = 2;
+/// The precision of real numbers, recorded for the C readers.
+const PRECISION: u16 = 64;
+/// Elements encoded per write.
+const CHUNK: usize = 4096;
+
+/// Bytes of one element: a `u64` tag, then either an `f64` at offset 8 or two
+/// `i128` at offsets 16 and 32.
+const ELEMENT_SIZE: usize = 48;
+const TAG_RATIONAL: u64 = 0;
+const TAG_REAL: u64 = 1;
+
+const _: () = assert!(size_of::<LinNum>() == ELEMENT_SIZE && align_of::<LinNum>() <= HEADER_SIZE);
+
+#[derive(Debug, Clone, Copy)]
+struct Header {
+    shape: u16,
+    rows: usize,
+    cols: usize,
+}
+
+impl Header {
+    fn encode(&self) -> [u8; HEADER_SIZE] {
+        let mut bytes = [0u8; HEADER_SIZE];
+        bytes[0..8].copy_from_slice(&MAGIC);
+        bytes[8..12].copy_from_slice(&BYTE_ORDER.to_ne_bytes());
+        bytes[12..14].copy_from_slice(&VERSION.to_ne_bytes());
+        bytes[14..16].copy_from_slice(&self.shape.to_ne_bytes());
+        bytes[16..18].copy_from_slice(&ELEMENT_LINNUM.to_ne_bytes());
+        bytes[18..20].copy_from_slice(&PRECISION.to_ne_bytes());
+        bytes[20..24].copy_from_slice(&(ELEMENT_SIZE as u32).to_ne_bytes());
+        bytes[24..32].copy_from_slice(&(self.rows as u64).to_ne_bytes());
+        bytes[32..40].copy_from_slice(&(self.cols as u64).to_ne_bytes());
+        bytes[40..48].copy_from_slice(&(HEADER_SIZE as u64).to_ne_bytes());
+        bytes
+    }
+
+    /// Decodes and checks a header, given the length of the whole file.
+    fn decode(bytes: &[u8], length: u64) -> io::Result<Header> {
+        let u16_at = |i: usize| u16::from_ne_bytes([bytes[i], bytes[i + 1]]);
+        let u32_at = |i: usize| u32::from_ne_bytes(bytes[i..i + 4].try_into().unwrap());
+        let u64_at = |i: usize| u64::from_ne_bytes(bytes[i..i + 8].try_into().unwrap());
+        if bytes.len() < HEADER_SIZE || bytes[0..8] != MAGIC {
+            return Err(invalid("not a linstorage file"));
+        }
+        if u32_at(8) != BYTE_ORDER {
+            return Err(invalid("written with another byte order"));
+        }
+        if u16_at(12) != VERSION {
+            return Err(invalid("unsupported version"));
+        }
+        let shape = u16_at(14);
+        if shape != SHAPE_VECTOR && shape != SHAPE_MATRIX {
+            return Err(invalid("unknown shape"));
+        }
+        if u16_at(16) != ELEMENT_LINNUM || u32_at(20) as usize != ELEMENT_SIZE {
+            return Err(invalid("elements of another layout"));
+        }
+        if u64_at(40) != HEADER_SIZE as u64 {
+            return Err(invalid("misaligned elements"));
+        }
+        let (rows, cols) = (u64_at(24), u64_at(32));
+        let size = rows.checked_mul(cols).and_then(|n| n.checked_mul(ELEMENT_SIZE as u64)).filter(|&n| n <= isize::MAX as u64);
+        match size {
+            None => Err(invalid("too large")),
+            Some(size) if length < HEADER_SIZE as u64 + size => Err(invalid("truncated")),
+            Some(_) => Ok(Header { shape, rows: rows as usize, cols: cols as usize }),
+        }
+    }
+}
+
+fn invalid(message: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, message)
+}
+
+fn encode(value: &LinNum, out: &mut [u8]) {
+    out.fill(0);
+    match value.rational_parts() {
+        Some((num, den)) => {
+            out[0..8].copy_from_slice(&TAG_RATIONAL.to_ne_bytes());
+            out[16..32].copy_from_slice(&num.to_ne_bytes());
+            out[32..48].copy_from_slice(&den.to_ne_bytes());
+        }
+        None => {
+            out[0..8].copy_from_slice(&TAG_REAL.to_ne_bytes());
+            out[8..16].copy_from_slice(&f64::from(*value).to_ne_bytes());
+        }
+    }
+}
+
+/// Checks that every element of `bytes` is a real or a rational with a
+/// positive denominator, so the bytes can be used as `LinNum`s.
+fn check_elements(bytes: &[u8]) -> io::Result<()> {
+    for element in bytes.chunks_exact(ELEMENT_SIZE) {
+        let valid = match u64::from_ne_bytes(element[0..8].try_into().unwrap()) {
+            TAG_REAL => true,
+            TAG_RATIONAL => i128::from_ne_bytes(element[32..48].try_into().unwrap()) > 0,
+            _ => false,
+        };
+        if !valid {
+            return Err(invalid("invalid element"));
+        }
+    }
+    Ok(())
+}
+
+/// Writes a file through a zeroed buffer, so padding bytes are written as zeros.
+fn save(path: &Path, header: Header, data: &[LinNum]) -> io::Result<()> {
+    let mut file = BufWriter::new(File::create(path)?);
+    file.write_all(&header.encode())?;
+    let mut buffer = vec![0u8; CHUNK * ELEMENT_SIZE];
+    for chunk in data.chunks(CHUNK) {
+        for (value, out) in chunk.iter().zip(buffer.chunks_exact_mut(ELEMENT_SIZE)) {
+            encode(value, out);
+        }
+        file.write_all(&buffer[..chunk.len() * ELEMENT_SIZE])?;
+    }
+    file.flush()
+}
+
+/// Reads a file straight into the storage of a new vector of elements.
+fn load(path: &Path) -> io::Result<(Header, Vec<LinNum>)> {
+    let mut file = File::open(path)?;
+    let length = file.metadata()?.len();
+    let mut bytes = [0u8; HEADER_SIZE];
+    file.read_exact(&mut bytes).map_err(|_| invalid("not a linstorage file"))?;
+    let header = Header::decode(&bytes, length)?;
+    let n = header.rows * header.cols;
+    let mut data: Vec<MaybeUninit<LinNum>> = Vec::with_capacity(n);
+    // SAFETY: the capacity holds `n` elements of `ELEMENT_SIZE` bytes, which
+    // are written before they are read.
+    let raw = unsafe {
+        std::ptr::write_bytes(data.as_mut_ptr(), 0, n);
+        std::slice::from_raw_parts_mut(data.as_mut_ptr() as *mut u8, n * ELEMENT_SIZE)
+    };
+    file.read_exact(raw)?;
+    check_elements(raw)?;
+    // SAFETY: every element was read and has a valid tag.
+    let data = unsafe {
+        data.set_len(n);
+        let mut data = std::mem::ManuallyDrop::new(data);
+        Vec::from_raw_parts(data.as_mut_ptr() as *mut LinNum, n, data.capacity())
+    };
+    Ok((header, data))
+}
+
+impl LinMatrix {
+    /// Writes the matrix to a binary file, replacing it.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the file was written.
+    /// - `Err(error)` if it could not be.
+    pub fn save<P: AsRef<Path>>(&self, path: P) -> io::Result<()> {
+        save(path.as_ref(), Header { shape: SHAPE_MATRIX, rows: self.rows, cols: self.cols }, &self.data)
+    }
+
+    /// Reads a matrix written by [`LinMatrix::save`], with a single read into
+    /// the storage of the matrix.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(matrix)` with the matrix.
+    /// - `Err(error)` if the file could not be read or does not hold a matrix of this build.
+    pub fn load<P: AsRef<Path>>(path: P) -> io::Result<LinMatrix> {
+        let (header, data) = load(path.as_ref())?;
+        if header.shape != SHAPE_MATRIX {
+            return Err(invalid("not a matrix"));
+        }
+        Ok(LinMatrix { rows: header.rows, cols: header.cols, data })
+    }
+}
+
+impl LinVector {
+    /// Writes the vector to a binary file, replacing it.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the file was written.
+    /// - `Err(error)` if it could not be.
+    pub fn save<P: AsRef<Path>>(&self, path: P) -> io::Result<()> {
+        save(path.as_ref(), Header { shape: SHAPE_VECTOR, rows: self.numbers.len(), cols: 1 }, &self.numbers)
+    }
+
+    /// Reads a vector written by [`LinVector::save`], with a single read into
+    /// the storage of the vector.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(vector)` with the vector.
+    /// - `Err(error)` if the file could not be read or does not hold a vector of this build.
+    pub fn load<P: AsRef<Path>>(path: P) -> io::Result<LinVector> {
+        let (header, numbers) = load(path.as_ref())?;
+        if header.shape != SHAPE_VECTOR {
+            return Err(invalid("not a vector"));
+        }
+        Ok(LinVector { numbers })
+    }
+}
+
+#[cfg(all(unix, target_pointer_width = "64"))]
+mod sys {
+    use std::os::raw::{c_int, c_void};
+
+    pub const PROT_READ: c_int = 1;
+    pub const MAP_PRIVATE: c_int = 2;
+    pub const MAP_FAILED: *mut c_void = !0 as *mut c_void;
+
+    extern "C" {
+        pub fn mmap(addr: *mut c_void, len: usize, prot: c_int, flags: c_int, fd: c_int, offset: i64) -> *mut c_void;
+        pub fn munmap(addr: *mut c_void, len: usize) -> c_int;
+    }
+}
+
+enum Backing {
+    #[cfg(all(unix, target_pointer_width = "64"))]
+    Mapped { base: *mut u8, length: usize },
+    #[cfg_attr(all(unix, target_pointer_width = "64"), allow(dead_code))]
+    Owned(Vec<LinNum>),
+}
+
+/// A vector or matrix file mapped into memory.
+///
+/// Opening a file checks only its header and copies nothing; the pages are
+/// read by the OS as the views touch them, and [`MappedFile::check`] validates
+/// a range of elements on demand. Where mmap is not available the file is read
+/// into memory, and checked, instead.
+pub struct MappedFile {
+    header: Header,
+    backing: Backing,
+}
+
+// SAFETY: the mapping is read-only and owned by the `MappedFile`.
+unsafe impl Send for MappedFile {}
+unsafe impl Sync for MappedFile {}
+
+impl MappedFile {
+    /// Maps a file written by [`LinMatrix::save`] or [`LinVector::save`].
+    ///
+    /// # Safety
+    ///
+    /// The elements are used in place without being read first, so while the
+    /// `MappedFile` lives:
+    ///
+    /// - the file must not be truncated or modified, by this or any other
+    ///   process, or reading the elements may fault or see invalid values;
+    /// - every element that is read must be a valid `LinNum`. This holds for
+    ///   files written by `save`; any other file must pass
+    ///   [`MappedFile::check`] over a range before that range is read.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(file)` with the mapping.
+    /// - `Err(error)` if the file could not be mapped or its header does not match this build.
+    #[cfg(all(unix, target_pointer_width = "64"))]
+    pub unsafe fn open<P: AsRef<Path>>(path: P) -> io::Result<MappedFile> {
+        use std::os::unix::io::AsRawFd;
+        let file = File::open(path)?;
+        let length = usize::try_from(file.metadata()?.len()).map_err(|_| invalid("too large"))?;
+        if length < HEADER_SIZE {
+            return Err(invalid("not a linstorage file"));
+        }
+        // SAFETY: a private read-only mapping of the whole file; it is
+        // unmapped on drop and never outlives the `MappedFile`.
+        let base = unsafe { sys::mmap(std::ptr::null_mut(), length, sys::PROT_READ, sys::MAP_PRIVATE, file.as_raw_fd(), 0) };
+        if base == sys::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        let mut mapped = MappedFile {
+            header: Header { shape: SHAPE_VECTOR, rows: 0, cols: 0 },
+            backing: Backing::Mapped { base: base as *mut u8, length },
+        };
+        // SAFETY: the mapping is `length` bytes long.
+        let bytes = unsafe { std::slice::from_raw_parts(base as *const u8, length) };
+        mapped.header = Header::decode(&bytes[..HEADER_SIZE], length as u64)?;
+        Ok(mapped)
+    }
+
+    /// Reads a file written by [`LinMatrix::save`] or [`LinVector::save`] into
+    /// memory, as mmap is not available on this target.
+    ///
+    /// # Safety
+    ///
+    /// None beyond the contract of the mapped `open`, which this target does
+    /// not need: every element is read and checked here.
+    #[cfg(not(all(unix, target_pointer_width = "64")))]
+    pub unsafe fn open<P: AsRef<Path>>(path: P) -> io::Result<MappedFile> {
+        let (header, data) = load(path.as_ref())?;
+        Ok(MappedFile { header, backing: Backing::Owned(data) })
+    }
+
+    /// Checks that `count` elements from `start`, in row-major order, are all
+    /// valid, reading only the pages that hold them.
+    ///
+    /// # Returns
+    ///
+    /// `false` if an element is invalid or the range is past the end.
+    pub fn check(&self, start: usize, count: usize) -> bool {
+        let size = self.header.rows * self.header.cols;
+        if start > size || count > size - start {
+            return false;
+        }
+        match &self.backing {
+            #[cfg(all(unix, target_pointer_width = "64"))]
+            Backing::Mapped { base, .. } => {
+                // SAFETY: the range lies within the mapping and is read as bytes.
+                let bytes = unsafe { std::slice::from_raw_parts(base.add(HEADER_SIZE + start * ELEMENT_SIZE), count * ELEMENT_SIZE) };
+                check_elements(bytes).is_ok()
+            }
+            Backing::Owned(_) => true,
+        }
+    }
+
+    /// Returns the number of rows and columns; a vector is a single column.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.header.rows, self.header.cols)
+    }
+
+    /// Returns the elements in row-major order.
+    pub fn as_slice(&self) -> &[LinNum] {
+        match &self.backing {
+            #[cfg(all(unix, target_pointer_width = "64"))]
+            // SAFETY: the elements start at a page-aligned base plus
+            // `HEADER_SIZE`, and the contract of `open` makes them valid.
+            Backing::Mapped { base, .. } => unsafe {
+                std::slice::from_raw_parts(base.add(HEADER_SIZE) as *const LinNum, self.header.rows * self.header.cols)
+            },
+            Backing::Owned(data) => data,
+        }
+    }
+
+    /// Returns a view of the elements of a vector file, `None` for a matrix file.
+    pub fn vector(&self) -> Option<VectorView<'_>> {
+        (self.header.shape == SHAPE_VECTOR).then(|| VectorView::from_slice(self.as_slice()))
+    }
+
+    /// Returns a view of the elements as a matrix.
+    pub fn matrix(&self) -> MatrixView<'_> {
+        MatrixView { data: self.as_slice(), rows: self.header.rows, cols: self.header.cols, row_stride: self.header.cols, col_stride: 1 }
+    }
+}
+
+impl Drop for MappedFile {
+    fn drop(&mut self) {
+        #[cfg(all(unix, target_pointer_width = "64"))]
+        if let Backing::Mapped { base, length } = self.backing {
+            // SAFETY: the mapping was made by `open` and no view outlives `self`.
+            unsafe {
+                sys::munmap(base as *mut _, length);
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn path(name: &str) -> std::path::PathBuf {
+        std::env::temp_dir().join(format!("linear-algebra-rs-{}-{name}", std::process::id()))
+    }
+
+    fn sample() -> LinMatrix {
+        let mut m = LinMatrix::new(3, 4);
+        for i in 0..3 {
+            for j in 0..4 {
+                let value = if (i + j) % 2 == 0 { LinNum::new_rational(i as i128 + 1, j as i128 + 2) } else { LinNum::new_real(i as f64 * 0.5 - j as f64) };
+                m.set(i, j, value);
+            }
+        }
+        m.set(2, 3, LinNum::new_rational(i128::MAX, 7));
+        m
+    }
+
+    #[test]
+    fn test_matrix_round_trip() {
+        let m = sample();
+        let file = path("matrix");
+        m.save(&file).unwrap();
+        assert_eq!(LinMatrix::load(&file).unwrap(), m);
+        let mapped = unsafe { MappedFile::open(&file) }.unwrap();
+        assert_eq!(mapped.dim(), (3, 4));
+        assert_eq!(mapped.as_slice(), &m.data[..]);
+        assert_eq!(mapped.matrix().t().to_matrix(), m.transpose());
+        assert!(mapped.vector().is_none());
+        assert!(LinVector::load(&file).is_err());
+        std::fs::remove_file(&file).unwrap();
+    }
+
+    #[test]
+    fn test_vector_round_trip() {
+        let v = linvector![1.0, 2.0, 3.0];
+        let file = path("vector");
+        v.save(&file).unwrap();
+        assert_eq!(LinVector::load(&file).unwrap(), v);
+        let mapped = unsafe { MappedFile::open(&file) }.unwrap();
+        assert_eq!(mapped.vector().unwrap().dot_product(v.view()).unwrap(), lnum!(14.0));
+        assert_eq!(mapped.dim(), (3, 1));
+        let empty = LinVector { numbers: Vec::new() };
+        empty.save(&file).unwrap();
+        assert_eq!(LinVector::load(&file).unwrap(), empty);
+        assert_eq!(unsafe { MappedFile::open(&file) }.unwrap().as_slice().len(), 0);
+        std::fs::remove_file(&file).unwrap();
+    }
+
+    #[test]
+    fn test_rejects_invalid_files() {
+        let file = path("invalid");
+        sample().save(&file).unwrap();
+        let bytes = std::fs::read(&file).unwrap();
+        std::fs::write(&file, &bytes[..bytes.len() - 1]).unwrap();
+        assert_eq!(unsafe { MappedFile::open(&file) }.err().unwrap().kind(), io::ErrorKind::InvalidData);
+        std::fs::write(&file, b"not a matrix").unwrap();
+        assert!(unsafe { MappedFile::open(&file) }.is_err());
+        assert!(LinMatrix::load(&file).is_err());
+
+        // A bad tag and a zero denominator are found by `check` over their range, and by `load`.
+        let mut corrupt = bytes.clone();
+        corrupt[HEADER_SIZE] = 7;
+        corrupt[HEADER_SIZE + 2 * ELEMENT_SIZE + 32..HEADER_SIZE + 3 * ELEMENT_SIZE].fill(0);
+        std::fs::write(&file, &corrupt).unwrap();
+        assert!(LinMatrix::load(&file).is_err());
+        let mapped = unsafe { MappedFile::open(&file) }.unwrap();
+        assert!(!mapped.check(0, 1) && !mapped.check(2, 1) && !mapped.check(1, 2));
+        assert!(mapped.check(1, 1) && mapped.check(3, 9) && mapped.check(12, 0));
+        assert!(!mapped.check(3, 10) && !mapped.check(13, 0));
+        drop(mapped);
+        corrupt[HEADER_SIZE] = bytes[HEADER_SIZE];
+        std::fs::write(&file, &corrupt).unwrap();
+        assert!(LinMatrix::load(&file).is_err());
+        assert!(LinMatrix::load(&file).is_err());
+        std::fs::remove_file(&file).unwrap();
+    }
+}
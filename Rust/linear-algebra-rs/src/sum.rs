@@ -0,0 +1,130 @@
+//! Summation methods for dot products and norms.
+//!
+//! Sums of many terms lose accuracy when they are added one by one, since
+//! every addition rounds. [`Summation::Neumaier`] carries the rounding errors
+//! along in a second accumulator and [`Summation::Pairwise`] adds the terms as
+//! a balanced tree, either of which keeps `f64` sums about as accurate as the
+//! result can be represented.
+
+use crate::linnum::LinNum;
+
+/// Number of terms [`Summation::Pairwise`] adds serially before combining.
+const PAIRWISE_BLOCK: usize = 32;
+
+/// The ways a sum of terms can be accumulated. The terms are added as reals,
+/// which dot products always returned.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Summation {
+    /// A single running sum, whose error grows with the number of terms.
+    Serial,
+    /// A running sum plus one collecting the rounding error of every
+    /// addition (Kahan-Neumaier), accurate to about one rounding of the result.
+    #[default]
+    Neumaier,
+    /// Blocks of terms summed serially and combined as a balanced tree, so the
+    /// error grows with the logarithm of the number of terms.
+    Pairwise,
+}
+
+impl Summation {
+    /// Adds up `terms` with this method.
+    pub fn sum<I: IntoIterator<Item = LinNum>>(self, terms: I) -> LinNum {
+        let terms = terms.into_iter().map(f64::from);
+        let sum = match self {
+            Summation::Serial => terms.sum(),
+            Summation::Neumaier => neumaier(terms),
+            Summation::Pairwise => pairwise(terms),
+        };
+        LinNum::new_real(sum)
+    }
+}
+
+fn neumaier(terms: impl Iterator<Item = f64>) -> f64 {
+    let (mut sum, mut comp) = (0.0f64, 0.0f64);
+    for x in terms {
+        let t = sum + x;
+        comp += if sum.abs() >= x.abs() { (sum - t) + x } else { (x - t) + sum };
+        sum = t;
+    }
+    // An infinite sum leaves a NaN compensation behind, the sum alone is right.
+    if comp.is_nan() { sum } else { sum + comp }
+}
+
+/// Sums blocks of `PAIRWISE_BLOCK` terms and merges equal-sized partial sums
+/// as they complete, like the carries of a binary counter, so the terms are
+/// streamed with a stack of one partial sum per level.
+fn pairwise(terms: impl Iterator<Item = f64>) -> f64 {
+    let mut stack: Vec<(f64, u32)> = Vec::new();
+    let (mut block, mut len) = (0.0, 0);
+    for x in terms {
+        block += x;
+        len += 1;
+        if len == PAIRWISE_BLOCK {
+            let mut partial = (block, 0);
+            while let Some(&(sum, level)) = stack.last() {
+                if level != partial.1 {
+                    break;
+                }
+                stack.pop();
+                partial = (sum + partial.0, level + 1);
+            }
+            stack.push(partial);
+            (block, len) = (0.0, 0);
+        }
+    }
+    stack.into_iter().rev().fold(block, |acc, (sum, _)| sum + acc)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Terms whose exact sum is 1, but whose serial sum is not.
+    fn terms(n: usize) -> Vec<LinNum> {
+        let mut terms = vec![lnum!(1.0)];
+        for _ in 0..n {
+            terms.push(lnum!(1e-16));
+            terms.push(lnum!(-1e-16));
+        }
+        terms.extend((0..n).map(|_| lnum!(0.1)));
+        terms.extend((0..n).map(|_| lnum!(-0.1)));
+        terms
+    }
+
+    #[test]
+    fn test_compensated_is_exact() {
+        let exact = lnum!(1.0);
+        let serial = Summation::Serial.sum(terms(1000));
+        assert_ne!(serial, exact);
+        assert_eq!(Summation::Neumaier.sum(terms(1000)), exact);
+    }
+
+    #[test]
+    fn test_pairwise_beats_serial() {
+        let terms = vec![lnum!(0.1); 100_000];
+        let error = |summation: Summation| (f64::from(summation.sum(terms.iter().copied())) - 10_000.0).abs();
+        assert_eq!(error(Summation::Neumaier), 0.0);
+        assert!(error(Summation::Pairwise) * 1000.0 < error(Summation::Serial));
+    }
+
+    #[test]
+    fn test_pairwise_matches_small_sums() {
+        for n in [0usize, 1, 31, 32, 33, 64, 100, 1000] {
+            let values: Vec<LinNum> = (0..n).map(|i| LinNum::new_real(i as f64)).collect();
+            assert_eq!(Summation::Pairwise.sum(values), LinNum::new_real((n * n.saturating_sub(1) / 2) as f64));
+        }
+    }
+
+    #[test]
+    fn test_non_finite() {
+        let terms = [lnum!(f64::MAX), lnum!(f64::MAX), lnum!(1.0)];
+        assert_eq!(Summation::Neumaier.sum(terms), lnum!(f64::INFINITY));
+        assert_eq!(Summation::Pairwise.sum(terms), lnum!(f64::INFINITY));
+    }
+
+    #[test]
+    fn test_rationals_are_summed_as_reals() {
+        let terms = [LinNum::new_rational(1, 2), LinNum::new_rational(1, 4)];
+        assert_eq!(Summation::default().sum(terms), lnum!(0.75));
+    }
+}
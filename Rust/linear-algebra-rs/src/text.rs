@@ -0,0 +1,213 @@
+//! Bulk text formatting and parsing of vectors and matrices.
+//!
+//! Elements are written as the shortest text that parses back to the same
+//! value: `n` or `n/d` for rationals, and for reals the shortest round-trip
+//! digits, always with a `.`, an exponent or `inf`/`NaN` so they read back as
+//! reals. Matrices are written one row per line. Output is collected in
+//! chunks of [`CHUNK`] bytes, so a writer sees one `write_all` per chunk
+//! instead of one write per element. The format is the one of the C
+//! library's `text.h`.
+//!
+//! The parsers accept elements separated by any mix of spaces, tabs, commas,
+//! semicolons and brackets, so CSV and whitespace separated text read back.
+//! Integers and `n/d` become rationals and everything else a real; integers
+//! beyond `i128` are read as reals.
+
+use crate::linnum::LinNum;
+use crate::matrix::LinMatrix;
+use crate::vector::LinVector;
+use std::fmt::Write as _;
+use std::io::{self, Read, Write};
+
+/// The size of the chunks the writers hand to their output.
+pub const CHUNK: usize = 64 * 1024;
+
+fn push_number(text: &mut String, num: &LinNum) {
+    // Writing into a `String` cannot fail.
+    let _ = match num.rational_parts() {
+        Some((num, 1)) => write!(text, "{}", num),
+        Some((num, den)) => write!(text, "{}/{}", num, den),
+        None => write!(text, "{:?}", f64::from(*num)),
+    };
+}
+
+/// Writes rows of `cols` elements, flushing `text` to `out` once it holds a chunk.
+fn write_rows<W: Write>(mut out: W, data: &[LinNum], cols: usize, sep: char) -> io::Result<()> {
+    let mut text = String::with_capacity(CHUNK + 128);
+    for row in data.chunks(cols.max(1)) {
+        for (j, num) in row.iter().enumerate() {
+            if j != 0 {
+                text.push(sep);
+            }
+            push_number(&mut text, num);
+            if text.len() >= CHUNK {
+                out.write_all(text.as_bytes())?;
+                text.clear();
+            }
+        }
+        text.push('\n');
+    }
+    out.write_all(text.as_bytes())?;
+    out.flush()
+}
+
+fn is_separator(c: char) -> bool {
+    matches!(c, ' ' | '\t' | ',' | ';' | '[' | ']' | '\r')
+}
+
+fn parse_number(token: &str) -> Option<LinNum> {
+    if let Some((num, den)) = token.split_once('/') {
+        let num = num.parse::<i128>().ok()?;
+        let den = den.parse::<i128>().ok().filter(|&den| den > 0)?;
+        return Some(LinNum::new_rational(num, den));
+    }
+    if let Ok(num) = token.parse::<i128>() {
+        return Some(LinNum::new_rational(num, 1));
+    }
+    token.parse::<f64>().ok().map(LinNum::new_real)
+}
+
+/// Parses every element of `text`, returning them with the shape of the
+/// non-blank lines. With `rectangular` the lines must all hold the same
+/// number of elements.
+fn parse(text: &str, rectangular: bool) -> io::Result<(Vec<LinNum>, usize, usize)> {
+    let mut data = Vec::new();
+    let (mut rows, mut cols) = (0, 0);
+    for (line, content) in text.lines().enumerate() {
+        let mut fields = 0;
+        for token in content.split(is_separator).filter(|token| !token.is_empty()) {
+            fields += 1;
+            let num = parse_number(token).ok_or_else(|| {
+                invalid(format!("invalid number \"{}\" at line {}, field {}", token, line + 1, fields))
+            })?;
+            data.push(num);
+        }
+        if fields == 0 {
+            continue;
+        }
+        if rectangular && rows != 0 && fields != cols {
+            return Err(invalid(format!("line {} has {} elements instead of {}", line + 1, fields, cols)));
+        }
+        cols = fields;
+        rows += 1;
+    }
+    Ok((data, rows, cols))
+}
+
+fn invalid(message: String) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, message)
+}
+
+fn read_all<R: Read>(mut input: R) -> io::Result<String> {
+    let mut text = String::new();
+    input.read_to_string(&mut text)?;
+    Ok(text)
+}
+
+impl LinMatrix {
+    /// Writes the matrix as text, one row per line with the elements separated by `sep`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the text was written.
+    /// - `Err(error)` if `out` failed.
+    pub fn write_text<W: Write>(&self, out: W, sep: char) -> io::Result<()> {
+        write_rows(out, &self.data, self.cols, sep)
+    }
+
+    /// Returns the text [`LinMatrix::write_text`] writes.
+    pub fn to_text(&self, sep: char) -> String {
+        let mut text = Vec::new();
+        self.write_text(&mut text, sep).expect("writing to a Vec cannot fail");
+        String::from_utf8(text).expect("the text is ASCII")
+    }
+
+    /// Parses a matrix from text with one row per line, such as CSV.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(matrix)` with the matrix.
+    /// - `Err(error)` if an element is not a number or the rows differ in length.
+    pub fn parse_text(text: &str) -> io::Result<LinMatrix> {
+        let (data, rows, cols) = parse(text, true)?;
+        Ok(LinMatrix { rows, cols, data })
+    }
+
+    /// Reads all of `input` and parses it with [`LinMatrix::parse_text`].
+    pub fn read_text<R: Read>(input: R) -> io::Result<LinMatrix> {
+        LinMatrix::parse_text(&read_all(input)?)
+    }
+}
+
+impl LinVector {
+    /// Writes the vector as one line of text with the elements separated by `sep`.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(())` if the text was written.
+    /// - `Err(error)` if `out` failed.
+    pub fn write_text<W: Write>(&self, out: W, sep: char) -> io::Result<()> {
+        write_rows(out, &self.numbers, self.numbers.len(), sep)
+    }
+
+    /// Returns the text [`LinVector::write_text`] writes.
+    pub fn to_text(&self, sep: char) -> String {
+        let mut text = Vec::new();
+        self.write_text(&mut text, sep).expect("writing to a Vec cannot fail");
+        String::from_utf8(text).expect("the text is ASCII")
+    }
+
+    /// Parses a vector from text, taking the elements of every line in order.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(vector)` with the vector.
+    /// - `Err(error)` if an element is not a number.
+    pub fn parse_text(text: &str) -> io::Result<LinVector> {
+        let (numbers, _, _) = parse(text, false)?;
+        Ok(LinVector { numbers })
+    }
+
+    /// Reads all of `input` and parses it with [`LinVector::parse_text`].
+    pub fn read_text<R: Read>(input: R) -> io::Result<LinVector> {
+        LinVector::parse_text(&read_all(input)?)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_matrix_text_round_trip() {
+        let mut matrix = LinMatrix::new(2, 3);
+        matrix.set(0, 0, LinNum::new_rational(2, 3));
+        matrix.set(0, 1, LinNum::new_rational(-7, 1));
+        matrix.set(0, 2, LinNum::new_real(0.1));
+        matrix.set(1, 0, LinNum::new_real(1.0 / 3.0));
+        matrix.set(1, 1, LinNum::new_real(1e300));
+        matrix.set(1, 2, LinNum::new_real(4.0));
+        let text = matrix.to_text(',');
+        assert_eq!(text.lines().next(), Some("2/3,-7,0.1"));
+        let parsed = LinMatrix::parse_text(&text).unwrap();
+        assert_eq!(parsed, matrix);
+        assert!(parsed.get(1, 2).is_real());
+    }
+
+    #[test]
+    fn test_parses_csv_and_whitespace() {
+        let matrix = LinMatrix::parse_text("1, 2;3\n\n[4 5\t6]\r\n").unwrap();
+        assert_eq!(matrix.dim(), (2, 3));
+        assert_eq!(matrix.get(1, 2), LinNum::new_rational(6, 1));
+        let vector = LinVector::read_text("1 2\n3.5".as_bytes()).unwrap();
+        assert_eq!(vector.to_text(' '), "1 2 3.5\n");
+    }
+
+    #[test]
+    fn test_rejects_invalid_text() {
+        assert!(LinMatrix::parse_text("1 2\n3").is_err());
+        assert!(LinMatrix::parse_text("1 x").is_err());
+        assert!(LinMatrix::parse_text("1/0").is_err());
+        assert!(LinVector::parse_text("1 2 three").is_err());
+    }
+}
@@ -1,4 +1,6 @@
 use crate::linnum::LinNum;
+use crate::stats::{self, Kernel};
+use crate::sum::Summation;
 use std::ops::{Add, AddAssign, Div, DivAssign, Index, IndexMut, Mul, MulAssign, Sub, SubAssign};
 
 macro_rules! linvector {
@@ -17,11 +19,31 @@ macro_rules! linvector {
 /// Represents a vector as defined in standard linear algebra.
 #[derive(Debug, PartialEq, Clone)]
 pub struct LinVector {
-    numbers: Vec<LinNum>,
+    pub(crate) numbers: Vec<LinNum>,
 }
 
 
 impl LinVector {
+    /// Creates a vector that takes over the elements of a `Vec`, without copying them.
+    pub fn from_vec(numbers: Vec<LinNum>) -> LinVector {
+        LinVector { numbers }
+    }
+
+    /// Returns the elements of the vector.
+    pub fn as_slice(&self) -> &[LinNum] {
+        &self.numbers
+    }
+
+    /// Returns the elements of the vector, mutably.
+    pub fn as_mut_slice(&mut self) -> &mut [LinNum] {
+        &mut self.numbers
+    }
+
+    /// Returns the elements of the vector, without copying them.
+    pub fn into_vec(self) -> Vec<LinNum> {
+        self.numbers
+    }
+
     /// Returns the dimension of the vector.
     ///
     /// # Returns
@@ -39,13 +61,34 @@ impl LinVector {
     ///
     /// # Returns
     ///
-    /// The dot product of the two vectors.
+    /// The dot product of the two vectors, summed with the default [`Summation`].
     pub fn dot_product(&self, other: &LinVector) -> LinNum {
-        let mut result = LinNum::new_real(0.0);
-        for (num1, num2) in self.numbers.iter().zip(other.numbers.iter()) {
-            result = result + (*num1 * *num2);
-        }
-        result
+        self.dot_product_with(other, Summation::default())
+    }
+
+    /// Computes the dot product of this vector with another vector, adding up
+    /// the products with the given method.
+    ///
+    /// # Parameters
+    ///
+    /// - `other`: A reference to the other vector.
+    /// - `summation`: How the products are added up.
+    ///
+    /// # Returns
+    ///
+    /// The dot product of the two vectors.
+    pub fn dot_product_with(&self, other: &LinVector, summation: Summation) -> LinNum {
+        let _timer = stats::time(Kernel::VectorDot);
+        summation.sum(self.numbers.iter().zip(other.numbers.iter()).map(|(&num1, &num2)| num1 * num2))
+    }
+
+    /// Computes the Euclidean norm of the vector.
+    ///
+    /// # Returns
+    ///
+    /// The square root of the dot product of the vector with itself, as a real number.
+    pub fn norm(&self) -> LinNum {
+        LinNum::new_real(f64::from(self.dot_product(self)).sqrt())
     }
 
     /// Computes the cross product of this vector with another vector.
@@ -85,6 +128,12 @@ impl LinVector {
     }
 }
 
+impl From<Vec<LinNum>> for LinVector {
+    fn from(numbers: Vec<LinNum>) -> LinVector {
+        LinVector::from_vec(numbers)
+    }
+}
+
 impl ToString for LinVector {
     fn to_string(&self) -> String {
         let mut result = String::from("[");
@@ -99,72 +148,135 @@ impl ToString for LinVector {
     }
 }
 
+impl LinVector {
+    /// Adds `alpha * x` to the vector in a single pass, without a temporary.
+    ///
+    /// Like [`LinMatrix::axpy`](crate::matrix::LinMatrix::axpy), rational
+    /// elements stay exact when `alpha` is rational.
+    ///
+    /// # Parameters
+    ///
+    /// - `alpha`: The scale of `x`.
+    /// - `x`: A reference to the vector to add.
+    pub fn axpy(&mut self, alpha: LinNum, x: &LinVector) {
+        for (num1, &num2) in self.numbers.iter_mut().zip(x.numbers.iter()) {
+            *num1 += alpha * num2;
+        }
+    }
+
+    /// Replaces every element with `op(element, other)`, dropping the elements
+    /// `other` has no counterpart for.
+    fn zip_assign(&mut self, other: &LinVector, op: impl Fn(LinNum, LinNum) -> LinNum) {
+        self.numbers.truncate(other.numbers.len());
+        for (num1, &num2) in self.numbers.iter_mut().zip(other.numbers.iter()) {
+            *num1 = op(*num1, num2);
+        }
+    }
+
+    /// Builds a vector from `op(element, other)`.
+    fn zip_with(&self, other: &LinVector, op: impl Fn(LinNum, LinNum) -> LinNum) -> LinVector {
+        LinVector {
+            numbers: self.numbers.iter().zip(other.numbers.iter()).map(|(&num1, &num2)| op(num1, num2)).collect(),
+        }
+    }
+}
+
 impl Add for LinVector {
     type Output = LinVector;
 
-    fn add(self, other: LinVector) -> LinVector {
-        let mut result = Vec::new();
-        for (num1, num2) in self.numbers.iter().zip(other.numbers.iter()) {
-            result.push(*num1 + *num2);
-        }
-        LinVector { numbers: result }
+    fn add(mut self, other: LinVector) -> LinVector {
+        self.zip_assign(&other, |num1, num2| num1 + num2);
+        self
+    }
+}
+
+impl Add<&LinVector> for &LinVector {
+    type Output = LinVector;
+
+    fn add(self, other: &LinVector) -> LinVector {
+        self.zip_with(other, |num1, num2| num1 + num2)
     }
 }
 
 impl Sub for LinVector {
     type Output = LinVector;
 
-    fn sub(self, other: LinVector) -> LinVector {
-        let mut result = Vec::new();
-        for (num1, num2) in self.numbers.iter().zip(other.numbers.iter()) {
-            result.push(*num1 - *num2);
-        }
-        LinVector { numbers: result }
+    fn sub(mut self, other: LinVector) -> LinVector {
+        self.zip_assign(&other, |num1, num2| num1 - num2);
+        self
+    }
+}
+
+impl Sub<&LinVector> for &LinVector {
+    type Output = LinVector;
+
+    fn sub(self, other: &LinVector) -> LinVector {
+        self.zip_with(other, |num1, num2| num1 - num2)
     }
 }
 
 impl Mul<LinNum> for LinVector {
     type Output = LinVector;
 
+    fn mul(mut self, other: LinNum) -> LinVector {
+        self *= other;
+        self
+    }
+}
+
+impl Mul<LinNum> for &LinVector {
+    type Output = LinVector;
+
     fn mul(self, other: LinNum) -> LinVector {
-        let mut result = Vec::new();
-        for num in self.numbers.iter() {
-            result.push(num.to_real() * other.to_real());
-        }
-        LinVector { numbers: result }
+        let other = other.to_real();
+        LinVector { numbers: self.numbers.iter().map(|num| num.to_real() * other).collect() }
     }
 }
 
 impl Div<LinNum> for LinVector {
     type Output = LinVector;
 
+    fn div(mut self, other: LinNum) -> LinVector {
+        self /= other;
+        self
+    }
+}
+
+impl Div<LinNum> for &LinVector {
+    type Output = LinVector;
+
     fn div(self, other: LinNum) -> LinVector {
-        let mut result = Vec::new();
-        for num in self.numbers.iter() {
-            result.push(num.to_real() / other.to_real());
-        }
-        LinVector { numbers: result }
+        let other = other.to_real();
+        LinVector { numbers: self.numbers.iter().map(|num| num.to_real() / other).collect() }
     }
 }
 
 impl MulAssign<LinNum> for LinVector {
     fn mul_assign(&mut self, other: LinNum) {
+        let other = other.to_real();
         for num in self.numbers.iter_mut() {
-            *num = num.to_real() * other.to_real();
+            *num = num.to_real() * other;
         }
     }
 }
 
 impl DivAssign<LinNum> for LinVector {
     fn div_assign(&mut self, other: LinNum) {
+        let other = other.to_real();
         for num in self.numbers.iter_mut() {
-            *num = num.to_real() / other.to_real();
+            *num = num.to_real() / other;
         }
     }
 }
 
 impl AddAssign for LinVector {
     fn add_assign(&mut self, other: LinVector) {
+        *self += &other;
+    }
+}
+
+impl AddAssign<&LinVector> for LinVector {
+    fn add_assign(&mut self, other: &LinVector) {
         for (num1, num2) in self.numbers.iter_mut().zip(other.numbers.iter()) {
             *num1 = num1.to_real() + num2.to_real();
         }
@@ -173,6 +285,12 @@ impl AddAssign for LinVector {
 
 impl SubAssign for LinVector {
     fn sub_assign(&mut self, other: LinVector) {
+        *self -= &other;
+    }
+}
+
+impl SubAssign<&LinVector> for LinVector {
+    fn sub_assign(&mut self, other: &LinVector) {
         for (num1, num2) in self.numbers.iter_mut().zip(other.numbers.iter()) {
             *num1 = num1.to_real() - num2.to_real();
         }
@@ -293,6 +411,42 @@ mod tests {
         assert_eq!(vec1, linvector![-3, -3, -3]);
     }
 
+    #[test]
+    fn test_ref_ops() {
+        let vec1 = linvector![1, 2, 3];
+        let vec2 = linvector![4, 5, 6];
+        assert_eq!(&vec1 + &vec2, linvector![5, 7, 9]);
+        assert_eq!(&vec1 - &vec2, linvector![-3, -3, -3]);
+        assert_eq!(&vec1 * LinNum::new_real(2.0), linvector![2, 4, 6]);
+        assert_eq!(&vec2 / LinNum::new_real(2.0), linvector![2.0, 2.5, 3.0]);
+        let mut vec3 = vec1.clone();
+        vec3 += &vec2;
+        vec3 -= &vec1;
+        assert_eq!(vec3, vec2);
+    }
+
+    #[test]
+    fn test_axpy() {
+        let mut vec1 = linvector![1, 2, 3];
+        let vec2 = linvector![4, 5, 6];
+        vec1.axpy(LinNum::new_real(2.0), &vec2);
+        assert_eq!(vec1, linvector![9, 12, 15]);
+
+        let mut exact = LinVector { numbers: vec![LinNum::new_rational(1, 3), LinNum::new_rational(-1, 2)] };
+        let x = LinVector { numbers: vec![LinNum::new_rational(2, 5), LinNum::new_rational(1, 1)] };
+        exact.axpy(LinNum::new_rational(5, 6), &x);
+        assert_eq!(exact.numbers, vec![LinNum::new_rational(2, 3), LinNum::new_rational(1, 3)]);
+    }
+
+    #[test]
+    fn test_norm_and_summation() {
+        assert_eq!(linvector![3, 4].norm(), LinNum::new_real(5.0));
+        let tenths = LinVector { numbers: vec![LinNum::new_real(0.1); 10_000] };
+        let ones = LinVector { numbers: vec![LinNum::new_real(1.0); 10_000] };
+        assert_eq!(tenths.dot_product(&ones), LinNum::new_real(1000.0));
+        assert_ne!(tenths.dot_product_with(&ones, Summation::Serial), LinNum::new_real(1000.0));
+    }
+
     #[test]
     fn test_index() {
         let vec = linvector![1, 2, 3];
@@ -0,0 +1,655 @@
+//! Borrowed, strided views of vectors and matrices.
+//!
+//! A [`VectorView`] is a slice with a length and a stride, a [`MatrixView`] a
+//! slice with a shape and a stride per dimension. Rows, columns, sub-blocks,
+//! transposes and every n-th element of an existing buffer are all views of
+//! it, so they can be handed to the kernels without copying. The `Mut`
+//! variants write through to the borrowed elements.
+
+use crate::gemm;
+use crate::linnum::LinNum;
+use crate::matrix::{LinMatrix, MatrixError};
+use crate::sum::Summation;
+use crate::vector::LinVector;
+use std::borrow::Cow;
+use std::ops::{Index, IndexMut, Mul};
+
+/// Returns the length of the slice holding `len` elements `stride` apart.
+fn span(len: usize, stride: usize) -> usize {
+    if len == 0 { 0 } else { (len - 1) * stride + 1 }
+}
+
+/// Returns the length of the slice holding a `rows` x `cols` strided block.
+fn span2(rows: usize, cols: usize, row_stride: usize, col_stride: usize) -> usize {
+    if rows == 0 || cols == 0 { 0 } else { (rows - 1) * row_stride + (cols - 1) * col_stride + 1 }
+}
+
+/// A read-only strided view of vector elements. Element `i` is `data[i * stride]`.
+#[derive(Debug, Clone, Copy)]
+pub struct VectorView<'a> {
+    data: &'a [LinNum],
+    len: usize,
+    stride: usize,
+}
+
+/// A mutable strided view of vector elements, see [`VectorView`].
+#[derive(Debug)]
+pub struct VectorViewMut<'a> {
+    data: &'a mut [LinNum],
+    len: usize,
+    stride: usize,
+}
+
+/// A read-only strided view of matrix elements. Element `(i, j)` is
+/// `data[i * row_stride + j * col_stride]`, so a block keeps the row stride
+/// of its parent and a transpose is the same buffer with the strides swapped.
+#[derive(Debug, Clone, Copy)]
+pub struct MatrixView<'a> {
+    pub(crate) data: &'a [LinNum],
+    pub(crate) rows: usize,
+    pub(crate) cols: usize,
+    pub(crate) row_stride: usize,
+    pub(crate) col_stride: usize,
+}
+
+/// A mutable strided view of matrix elements, see [`MatrixView`].
+#[derive(Debug)]
+pub struct MatrixViewMut<'a> {
+    data: &'a mut [LinNum],
+    rows: usize,
+    cols: usize,
+    row_stride: usize,
+    col_stride: usize,
+}
+
+impl<'a> VectorView<'a> {
+    /// Creates a view of every element of a slice.
+    pub fn from_slice(data: &'a [LinNum]) -> VectorView<'a> {
+        VectorView { data, len: data.len(), stride: 1 }
+    }
+
+    /// Returns the number of elements in the view.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns `true` if the view has no elements.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Returns the element at the specified index.
+    pub fn get(&self, index: usize) -> LinNum {
+        self[index]
+    }
+
+    /// Returns an iterator over the elements of the view.
+    pub fn iter(&self) -> impl Iterator<Item = &'a LinNum> + 'a {
+        let data = self.data;
+        data.iter().step_by(self.stride.max(1)).take(self.len)
+    }
+
+    /// Returns a view of `len` elements starting at `start`, taking every
+    /// `step`-th element.
+    ///
+    /// # Panics
+    ///
+    /// This function panics if `step` is 0 or the elements are out of bounds.
+    pub fn slice(&self, start: usize, len: usize, step: usize) -> VectorView<'a> {
+        assert!(step > 0 && (len == 0 || start + (len - 1) * step < self.len), "vector view out of bounds");
+        let stride = self.stride * step;
+        let data = if len == 0 { &self.data[..0] } else { &self.data[start * self.stride..][..span(len, stride)] };
+        VectorView { data, len, stride }
+    }
+
+    /// Copies the elements of the view into a new vector.
+    pub fn to_vector(&self) -> LinVector {
+        LinVector { numbers: self.iter().copied().collect() }
+    }
+
+    /// Computes the dot product of two views, summed with the default [`Summation`].
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(dot)` with the dot product.
+    /// - `Err(MatrixError::DimensionMismatch)` if the views differ in length.
+    pub fn dot_product(&self, other: VectorView) -> Result<LinNum, MatrixError> {
+        if self.len != other.len {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        Ok(Summation::default().sum(self.iter().zip(other.iter()).map(|(&x, &y)| x * y)))
+    }
+}
+
+impl Index<usize> for VectorView<'_> {
+    type Output = LinNum;
+
+    fn index(&self, index: usize) -> &LinNum {
+        assert!(index < self.len, "vector view index out of bounds");
+        &self.data[index * self.stride]
+    }
+}
+
+impl<'a> VectorViewMut<'a> {
+    /// Creates a mutable view of every element of a slice.
+    pub fn from_slice(data: &'a mut [LinNum]) -> VectorViewMut<'a> {
+        VectorViewMut { len: data.len(), data, stride: 1 }
+    }
+
+    /// Returns the number of elements in the view.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns `true` if the view has no elements.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Returns a read-only view of the same elements.
+    pub fn as_view(&self) -> VectorView<'_> {
+        VectorView { data: self.data, len: self.len, stride: self.stride }
+    }
+
+    /// Returns a mutable view of `len` elements starting at `start`, taking
+    /// every `step`-th element, see [`VectorView::slice`].
+    pub fn slice_mut(&mut self, start: usize, len: usize, step: usize) -> VectorViewMut<'_> {
+        assert!(step > 0 && (len == 0 || start + (len - 1) * step < self.len), "vector view out of bounds");
+        let stride = self.stride * step;
+        let data: &mut [LinNum] = self.data;
+        let data = if len == 0 { &mut data[..0] } else { &mut data[start * self.stride..][..span(len, stride)] };
+        VectorViewMut { data, len, stride }
+    }
+
+    /// Applies `op` to every element of the view.
+    fn for_each(&mut self, mut op: impl FnMut(usize, &mut LinNum)) {
+        for (i, value) in self.data.iter_mut().step_by(self.stride.max(1)).take(self.len).enumerate() {
+            op(i, value);
+        }
+    }
+
+    /// Sets every element of the view to `value`.
+    pub fn fill(&mut self, value: LinNum) {
+        self.for_each(|_, x| *x = value);
+    }
+
+    /// Multiplies every element of the view by `alpha`.
+    pub fn scale(&mut self, alpha: LinNum) {
+        self.for_each(|_, x| *x *= alpha);
+    }
+
+    /// Copies the elements of `other` into the view.
+    ///
+    /// Returns `Err(MatrixError::DimensionMismatch)` if the lengths differ.
+    pub fn copy_from(&mut self, other: VectorView) -> Result<(), MatrixError> {
+        if self.len != other.len {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.for_each(|i, x| *x = other[i]);
+        Ok(())
+    }
+
+    /// Adds `alpha * x` to the elements of the view, see [`LinVector::axpy`].
+    ///
+    /// Returns `Err(MatrixError::DimensionMismatch)` if the lengths differ.
+    pub fn axpy(&mut self, alpha: LinNum, x: VectorView) -> Result<(), MatrixError> {
+        if self.len != x.len {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.for_each(|i, y| *y += alpha * x[i]);
+        Ok(())
+    }
+}
+
+impl Index<usize> for VectorViewMut<'_> {
+    type Output = LinNum;
+
+    fn index(&self, index: usize) -> &LinNum {
+        assert!(index < self.len, "vector view index out of bounds");
+        &self.data[index * self.stride]
+    }
+}
+
+impl IndexMut<usize> for VectorViewMut<'_> {
+    fn index_mut(&mut self, index: usize) -> &mut LinNum {
+        assert!(index < self.len, "vector view index out of bounds");
+        &mut self.data[index * self.stride]
+    }
+}
+
+impl<'a> MatrixView<'a> {
+    /// Creates a view of a slice holding a `rows` x `cols` matrix in row-major order.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(view)` with the view.
+    /// - `Err(MatrixError::DimensionMismatch)` if `data` does not hold `rows * cols` elements.
+    pub fn from_slice(data: &'a [LinNum], rows: usize, cols: usize) -> Result<MatrixView<'a>, MatrixError> {
+        if data.len() != rows * cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        Ok(MatrixView { data, rows, cols, row_stride: cols, col_stride: 1 })
+    }
+
+    /// Returns the dimensions of the view as a tuple `(rows, cols)`.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    /// Returns the value at the specified row and column of the view.
+    pub fn get(&self, row: usize, col: usize) -> LinNum {
+        self[(row, col)]
+    }
+
+    /// Returns a view of the transpose, without copying it.
+    pub fn t(self) -> MatrixView<'a> {
+        MatrixView {
+            data: self.data,
+            rows: self.cols,
+            cols: self.rows,
+            row_stride: self.col_stride,
+            col_stride: self.row_stride,
+        }
+    }
+
+    /// Returns a view of the `rows` x `cols` block starting at `(row, col)`.
+    ///
+    /// # Panics
+    ///
+    /// This function panics if the block does not fit in the view.
+    pub fn block(&self, row: usize, col: usize, rows: usize, cols: usize) -> MatrixView<'a> {
+        assert!(row + rows <= self.rows && col + cols <= self.cols, "matrix view out of bounds");
+        let len = span2(rows, cols, self.row_stride, self.col_stride);
+        let data = if len == 0 { &self.data[..0] } else { &self.data[row * self.row_stride + col * self.col_stride..][..len] };
+        MatrixView { data, rows, cols, row_stride: self.row_stride, col_stride: self.col_stride }
+    }
+
+    /// Returns a view of the specified row.
+    pub fn row(&self, row: usize) -> VectorView<'a> {
+        let block = self.block(row, 0, 1, self.cols);
+        VectorView { data: block.data, len: self.cols, stride: self.col_stride }
+    }
+
+    /// Returns a view of the specified column.
+    pub fn col(&self, col: usize) -> VectorView<'a> {
+        let block = self.block(0, col, self.rows, 1);
+        VectorView { data: block.data, len: self.rows, stride: self.row_stride }
+    }
+
+    /// Returns an iterator over the elements of the view in row-major order.
+    pub fn iter(&self) -> impl Iterator<Item = &'a LinNum> + 'a {
+        let view = *self;
+        (0..view.rows).flat_map(move |i| view.row(i).iter())
+    }
+
+    /// Returns `true` if the view covers its whole buffer in row-major order.
+    fn is_contiguous(&self) -> bool {
+        self.col_stride == 1 && self.row_stride == self.cols && self.data.len() == self.rows * self.cols
+    }
+
+    /// Returns the elements in row-major order, borrowing them when the view
+    /// already is contiguous and copying them otherwise.
+    pub(crate) fn row_major(&self) -> Cow<'a, [LinNum]> {
+        if self.is_contiguous() {
+            Cow::Borrowed(self.data)
+        } else if self.t().is_contiguous() {
+            Cow::Owned(crate::matrix::transpose_data(self.data, self.cols, self.rows))
+        } else {
+            Cow::Owned(self.iter().copied().collect())
+        }
+    }
+
+    /// Converts the elements to `f64` if they are all real, returning the
+    /// values with the strides to read them by. Views covering a whole buffer
+    /// keep their layout; others are gathered in row-major order.
+    pub(crate) fn to_f64(&self) -> Option<(Vec<f64>, usize, usize)> {
+        if self.is_contiguous() || self.t().is_contiguous() {
+            if !self.data.iter().all(LinNum::is_real) {
+                return None;
+            }
+            return Some((self.data.iter().map(|&x| f64::from(x)).collect(), self.row_stride, self.col_stride));
+        }
+        if !self.iter().all(LinNum::is_real) {
+            return None;
+        }
+        Some((self.iter().map(|&x| f64::from(x)).collect(), self.cols, 1))
+    }
+
+    /// Copies the elements of the view into a new matrix.
+    pub fn to_matrix(&self) -> LinMatrix {
+        LinMatrix { rows: self.rows, cols: self.cols, data: self.row_major().into_owned() }
+    }
+
+    /// Multiplies the view by a vector view.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(vector)` with one element per row of the view.
+    /// - `Err(MatrixError::DimensionMismatch)` if the vector does not have one
+    ///   element per column.
+    pub fn mul_vector(&self, vector: VectorView) -> Result<LinVector, MatrixError> {
+        if self.cols != vector.len {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        let numbers = (0..self.rows).map(|i| self.row(i).dot_product(vector)).collect::<Result<_, _>>()?;
+        Ok(LinVector { numbers })
+    }
+}
+
+impl Index<(usize, usize)> for MatrixView<'_> {
+    type Output = LinNum;
+
+    fn index(&self, (row, col): (usize, usize)) -> &LinNum {
+        assert!(row < self.rows && col < self.cols, "matrix view index out of bounds");
+        &self.data[row * self.row_stride + col * self.col_stride]
+    }
+}
+
+impl<'a> MatrixViewMut<'a> {
+    /// Creates a mutable view of a slice holding a `rows` x `cols` matrix in row-major order.
+    ///
+    /// # Returns
+    ///
+    /// - `Ok(view)` with the view.
+    /// - `Err(MatrixError::DimensionMismatch)` if `data` does not hold `rows * cols` elements.
+    pub fn from_slice(data: &'a mut [LinNum], rows: usize, cols: usize) -> Result<MatrixViewMut<'a>, MatrixError> {
+        if data.len() != rows * cols {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        Ok(MatrixViewMut { data, rows, cols, row_stride: cols, col_stride: 1 })
+    }
+
+    /// Returns the dimensions of the view as a tuple `(rows, cols)`.
+    pub fn dim(&self) -> (usize, usize) {
+        (self.rows, self.cols)
+    }
+
+    /// Returns a read-only view of the same elements.
+    pub fn as_view(&self) -> MatrixView<'_> {
+        MatrixView {
+            data: self.data,
+            rows: self.rows,
+            cols: self.cols,
+            row_stride: self.row_stride,
+            col_stride: self.col_stride,
+        }
+    }
+
+    /// Narrows the view to the `rows` x `cols` block starting at `(row, col)`.
+    fn into_block(self, row: usize, col: usize, rows: usize, cols: usize) -> MatrixViewMut<'a> {
+        assert!(row + rows <= self.rows && col + cols <= self.cols, "matrix view out of bounds");
+        let len = span2(rows, cols, self.row_stride, self.col_stride);
+        let start = row * self.row_stride + col * self.col_stride;
+        let data = if len == 0 { &mut self.data[..0] } else { &mut self.data[start..][..len] };
+        MatrixViewMut { data, rows, cols, row_stride: self.row_stride, col_stride: self.col_stride }
+    }
+
+    /// Returns a mutable view of the `rows` x `cols` block starting at
+    /// `(row, col)`, see [`MatrixView::block`].
+    pub fn block_mut(&mut self, row: usize, col: usize, rows: usize, cols: usize) -> MatrixViewMut<'_> {
+        self.reborrow().into_block(row, col, rows, cols)
+    }
+
+    /// Returns a mutable view of the specified row.
+    pub fn row_mut(&mut self, row: usize) -> VectorViewMut<'_> {
+        let (cols, stride) = (self.cols, self.col_stride);
+        let block = self.reborrow().into_block(row, 0, 1, cols);
+        VectorViewMut { data: block.data, len: cols, stride }
+    }
+
+    /// Returns a mutable view of the specified column.
+    pub fn col_mut(&mut self, col: usize) -> VectorViewMut<'_> {
+        let (rows, stride) = (self.rows, self.row_stride);
+        let block = self.reborrow().into_block(0, col, rows, 1);
+        VectorViewMut { data: block.data, len: rows, stride }
+    }
+
+    fn reborrow(&mut self) -> MatrixViewMut<'_> {
+        MatrixViewMut {
+            data: self.data,
+            rows: self.rows,
+            cols: self.cols,
+            row_stride: self.row_stride,
+            col_stride: self.col_stride,
+        }
+    }
+
+    /// Applies `op(row, col, element)` to every element of the view.
+    fn for_each(&mut self, mut op: impl FnMut(usize, usize, &mut LinNum)) {
+        for i in 0..self.rows {
+            for j in 0..self.cols {
+                op(i, j, &mut self.data[i * self.row_stride + j * self.col_stride]);
+            }
+        }
+    }
+
+    /// Sets every element of the view to `value`.
+    pub fn fill(&mut self, value: LinNum) {
+        self.for_each(|_, _, x| *x = value);
+    }
+
+    /// Multiplies every element of the view by `alpha`.
+    pub fn scale(&mut self, alpha: LinNum) {
+        self.for_each(|_, _, x| *x *= alpha);
+    }
+
+    /// Copies the elements of `other` into the view.
+    ///
+    /// Returns `Err(MatrixError::DimensionMismatch)` if the shapes differ.
+    pub fn copy_from(&mut self, other: MatrixView) -> Result<(), MatrixError> {
+        if self.dim() != other.dim() {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.for_each(|i, j, x| *x = other[(i, j)]);
+        Ok(())
+    }
+
+    /// Adds `alpha * x` to the elements of the view.
+    ///
+    /// Returns `Err(MatrixError::DimensionMismatch)` if the shapes differ.
+    pub fn axpy(&mut self, alpha: LinNum, x: MatrixView) -> Result<(), MatrixError> {
+        if self.dim() != x.dim() {
+            return Err(MatrixError::DimensionMismatch);
+        }
+        self.for_each(|i, j, y| *y += alpha * x[(i, j)]);
+        Ok(())
+    }
+}
+
+impl Index<(usize, usize)> for MatrixViewMut<'_> {
+    type Output = LinNum;
+
+    fn index(&self, (row, col): (usize, usize)) -> &LinNum {
+        assert!(row < self.rows && col < self.cols, "matrix view index out of bounds");
+        &self.data[row * self.row_stride + col * self.col_stride]
+    }
+}
+
+impl IndexMut<(usize, usize)> for MatrixViewMut<'_> {
+    fn index_mut(&mut self, (row, col): (usize, usize)) -> &mut LinNum {
+        assert!(row < self.rows && col < self.cols, "matrix view index out of bounds");
+        &mut self.data[row * self.row_stride + col * self.col_stride]
+    }
+}
+
+impl LinVector {
+    /// Returns a view of all the elements of the vector.
+    pub fn view(&self) -> VectorView<'_> {
+        VectorView::from_slice(&self.numbers)
+    }
+
+    /// Returns a mutable view of all the elements of the vector.
+    pub fn view_mut(&mut self) -> VectorViewMut<'_> {
+        VectorViewMut::from_slice(&mut self.numbers)
+    }
+
+    /// Returns a view of `len` elements starting at `start`, taking every
+    /// `step`-th element, see [`VectorView::slice`].
+    pub fn slice(&self, start: usize, len: usize, step: usize) -> VectorView<'_> {
+        self.view().slice(start, len, step)
+    }
+}
+
+impl LinMatrix {
+    /// Returns a view of the whole matrix.
+    pub fn view(&self) -> MatrixView<'_> {
+        MatrixView { data: &self.data, rows: self.rows, cols: self.cols, row_stride: self.cols, col_stride: 1 }
+    }
+
+    /// Returns a mutable view of the whole matrix.
+    pub fn view_mut(&mut self) -> MatrixViewMut<'_> {
+        MatrixViewMut { data: &mut self.data, rows: self.rows, cols: self.cols, row_stride: self.cols, col_stride: 1 }
+    }
+
+    /// Returns a view of the specified row.
+    pub fn row(&self, row: usize) -> VectorView<'_> {
+        self.view().row(row)
+    }
+
+    /// Returns a view of the specified column. Its elements are `cols` apart.
+    pub fn col(&self, col: usize) -> VectorView<'_> {
+        self.view().col(col)
+    }
+
+    /// Returns a view of the `rows` x `cols` block starting at `(row, col)`,
+    /// without copying it.
+    pub fn block(&self, row: usize, col: usize, rows: usize, cols: usize) -> MatrixView<'_> {
+        self.view().block(row, col, rows, cols)
+    }
+
+    /// Returns a mutable view of the `rows` x `cols` block starting at `(row, col)`.
+    pub fn block_mut(&mut self, row: usize, col: usize, rows: usize, cols: usize) -> MatrixViewMut<'_> {
+        self.view_mut().into_block(row, col, rows, cols)
+    }
+}
+
+/// Multiplies two views with the kernel of `gemm`, checking their shapes first.
+fn multiply(a: MatrixView, b: MatrixView) -> Result<LinMatrix, MatrixError> {
+    if a.cols != b.rows {
+        return Err(MatrixError::DimensionMismatch);
+    }
+    Ok(gemm::multiply_views(a, b))
+}
+
+impl Mul<MatrixView<'_>> for MatrixView<'_> {
+    type Output = Result<LinMatrix, MatrixError>;
+    /// Multiplies two views with the blocked kernel of `gemm`, reading both
+    /// through their strides.
+    fn mul(self, other: MatrixView<'_>) -> Result<LinMatrix, MatrixError> {
+        multiply(self, other)
+    }
+}
+
+impl Mul<MatrixView<'_>> for &LinMatrix {
+    type Output = Result<LinMatrix, MatrixError>;
+
+    fn mul(self, other: MatrixView<'_>) -> Result<LinMatrix, MatrixError> {
+        multiply(self.view(), other)
+    }
+}
+
+impl Mul<&LinMatrix> for MatrixView<'_> {
+    type Output = Result<LinMatrix, MatrixError>;
+
+    fn mul(self, other: &LinMatrix) -> Result<LinMatrix, MatrixError> {
+        multiply(self, other.view())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn numbered(rows: usize, cols: usize) -> LinMatrix {
+        let mut matrix = LinMatrix::new(rows, cols);
+        for i in 0..rows * cols {
+            matrix.data[i] = lnum!(i as f64);
+        }
+        matrix
+    }
+
+    #[test]
+    fn test_vector_slices() {
+        let vector = linvector![0, 1, 2, 3, 4, 5, 6, 7];
+        let even = vector.slice(0, 4, 2);
+        assert_eq!(even.to_vector(), linvector![0, 2, 4, 6]);
+        assert_eq!(even.slice(1, 2, 2).to_vector(), linvector![2, 6]);
+        assert_eq!(vector.slice(3, 0, 1).len(), 0);
+        assert_eq!(even.dot_product(vector.slice(1, 4, 2)), Ok(lnum!(68.0)));
+        assert_eq!(even.dot_product(vector.view()), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_views_of_slices() {
+        let mut buffer: Vec<LinNum> = (0..6).map(|i| lnum!(i as f64)).collect();
+        let view = MatrixView::from_slice(&buffer, 2, 3).unwrap();
+        assert_eq!(view.to_matrix(), numbered(2, 3));
+        assert_eq!(view.t().get(2, 1), lnum!(5.0));
+        assert!(MatrixView::from_slice(&buffer, 4, 2).is_err());
+        let mut view = MatrixViewMut::from_slice(&mut buffer, 3, 2).unwrap();
+        view[(2, 1)] = lnum!(9.0);
+        assert_eq!(buffer[5], lnum!(9.0));
+    }
+
+    #[test]
+    #[should_panic]
+    fn test_vector_slice_out_of_bounds() {
+        linvector![0, 1, 2].slice(1, 2, 2);
+    }
+
+    #[test]
+    fn test_vector_view_mut() {
+        let mut vector = linvector![1, 2, 3, 4];
+        let other = linvector![10, 20];
+        let mut view = vector.view_mut();
+        let mut odd = view.slice_mut(1, 2, 2);
+        odd.axpy(lnum!(1.0), other.view()).unwrap();
+        odd[0] = lnum!(0.0);
+        view.slice_mut(0, 2, 2).scale(lnum!(2.0));
+        assert_eq!(vector, linvector![2, 0, 6, 24]);
+    }
+
+    #[test]
+    fn test_rows_cols_blocks() {
+        let matrix = numbered(5, 4);
+        assert_eq!(matrix.row(2).to_vector(), linvector![8, 9, 10, 11]);
+        assert_eq!(matrix.col(1).to_vector(), linvector![1, 5, 9, 13, 17]);
+        let block = matrix.block(1, 1, 3, 2);
+        assert_eq!(block.to_matrix(), matrix!([5.0, 6.0], [9.0, 10.0], [13.0, 14.0]));
+        assert_eq!(block.t().to_matrix(), block.to_matrix().transpose());
+        assert_eq!(block.col(1).to_vector(), linvector![6, 10, 14]);
+        assert_eq!(block.t().block(1, 1, 1, 2).to_matrix(), matrix!([10.0, 14.0]));
+        assert_eq!(matrix.block(5, 4, 0, 0).dim(), (0, 0));
+        assert_eq!(block.iter().count(), 6);
+    }
+
+    #[test]
+    fn test_block_products() {
+        let a = numbered(9, 8);
+        let b = numbered(8, 7);
+        let (av, bv) = (a.block(2, 1, 4, 5), b.block(3, 2, 5, 3));
+        assert_eq!(av * bv, &av.to_matrix() * &bv.to_matrix());
+        assert_eq!(bv.t() * av.t(), &bv.to_matrix().transpose() * &av.to_matrix().transpose());
+        let rational = LinMatrix { rows: 4, cols: 5, data: (0..20).map(|i| LinNum::new_rational(i, 3)).collect() };
+        let rv = rational.block(1, 0, 3, 5);
+        assert_eq!(rv * bv, &rv.to_matrix() * &bv.to_matrix());
+        assert_eq!(av * av, Err(MatrixError::DimensionMismatch));
+        let x = linvector![1, 2, 3, 4, 5];
+        assert_eq!(av.mul_vector(x.view()).unwrap().dim(), 4);
+        assert_eq!(av.mul_vector(x.slice(0, 3, 2)), Err(MatrixError::DimensionMismatch));
+    }
+
+    #[test]
+    fn test_matrix_view_mut() {
+        let mut matrix = numbered(4, 4);
+        let source = numbered(2, 2);
+        let mut block = matrix.block_mut(1, 1, 2, 2);
+        block.copy_from(source.view()).unwrap();
+        block.axpy(lnum!(1.0), source.view()).unwrap();
+        block.row_mut(0).fill(lnum!(-1.0));
+        block.col_mut(1)[1] = lnum!(7.0);
+        assert_eq!(matrix.row(1).to_vector(), linvector![4, -1, -1, 7]);
+        assert_eq!(matrix.row(2).to_vector(), linvector![8, 4, 7, 11]);
+        assert_eq!(matrix.block_mut(0, 0, 1, 1).copy_from(source.view()), Err(MatrixError::DimensionMismatch));
+    }
+}